@@ -9,14 +9,70 @@
 #include <sof/audio/asrc/asrc_farrow.h>
 #include <sof/audio/format.h>
 
+/*
+ * The impulse response is stored time reversed by the calc_impulse_response
+ * functions below. The filter_length newest samples of a channel start at
+ * buffer_write_position - filter_length + 1 and are contiguous due to the
+ * redundant ring buffer halves, so the filters are plain forward dot
+ * products. Two channels are filtered per pass to share the impulse
+ * response loads. The loops have no wrap or pointer dependencies and
+ * can be vectorized by the compiler.
+ */
+
+static inline int64_t asrc_dot16(const int16_t *__restrict x,
+				 const int32_t *__restrict h, int length)
+{
+	int64_t prod = 0;
+	int n;
+
+	for (n = 0; n < length; n++)
+		prod += (int64_t)x[n] * h[n];
+
+	return prod;
+}
+
+static inline int64_t asrc_dot32(const int32_t *__restrict x,
+				 const int32_t *__restrict h, int length)
+{
+	int64_t prod = 0;
+	int n;
+
+	for (n = 0; n < length; n++)
+		prod += (int64_t)x[n] * (h[n] >> 8);
+
+	return prod;
+}
+
+/* Data is Q1.15, coefficients are Q1.30. Prod is Qx.45. Shift left after
+ * accumulation, because interim results might saturate during filtering.
+ * Round to 16 bit.
+ */
+static inline int16_t asrc_fir_out16(int64_t prod)
+{
+	return sat_int16(Q_SHIFT_RND(sat_int32(Q_SHIFT(prod, 45, 31)),
+				     31, 15));
+}
+
+/* Data is Q1.31, coefficients are Q1.22. They are down scaled by 1 shift.
+ * In addition there is a C implementation specific right shift by 8. It
+ * gives headroom to calculate up to 256 taps FIR. The use of 24 bits of
+ * 32 bits is not a practical limitation for quality. The product is Qx.54.
+ */
+static inline int32_t asrc_fir_out32(int64_t prod)
+{
+	return sat_int32(Q_SHIFT(prod, 53, 31));
+}
+
 void asrc_fir_filter16(struct asrc_farrow *src_obj, int16_t **output_buffers,
 		       int index_output_frame)
 {
-	int64_t prod;
-	int32_t prod32;
-	int16_t prod16;
-	int32_t *filter_p;
-	int16_t *buffer_p;
+	const int32_t *filter_p = src_obj->impulse_response;
+	const int16_t *buffer0_p;
+	const int16_t *buffer1_p;
+	int64_t prod0;
+	int64_t prod1;
+	int length = src_obj->filter_length;
+	int start = src_obj->buffer_write_position - length + 1;
 	int ch;
 	int n;
 	int i;
@@ -26,45 +82,38 @@ void asrc_fir_filter16(struct asrc_farrow *src_obj, int16_t **output_buffers,
 	else
 		i = index_output_frame;
 
-	/* Iterate over each channel */
-	for (ch = 0; ch < src_obj->num_channels; ch++) {
-		/* Pointer to the beginning of the impulse response */
-		filter_p = &src_obj->impulse_response[0];
-
-		/* Pointer to the buffered input data */
-		buffer_p = &src_obj->ring_buffers16[ch]
-			[src_obj->buffer_write_position];
-
-		/* Initialise the accumulator */
-		prod = 0;
-
-		/* Iterate over the filter bins.
-		 * Data is Q1.15, coefficients are Q1.30. Prod will be Qx.45.
-		 */
-		for (n = 0; n < src_obj->filter_length; n++)
-			prod += (int64_t)(*buffer_p--) * (*filter_p++);
-
-		/* Shift left after accumulation, because interim
-		 * results might saturate during filtering prod = prod
-		 * << 1; will shift after last addition
-		 */
-		prod32 = sat_int32(Q_SHIFT(prod, 45, 31));
+	for (ch = 0; ch + 1 < src_obj->num_channels; ch += 2) {
+		buffer0_p = &src_obj->ring_buffers16[ch][start];
+		buffer1_p = &src_obj->ring_buffers16[ch + 1][start];
+		prod0 = 0;
+		prod1 = 0;
+		for (n = 0; n < length; n++) {
+			prod0 += (int64_t)buffer0_p[n] * filter_p[n];
+			prod1 += (int64_t)buffer1_p[n] * filter_p[n];
+		}
+
+		output_buffers[ch][i] = asrc_fir_out16(prod0);
+		output_buffers[ch + 1][i] = asrc_fir_out16(prod1);
+	}
 
-		/* Round 'prod' to 16 bit and store it in
-		 * (de-)interleaved format in the output buffers
-		 */
-		prod16 = sat_int16(Q_SHIFT_RND(prod32, 31, 15));
-		output_buffers[ch][i] = prod16;
+	if (ch < src_obj->num_channels) {
+		buffer0_p = &src_obj->ring_buffers16[ch][start];
+		prod0 = asrc_dot16(buffer0_p, filter_p, length);
+		output_buffers[ch][i] = asrc_fir_out16(prod0);
 	}
 }
 
 void asrc_fir_filter32(struct asrc_farrow *src_obj, int32_t **output_buffers,
 		       int index_output_frame)
 {
-	int64_t prod;
-	int32_t prod32;
-	const int32_t *filter_p;
-	int32_t *buffer_p;
+	const int32_t *filter_p = src_obj->impulse_response;
+	const int32_t *buffer0_p;
+	const int32_t *buffer1_p;
+	int64_t prod0;
+	int64_t prod1;
+	int32_t coef;
+	int length = src_obj->filter_length;
+	int start = src_obj->buffer_write_position - length + 1;
 	int ch;
 	int n;
 	int i;
@@ -74,38 +123,25 @@ void asrc_fir_filter32(struct asrc_farrow *src_obj, int32_t **output_buffers,
 	else
 		i = index_output_frame;
 
-	/* Iterate over each channel */
-	for (ch = 0; ch < src_obj->num_channels; ch++) {
-		/* Pointer to the beginning of the impulse response */
-		filter_p = &src_obj->impulse_response[0];
-
-		/* Pointer to the buffered input data */
-		buffer_p = &src_obj->ring_buffers32[ch]
-			[src_obj->buffer_write_position];
-
-		/* Initialise the accumulator */
-		prod = 0;
-
-		/* Iterate over the filter bins. Data is Q1.31, coefficients
-		 * are Q1.22. They are down scaled by 1 shift. In addition
-		 * there C is implementation specific right shift by 8. It
-		 * gives headroom to calculate up to 256 taps FIR. The use
-		 * of 24 bits of 32 bits is not a practical limitation for
-		 * quality. The product is Qx.54.
-		 */
-		for (n = 0; n < src_obj->filter_length; n++)
-			prod += (int64_t)(*buffer_p--) * (*filter_p++ >> 8);
-
-		/* Shift left after accumulation, because interim
-		 * results might saturate during filtering prod = prod
-		 * << 1; will shift after last addition
-		 */
-		prod32 = sat_int32(Q_SHIFT(prod, 53, 31));
+	for (ch = 0; ch + 1 < src_obj->num_channels; ch += 2) {
+		buffer0_p = &src_obj->ring_buffers32[ch][start];
+		buffer1_p = &src_obj->ring_buffers32[ch + 1][start];
+		prod0 = 0;
+		prod1 = 0;
+		for (n = 0; n < length; n++) {
+			coef = filter_p[n] >> 8;
+			prod0 += (int64_t)buffer0_p[n] * coef;
+			prod1 += (int64_t)buffer1_p[n] * coef;
+		}
+
+		output_buffers[ch][i] = asrc_fir_out32(prod0);
+		output_buffers[ch + 1][i] = asrc_fir_out32(prod1);
+	}
 
-		/* Store 'prod' in (de-)interleaved format in the output
-		 * buffers
-		 */
-		output_buffers[ch][i] = prod32;
+	if (ch < src_obj->num_channels) {
+		buffer0_p = &src_obj->ring_buffers32[ch][start];
+		prod0 = asrc_dot32(buffer0_p, filter_p, length);
+		output_buffers[ch][i] = asrc_fir_out32(prod0);
 	}
 }
 
@@ -128,9 +164,10 @@ void asrc_calc_impulse_response_n4(struct asrc_farrow *src_obj)
 
 	/*
 	 * Set the pointer to the impulse response.
-	 * This is where the result is stored.
+	 * This is where the result is stored. It is stored
+	 * time reversed from the end for the forward filter.
 	 */
-	result_P = &src_obj->impulse_response[0];
+	result_P = &src_obj->impulse_response[src_obj->filter_length - 1];
 
 	/* Get the current fractional time */
 	time = sat_int32(((int64_t)src_obj->time_value) << 4);
@@ -191,8 +228,8 @@ void asrc_calc_impulse_response_n4(struct asrc_farrow *src_obj)
 		accum20h += q_multsr_sat_32x32(accum31h, time, 62 - 31);
 
 		/* Store the result */
-		*result_P++ = accum20l;
-		*result_P++ = accum20h;
+		*result_P-- = accum20l;
+		*result_P-- = accum20h;
 	}
 }
 
@@ -213,7 +250,7 @@ void asrc_calc_impulse_response_n5(struct asrc_farrow *src_obj)
 	int index_limit;
 
 	filter_P = &src_obj->polyphase_filters[0];
-	result_P = &src_obj->impulse_response[0];
+	result_P = &src_obj->impulse_response[src_obj->filter_length - 1];
 	time = sat_int32(((int64_t)src_obj->time_value) << 4);
 
 	index_limit = src_obj->filter_length >> 1;
@@ -240,8 +277,8 @@ void asrc_calc_impulse_response_n5(struct asrc_farrow *src_obj)
 		accum420l += q_multsr_sat_32x32(accum31l, time, 62 - 31);
 		accum420h += q_multsr_sat_32x32(accum31h, time, 62 - 31);
 
-		*result_P++ = accum420l;
-		*result_P++ = accum420h;
+		*result_P-- = accum420l;
+		*result_P-- = accum420h;
 	}
 }
 
@@ -262,7 +299,7 @@ void asrc_calc_impulse_response_n6(struct asrc_farrow *src_obj)
 	int index_limit;
 
 	filter_P = &src_obj->polyphase_filters[0];
-	result_P = &src_obj->impulse_response[0];
+	result_P = &src_obj->impulse_response[src_obj->filter_length - 1];
 	time = sat_int32(((int64_t)src_obj->time_value) << 4);
 
 	index_limit = src_obj->filter_length >> 1;
@@ -294,8 +331,8 @@ void asrc_calc_impulse_response_n6(struct asrc_farrow *src_obj)
 		accum420l += q_multsr_sat_32x32(accum531l, time, 62 - 31);
 		accum420h += q_multsr_sat_32x32(accum531h, time, 62 - 31);
 
-		*result_P++ = accum420l;
-		*result_P++ = accum420h;
+		*result_P-- = accum420l;
+		*result_P-- = accum420h;
 	}
 }
 
@@ -316,7 +353,7 @@ void asrc_calc_impulse_response_n7(struct asrc_farrow *src_obj)
 	int index_limit;
 
 	filter_P = &src_obj->polyphase_filters[0];
-	result_P = &src_obj->impulse_response[0];
+	result_P = &src_obj->impulse_response[src_obj->filter_length - 1];
 	time = sat_int32(((int64_t)src_obj->time_value) << 4);
 
 	index_limit = src_obj->filter_length >> 1;
@@ -353,8 +390,8 @@ void asrc_calc_impulse_response_n7(struct asrc_farrow *src_obj)
 		accum6420l += q_multsr_sat_32x32(accum531l, time, 62 - 31);
 		accum6420h += q_multsr_sat_32x32(accum531h, time, 62 - 31);
 
-		*result_P++ = accum6420l;
-		*result_P++ = accum6420h;
+		*result_P-- = accum6420l;
+		*result_P-- = accum6420h;
 	}
 }
 
@@ -7,11 +7,13 @@
 
 #include <sof/audio/buffer.h>
 #include <sof/audio/component.h>
+#include <sof/debug/panic.h>
 #include <sof/drivers/interrupt.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/cache.h>
 #include <sof/lib/memory.h>
 #include <sof/lib/notifier.h>
+#include <sof/math/numbers.h>
 #include <sof/list.h>
 #include <sof/spinlock.h>
 #include <ipc/topology.h>
@@ -131,6 +133,211 @@ int buffer_set_size(struct comp_buffer *buffer, uint32_t size)
 	return 0;
 }
 
+#if CONFIG_PIPELINE_BUFFER_PLANNER
+void buffer_attach_arena(struct comp_buffer *buffer,
+			 struct buffer_arena *arena)
+{
+	buf_dbg(buffer, "buffer_attach_arena()");
+
+	rfree(buffer->stream.addr);
+	buffer->stream.addr = arena->addr;
+	buffer->arena = arena;
+	arena->users++;
+
+	buffer_init(buffer, buffer->stream.size, buffer->caps);
+}
+
+/* the last buffer frees the shared storage */
+static void buffer_put_arena(struct buffer_arena *arena)
+{
+	if (--arena->users)
+		return;
+
+	rfree(arena->addr);
+	rfree(arena);
+}
+
+int buffer_detach_arena(struct comp_buffer *buffer)
+{
+	struct audio_stream *stream = &buffer->stream;
+	char *addr;
+	int ret;
+
+	buf_dbg(buffer, "buffer_detach_arena()");
+
+	addr = rballoc_align(0, buffer->caps, stream->size,
+			     PLATFORM_DCACHE_ALIGN);
+	if (!addr) {
+		buf_err(buffer, "buffer_detach_arena(): could not alloc size = %u bytes of type = %u",
+			stream->size, buffer->caps);
+		return -ENOMEM;
+	}
+
+	ret = memcpy_s(addr, stream->size, stream->addr, stream->size);
+	assert(!ret);
+
+	/* the data stays at the same offsets in the private storage */
+	stream->r_ptr = addr + ((char *)stream->r_ptr - (char *)stream->addr);
+	stream->w_ptr = addr + ((char *)stream->w_ptr - (char *)stream->addr);
+	stream->addr = addr;
+	stream->end_addr = addr + stream->size;
+
+	buffer_put_arena(buffer->arena);
+	buffer->arena = NULL;
+
+	return 0;
+}
+
+static void buffer_free_data(struct comp_buffer *buffer)
+{
+	if (buffer->arena)
+		buffer_put_arena(buffer->arena);
+	else
+		rfree(buffer->stream.addr);
+}
+#else
+static void buffer_free_data(struct comp_buffer *buffer)
+{
+	rfree(buffer->stream.addr);
+}
+#endif
+
+#if CONFIG_COMP_INPLACE
+/* downstream buffers of the group use the storage of this one */
+static void buffer_inplace_share(struct comp_buffer *buffer)
+{
+	void *addr = buffer->stream.addr;
+
+	for (buffer = buffer->inplace_sink; buffer;
+	     buffer = buffer->inplace_sink)
+		audio_stream_init(&buffer->stream, addr, buffer->stream.size);
+}
+
+/* Data of the group is held between the write pointer of the first buffer
+ * and the read pointer of the last one, so each buffer can be written only
+ * up to the data of itself and all downstream buffers.
+ */
+static void buffer_inplace_sync(struct comp_buffer *buffer)
+{
+	uint32_t used = 0;
+
+	while (buffer->inplace_sink)
+		buffer = buffer->inplace_sink;
+
+	for (; buffer; buffer = buffer->inplace_source) {
+		used += buffer->stream.avail;
+		buffer->stream.free = buffer->stream.size - used;
+	}
+}
+
+void buffer_inplace_link(struct comp_buffer *source, struct comp_buffer *sink)
+{
+	if (sink->inplace_source)
+		return;
+
+	buf_dbg(sink, "buffer_inplace_link(), source->id = %u", source->id);
+
+	source->inplace_sink = sink;
+	sink->inplace_source = source;
+	sink->private_addr = sink->stream.addr;
+
+	buffer_inplace_share(source);
+}
+
+void buffer_inplace_unlink(struct comp_buffer *buffer)
+{
+	if (!buffer->inplace_source)
+		return;
+
+	buf_dbg(buffer, "buffer_inplace_unlink()");
+
+	buffer->inplace_source->inplace_sink = NULL;
+	buffer->inplace_source = NULL;
+
+	audio_stream_init(&buffer->stream, buffer->private_addr,
+			  buffer->stream.size);
+	buffer->private_addr = NULL;
+
+	buffer_inplace_share(buffer);
+}
+#endif
+
+#if CONFIG_PIPELINE_CACHE_BATCH
+static uint32_t buffer_cache_lines(const void *addr, uint32_t bytes)
+{
+	uintptr_t start = (uintptr_t)addr;
+
+	if (!bytes)
+		return 0;
+
+	return (start + bytes + PLATFORM_DCACHE_ALIGN - 1) /
+		PLATFORM_DCACHE_ALIGN - start / PLATFORM_DCACHE_ALIGN;
+}
+
+/* lines of the stream fragment from ptr with rollover */
+static uint32_t buffer_stream_lines(const struct audio_stream *stream,
+				    const void *ptr, uint32_t bytes)
+{
+	uint32_t head = MIN(bytes, (char *)stream->end_addr - (char *)ptr);
+
+	return buffer_cache_lines(ptr, head) +
+		buffer_cache_lines(stream->addr, bytes - head);
+}
+
+/* Components request invalidation of the data they are about to read,
+ * some of them the whole buffer. The first request invalidates all the
+ * available data, which stays valid until it is consumed, so the next
+ * requests in this or the following passes only need the new data.
+ */
+void buffer_invalidate_batch(struct comp_buffer *buffer, uint32_t bytes)
+{
+	struct pipeline_cache_stats *stats = &buffer->sink->pipeline->cache;
+	struct audio_stream *stream = &buffer->stream;
+	uint32_t head;
+	void *ptr;
+
+	bytes = MIN(bytes, stream->size);
+	stats->inv_req += buffer_stream_lines(stream, stream->r_ptr, bytes);
+
+	if (bytes <= buffer->inv_bytes ||
+	    stream->avail <= buffer->inv_bytes)
+		return;
+
+	ptr = audio_stream_wrap(stream,
+				(char *)stream->r_ptr + buffer->inv_bytes);
+	bytes = stream->avail - buffer->inv_bytes;
+	head = MIN(bytes, (char *)stream->end_addr - (char *)ptr);
+
+	dcache_invalidate_region(ptr, head);
+	if (bytes > head)
+		dcache_invalidate_region(stream->addr, bytes - head);
+
+	stats->inv_lines += buffer_stream_lines(stream, ptr, bytes);
+	buffer->inv_bytes = stream->avail;
+}
+
+void buffer_writeback_batch(struct comp_buffer *buffer, uint32_t bytes)
+{
+	struct audio_stream *stream = &buffer->stream;
+
+	buffer->source->pipeline->cache.wb_req +=
+		buffer_stream_lines(stream, stream->w_ptr,
+				    MIN(bytes, stream->size));
+}
+
+/* produced data is written back before the other core can see it */
+static void buffer_writeback_produced(struct comp_buffer *buffer,
+				      uint32_t bytes)
+{
+	struct audio_stream *stream = &buffer->stream;
+
+	audio_stream_writeback(stream, bytes);
+
+	buffer->source->pipeline->cache.wb_lines +=
+		buffer_stream_lines(stream, stream->w_ptr, bytes);
+}
+#endif
+
 /* free component in the pipeline */
 void buffer_free(struct comp_buffer *buffer)
 {
@@ -148,7 +355,14 @@ void buffer_free(struct comp_buffer *buffer)
 
 	list_item_del(&buffer->source_list);
 	list_item_del(&buffer->sink_list);
-	rfree(buffer->stream.addr);
+
+#if CONFIG_COMP_INPLACE
+	if (buffer->inplace_sink)
+		buffer_inplace_unlink(buffer->inplace_sink);
+	buffer_inplace_unlink(buffer);
+#endif
+
+	buffer_free_data(buffer);
 	rfree(buffer->lock);
 	rfree(buffer);
 }
@@ -173,10 +387,19 @@ void comp_update_buffer_produce(struct comp_buffer *buffer, uint32_t bytes)
 		return;
 	}
 
+#if CONFIG_PIPELINE_CACHE_BATCH
+	if (buffer->inter_core)
+		buffer_writeback_produced(buffer, bytes);
+#endif
+
 	buffer_lock(buffer, &flags);
 
 	audio_stream_produce(&buffer->stream, bytes);
 
+#if CONFIG_COMP_INPLACE
+	buffer_inplace_sync(buffer);
+#endif
+
 	notifier_event(buffer, NOTIFIER_ID_BUFFER_PRODUCE,
 		       NOTIFIER_TARGET_CORE_LOCAL, &cb_data, sizeof(cb_data));
 
@@ -217,6 +440,14 @@ void comp_update_buffer_consume(struct comp_buffer *buffer, uint32_t bytes)
 
 	audio_stream_consume(&buffer->stream, bytes);
 
+#if CONFIG_PIPELINE_CACHE_BATCH
+	buffer->inv_bytes -= MIN(bytes, buffer->inv_bytes);
+#endif
+
+#if CONFIG_COMP_INPLACE
+	buffer_inplace_sync(buffer);
+#endif
+
 	notifier_event(buffer, NOTIFIER_ID_BUFFER_CONSUME,
 		       NOTIFIER_TARGET_CORE_LOCAL, &cb_data, sizeof(cb_data));
 
@@ -0,0 +1,293 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/*
+ * Pipeline buffer memory planner.
+ *
+ * Intermediate buffers of a linear run of components hold data only from
+ * the copy of their source component until the copy of their sink
+ * component. Buffers whose lifetimes in the copy order don't overlap are
+ * assigned to the same arena, so a chain of N intermediate buffers needs
+ * storage of only two of them.
+ *
+ * The planning is valid only if the sink component consumes all the data
+ * of the buffer in each copy, so only the source buffers of components
+ * with COMP_DRV_DRAIN capability are planned. Others, e.g. SRC consuming
+ * the input in blocks, keep private storage. A draining component still
+ * leaves data when its own sink buffer is full, e.g. on back-pressure of
+ * the DAI, so the buffers are checked after each copy and one holding
+ * data is moved to private storage before another arena user writes it.
+ */
+
+#include <sof/audio/buffer.h>
+#include <sof/audio/component.h>
+#include <sof/audio/pipeline.h>
+#include <sof/lib/alloc.h>
+#include <sof/lib/memory.h>
+#include <sof/list.h>
+#include <sof/math/numbers.h>
+#include <sof/platform.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct plan_buffer {
+	struct comp_buffer *buffer;
+	uint32_t start;		/* copy step of the source component */
+	uint32_t end;		/* copy step of the sink component */
+	int arena;		/* index of the assigned arena */
+};
+
+struct plan_arena {
+	uint32_t end;		/* last step of the current user */
+	uint32_t size;
+	uint32_t caps;
+	uint32_t users;
+	struct buffer_arena *arena;
+};
+
+struct plan_data {
+	struct pipeline *p;
+	struct plan_buffer *buffers;	/* NULL when only counting */
+	struct plan_arena *arenas;
+	int num_buffers;
+	int num_arenas;
+	uint32_t step;
+};
+
+static bool plan_list_is_single(struct list_item *list)
+{
+	return !list_is_empty(list) && list->next->next == list;
+}
+
+/* only buffers inside a linear run of the pipeline are planned, the buffers
+ * of the first and last components can be accessed by DMA at any time
+ */
+static bool plan_buffer_is_intermediate(struct plan_data *pd,
+					struct comp_buffer *buffer)
+{
+	struct comp_dev *source = buffer->source;
+	struct comp_dev *sink = buffer->sink;
+
+	return source->pipeline == pd->p && sink->pipeline == pd->p &&
+		source != pd->p->source_comp && sink != pd->p->sink_comp &&
+		!buffer->inter_core &&
+		(sink->drv->flags & COMP_DRV_DRAIN) &&
+		plan_list_is_single(&source->bsink_list) &&
+		plan_list_is_single(&sink->bsource_list);
+}
+
+/* returns the next buffer after item in the sink list of the component
+ * which leads to a component of the walk, merging components end the walk
+ */
+static struct comp_buffer *plan_next_sink(struct plan_data *pd,
+					  struct comp_dev *current,
+					  struct list_item *item)
+{
+	struct comp_buffer *buffer;
+
+	for (item = item->next; item != &current->bsink_list;
+	     item = item->next) {
+		buffer = container_of(item, struct comp_buffer, source_list);
+
+		if (buffer->sink && buffer->sink->pipeline == pd->p &&
+		    buffer->sink != pd->p->source_comp &&
+		    plan_list_is_single(&buffer->sink->bsource_list))
+			return buffer;
+	}
+
+	return NULL;
+}
+
+/* numbers the components in the copy order, which for a linear run is
+ * the same for downstream and upstream walks. Every component of the walk
+ * but the first has a single source buffer, so the walk goes back up
+ * through it instead of keeping a stack.
+ */
+static void plan_walk(struct plan_data *pd)
+{
+	struct comp_dev *current = pd->p->source_comp;
+	struct comp_buffer *buffer;
+
+	buffer = plan_next_sink(pd, current, &current->bsink_list);
+	pd->step++;
+
+	while (buffer) {
+		/* the source of a planned buffer has a single sink, so it
+		 * is the component numbered just before
+		 */
+		if (plan_buffer_is_intermediate(pd, buffer)) {
+			if (pd->buffers) {
+				pd->buffers[pd->num_buffers].buffer = buffer;
+				pd->buffers[pd->num_buffers].start =
+					pd->step - 1;
+				pd->buffers[pd->num_buffers].end = pd->step;
+			}
+			pd->num_buffers++;
+		}
+
+		/* go down to the first sink of the component */
+		current = buffer->sink;
+		buffer = plan_next_sink(pd, current, &current->bsink_list);
+		pd->step++;
+
+		/* go up to the next sink of the nearest component */
+		while (!buffer && current != pd->p->source_comp) {
+			buffer = list_first_item(&current->bsource_list,
+						 struct comp_buffer, sink_list);
+			current = buffer->source;
+			buffer = plan_next_sink(pd, current,
+						&buffer->source_list);
+		}
+	}
+}
+
+/* greedy interval assignment, buffers are sorted by start step */
+static void plan_assign(struct plan_data *pd)
+{
+	struct plan_buffer *pb;
+	struct plan_arena *pa;
+	uint32_t size;
+	int best;
+	int i;
+	int j;
+
+	for (i = 0; i < pd->num_buffers; i++) {
+		pb = &pd->buffers[i];
+		size = pb->buffer->stream.size;
+		best = -1;
+
+		/* prefer the free arena which needs to grow the least */
+		for (j = 0; j < pd->num_arenas; j++) {
+			pa = &pd->arenas[j];
+			if (pa->end >= pb->start || pa->caps != pb->buffer->caps)
+				continue;
+
+			if (best < 0 ||
+			    MAX(size, pa->size) < MAX(size, pd->arenas[best].size))
+				best = j;
+		}
+
+		if (best < 0) {
+			best = pd->num_arenas++;
+			pd->arenas[best].caps = pb->buffer->caps;
+		}
+
+		pa = &pd->arenas[best];
+		pa->end = pb->end;
+		pa->size = MAX(pa->size, size);
+		pa->users++;
+		pb->arena = best;
+	}
+}
+
+/* allocates the arenas shared by more than one buffer */
+static void plan_apply(struct plan_data *pd)
+{
+	struct buffer_arena *arena;
+	struct plan_buffer *pb;
+	struct plan_arena *pa;
+	uint32_t planned = 0;
+	uint32_t total = 0;
+	int i;
+
+	for (i = 0; i < pd->num_arenas; i++) {
+		pa = &pd->arenas[i];
+		if (pa->users < 2)
+			continue;
+
+		arena = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+				sizeof(*arena));
+		if (!arena)
+			continue;
+
+		arena->addr = rballoc_align(0, pa->caps, pa->size,
+					    PLATFORM_DCACHE_ALIGN);
+		if (!arena->addr) {
+			rfree(arena);
+			continue;
+		}
+
+		arena->size = pa->size;
+		arena->caps = pa->caps;
+		pa->arena = arena;
+	}
+
+	for (i = 0; i < pd->num_buffers; i++) {
+		pb = &pd->buffers[i];
+		pa = &pd->arenas[pb->arena];
+		total += pb->buffer->stream.size;
+
+		if (pa->arena)
+			buffer_attach_arena(pb->buffer, pa->arena);
+		else
+			planned += pb->buffer->stream.size;
+	}
+
+	for (i = 0; i < pd->num_arenas; i++)
+		if (pd->arenas[i].arena)
+			planned += pd->arenas[i].size;
+
+	pipe_info(pd->p, "pipeline_buffers_plan(): %u buffers of %u bytes in %u bytes",
+		  pd->num_buffers, total, planned);
+}
+
+void pipeline_buffers_plan(struct pipeline *p)
+{
+	struct plan_data pd = { .p = p };
+	int num_buffers;
+
+	/* count the buffers to plan first */
+	plan_walk(&pd);
+	if (pd.num_buffers < 2)
+		return;
+
+	num_buffers = pd.num_buffers;
+	pd.buffers = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+			     num_buffers * (sizeof(*pd.buffers) +
+					    sizeof(*pd.arenas)));
+	if (!pd.buffers) {
+		pipe_err(p, "pipeline_buffers_plan(): alloc failed for %d buffers",
+			 num_buffers);
+		return;
+	}
+
+	/* each buffer can need its own arena at most */
+	pd.arenas = (struct plan_arena *)(pd.buffers + num_buffers);
+	pd.num_buffers = 0;
+	pd.step = 0;
+
+	plan_walk(&pd);
+	plan_assign(&pd);
+	plan_apply(&pd);
+
+	rfree(pd.buffers);
+}
+
+int pipeline_buffers_check(struct comp_dev *dev)
+{
+	struct comp_buffer *buffer;
+	struct list_item *clist;
+	int ret;
+
+	list_for_item(clist, &dev->bsource_list) {
+		buffer = container_of(clist, struct comp_buffer, sink_list);
+
+		if (!buffer->arena ||
+		    !audio_stream_get_avail_bytes(&buffer->stream))
+			continue;
+
+		/* the data left would be overwritten by the arena users */
+		comp_warn(dev, "pipeline_buffers_check(): %u bytes left in shared buffer %u",
+			  audio_stream_get_avail_bytes(&buffer->stream),
+			  buffer->id);
+
+		ret = buffer_detach_arena(buffer);
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
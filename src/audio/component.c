@@ -69,8 +69,9 @@ static const struct comp_driver *get_drv(struct sof_ipc_comp *comp)
 	list_for_item(clist, &drivers->list) {
 		info = container_of(clist, struct comp_driver_info,
 				    list);
-		if (!memcmp(info->drv->uid, comp_ext->uuid,
-			    UUID_SIZE)) {
+		/* drivers of the host library have no runtime UUID */
+		if (info->drv->uid &&
+		    !memcmp(info->drv->uid, comp_ext->uuid, UUID_SIZE)) {
 			tr_dbg(&comp_tr,
 			       "get_drv_from_uuid(), found driver type %d, uuid %pU",
 			       info->drv->type,
@@ -384,16 +385,39 @@ struct comp_data_blob_handler {
 	uint32_t data_size;	/**< size of component's data blob */
 	void *data;		/**< pointer to data blob */
 	void *data_new;		/**< pointer to new data blob */
+	uint32_t new_data_size;	/**< size of new data blob */
 	bool data_ready;	/**< set when data blob is fully received */
 	uint32_t data_pos;	/**< indicates a data position in data
 				  *  sending/receiving process
 				  */
+	const struct comp_data_blob_ops *ops;	/**< optional blob callbacks */
+	void *prepared;		/**< data prepared from data_new */
+	void *retired;		/**< data swapped out by copy() */
 };
 
+/* frees data prepared by the component, never called from copy() */
+static void comp_free_prepared_blob(struct comp_data_blob_handler *blob_handler)
+{
+	if (!blob_handler->ops)
+		return;
+
+	if (blob_handler->prepared)
+		blob_handler->ops->free(blob_handler->dev,
+					blob_handler->prepared);
+	if (blob_handler->retired)
+		blob_handler->ops->free(blob_handler->dev,
+					blob_handler->retired);
+
+	blob_handler->prepared = NULL;
+	blob_handler->retired = NULL;
+}
+
 static void comp_free_data_blob(struct comp_data_blob_handler *blob_handler)
 {
 	assert(blob_handler);
 
+	comp_free_prepared_blob(blob_handler);
+
 	if (!blob_handler->data)
 		return;
 
@@ -402,6 +426,7 @@ static void comp_free_data_blob(struct comp_data_blob_handler *blob_handler)
 	blob_handler->data = NULL;
 	blob_handler->data_new = NULL;
 	blob_handler->data_size = 0;
+	blob_handler->new_data_size = 0;
 }
 
 void *comp_get_data_blob(struct comp_data_blob_handler *blob_handler,
@@ -421,8 +446,19 @@ void *comp_get_data_blob(struct comp_data_blob_handler *blob_handler,
 		/* Free "old" data blob and set data to data_new pointer */
 		rfree(blob_handler->data);
 		blob_handler->data = blob_handler->data_new;
+		blob_handler->data_size = blob_handler->new_data_size;
 		blob_handler->data_new = NULL;
 		blob_handler->data_ready = false;
+
+		/* Switch to the data prepared from the new blob. What the
+		 * component swaps out is freed later outside of copy().
+		 */
+		if (blob_handler->prepared) {
+			blob_handler->ops->swap(blob_handler->dev,
+						blob_handler->prepared);
+			blob_handler->retired = blob_handler->prepared;
+			blob_handler->prepared = NULL;
+		}
 	}
 
 	/* If data is available we calculate crc32 when crc pointer is given */
@@ -497,6 +533,31 @@ int comp_init_data_blob(struct comp_data_blob_handler *blob_handler,
 	return 0;
 }
 
+static int comp_prepare_data_blob(struct comp_data_blob_handler *blob_handler)
+{
+	int ret;
+
+	ret = blob_handler->ops->prepare(blob_handler->dev,
+					 blob_handler->data_new,
+					 blob_handler->new_data_size,
+					 &blob_handler->prepared);
+	if (ret < 0) {
+		comp_err(blob_handler->dev, "comp_prepare_data_blob(): failed %d",
+			 ret);
+
+		/* the current blob and its size stay in use */
+		rfree(blob_handler->data_new);
+		blob_handler->data_new = NULL;
+		blob_handler->new_data_size = 0;
+		return ret;
+	}
+
+	/* The new configuration is OK to be swapped to */
+	blob_handler->data_ready = true;
+
+	return 0;
+}
+
 int comp_data_blob_set_cmd(struct comp_data_blob_handler *blob_handler,
 			   struct sof_ipc_ctrl_data *cdata)
 {
@@ -537,6 +598,9 @@ int comp_data_blob_set_cmd(struct comp_data_blob_handler *blob_handler,
 		if (!cdata->data->size)
 			return 0;
 
+		/* data swapped out by the last copy() isn't used anymore */
+		comp_free_prepared_blob(blob_handler);
+
 		blob_handler->data_new = rballoc(0, SOF_MEM_CAPS_RAM,
 						 cdata->data->size);
 		if (!blob_handler->data_new) {
@@ -544,7 +608,7 @@ int comp_data_blob_set_cmd(struct comp_data_blob_handler *blob_handler,
 			return -ENOMEM;
 		}
 
-		blob_handler->data_size = cdata->data->size;
+		blob_handler->new_data_size = cdata->data->size;
 		blob_handler->data_ready = false;
 		blob_handler->data_pos = 0;
 	}
@@ -558,7 +622,7 @@ int comp_data_blob_set_cmd(struct comp_data_blob_handler *blob_handler,
 	}
 
 	ret = memcpy_s((char *)blob_handler->data_new + blob_handler->data_pos,
-		       blob_handler->data_size - blob_handler->data_pos,
+		       blob_handler->new_data_size - blob_handler->data_pos,
 		       cdata->data->data, cdata->num_elems);
 	assert(!ret);
 
@@ -567,6 +631,13 @@ int comp_data_blob_set_cmd(struct comp_data_blob_handler *blob_handler,
 	if (!cdata->elems_remaining) {
 		comp_dbg(blob_handler->dev, "comp_data_blob_set_cmd(): final package received");
 
+		/* While streaming the component prepares the new data here
+		 * and copy() only swaps to it at the next period.
+		 */
+		if (blob_handler->ops &&
+		    blob_handler->dev->state != COMP_STATE_READY)
+			return comp_prepare_data_blob(blob_handler);
+
 		/* The new configuration is OK to be applied */
 		blob_handler->data_ready = true;
 
@@ -585,6 +656,7 @@ int comp_data_blob_set_cmd(struct comp_data_blob_handler *blob_handler,
 		 */
 		if (!blob_handler->data) {
 			blob_handler->data = blob_handler->data_new;
+			blob_handler->data_size = blob_handler->new_data_size;
 			blob_handler->data_new = NULL;
 		}
 	}
@@ -654,6 +726,14 @@ struct comp_data_blob_handler *comp_data_blob_handler_new(struct comp_dev *dev)
 	return handler;
 }
 
+void comp_data_blob_set_ops(struct comp_data_blob_handler *blob_handler,
+			    const struct comp_data_blob_ops *ops)
+{
+	assert(blob_handler);
+
+	blob_handler->ops = ops;
+}
+
 void comp_data_blob_handler_free(struct comp_data_blob_handler *blob_handler)
 {
 	if (!blob_handler)
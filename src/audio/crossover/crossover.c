@@ -39,12 +39,6 @@ DECLARE_SOF_RT_UUID("crossover", crossover_uuid, 0x948c9ad1, 0x806a, 0x4131,
 
 DECLARE_TR_CTX(crossover_tr, SOF_UUID(crossover_uuid), LOG_LEVEL_INFO);
 
-static inline void crossover_free_config(struct sof_crossover_config **config)
-{
-	rfree(*config);
-	*config = NULL;
-}
-
 /**
  * \brief Reset the state of an LR4 filter.
  */
@@ -303,6 +297,153 @@ static int crossover_setup(struct comp_data *cd, int nch)
 	return ret;
 }
 
+/**
+ * \brief Verifies that the config is formatted correctly.
+ *
+ * The function can only be called after the buffers have been initialized.
+ */
+static int crossover_validate_config(struct comp_dev *dev,
+				     struct sof_crossover_config *config)
+{
+	struct comp_buffer *sink;
+	struct list_item *sink_list;
+	uint32_t size = config->size;
+	int32_t num_assigned_sinks = 0;
+	uint8_t assigned_sinks[SOF_CROSSOVER_MAX_STREAMS] = {0};
+	int i;
+
+	if (size > SOF_CROSSOVER_MAX_SIZE || !size) {
+		comp_err(dev, "crossover_validate_config(), size %d is invalid",
+			 size);
+		return -EINVAL;
+	}
+
+	if (config->num_sinks > SOF_CROSSOVER_MAX_STREAMS ||
+	    config->num_sinks < 2) {
+		comp_err(dev, "crossover_validate_config(), invalid num_sinks %i, expected number between 2 and %i",
+			 config->num_sinks, SOF_CROSSOVER_MAX_STREAMS);
+		return -EINVAL;
+	}
+
+	/* Align the crossover's sinks, to their respective configuation in
+	 * the config.
+	 */
+	list_for_item(sink_list, &dev->bsink_list) {
+		sink = container_of(sink_list, struct comp_buffer, source_list);
+		i = crossover_get_stream_index(config, sink->pipeline_id);
+		if (i < 0) {
+			comp_warn(dev, "crossover_validate_config(), could not assign sink %d",
+				  sink->pipeline_id);
+			break;
+		}
+
+		if (assigned_sinks[i]) {
+			comp_warn(dev, "crossover_validate_config(), multiple sinks from pipeline %d are assigned",
+				  sink->pipeline_id);
+			break;
+		}
+
+		assigned_sinks[i] = true;
+		num_assigned_sinks++;
+	}
+
+	/* Config is invalid if the number of assigned sinks
+	 * is different than what is configured.
+	 */
+	if (num_assigned_sinks != config->num_sinks) {
+		comp_err(dev, "crossover_validate_config(), number of assigned sinks %d, expected from config %d",
+			 num_assigned_sinks, config->num_sinks);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* Builds the filters for a blob received while streaming in the IPC
+ * context, so that copy() only needs to swap to them.
+ */
+static int crossover_blob_prepare(struct comp_dev *dev, void *data,
+				  size_t size, void **prepared)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct comp_data *new_cd;
+	struct comp_buffer *source;
+	int ret;
+
+	if (crossover_validate_config(dev, data) < 0) {
+		comp_err(dev, "crossover_blob_prepare(), invalid binary config format");
+		return -EINVAL;
+	}
+
+	source = list_first_item(&dev->bsource_list, struct comp_buffer,
+				 sink_list);
+
+	new_cd = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+			 sizeof(*new_cd));
+	if (!new_cd)
+		return -ENOMEM;
+
+	new_cd->config = data;
+	ret = crossover_setup(new_cd, source->stream.channels);
+	if (ret < 0) {
+		comp_err(dev, "crossover_blob_prepare(), setup failed");
+		goto err;
+	}
+
+	/* leave pass-through if streaming was started without a blob */
+	new_cd->crossover_process = crossover_find_proc_func(cd->source_format);
+	new_cd->crossover_split =
+		crossover_find_split_func(new_cd->config->num_sinks);
+	if (!new_cd->crossover_process || !new_cd->crossover_split) {
+		comp_err(dev, "crossover_blob_prepare(), no processing functions for frame_fmt %i and num_sinks %i",
+			 cd->source_format, new_cd->config->num_sinks);
+		ret = -EINVAL;
+		goto err;
+	}
+
+	*prepared = new_cd;
+	return 0;
+
+err:
+	crossover_reset_state(new_cd);
+	rfree(new_cd);
+	return ret;
+}
+
+static void crossover_blob_swap(struct comp_dev *dev, void *prepared)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct comp_data *new_cd = prepared;
+	struct crossover_state state;
+	crossover_process process = cd->crossover_process;
+	crossover_split split = cd->crossover_split;
+	int i;
+
+	/* one channel at a time to keep the stack usage small */
+	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++) {
+		state = cd->state[i];
+		cd->state[i] = new_cd->state[i];
+		new_cd->state[i] = state;
+	}
+
+	cd->crossover_process = new_cd->crossover_process;
+	cd->crossover_split = new_cd->crossover_split;
+	new_cd->crossover_process = process;
+	new_cd->crossover_split = split;
+}
+
+static void crossover_blob_free(struct comp_dev *dev, void *prepared)
+{
+	crossover_reset_state(prepared);
+	rfree(prepared);
+}
+
+static const struct comp_data_blob_ops crossover_blob_ops = {
+	.prepare = crossover_blob_prepare,
+	.swap = crossover_blob_swap,
+	.free = crossover_blob_free,
+};
+
 /**
  * \brief Creates a Crossover Filter component.
  * \return Pointer to Crossover Filter component device.
@@ -348,19 +489,26 @@ static struct comp_dev *crossover_new(const struct comp_driver *drv,
 	cd->crossover_process = NULL;
 	cd->crossover_split = NULL;
 	cd->config = NULL;
-	cd->config_new = NULL;
-
-	if (bs) {
-		cd->config = rzalloc(SOF_MEM_ZONE_RUNTIME, 0,
-				     SOF_MEM_CAPS_RAM, bs);
-		if (!cd->config) {
-			rfree(dev);
-			rfree(cd);
-			return NULL;
-		}
 
-		ret = memcpy_s(cd->config, bs, ipc_crossover->data, bs);
-		assert(!ret);
+	/* Handler for configuration data */
+	cd->model_handler = comp_data_blob_handler_new(dev);
+	if (!cd->model_handler) {
+		comp_cl_err(&comp_crossover, "crossover_new(): comp_data_blob_handler_new() failed.");
+		rfree(dev);
+		rfree(cd);
+		return NULL;
+	}
+
+	comp_data_blob_set_ops(cd->model_handler, &crossover_blob_ops);
+
+	/* Get configuration data */
+	ret = comp_init_data_blob(cd->model_handler, bs, ipc_crossover->data);
+	if (ret < 0) {
+		comp_cl_err(&comp_crossover, "crossover_new(): comp_init_data_blob() failed.");
+		comp_data_blob_handler_free(cd->model_handler);
+		rfree(dev);
+		rfree(cd);
+		return NULL;
 	}
 
 	dev->state = COMP_STATE_READY;
@@ -376,77 +524,13 @@ static void crossover_free(struct comp_dev *dev)
 
 	comp_info(dev, "crossover_free()");
 
-	crossover_free_config(&cd->config);
-	crossover_free_config(&cd->config_new);
-
 	crossover_reset_state(cd);
+	comp_data_blob_handler_free(cd->model_handler);
 
 	rfree(cd);
 	rfree(dev);
 }
 
-/**
- * \brief Verifies that the config is formatted correctly.
- *
- * The function can only be called after the buffers have been initialized.
- */
-static int crossover_validate_config(struct comp_dev *dev,
-				     struct sof_crossover_config *config)
-{
-	struct comp_buffer *sink;
-	struct list_item *sink_list;
-	uint32_t size = config->size;
-	int32_t num_assigned_sinks = 0;
-	uint8_t assigned_sinks[SOF_CROSSOVER_MAX_STREAMS] = {0};
-	int i;
-
-	if (size > SOF_CROSSOVER_MAX_SIZE || !size) {
-		comp_err(dev, "crossover_validate_config(), size %d is invalid",
-			 size);
-		return -EINVAL;
-	}
-
-	if (config->num_sinks > SOF_CROSSOVER_MAX_STREAMS ||
-	    config->num_sinks < 2) {
-		comp_err(dev, "crossover_validate_config(), invalid num_sinks %i, expected number between 2 and %i",
-			 config->num_sinks, SOF_CROSSOVER_MAX_STREAMS);
-		return -EINVAL;
-	}
-
-	/* Align the crossover's sinks, to their respective configuation in
-	 * the config.
-	 */
-	list_for_item(sink_list, &dev->bsink_list) {
-		sink = container_of(sink_list, struct comp_buffer, source_list);
-		i = crossover_get_stream_index(config, sink->pipeline_id);
-		if (i < 0) {
-			comp_warn(dev, "crossover_validate_config(), could not assign sink %d",
-				  sink->pipeline_id);
-			break;
-		}
-
-		if (assigned_sinks[i]) {
-			comp_warn(dev, "crossover_validate_config(), multiple sinks from pipeline %d are assigned",
-				  sink->pipeline_id);
-			break;
-		}
-
-		assigned_sinks[i] = true;
-		num_assigned_sinks++;
-	}
-
-	/* Config is invalid if the number of assigned sinks
-	 * is different than what is configured.
-	 */
-	if (num_assigned_sinks != config->num_sinks) {
-		comp_err(dev, "crossover_validate_config(), number of assigned sinks %d, expected from config %d",
-			 num_assigned_sinks, config->num_sinks);
-		return -EINVAL;
-	}
-
-	return 0;
-}
-
 static int crossover_verify_params(struct comp_dev *dev,
 				   struct sof_ipc_stream_params *params)
 {
@@ -486,54 +570,12 @@ static int crossover_cmd_set_data(struct comp_dev *dev,
 				  struct sof_ipc_ctrl_data *cdata)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	struct sof_crossover_config *request;
-	uint32_t bs;
 	int ret = 0;
 
 	switch (cdata->cmd) {
 	case SOF_CTRL_CMD_BINARY:
 		comp_info(dev, "crossover_cmd_set_data(), SOF_CTRL_CMD_BINARY");
-
-		/* Find size from header */
-		request = (struct sof_crossover_config *)ASSUME_ALIGNED(cdata->data->data, 4);
-		bs = request->size;
-
-		/* Check that there is no work-in-progress previous request */
-		if (cd->config_new) {
-			comp_err(dev, "crossover_cmd_set_data(), busy with previous");
-			return -EBUSY;
-		}
-
-		/* Allocate and make a copy of the blob */
-		cd->config_new = rzalloc(SOF_MEM_ZONE_RUNTIME, 0,
-					 SOF_MEM_CAPS_RAM, bs);
-		if (!cd->config_new) {
-			comp_err(dev, "crossover_cmd_set_data(), alloc fail");
-			return -EINVAL;
-		}
-
-		/* Copy the configuration. If the component state is ready
-		 * the Crossover will initialize in prepare().
-		 */
-		ret = memcpy_s(cd->config_new, bs, request, bs);
-		assert(!ret);
-
-		/* If component state is READY we can omit old configuration
-		 * immediately. When in playback/capture the new configuration
-		 * presence is checked in copy().
-		 */
-		if (dev->state == COMP_STATE_READY)
-			crossover_free_config(&cd->config);
-
-		/* If there is no existing configuration the received can
-		 * be set to current immediately. It will be applied in
-		 * prepare() when streaming starts.
-		 */
-		if (!cd->config) {
-			cd->config = cd->config_new;
-			cd->config_new = NULL;
-		}
-
+		ret = comp_data_blob_set_cmd(cd->model_handler, cdata);
 		break;
 	default:
 		comp_err(dev, "crossover_cmd_set_data(), invalid command");
@@ -548,32 +590,13 @@ static int crossover_cmd_get_data(struct comp_dev *dev,
 				  struct sof_ipc_ctrl_data *cdata, int max_size)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	uint32_t bs;
 	int ret = 0;
 
 	switch (cdata->cmd) {
 	case SOF_CTRL_CMD_BINARY:
 		comp_info(dev, "crossover_cmd_get_data(), SOF_CTRL_CMD_BINARY");
-
-		/* Copy back to user space */
-		if (cd->config) {
-			bs = cd->config->size;
-			comp_info(dev, "crossover_cmd_get_data(), size %u",
-				  bs);
-			if (bs > SOF_CROSSOVER_MAX_SIZE || bs == 0 ||
-			    bs > max_size)
-				return -EINVAL;
-			ret = memcpy_s(cdata->data->data,
-				       cdata->data->size,
-				       cd->config, bs);
-			assert(!ret);
-
-			cdata->data->abi = SOF_ABI_VERSION;
-			cdata->data->size = bs;
-		} else {
-			comp_err(dev, "crossover_cmd_get_data(), no config");
-			ret = -EINVAL;
-		}
+		ret = comp_data_blob_get_cmd(cd->model_handler, cdata,
+					     max_size);
 		break;
 	default:
 		comp_err(dev, "crossover_cmd_get_data(), invalid command");
@@ -632,7 +655,7 @@ static int crossover_copy(struct comp_dev *dev)
 	struct comp_data *cd = comp_get_drvdata(dev);
 	struct comp_buffer *source;
 	struct comp_buffer *sinks[SOF_CROSSOVER_MAX_STREAMS] = { NULL };
-	int i, ret;
+	int i;
 	uint32_t num_sinks;
 	uint32_t num_assigned_sinks = 0;
 	uint32_t frames = UINT_MAX;
@@ -645,17 +668,9 @@ static int crossover_copy(struct comp_dev *dev)
 	source = list_first_item(&dev->bsource_list, struct comp_buffer,
 				 sink_list);
 
-	/* Check for changed configuration */
-	if (cd->config_new) {
-		crossover_free_config(&cd->config);
-		cd->config = cd->config_new;
-		cd->config_new = NULL;
-		ret = crossover_setup(cd, source->stream.channels);
-		if (ret < 0) {
-			comp_err(dev, "crossover_copy(), setup failed");
-			return -EINVAL;
-		}
-	}
+	/* Switch to the filters prepared for a changed configuration */
+	if (comp_is_new_data_blob_available(cd->model_handler))
+		cd->config = comp_get_data_blob(cd->model_handler, NULL, NULL);
 
 	/* Use the assign_sink array from the config to route
 	 * the output to the corresponding sinks.
@@ -778,10 +793,11 @@ static int crossover_prepare(struct comp_dev *dev)
 		  source->stream.channels);
 
 	/* Initialize Crossover */
+	cd->config = comp_get_data_blob(cd->model_handler, NULL, NULL);
 	if (cd->config && crossover_validate_config(dev, cd->config) < 0) {
-		/* If config is invalid then delete it */
+		/* If config is invalid then run in passthrough mode */
 		comp_err(dev, "crossover_prepare(), invalid binary config format");
-		crossover_free_config(&cd->config);
+		cd->config = NULL;
 	}
 
 	if (cd->config) {
@@ -31,6 +31,7 @@
 #include <ipc/topology.h>
 #include <user/trace.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -57,6 +58,9 @@ struct dai_data {
 
 	pcm_converter_func process;	/* processing function */
 
+	bool zero_copy;		/* DMA works on local_buffer, no dma_buffer */
+	uint32_t dma_pending;	/* local_buffer bytes in flight with DMA */
+
 	uint32_t dai_pos_blks;	/* position in bytes (nearest block) */
 	uint64_t start_position;	/* position on start */
 	uint32_t period_bytes;	/**< number of bytes per one period */
@@ -102,6 +106,52 @@ static int dai_assign_group(struct comp_dev *dev, uint32_t group_id)
 	return 0;
 }
 
+/* cache operation on the local buffer bytes from ptr, with wrap */
+static void dai_zero_copy_cache(struct audio_stream *stream, void *ptr,
+				uint32_t bytes, bool writeback)
+{
+	uint32_t head_size = MIN(bytes,
+				 audio_stream_bytes_without_wrap(stream, ptr));
+	uint32_t tail_size = bytes - head_size;
+
+	if (writeback) {
+		dcache_writeback_region(ptr, head_size);
+		if (tail_size)
+			dcache_writeback_region(stream->addr, tail_size);
+	} else {
+		dcache_invalidate_region(ptr, head_size);
+		if (tail_size)
+			dcache_invalidate_region(stream->addr, tail_size);
+	}
+}
+
+/* In zero-copy mode the DMA buffer is the pipeline buffer, so only the
+ * playback data already passed to DMA is silenced.
+ */
+static void dai_dma_buffer_zero(struct comp_dev *dev)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	struct audio_stream *stream;
+	uint32_t head_size;
+
+	if (!dd->zero_copy) {
+		buffer_zero(dd->dma_buffer);
+		return;
+	}
+
+	/* DMA writes the captured data over the space passed to it */
+	if (dev->direction != SOF_IPC_STREAM_PLAYBACK)
+		return;
+
+	stream = &dd->local_buffer->stream;
+	head_size = MIN(dd->dma_pending,
+			audio_stream_bytes_without_wrap(stream, stream->r_ptr));
+
+	bzero(stream->r_ptr, head_size);
+	bzero(stream->addr, dd->dma_pending - head_size);
+	dai_zero_copy_cache(stream, stream->r_ptr, dd->dma_pending, true);
+}
+
 /* this is called by DMA driver every time descriptor has completed */
 static void dai_dma_cb(void *arg, enum notify_id type, void *data)
 {
@@ -132,12 +182,23 @@ static void dai_dma_cb(void *arg, enum notify_id type, void *data)
 		/* make sure we only playback silence during an XRUN */
 		if (dev->direction == SOF_IPC_STREAM_PLAYBACK)
 			/* fill buffer with silence */
-			buffer_zero(dd->dma_buffer);
+			dai_dma_buffer_zero(dev);
 
 		return;
 	}
 
-	if (dev->direction == SOF_IPC_STREAM_PLAYBACK) {
+	if (dd->zero_copy) {
+		/* DMA has accessed the local buffer directly */
+		ret = 0;
+
+		if (dev->direction == SOF_IPC_STREAM_PLAYBACK) {
+			dd->dma_pending += bytes;
+			buffer_ptr = dd->local_buffer->stream.r_ptr;
+		} else {
+			dd->dma_pending -= bytes;
+			buffer_ptr = dd->local_buffer->stream.w_ptr;
+		}
+	} else if (dev->direction == SOF_IPC_STREAM_PLAYBACK) {
 		ret = dma_buffer_copy_to(dd->local_buffer, dd->dma_buffer,
 					 dd->process, bytes);
 
@@ -431,6 +492,29 @@ static int dai_capture_params(struct comp_dev *dev, uint32_t period_bytes,
 	return 0;
 }
 
+/* DMA can use the local buffer if no conversion or resize is needed */
+static bool dai_zero_copy_check(struct comp_dev *dev, uint32_t buffer_size,
+				uint32_t period_count, uint32_t addr_align)
+{
+#if CONFIG_COMP_DAI_ZERO_COPY
+	struct sof_ipc_comp_config *dconfig = dev_comp_config(dev);
+	struct dai_data *dd = comp_get_drvdata(dev);
+	struct comp_buffer *buf = dd->local_buffer;
+
+	return buf->stream.frame_fmt == dconfig->frame_fmt &&
+	       buf->stream.size == buffer_size &&
+	       buffer_size == dd->period_bytes * period_count &&
+	       (buf->caps & SOF_MEM_CAPS_DMA) &&
+	       (!addr_align ||
+		IS_ALIGNED((uintptr_t)buf->stream.addr, addr_align)) &&
+	       !buf->inter_core &&
+	       !buf->stream.underrun_permitted &&
+	       !buf->stream.overrun_permitted;
+#else
+	return false;
+#endif
+}
+
 static int dai_params(struct comp_dev *dev,
 		      struct sof_ipc_stream_params *params)
 {
@@ -514,8 +598,23 @@ static int dai_params(struct comp_dev *dev,
 	/* calculate DMA buffer size */
 	buffer_size = ALIGN_UP(period_count * period_bytes, align);
 
-	/* alloc DMA buffer or change its size if exists */
-	if (dd->dma_buffer) {
+	/* local buffer isn't ours to resize */
+	if (dd->zero_copy) {
+		dd->dma_buffer = NULL;
+		dd->zero_copy = false;
+	}
+
+	/* use local buffer, alloc DMA buffer or change its size if exists */
+	if (dai_zero_copy_check(dev, buffer_size, period_count, addr_align)) {
+		comp_info(dev, "dai_params(): DMA on local buffer, size %u",
+			  buffer_size);
+
+		if (dd->dma_buffer)
+			buffer_free(dd->dma_buffer);
+
+		dd->dma_buffer = dd->local_buffer;
+		dd->zero_copy = true;
+	} else if (dd->dma_buffer) {
 		err = buffer_set_size(dd->dma_buffer, buffer_size);
 		if (err < 0) {
 			comp_err(dev, "dai_params(): buffer_set_size() failed, buffer_size = %u",
@@ -561,6 +660,7 @@ static int dai_prepare(struct comp_dev *dev)
 		return PPL_STATUS_PATH_STOP;
 
 	dev->position = 0;
+	dd->dma_pending = 0;
 
 	if (!dd->chan) {
 		comp_err(dev, "dai_prepare(): Missing dd->chan.");
@@ -575,7 +675,7 @@ static int dai_prepare(struct comp_dev *dev)
 	}
 
 	/* clear dma buffer to avoid pop noise */
-	buffer_zero(dd->dma_buffer);
+	dai_dma_buffer_zero(dev);
 
 	/* dma reconfig not required if XRUN handling */
 	if (dd->xrun) {
@@ -600,11 +700,17 @@ static int dai_reset(struct comp_dev *dev)
 
 	dma_sg_free(&config->elem_array);
 
-	if (dd->dma_buffer) {
+	if (dd->zero_copy) {
+		/* local buffer belongs to the pipeline */
+		dd->dma_buffer = NULL;
+		dd->zero_copy = false;
+	} else if (dd->dma_buffer) {
 		buffer_free(dd->dma_buffer);
 		dd->dma_buffer = NULL;
 	}
 
+	dd->dma_pending = 0;
+
 	dd->dai_pos_blks = 0;
 	if (dd->dai_pos)
 		*dd->dai_pos = 0;
@@ -666,7 +772,7 @@ static int dai_comp_trigger_internal(struct comp_dev *dev, int cmd)
 		 * this is only supported at capture mode.
 		 */
 		if (dev->direction == SOF_IPC_STREAM_CAPTURE)
-			buffer_zero(dd->dma_buffer);
+			dai_dma_buffer_zero(dev);
 
 		/* only start the DAI if we are not XRUN handling */
 		if (dd->xrun == 0) {
@@ -787,6 +893,71 @@ static void dai_report_xrun(struct comp_dev *dev, uint32_t bytes)
 	}
 }
 
+/*
+ * DMA transfers from or to the local buffer directly. Playback data stays
+ * in the local buffer until DMA has read it, dma_pending bytes from r_ptr
+ * have been passed to DMA. Captured data is produced as soon as DMA has
+ * written it and the space is passed back to DMA once consumed, dma_pending
+ * bytes before w_ptr are still owned by the local buffer.
+ */
+static int dai_zero_copy(struct comp_dev *dev, uint32_t avail_bytes,
+			 uint32_t free_bytes)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	struct comp_buffer *buf = dd->local_buffer;
+	struct audio_stream *stream = &buf->stream;
+	uint32_t copy_bytes;
+	uint32_t done;
+	int ret;
+
+	if (dev->direction == SOF_IPC_STREAM_PLAYBACK) {
+		/* DMA has read everything passed to it but avail_bytes */
+		done = dd->dma_pending - MIN(avail_bytes, dd->dma_pending);
+		if (done) {
+			dd->dma_pending -= done;
+			comp_update_buffer_consume(buf, done);
+		}
+
+		/* pass newly produced data to DMA */
+		copy_bytes = MIN(audio_stream_get_avail_bytes(stream) -
+				 dd->dma_pending, free_bytes);
+		dai_zero_copy_cache(stream,
+				    audio_stream_wrap(stream,
+						      (char *)stream->r_ptr +
+						      dd->dma_pending),
+				    copy_bytes, true);
+	} else {
+		/* DMA has written avail_bytes not yet passed back */
+		done = avail_bytes - MIN(avail_bytes, dd->dma_pending);
+		if (done) {
+			dai_zero_copy_cache(stream, stream->w_ptr, done,
+					    false);
+			dd->dma_pending += done;
+			comp_update_buffer_produce(buf, done);
+		}
+
+		/* pass consumed space back to DMA */
+		copy_bytes = dd->dma_pending -
+			MIN(audio_stream_get_avail_bytes(stream),
+			    dd->dma_pending);
+	}
+
+	comp_dbg(dev, "dai_zero_copy(), dir: %d done= 0x%x copy_bytes= 0x%x",
+		 dev->direction, done, copy_bytes);
+
+	/* return if nothing to copy */
+	if (!copy_bytes) {
+		comp_warn(dev, "dai_zero_copy(): nothing to copy");
+		return 0;
+	}
+
+	ret = dma_copy(dd->chan, copy_bytes, 0);
+	if (ret < 0)
+		dai_report_xrun(dev, copy_bytes);
+
+	return ret;
+}
+
 /* copy and process stream data from source to sink buffers */
 static int dai_copy(struct comp_dev *dev)
 {
@@ -811,6 +982,9 @@ static int dai_copy(struct comp_dev *dev)
 		return ret;
 	}
 
+	if (dd->zero_copy)
+		return dai_zero_copy(dev, avail_bytes, free_bytes);
+
 	buffer_lock(buf, &flags);
 
 	/* calculate minimum size to copy */
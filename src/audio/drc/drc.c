@@ -454,6 +454,7 @@ static int drc_reset(struct comp_dev *dev)
 static const struct comp_driver comp_drc = {
 	.uid = SOF_RT_UUID(drc_uuid),
 	.tctx = &drc_tr,
+	.flags = COMP_DRV_INPLACE | COMP_DRV_DRAIN,
 	.ops = {
 		.create  = drc_new,
 		.free    = drc_free,
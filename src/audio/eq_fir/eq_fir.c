@@ -42,14 +42,19 @@ DECLARE_SOF_RT_UUID("eq-fir", eq_fir_uuid, 0x43a90ce7, 0xf3a5, 0x41df,
 DECLARE_TR_CTX(eq_fir_tr, SOF_UUID(eq_fir_uuid), LOG_LEVEL_INFO);
 
 /* src component private data */
-struct comp_data {
+/* FIR filters, prepared separately for a blob received while streaming */
+struct eq_fir_filters {
 	struct fir_state_32x16 fir[PLATFORM_MAX_CHANNELS]; /**< filters state */
+	int32_t *fir_delay;			/**< pointer to allocated RAM */
+	size_t fir_delay_size;			/**< allocated size */
+};
+
+struct comp_data {
+	struct eq_fir_filters filters;		/**< filters in use */
 	struct comp_data_blob_handler *model_handler;
 	struct sof_eq_fir_config *config;
 	enum sof_ipc_frame source_format;	/**< source frame format */
 	enum sof_ipc_frame sink_format;		/**< sink frame format */
-	int32_t *fir_delay;			/**< pointer to allocated RAM */
-	size_t fir_delay_size;			/**< allocated size */
 	void (*eq_fir_func)(struct fir_state_32x16 fir[],
 			    const struct audio_stream *source,
 			    struct audio_stream *sink,
@@ -149,17 +154,17 @@ static void eq_fir_passthrough(struct fir_state_32x16 fir[],
 	audio_stream_copy(source, 0, sink, 0, frames * nch);
 }
 
-static void eq_fir_free_delaylines(struct comp_data *cd)
+static void eq_fir_free_delaylines(struct eq_fir_filters *filters)
 {
-	struct fir_state_32x16 *fir = cd->fir;
+	struct fir_state_32x16 *fir = filters->fir;
 	int i = 0;
 
 	/* Free the common buffer for all EQs and point then
 	 * each FIR channel delay line to NULL.
 	 */
-	rfree(cd->fir_delay);
-	cd->fir_delay = NULL;
-	cd->fir_delay_size = 0;
+	rfree(filters->fir_delay);
+	filters->fir_delay = NULL;
+	filters->fir_delay_size = 0;
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
 		fir[i].delay = NULL;
 }
@@ -275,15 +280,16 @@ static void eq_fir_init_delay(struct fir_state_32x16 *fir,
 	}
 }
 
-static int eq_fir_setup(struct comp_data *cd, int nch)
+static int eq_fir_setup(struct eq_fir_filters *filters,
+			struct sof_eq_fir_config *config, int nch)
 {
 	int delay_size;
 
 	/* Free existing FIR channels data if it was allocated */
-	eq_fir_free_delaylines(cd);
+	eq_fir_free_delaylines(filters);
 
 	/* Set coefficients for each channel EQ from coefficient blob */
-	delay_size = eq_fir_init_coef(cd->config, cd->fir, nch);
+	delay_size = eq_fir_init_coef(config, filters->fir, nch);
 	if (delay_size < 0)
 		return delay_size; /* Contains error code */
 
@@ -294,21 +300,78 @@ static int eq_fir_setup(struct comp_data *cd, int nch)
 		return 0;
 
 	/* Allocate all FIR channels data in a big chunk and clear it */
-	cd->fir_delay = rballoc(0, SOF_MEM_CAPS_RAM, delay_size);
-	if (!cd->fir_delay) {
+	filters->fir_delay = rballoc(0, SOF_MEM_CAPS_RAM, delay_size);
+	if (!filters->fir_delay) {
 		comp_cl_err(&comp_eq_fir, "eq_fir_setup(), delay allocation failed for size %d",
 			    delay_size);
 		return -ENOMEM;
 	}
 
-	memset(cd->fir_delay, 0, delay_size);
-	cd->fir_delay_size = delay_size;
+	memset(filters->fir_delay, 0, delay_size);
+	filters->fir_delay_size = delay_size;
 
 	/* Assign delay line to each channel EQ */
-	eq_fir_init_delay(cd->fir, cd->fir_delay, nch);
+	eq_fir_init_delay(filters->fir, filters->fir_delay, nch);
+	return 0;
+}
+
+/* Builds the filters for a blob received while streaming in the IPC
+ * context, so that copy() only needs to swap to them.
+ */
+static int eq_fir_blob_prepare(struct comp_dev *dev, void *data, size_t size,
+			       void **prepared)
+{
+	struct eq_fir_filters *filters;
+	struct comp_buffer *sourceb;
+	int ret;
+
+	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
+				  sink_list);
+
+	filters = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+			  sizeof(*filters));
+	if (!filters)
+		return -ENOMEM;
+
+	ret = eq_fir_setup(filters, data, sourceb->stream.channels);
+	if (ret < 0) {
+		comp_err(dev, "eq_fir_blob_prepare(), failed FIR setup");
+		eq_fir_free_delaylines(filters);
+		rfree(filters);
+		return ret;
+	}
+
+	*prepared = filters;
 	return 0;
 }
 
+static void eq_fir_blob_swap(struct comp_dev *dev, void *prepared)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct eq_fir_filters *filters = prepared;
+	struct eq_fir_filters old = cd->filters;
+
+	cd->filters = *filters;
+	*filters = old;
+
+	/* leave pass-through if streaming was started without a blob, the
+	 * frame format was already accepted in prepare()
+	 */
+	set_fir_func(dev);
+}
+
+static void eq_fir_blob_free(struct comp_dev *dev, void *prepared)
+{
+	eq_fir_free_delaylines(prepared);
+	rfree(prepared);
+}
+
+static const struct comp_data_blob_ops eq_fir_blob_ops = {
+	.prepare = eq_fir_blob_prepare,
+	.swap = eq_fir_blob_swap,
+	.free = eq_fir_blob_free,
+};
+
 /*
  * End of algorithm code. Next the standard component methods.
  */
@@ -354,8 +417,8 @@ static struct comp_dev *eq_fir_new(const struct comp_driver *drv,
 	comp_set_drvdata(dev, cd);
 
 	cd->eq_fir_func = NULL;
-	cd->fir_delay = NULL;
-	cd->fir_delay_size = 0;
+	cd->filters.fir_delay = NULL;
+	cd->filters.fir_delay_size = 0;
 
 	/* component model data handler */
 	cd->model_handler = comp_data_blob_handler_new(dev);
@@ -366,6 +429,8 @@ static struct comp_dev *eq_fir_new(const struct comp_driver *drv,
 		return NULL;
 	}
 
+	comp_data_blob_set_ops(cd->model_handler, &eq_fir_blob_ops);
+
 	/* Allocate and make a copy of the coefficients blob and reset FIR. If
 	 * the EQ is configured later in run-time the size is zero.
 	 */
@@ -378,7 +443,7 @@ static struct comp_dev *eq_fir_new(const struct comp_driver *drv,
 	}
 
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
-		fir_reset(&cd->fir[i]);
+		fir_reset(&cd->filters.fir[i]);
 
 	dev->state = COMP_STATE_READY;
 	return dev;
@@ -390,7 +455,7 @@ static void eq_fir_free(struct comp_dev *dev)
 
 	comp_info(dev, "eq_fir_free()");
 
-	eq_fir_free_delaylines(cd);
+	eq_fir_free_delaylines(&cd->filters);
 	comp_data_blob_handler_free(cd->model_handler);
 
 	rfree(cd);
@@ -481,7 +546,7 @@ static void eq_fir_process(struct comp_dev *dev, struct comp_buffer *source,
 
 	buffer_invalidate(source, source_bytes);
 
-	cd->eq_fir_func(cd->fir, &source->stream, &sink->stream, frames,
+	cd->eq_fir_func(cd->filters.fir, &source->stream, &sink->stream, frames,
 			source->stream.channels);
 
 	buffer_writeback(sink, sink_bytes);
@@ -498,7 +563,6 @@ static int eq_fir_copy(struct comp_dev *dev)
 	struct comp_buffer *sourceb;
 	struct comp_buffer *sinkb;
 	struct comp_data *cd = comp_get_drvdata(dev);
-	int ret;
 	int n;
 
 	comp_dbg(dev, "eq_fir_copy()");
@@ -506,15 +570,9 @@ static int eq_fir_copy(struct comp_dev *dev)
 	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
 				  sink_list);
 
-	/* Check for changed configuration */
-	if (comp_is_new_data_blob_available(cd->model_handler)) {
+	/* Swap to the filters prepared for changed configuration */
+	if (comp_is_new_data_blob_available(cd->model_handler))
 		cd->config = comp_get_data_blob(cd->model_handler, NULL, NULL);
-		ret = eq_fir_setup(cd, sourceb->stream.channels);
-		if (ret < 0) {
-			comp_err(dev, "eq_fir_copy(), failed FIR setup");
-			return ret;
-		}
-	}
 
 	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
 				source_list);
@@ -584,7 +642,8 @@ static int eq_fir_prepare(struct comp_dev *dev)
 	cd->config = comp_get_data_blob(cd->model_handler, NULL, NULL);
 
 	if (cd->config) {
-		ret = eq_fir_setup(cd, sourceb->stream.channels);
+		ret = eq_fir_setup(&cd->filters, cd->config,
+				   sourceb->stream.channels);
 		if (ret < 0) {
 			comp_err(dev, "eq_fir_prepare(): eq_fir_setup failed.");
 			goto err;
@@ -610,11 +669,11 @@ static int eq_fir_reset(struct comp_dev *dev)
 
 	comp_info(dev, "eq_fir_reset()");
 
-	eq_fir_free_delaylines(cd);
+	eq_fir_free_delaylines(&cd->filters);
 
 	cd->eq_fir_func = NULL;
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
-		fir_reset(&cd->fir[i]);
+		fir_reset(&cd->filters.fir[i]);
 
 	comp_set_state(dev, COMP_TRIGGER_RESET);
 	return 0;
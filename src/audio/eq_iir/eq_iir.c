@@ -41,15 +41,20 @@ DECLARE_SOF_RT_UUID("eq-iir", eq_iir_uuid, 0x5150c0e6, 0x27f9, 0x4ec8,
 
 DECLARE_TR_CTX(eq_iir_tr, SOF_UUID(eq_iir_uuid), LOG_LEVEL_INFO);
 
+/* IIR filters, prepared separately for a blob received while streaming */
+struct eq_iir_filters {
+	struct iir_state_df2t iir[PLATFORM_MAX_CHANNELS]; /**< filters state */
+	int64_t *iir_delay;			/**< pointer to allocated RAM */
+	size_t iir_delay_size;			/**< allocated size */
+};
+
 /* IIR component private data */
 struct comp_data {
-	struct iir_state_df2t iir[PLATFORM_MAX_CHANNELS]; /**< filters state */
+	struct eq_iir_filters filters;		/**< filters in use */
 	struct comp_data_blob_handler *model_handler;
 	struct sof_eq_iir_config *config;
 	enum sof_ipc_frame source_format;	/**< source frame format */
 	enum sof_ipc_frame sink_format;		/**< sink frame format */
-	int64_t *iir_delay;			/**< pointer to allocated RAM */
-	size_t iir_delay_size;			/**< allocated size */
 	eq_iir_func eq_iir_func;		/**< processing function */
 };
 
@@ -75,7 +80,7 @@ static void eq_iir_s16_default(const struct comp_dev *dev,
 	int nch = source->channels;
 
 	for (ch = 0; ch < nch; ch++) {
-		filter = &cd->iir[ch];
+		filter = &cd->filters.iir[ch];
 		idx = ch;
 		for (i = 0; i < frames; i++) {
 			x = audio_stream_read_frag_s16(source, idx);
@@ -106,7 +111,7 @@ static void eq_iir_s24_default(const struct comp_dev *dev,
 	int nch = source->channels;
 
 	for (ch = 0; ch < nch; ch++) {
-		filter = &cd->iir[ch];
+		filter = &cd->filters.iir[ch];
 		idx = ch;
 		for (i = 0; i < frames; i++) {
 			x = audio_stream_read_frag_s32(source, idx);
@@ -136,7 +141,7 @@ static void eq_iir_s32_default(const struct comp_dev *dev,
 	int nch = source->channels;
 
 	for (ch = 0; ch < nch; ch++) {
-		filter = &cd->iir[ch];
+		filter = &cd->filters.iir[ch];
 		idx = ch;
 		for (i = 0; i < frames; i++) {
 			x = audio_stream_read_frag_s32(source, idx);
@@ -166,7 +171,7 @@ static void eq_iir_s32_16_default(const struct comp_dev *dev,
 	int nch = source->channels;
 
 	for (ch = 0; ch < nch; ch++) {
-		filter = &cd->iir[ch];
+		filter = &cd->filters.iir[ch];
 		idx = ch;
 		for (i = 0; i < frames; i++) {
 			x = audio_stream_read_frag_s32(source, idx);
@@ -197,7 +202,7 @@ static void eq_iir_s32_24_default(const struct comp_dev *dev,
 	int nch = source->channels;
 
 	for (ch = 0; ch < nch; ch++) {
-		filter = &cd->iir[ch];
+		filter = &cd->filters.iir[ch];
 		idx = ch;
 		for (i = 0; i < frames; i++) {
 			x = audio_stream_read_frag_s32(source, idx);
@@ -326,17 +331,17 @@ static eq_iir_func eq_iir_find_func(enum sof_ipc_frame source_format,
 	return NULL;
 }
 
-static void eq_iir_free_delaylines(struct comp_data *cd)
+static void eq_iir_free_delaylines(struct eq_iir_filters *filters)
 {
-	struct iir_state_df2t *iir = cd->iir;
+	struct iir_state_df2t *iir = filters->iir;
 	int i = 0;
 
 	/* Free the common buffer for all EQs and point then
 	 * each IIR channel delay line to NULL.
 	 */
-	rfree(cd->iir_delay);
-	cd->iir_delay = NULL;
-	cd->iir_delay_size = 0;
+	rfree(filters->iir_delay);
+	filters->iir_delay = NULL;
+	filters->iir_delay_size = 0;
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
 		iir[i].delay = NULL;
 }
@@ -447,15 +452,16 @@ static void eq_iir_init_delay(struct iir_state_df2t *iir,
 	}
 }
 
-static int eq_iir_setup(struct comp_data *cd, int nch)
+static int eq_iir_setup(struct eq_iir_filters *filters,
+			struct sof_eq_iir_config *config, int nch)
 {
 	int delay_size;
 
 	/* Free existing IIR channels data if it was allocated */
-	eq_iir_free_delaylines(cd);
+	eq_iir_free_delaylines(filters);
 
 	/* Set coefficients for each channel EQ from coefficient blob */
-	delay_size = eq_iir_init_coef(cd->config, cd->iir, nch);
+	delay_size = eq_iir_init_coef(config, filters->iir, nch);
 	if (delay_size < 0)
 		return delay_size; /* Contains error code */
 
@@ -466,21 +472,78 @@ static int eq_iir_setup(struct comp_data *cd, int nch)
 		return 0;
 
 	/* Allocate all IIR channels data in a big chunk and clear it */
-	cd->iir_delay = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
-				delay_size);
-	if (!cd->iir_delay) {
+	filters->iir_delay = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+				     delay_size);
+	if (!filters->iir_delay) {
 		comp_cl_err(&comp_eq_iir, "eq_iir_setup(), delay allocation fail");
 		return -ENOMEM;
 	}
 
-	memset(cd->iir_delay, 0, delay_size);
-	cd->iir_delay_size = delay_size;
+	memset(filters->iir_delay, 0, delay_size);
+	filters->iir_delay_size = delay_size;
 
 	/* Assign delay line to each channel EQ */
-	eq_iir_init_delay(cd->iir, cd->iir_delay, nch);
+	eq_iir_init_delay(filters->iir, filters->iir_delay, nch);
 	return 0;
 }
 
+/* Builds the filters for a blob received while streaming in the IPC
+ * context, so that copy() only needs to swap to them.
+ */
+static int eq_iir_blob_prepare(struct comp_dev *dev, void *data, size_t size,
+			       void **prepared)
+{
+	struct eq_iir_filters *filters;
+	struct comp_buffer *sourceb;
+	int ret;
+
+	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
+				  sink_list);
+
+	filters = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+			  sizeof(*filters));
+	if (!filters)
+		return -ENOMEM;
+
+	ret = eq_iir_setup(filters, data, sourceb->stream.channels);
+	if (ret < 0) {
+		comp_err(dev, "eq_iir_blob_prepare(), failed IIR setup");
+		eq_iir_free_delaylines(filters);
+		rfree(filters);
+		return ret;
+	}
+
+	*prepared = filters;
+	return 0;
+}
+
+static void eq_iir_blob_swap(struct comp_dev *dev, void *prepared)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct eq_iir_filters *filters = prepared;
+	struct eq_iir_filters old = cd->filters;
+
+	cd->filters = *filters;
+	*filters = old;
+
+	/* leave pass-through if streaming was started without a blob */
+	cd->eq_iir_func = eq_iir_find_func(cd->source_format, cd->sink_format,
+					   fm_configured,
+					   ARRAY_SIZE(fm_configured));
+}
+
+static void eq_iir_blob_free(struct comp_dev *dev, void *prepared)
+{
+	eq_iir_free_delaylines(prepared);
+	rfree(prepared);
+}
+
+static const struct comp_data_blob_ops eq_iir_blob_ops = {
+	.prepare = eq_iir_blob_prepare,
+	.swap = eq_iir_blob_swap,
+	.free = eq_iir_blob_free,
+};
+
 /*
  * End of EQ setup code. Next the standard component methods.
  */
@@ -526,8 +589,8 @@ static struct comp_dev *eq_iir_new(const struct comp_driver *drv,
 	comp_set_drvdata(dev, cd);
 
 	cd->eq_iir_func = NULL;
-	cd->iir_delay = NULL;
-	cd->iir_delay_size = 0;
+	cd->filters.iir_delay = NULL;
+	cd->filters.iir_delay_size = 0;
 
 	/* component model data handler */
 	cd->model_handler = comp_data_blob_handler_new(dev);
@@ -538,6 +601,8 @@ static struct comp_dev *eq_iir_new(const struct comp_driver *drv,
 		return NULL;
 	}
 
+	comp_data_blob_set_ops(cd->model_handler, &eq_iir_blob_ops);
+
 	/* Allocate and make a copy of the coefficients blob and reset IIR. If
 	 * the EQ is configured later in run-time the size is zero.
 	 */
@@ -550,7 +615,7 @@ static struct comp_dev *eq_iir_new(const struct comp_driver *drv,
 	}
 
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
-		iir_reset_df2t(&cd->iir[i]);
+		iir_reset_df2t(&cd->filters.iir[i]);
 
 	dev->state = COMP_STATE_READY;
 	return dev;
@@ -562,7 +627,7 @@ static void eq_iir_free(struct comp_dev *dev)
 
 	comp_info(dev, "eq_iir_free()");
 
-	eq_iir_free_delaylines(cd);
+	eq_iir_free_delaylines(&cd->filters);
 	comp_data_blob_handler_free(cd->model_handler);
 
 	rfree(cd);
@@ -723,22 +788,15 @@ static int eq_iir_copy(struct comp_dev *dev)
 	struct comp_data *cd = comp_get_drvdata(dev);
 	struct comp_buffer *sourceb;
 	struct comp_buffer *sinkb;
-	int ret;
 
 	comp_dbg(dev, "eq_iir_copy()");
 
 	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
 				  sink_list);
 
-	/* Check for changed configuration */
-	if (comp_is_new_data_blob_available(cd->model_handler)) {
+	/* Swap to the filters prepared for changed configuration */
+	if (comp_is_new_data_blob_available(cd->model_handler))
 		cd->config = comp_get_data_blob(cd->model_handler, NULL, NULL);
-		ret = eq_iir_setup(cd, sourceb->stream.channels);
-		if (ret < 0) {
-			comp_err(dev, "eq_iir_copy(), failed IIR setup");
-			return ret;
-		}
-	}
 
 	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
 				source_list);
@@ -798,7 +856,8 @@ static int eq_iir_prepare(struct comp_dev *dev)
 	comp_info(dev, "eq_iir_prepare(), source_format=%d, sink_format=%d",
 		  cd->source_format, cd->sink_format);
 	if (cd->config) {
-		ret = eq_iir_setup(cd, sourceb->stream.channels);
+		ret = eq_iir_setup(&cd->filters, cd->config,
+				   sourceb->stream.channels);
 		if (ret < 0) {
 			comp_err(dev, "eq_iir_prepare(), setup failed.");
 			goto err;
@@ -839,11 +898,11 @@ static int eq_iir_reset(struct comp_dev *dev)
 
 	comp_info(dev, "eq_iir_reset()");
 
-	eq_iir_free_delaylines(cd);
+	eq_iir_free_delaylines(&cd->filters);
 
 	cd->eq_iir_func = NULL;
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
-		iir_reset_df2t(&cd->iir[i]);
+		iir_reset_df2t(&cd->filters.iir[i]);
 
 	comp_set_state(dev, COMP_TRIGGER_RESET);
 	return 0;
@@ -853,6 +912,7 @@ static const struct comp_driver comp_eq_iir = {
 	.type = SOF_COMP_EQ_IIR,
 	.uid = SOF_RT_UUID(eq_iir_uuid),
 	.tctx = &eq_iir_tr,
+	.flags = COMP_DRV_INPLACE | COMP_DRV_DRAIN,
 	.ops = {
 		.create = eq_iir_new,
 		.free = eq_iir_free,
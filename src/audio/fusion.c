@@ -0,0 +1,289 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/*
+ * Fused processing of adjacent components.
+ *
+ * Components processing the data frame by frame, like volume and selector,
+ * implement the process operation working on plain streams. A run of such
+ * components inside a pipeline is detected when the pipeline is prepared and
+ * copied by the first component of the run. Each block of frames is read
+ * from the source buffer of the run, passed through the components in a
+ * small scratch memory and written to the sink buffer of the run, so the
+ * intermediate buffers are bypassed. The components keep their private
+ * data, so their controls work as without the fusion.
+ */
+
+#include <sof/audio/buffer.h>
+#include <sof/audio/component.h>
+#include <sof/audio/fusion.h>
+#include <sof/audio/pipeline.h>
+#include <sof/lib/alloc.h>
+#include <sof/lib/memory.h>
+#include <sof/list.h>
+#include <sof/math/numbers.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+static bool fusion_list_is_single(struct list_item *list)
+{
+	return !list_is_empty(list) && list->next->next == list;
+}
+
+static bool fusion_comp_is_fusable(struct pipeline *p, struct comp_dev *dev)
+{
+	return dev && dev->pipeline == p && dev->drv->ops.process &&
+		!dev->fusion &&
+		fusion_list_is_single(&dev->bsource_list) &&
+		fusion_list_is_single(&dev->bsink_list);
+}
+
+static bool fusion_can_link(struct pipeline *p, struct comp_buffer *buffer)
+{
+#if CONFIG_PIPELINE_BUFFER_PLANNER
+	/* the planned copy order of shared buffers must be kept */
+	if (buffer->arena)
+		return false;
+#endif
+
+	return !buffer->inter_core &&
+		fusion_comp_is_fusable(p, buffer->source) &&
+		fusion_comp_is_fusable(p, buffer->sink);
+}
+
+static struct comp_buffer *fusion_sink_buffer(struct comp_dev *dev)
+{
+	return list_first_item(&dev->bsink_list, struct comp_buffer,
+			       source_list);
+}
+
+static struct comp_buffer *fusion_source_buffer(struct comp_dev *dev)
+{
+	return list_first_item(&dev->bsource_list, struct comp_buffer,
+			       sink_list);
+}
+
+/* creates the run starting with the component if it has fusable sinks */
+static void fusion_run_new(struct pipeline *p, struct comp_dev *head)
+{
+	struct comp_fusion *run;
+	struct comp_buffer *buffer;
+	struct comp_dev *comps[COMP_FUSION_MAX];
+	uint32_t size = 0;
+	int num_comps = 1;
+	int i;
+
+	comps[0] = head;
+	buffer = fusion_sink_buffer(head);
+
+	while (num_comps < COMP_FUSION_MAX && fusion_can_link(p, buffer)) {
+#if CONFIG_PIPELINE_BUFFER_PLANNER
+		/* the run would write its sink while reading the source */
+		if (fusion_sink_buffer(buffer->sink)->arena &&
+		    fusion_sink_buffer(buffer->sink)->arena ==
+		    fusion_source_buffer(head)->arena)
+			break;
+#endif
+
+		size = MAX(size, audio_stream_frame_bytes(&buffer->stream));
+		comps[num_comps++] = buffer->sink;
+		buffer = fusion_sink_buffer(buffer->sink);
+	}
+
+	if (num_comps < 2)
+		return;
+
+	run = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM, sizeof(*run));
+	if (!run) {
+		pipe_err(p, "fusion_run_new(): alloc failed");
+		return;
+	}
+
+	run->scratch_size = size * COMP_FUSION_BLOCK_FRAMES;
+	run->scratch[0] = rballoc(0, SOF_MEM_CAPS_RAM, run->scratch_size * 2);
+	if (!run->scratch[0]) {
+		pipe_err(p, "fusion_run_new(): scratch alloc failed");
+		rfree(run);
+		return;
+	}
+
+	run->scratch[1] = (char *)run->scratch[0] + run->scratch_size;
+	run->num_comps = num_comps;
+
+	for (i = 0; i < num_comps; i++) {
+		run->comps[i] = comps[i];
+		comps[i]->fusion = run;
+	}
+
+	pipe_info(p, "fusion_run_new(): %d components from comp %u",
+		  num_comps, dev_comp_id(head));
+}
+
+/* returns the next buffer after item in the sink list of the component
+ * which leads to a component of the walk, merging components end the walk
+ */
+static struct comp_buffer *fusion_next_sink(struct pipeline *p,
+					    struct comp_dev *current,
+					    struct list_item *item)
+{
+	struct comp_buffer *buffer;
+
+	for (item = item->next; item != &current->bsink_list;
+	     item = item->next) {
+		buffer = container_of(item, struct comp_buffer, source_list);
+
+		if (buffer->sink && buffer->sink->pipeline == p &&
+		    buffer->sink != p->source_comp &&
+		    fusion_list_is_single(&buffer->sink->bsource_list))
+			return buffer;
+	}
+
+	return NULL;
+}
+
+/* starts a run unless the component continues the upstream one */
+static void fusion_visit(struct pipeline *p, struct comp_dev *current)
+{
+	if (fusion_comp_is_fusable(p, current) &&
+	    !fusion_can_link(p, fusion_source_buffer(current)))
+		fusion_run_new(p, current);
+}
+
+/* Every component of the walk but the first has a single source buffer,
+ * so the walk goes back up through it instead of keeping a stack.
+ */
+void pipeline_fusion_build(struct pipeline *p)
+{
+	struct comp_dev *current = p->source_comp;
+	struct comp_buffer *buffer;
+
+	fusion_visit(p, current);
+	buffer = fusion_next_sink(p, current, &current->bsink_list);
+
+	while (buffer) {
+		/* go down to the first sink of the component */
+		current = buffer->sink;
+		fusion_visit(p, current);
+		buffer = fusion_next_sink(p, current, &current->bsink_list);
+
+		/* go up to the next sink of the nearest component */
+		while (!buffer && current != p->source_comp) {
+			buffer = fusion_source_buffer(current);
+			current = buffer->source;
+			buffer = fusion_next_sink(p, current,
+						  &buffer->source_list);
+		}
+	}
+}
+
+void pipeline_fusion_free(struct comp_dev *dev)
+{
+	struct comp_fusion *run = dev->fusion;
+	int i;
+
+	if (!run)
+		return;
+
+	for (i = 0; i < run->num_comps; i++)
+		run->comps[i]->fusion = NULL;
+
+	rfree(run->scratch[0]);
+	rfree(run);
+}
+
+/* stream of the intermediate buffer moved to the scratch block */
+static void fusion_scratch_stream(struct comp_fusion *run, int stage,
+				  struct audio_stream *stream)
+{
+	*stream = fusion_sink_buffer(run->comps[stage])->stream;
+	audio_stream_init(stream, run->scratch[stage & 1], run->scratch_size);
+}
+
+int comp_fusion_copy(struct comp_dev *dev)
+{
+	struct comp_fusion *run = dev->fusion;
+	struct comp_dev *tail = run->comps[run->num_comps - 1];
+	struct audio_stream scratch[2];
+	struct audio_stream source_stream;
+	struct audio_stream sink_stream;
+	struct audio_stream *source;
+	struct audio_stream *sink;
+	struct comp_buffer *sourceb;
+	struct comp_buffer *sinkb;
+	uint32_t source_flags = 0;
+	uint32_t sink_flags = 0;
+	uint32_t source_frame_bytes;
+	uint32_t sink_frame_bytes;
+	uint32_t frames;
+	uint32_t total;
+	uint32_t avail;
+	int last = run->num_comps - 1;
+	int ret;
+	int i;
+
+	/* the whole run is processed by its first component */
+	if (run->comps[0] != dev)
+		return 0;
+
+	sourceb = fusion_source_buffer(dev);
+	sinkb = fusion_sink_buffer(tail);
+
+	buffer_lock(sourceb, &source_flags);
+	buffer_lock(sinkb, &sink_flags);
+
+	avail = audio_stream_avail_frames(&sourceb->stream, &sinkb->stream);
+	source_stream = sourceb->stream;
+	sink_stream = sinkb->stream;
+
+	buffer_unlock(sinkb, sink_flags);
+	buffer_unlock(sourceb, source_flags);
+
+	comp_dbg(dev, "comp_fusion_copy(), frames = %u", avail);
+
+	if (!avail)
+		return 0;
+
+	source_frame_bytes = audio_stream_frame_bytes(&source_stream);
+	sink_frame_bytes = audio_stream_frame_bytes(&sink_stream);
+
+	buffer_invalidate(sourceb, avail * source_frame_bytes);
+
+	for (total = avail; avail; avail -= frames) {
+		frames = MIN(avail, COMP_FUSION_BLOCK_FRAMES);
+
+		for (i = 0; i <= last; i++) {
+			source = i ? &scratch[(i - 1) & 1] : &source_stream;
+
+			if (i < last) {
+				sink = &scratch[i & 1];
+				fusion_scratch_stream(run, i, sink);
+			} else {
+				sink = &sink_stream;
+			}
+
+			ret = run->comps[i]->drv->ops.process(run->comps[i],
+							      source, sink,
+							      frames);
+			if (ret < 0) {
+				comp_err(run->comps[i], "comp_fusion_copy(): process failed, ret = %d",
+					 ret);
+				return ret;
+			}
+		}
+
+		audio_stream_consume(&source_stream,
+				     frames * source_frame_bytes);
+		audio_stream_produce(&sink_stream, frames * sink_frame_bytes);
+	}
+
+	/* commit all the blocks at once */
+	buffer_writeback(sinkb, total * sink_frame_bytes);
+
+	comp_update_buffer_produce(sinkb, total * sink_frame_bytes);
+	comp_update_buffer_consume(sourceb, total * source_frame_bytes);
+
+	return 0;
+}
@@ -91,6 +91,7 @@ struct host_data {
 				   *  copied by dma connected to host
 				   */
 	uint32_t period_bytes;	/**< number of bytes per one period */
+	uint32_t copy_limit_bytes; /**< max bytes per one playback copy */
 
 	host_copy_func copy;	/**< host copy function */
 	pcm_converter_func process;	/**< processing function */
@@ -168,6 +169,12 @@ static void host_update_position(struct comp_dev *dev, uint32_t bytes)
 	if (hd->local_pos >= hd->host_size)
 		hd->local_pos = 0;
 
+#if CONFIG_STREAM_POSN_SEQLOCK
+	/* position record polled by the host is updated every period */
+	pipeline_get_timestamp(dev->pipeline, dev, &hd->posn);
+	pipeline_posn_write(dev->pipeline, &hd->posn);
+#endif
+
 	/* Don't send stream position if no_stream_position == 1 */
 	if (!hd->no_stream_position) {
 		hd->report_pos += bytes;
@@ -180,12 +187,13 @@ static void host_update_position(struct comp_dev *dev, uint32_t bytes)
 		    hd->report_pos >= hd->host_period_bytes) {
 			hd->report_pos = 0;
 
+#if !CONFIG_STREAM_POSN_SEQLOCK
 			/* send timestamped position to host
 			 * (updates position first, by calling ops.position())
 			 */
 			pipeline_get_timestamp(dev->pipeline, dev, &hd->posn);
-			mailbox_stream_write(dev->pipeline->posn_offset,
-					     &hd->posn, sizeof(hd->posn));
+			pipeline_posn_write(dev->pipeline, &hd->posn);
+#endif
 			ipc_msg_send(hd->msg, &hd->posn, false);
 		}
 	}
@@ -349,9 +357,10 @@ static uint32_t host_get_copy_bytes_normal(struct comp_dev *dev)
 	/* calculate minimum size to copy */
 	if (dev->direction == SOF_IPC_STREAM_PLAYBACK)
 		/* limit bytes per copy to one period for the whole pipeline
-		 * in order to avoid high load spike
+		 * in order to avoid high load spike, deep buffer pipelines
+		 * pull all available data in one burst
 		 */
-		copy_bytes = MIN(hd->period_bytes,
+		copy_bytes = MIN(hd->copy_limit_bytes,
 				 MIN(avail_bytes,
 				     audio_stream_get_free_bytes(&hd->local_buffer->stream)));
 	else
@@ -789,6 +798,10 @@ static int host_params(struct comp_dev *dev,
 	/* minimal copied data shouldn't be less than alignment */
 	hd->period_bytes = ALIGN_UP(period_bytes, hd->dma_copy_align);
 
+	/* deep buffer pipelines are limited only by the free space */
+	hd->copy_limit_bytes = pipeline_is_deep_buffer(dev->pipeline) ?
+		UINT32_MAX : hd->period_bytes;
+
 	/* set up callback */
 	notifier_register(dev, hd->chan, NOTIFIER_ID_DMA_COPY, host_dma_cb, 0);
 
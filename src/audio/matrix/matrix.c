@@ -0,0 +1,639 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/component.h>
+#include <sof/audio/buffer.h>
+#include <sof/audio/format.h>
+#include <sof/audio/matrix/matrix.h>
+#include <sof/audio/pipeline.h>
+#include <sof/common.h>
+#include <sof/debug/panic.h>
+#include <sof/drivers/ipc.h>
+#include <sof/lib/alloc.h>
+#include <sof/lib/memory.h>
+#include <sof/lib/uuid.h>
+#include <sof/list.h>
+#include <sof/platform.h>
+#include <sof/string.h>
+#include <sof/ut.h>
+#include <sof/trace/trace.h>
+#include <ipc/control.h>
+#include <ipc/stream.h>
+#include <ipc/topology.h>
+#include <user/matrix.h>
+#include <user/trace.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+static const struct comp_driver comp_matrix;
+
+/* 7c4d3a1b-5e29-4f83-9a6c-2d18b0e4f537 */
+DECLARE_SOF_RT_UUID("matrix", matrix_uuid, 0x7c4d3a1b, 0x5e29, 0x4f83,
+		    0x9a, 0x6c, 0x2d, 0x18, 0xb0, 0xe4, 0xf5, 0x37);
+
+DECLARE_TR_CTX(matrix_tr, SOF_UUID(matrix_uuid), LOG_LEVEL_INFO);
+
+static bool matrix_check_format(enum sof_ipc_frame fmt)
+{
+	switch (fmt) {
+#if CONFIG_FORMAT_S16LE
+	case SOF_IPC_FRAME_S16_LE:
+		return true;
+#endif /* CONFIG_FORMAT_S16LE */
+#if CONFIG_FORMAT_S24LE
+	case SOF_IPC_FRAME_S24_4LE:
+		return true;
+#endif /* CONFIG_FORMAT_S24LE */
+#if CONFIG_FORMAT_S32LE
+	case SOF_IPC_FRAME_S32_LE:
+		return true;
+#endif /* CONFIG_FORMAT_S32LE */
+	default:
+		return false;
+	}
+}
+
+static int matrix_check_config(struct comp_dev *dev,
+			       const struct sof_matrix_config *config,
+			       size_t size)
+{
+	size_t coef_size;
+
+	if (size < sizeof(*config)) {
+		comp_err(dev, "matrix_check_config(), invalid blob size %u",
+			 size);
+		return -EINVAL;
+	}
+
+	if (!config->in_channels ||
+	    config->in_channels > PLATFORM_MAX_CHANNELS ||
+	    !config->out_channels ||
+	    config->out_channels > PLATFORM_MAX_CHANNELS) {
+		comp_err(dev, "matrix_check_config(), invalid channels %u to %u",
+			 config->in_channels, config->out_channels);
+		return -EINVAL;
+	}
+
+	coef_size = config->in_channels * config->out_channels *
+		sizeof(int16_t);
+	if (size < sizeof(*config) + coef_size) {
+		comp_err(dev, "matrix_check_config(), blob size %u too small for %u coefficients",
+			 size, coef_size / sizeof(int16_t));
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* Builds the plan from the blob, or the identity plan of channels count
+ * when the matrix is not configured. Only the non-zero coefficients are
+ * listed as terms, outputs of a single 1.0 coefficient are copies.
+ */
+static void matrix_init_plan(struct matrix_plan *plan,
+			     const struct sof_matrix_config *config,
+			     uint32_t channels)
+{
+	struct matrix_term *term = plan->term;
+	int16_t coef;
+	int in;
+	int out;
+
+	plan->in_channels = config ? config->in_channels : channels;
+	plan->out_channels = config ? config->out_channels : channels;
+
+	for (out = 0; out < plan->out_channels; out++) {
+		plan->term_count[out] = 0;
+		plan->src_channel[out] = MATRIX_CHANNEL_NONE;
+
+		for (in = 0; in < plan->in_channels; in++) {
+			if (config)
+				coef = config->coef[out * plan->in_channels +
+						    in];
+			else
+				coef = in == out ? MATRIX_COEF_UNITY : 0;
+
+			plan->coef[out * plan->in_channels + in] = coef;
+			if (!coef)
+				continue;
+
+			term->in_channel = in;
+			term->coef = coef;
+			term++;
+			plan->term_count[out]++;
+		}
+
+		if (plan->term_count[out] == 1 &&
+		    term[-1].coef == MATRIX_COEF_UNITY)
+			plan->src_channel[out] = term[-1].in_channel;
+	}
+}
+
+/* Picks the fastest function for the plan. Same source and sink formats
+ * are copied when possible, or processed by kernels for common channel
+ * counts. Everything else, including format conversions, uses the
+ * generic function.
+ */
+static matrix_func matrix_find_func(struct matrix_comp_data *cd,
+				    const struct matrix_plan *plan)
+{
+	matrix_func func;
+	bool identity = plan->in_channels == plan->out_channels;
+	bool copy = true;
+	int ch;
+
+	if (cd->source_format != cd->sink_format)
+		return matrix_generic;
+
+	for (ch = 0; ch < plan->out_channels; ch++) {
+		if (plan->src_channel[ch] != ch)
+			identity = false;
+		if (plan->term_count[ch] &&
+		    plan->src_channel[ch] == MATRIX_CHANNEL_NONE)
+			copy = false;
+	}
+
+	if (identity)
+		return matrix_identity;
+
+	if (copy) {
+		func = matrix_find_copy_func(cd->source_format);
+		if (func)
+			return func;
+	}
+
+	func = matrix_find_dense_func(cd->source_format, plan->in_channels,
+				      plan->out_channels);
+	if (func)
+		return func;
+
+	return matrix_generic;
+}
+
+/* Builds the plan for a blob received while streaming in the IPC context,
+ * so that copy() only needs to swap to it.
+ */
+static int matrix_blob_prepare(struct comp_dev *dev, void *data, size_t size,
+			       void **prepared)
+{
+	struct matrix_comp_data *cd = comp_get_drvdata(dev);
+	struct sof_matrix_config *config = data;
+	struct matrix_plan *plan;
+	int ret;
+
+	ret = matrix_check_config(dev, config, size);
+	if (ret < 0)
+		return ret;
+
+	if (config->in_channels != cd->plan.in_channels ||
+	    config->out_channels != cd->plan.out_channels) {
+		comp_err(dev, "matrix_blob_prepare(), channels can't change while streaming");
+		return -EINVAL;
+	}
+
+	plan = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+		       sizeof(*plan));
+	if (!plan)
+		return -ENOMEM;
+
+	matrix_init_plan(plan, config, 0);
+	plan->func = matrix_find_func(cd, plan);
+
+	*prepared = plan;
+	return 0;
+}
+
+static void matrix_blob_swap(struct comp_dev *dev, void *prepared)
+{
+	struct matrix_comp_data *cd = comp_get_drvdata(dev);
+	struct matrix_plan *plan = prepared;
+	struct matrix_plan old = cd->plan;
+
+	cd->plan = *plan;
+	*plan = old;
+}
+
+static void matrix_blob_free(struct comp_dev *dev, void *prepared)
+{
+	rfree(prepared);
+}
+
+static const struct comp_data_blob_ops matrix_blob_ops = {
+	.prepare = matrix_blob_prepare,
+	.swap = matrix_blob_swap,
+	.free = matrix_blob_free,
+};
+
+static struct comp_dev *matrix_new(const struct comp_driver *drv,
+				   struct sof_ipc_comp *comp)
+{
+	struct comp_dev *dev;
+	struct matrix_comp_data *cd;
+	struct sof_ipc_comp_process *matrix;
+	struct sof_ipc_comp_process *ipc_matrix =
+		(struct sof_ipc_comp_process *)comp;
+	size_t bs = ipc_matrix->size;
+	int ret;
+
+	comp_cl_info(&comp_matrix, "matrix_new()");
+
+	/* Check first before proceeding with dev and cd that coefficients
+	 * blob size is sane.
+	 */
+	if (bs > SOF_MATRIX_MAX_SIZE) {
+		comp_cl_err(&comp_matrix, "matrix_new(), coefficients blob size %u exceeds maximum",
+			    bs);
+		return NULL;
+	}
+
+	dev = comp_alloc(drv, COMP_SIZE(struct sof_ipc_comp_process));
+	if (!dev)
+		return NULL;
+
+	matrix = COMP_GET_IPC(dev, sof_ipc_comp_process);
+	ret = memcpy_s(matrix, sizeof(*matrix), ipc_matrix,
+		       sizeof(struct sof_ipc_comp_process));
+	assert(!ret);
+
+	cd = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM, sizeof(*cd));
+	if (!cd) {
+		rfree(dev);
+		return NULL;
+	}
+
+	comp_set_drvdata(dev, cd);
+
+	/* component model data handler */
+	cd->model_handler = comp_data_blob_handler_new(dev);
+	if (!cd->model_handler) {
+		comp_cl_err(&comp_matrix, "matrix_new(): comp_data_blob_handler_new() failed.");
+		rfree(dev);
+		rfree(cd);
+		return NULL;
+	}
+
+	comp_data_blob_set_ops(cd->model_handler, &matrix_blob_ops);
+
+	/* Allocate and make a copy of the coefficients blob. If the matrix is
+	 * configured later in run-time the size is zero.
+	 */
+	ret = comp_init_data_blob(cd->model_handler, bs, ipc_matrix->data);
+	if (ret < 0) {
+		comp_cl_err(&comp_matrix, "matrix_new(): comp_init_data_blob() failed.");
+		comp_data_blob_handler_free(cd->model_handler);
+		rfree(dev);
+		rfree(cd);
+		return NULL;
+	}
+
+	dev->state = COMP_STATE_READY;
+	return dev;
+}
+
+static void matrix_free(struct comp_dev *dev)
+{
+	struct matrix_comp_data *cd = comp_get_drvdata(dev);
+
+	comp_info(dev, "matrix_free()");
+
+	comp_data_blob_handler_free(cd->model_handler);
+
+	rfree(cd);
+	rfree(dev);
+}
+
+static int matrix_verify_params(struct comp_dev *dev,
+				struct sof_ipc_stream_params *params)
+{
+	struct matrix_comp_data *cd = comp_get_drvdata(dev);
+	struct sof_matrix_config *config;
+	struct comp_buffer *sourceb;
+	struct comp_buffer *sinkb;
+	uint32_t buffer_flag;
+	size_t size;
+	int ret;
+
+	comp_dbg(dev, "matrix_verify_params()");
+
+	/* Matrix component will only ever have 1 source and 1 sink buffer */
+	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
+				  sink_list);
+	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
+				source_list);
+
+	/* Any pair of supported frame formats is converted, sink (playback)
+	 * or source (capture) frame_fmt is overwritten with pcm frame_fmt
+	 * only if it is not supported.
+	 */
+	buffer_flag = matrix_check_format(sourceb->stream.frame_fmt) &&
+		matrix_check_format(sinkb->stream.frame_fmt) ?
+		BUFF_PARAMS_FRAME_FMT : 0;
+
+	/* The blob defines the channels counts of both sides of the matrix,
+	 * the pcm params channels are changed for the other side.
+	 */
+	config = comp_get_data_blob(cd->model_handler, &size, NULL);
+	if (config) {
+		ret = matrix_check_config(dev, config, size);
+		if (ret < 0)
+			return ret;
+
+		if (dev->direction == SOF_IPC_STREAM_PLAYBACK) {
+			if (params->channels != config->in_channels) {
+				comp_err(dev, "matrix_verify_params(): pcm channels %u don't match in_channels %u",
+					 params->channels, config->in_channels);
+				return -EINVAL;
+			}
+			params->channels = config->out_channels;
+		} else {
+			if (params->channels != config->out_channels) {
+				comp_err(dev, "matrix_verify_params(): pcm channels %u don't match out_channels %u",
+					 params->channels,
+					 config->out_channels);
+				return -EINVAL;
+			}
+			params->channels = config->in_channels;
+		}
+	}
+
+	ret = comp_verify_params(dev, buffer_flag, params);
+	if (ret < 0) {
+		comp_err(dev, "matrix_verify_params(): comp_verify_params() failed.");
+		return ret;
+	}
+
+	return 0;
+}
+
+/* set component audio stream parameters */
+static int matrix_params(struct comp_dev *dev,
+			 struct sof_ipc_stream_params *params)
+{
+	int err;
+
+	comp_info(dev, "matrix_params()");
+
+	err = matrix_verify_params(dev, params);
+	if (err < 0) {
+		comp_err(dev, "matrix_params(): pcm params verification failed.");
+		return -EINVAL;
+	}
+
+	/* All configuration work is postponed to prepare(). */
+	return 0;
+}
+
+static int matrix_cmd_get_data(struct comp_dev *dev,
+			       struct sof_ipc_ctrl_data *cdata, int max_size)
+{
+	struct matrix_comp_data *cd = comp_get_drvdata(dev);
+	int ret = 0;
+
+	switch (cdata->cmd) {
+	case SOF_CTRL_CMD_BINARY:
+		comp_info(dev, "matrix_cmd_get_data(), SOF_CTRL_CMD_BINARY");
+		ret = comp_data_blob_get_cmd(cd->model_handler, cdata,
+					     max_size);
+		break;
+	default:
+		comp_err(dev, "matrix_cmd_get_data(), invalid command");
+		ret = -EINVAL;
+		break;
+	}
+	return ret;
+}
+
+static int matrix_cmd_set_data(struct comp_dev *dev,
+			       struct sof_ipc_ctrl_data *cdata)
+{
+	struct matrix_comp_data *cd = comp_get_drvdata(dev);
+	int ret = 0;
+
+	switch (cdata->cmd) {
+	case SOF_CTRL_CMD_BINARY:
+		comp_info(dev, "matrix_cmd_set_data(), SOF_CTRL_CMD_BINARY");
+		ret = comp_data_blob_set_cmd(cd->model_handler, cdata);
+		break;
+	default:
+		comp_err(dev, "matrix_cmd_set_data(), invalid command");
+		ret = -EINVAL;
+		break;
+	}
+
+	return ret;
+}
+
+/* used to pass standard and bespoke commands (with data) to component */
+static int matrix_cmd(struct comp_dev *dev, int cmd, void *data,
+		      int max_data_size)
+{
+	struct sof_ipc_ctrl_data *cdata = data;
+	int ret = 0;
+
+	comp_info(dev, "matrix_cmd()");
+
+	switch (cmd) {
+	case COMP_CMD_SET_DATA:
+		ret = matrix_cmd_set_data(dev, cdata);
+		break;
+	case COMP_CMD_GET_DATA:
+		ret = matrix_cmd_get_data(dev, cdata, max_data_size);
+		break;
+	default:
+		comp_err(dev, "matrix_cmd(), invalid command");
+		ret = -EINVAL;
+	}
+
+	return ret;
+}
+
+static int matrix_trigger(struct comp_dev *dev, int cmd)
+{
+	int ret;
+
+	comp_info(dev, "matrix_trigger()");
+
+	ret = comp_set_state(dev, cmd);
+	if (ret == COMP_STATUS_STATE_ALREADY_SET)
+		ret = PPL_STATUS_PATH_STOP;
+
+	return ret;
+}
+
+static void matrix_process(struct comp_dev *dev, struct comp_buffer *source,
+			   struct comp_buffer *sink, int frames,
+			   uint32_t source_bytes, uint32_t sink_bytes)
+{
+	struct matrix_comp_data *cd = comp_get_drvdata(dev);
+
+	buffer_invalidate(source, source_bytes);
+
+	cd->plan.func(dev, &source->stream, &sink->stream, frames);
+
+	buffer_writeback(sink, sink_bytes);
+
+	/* calc new free and available */
+	comp_update_buffer_consume(source, source_bytes);
+	comp_update_buffer_produce(sink, sink_bytes);
+}
+
+/* copy and process stream data from source to sink buffers */
+static int matrix_copy(struct comp_dev *dev)
+{
+	struct comp_copy_limits cl;
+	struct matrix_comp_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *sourceb;
+	struct comp_buffer *sinkb;
+
+	comp_dbg(dev, "matrix_copy()");
+
+	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
+				  sink_list);
+
+	/* Swap to the plan prepared for changed configuration */
+	if (comp_is_new_data_blob_available(cd->model_handler))
+		cd->config = comp_get_data_blob(cd->model_handler, NULL, NULL);
+
+	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
+				source_list);
+
+	/* Get source, sink, number of frames etc. to process. */
+	comp_get_copy_limits_with_lock(sourceb, sinkb, &cl);
+
+	/* Run matrix function */
+	matrix_process(dev, sourceb, sinkb, cl.frames, cl.source_bytes,
+		       cl.sink_bytes);
+
+	return 0;
+}
+
+static int matrix_prepare(struct comp_dev *dev)
+{
+	struct matrix_comp_data *cd = comp_get_drvdata(dev);
+	struct sof_ipc_comp_config *config = dev_comp_config(dev);
+	struct comp_buffer *sourceb;
+	struct comp_buffer *sinkb;
+	uint32_t sink_period_bytes;
+	size_t size;
+	int ret;
+
+	comp_info(dev, "matrix_prepare()");
+
+	ret = comp_set_state(dev, COMP_TRIGGER_PREPARE);
+	if (ret < 0)
+		return ret;
+
+	if (ret == COMP_STATUS_STATE_ALREADY_SET)
+		return PPL_STATUS_PATH_STOP;
+
+	/* Matrix component will only ever have 1 source and 1 sink buffer */
+	sourceb = list_first_item(&dev->bsource_list,
+				  struct comp_buffer, sink_list);
+	sinkb = list_first_item(&dev->bsink_list,
+				struct comp_buffer, source_list);
+
+	/* get source and sink data formats */
+	cd->source_format = sourceb->stream.frame_fmt;
+	cd->sink_format = sinkb->stream.frame_fmt;
+	if (!matrix_check_format(cd->source_format) ||
+	    !matrix_check_format(cd->sink_format)) {
+		comp_err(dev, "matrix_prepare(), unsupported formats %d to %d",
+			 cd->source_format, cd->sink_format);
+		ret = -EINVAL;
+		goto err;
+	}
+
+	/* get sink period bytes */
+	sink_period_bytes = audio_stream_period_bytes(&sinkb->stream,
+						      dev->frames);
+
+	if (sinkb->stream.size < config->periods_sink * sink_period_bytes) {
+		comp_err(dev, "matrix_prepare(): sink buffer size %d is insufficient < %d * %d",
+			 sinkb->stream.size, config->periods_sink,
+			 sink_period_bytes);
+		ret = -ENOMEM;
+		goto err;
+	}
+
+	cd->config = comp_get_data_blob(cd->model_handler, &size, NULL);
+
+	comp_info(dev, "matrix_prepare(), source_format=%d, sink_format=%d",
+		  cd->source_format, cd->sink_format);
+	if (cd->config) {
+		ret = matrix_check_config(dev, cd->config, size);
+		if (ret < 0)
+			goto err;
+
+		if (sourceb->stream.channels != cd->config->in_channels ||
+		    sinkb->stream.channels != cd->config->out_channels) {
+			comp_err(dev, "matrix_prepare(), stream channels %u to %u don't match the matrix",
+				 sourceb->stream.channels,
+				 sinkb->stream.channels);
+			ret = -EINVAL;
+			goto err;
+		}
+	} else if (sourceb->stream.channels != sinkb->stream.channels ||
+		   sourceb->stream.channels > PLATFORM_MAX_CHANNELS) {
+		comp_err(dev, "matrix_prepare(), pass-through of channels %u to %u",
+			 sourceb->stream.channels, sinkb->stream.channels);
+		ret = -EINVAL;
+		goto err;
+	}
+
+	matrix_init_plan(&cd->plan, cd->config, sourceb->stream.channels);
+	cd->plan.func = matrix_find_func(cd, &cd->plan);
+
+	if (cd->config)
+		comp_info(dev, "matrix_prepare(), %u to %u channels matrix is configured.",
+			  cd->plan.in_channels, cd->plan.out_channels);
+	else
+		comp_info(dev, "matrix_prepare(), pass-through mode.");
+
+	return 0;
+
+err:
+	comp_set_state(dev, COMP_TRIGGER_RESET);
+	return ret;
+}
+
+static int matrix_reset(struct comp_dev *dev)
+{
+	struct matrix_comp_data *cd = comp_get_drvdata(dev);
+
+	comp_info(dev, "matrix_reset()");
+
+	cd->plan.func = NULL;
+
+	comp_set_state(dev, COMP_TRIGGER_RESET);
+	return 0;
+}
+
+static const struct comp_driver comp_matrix = {
+	.uid = SOF_RT_UUID(matrix_uuid),
+	.tctx = &matrix_tr,
+	.flags = COMP_DRV_DRAIN,
+	.ops = {
+		.create = matrix_new,
+		.free = matrix_free,
+		.params = matrix_params,
+		.cmd = matrix_cmd,
+		.trigger = matrix_trigger,
+		.copy = matrix_copy,
+		.prepare = matrix_prepare,
+		.reset = matrix_reset,
+	},
+};
+
+static SHARED_DATA struct comp_driver_info comp_matrix_info = {
+	.drv = &comp_matrix,
+};
+
+UT_STATIC void sys_comp_matrix_init(void)
+{
+	comp_register(platform_shared_get(&comp_matrix_info,
+					  sizeof(comp_matrix_info)));
+}
+
+DECLARE_MODULE(sys_comp_matrix_init);
@@ -0,0 +1,474 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/audio_stream.h>
+#include <sof/audio/component.h>
+#include <sof/audio/format.h>
+#include <sof/audio/matrix/matrix.h>
+#include <sof/common.h>
+#include <ipc/stream.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* frames until the source or the sink pointer wraps */
+static inline uint32_t matrix_frames_without_wrap(const struct audio_stream *source,
+						  const void *x,
+						  const struct audio_stream *sink,
+						  const void *y)
+{
+	return MIN(audio_stream_frames_without_wrap(source, x),
+		   audio_stream_frames_without_wrap(sink, y));
+}
+
+/* Identity matrix of same source and sink formats, e.g. pass-through */
+void matrix_identity(const struct comp_dev *dev,
+		     const struct audio_stream *source,
+		     struct audio_stream *sink, uint32_t frames)
+{
+	audio_stream_copy(source, 0, sink, 0, frames * source->channels);
+}
+
+/*
+ * Generic processing for any matrix and any source and sink formats. The
+ * samples are converted to Q1.31 and only the non-zero terms are
+ * multiplied, the sum of Q1.31 x Q2.14 products is Q3.45.
+ */
+
+static inline void matrix_load_frame(const void *x, int32_t *in, int nch,
+				     enum sof_ipc_frame fmt)
+{
+	const int16_t *x16 = x;
+	const int32_t *x32 = x;
+	int ch;
+
+	switch (fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		for (ch = 0; ch < nch; ch++)
+			in[ch] = (int32_t)x16[ch] << 16;
+		break;
+	case SOF_IPC_FRAME_S24_4LE:
+		for (ch = 0; ch < nch; ch++)
+			in[ch] = sign_extend_s24(x32[ch]) << 8;
+		break;
+	default:
+		for (ch = 0; ch < nch; ch++)
+			in[ch] = x32[ch];
+		break;
+	}
+}
+
+static inline void matrix_store_sample(void *y, int ch, int64_t acc,
+				       enum sof_ipc_frame fmt)
+{
+	int16_t *y16 = y;
+	int32_t *y32 = y;
+
+	switch (fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		y16[ch] = sat_int16(Q_SHIFT_RND(acc, 45, 15));
+		break;
+	case SOF_IPC_FRAME_S24_4LE:
+		y32[ch] = sat_int24(Q_SHIFT_RND(acc, 45, 23));
+		break;
+	default:
+		y32[ch] = sat_int32(Q_SHIFT_RND(acc, 45, 31));
+		break;
+	}
+}
+
+void matrix_generic(const struct comp_dev *dev,
+		    const struct audio_stream *source,
+		    struct audio_stream *sink, uint32_t frames)
+{
+	struct matrix_comp_data *cd = comp_get_drvdata(dev);
+	const struct matrix_plan *plan = &cd->plan;
+	const struct matrix_term *term;
+	int32_t in[PLATFORM_MAX_CHANNELS];
+	uint32_t source_frame_bytes = audio_stream_frame_bytes(source);
+	uint32_t sink_frame_bytes = audio_stream_frame_bytes(sink);
+	char *x = source->r_ptr;
+	char *y = sink->w_ptr;
+	int64_t acc;
+	int in_nch = plan->in_channels;
+	int out_nch = plan->out_channels;
+	int ch;
+	int i;
+	int n;
+	int t;
+
+	while (frames) {
+		n = MIN(frames, matrix_frames_without_wrap(source, x, sink, y));
+		for (i = 0; i < n; i++) {
+			matrix_load_frame(x, in, in_nch, source->frame_fmt);
+			term = plan->term;
+			for (ch = 0; ch < out_nch; ch++) {
+				acc = 0;
+				for (t = 0; t < plan->term_count[ch]; t++) {
+					acc += (int64_t)in[term->in_channel] *
+						term->coef;
+					term++;
+				}
+
+				matrix_store_sample(y, ch, acc,
+						    sink->frame_fmt);
+			}
+
+			x += source_frame_bytes;
+			y += sink_frame_bytes;
+		}
+
+		x = audio_stream_wrap(source, x);
+		y = audio_stream_wrap(sink, y);
+		frames -= n;
+	}
+}
+
+/*
+ * Copy processing for outputs that are single input channels or silence,
+ * e.g. channel permutations, mono to stereo or picking one channel.
+ */
+
+#if CONFIG_FORMAT_S16LE
+static void matrix_copy_s16(const struct comp_dev *dev,
+			    const struct audio_stream *source,
+			    struct audio_stream *sink, uint32_t frames)
+{
+	struct matrix_comp_data *cd = comp_get_drvdata(dev);
+	const struct matrix_plan *plan = &cd->plan;
+	int16_t *x = source->r_ptr;
+	int16_t *y = sink->w_ptr;
+	int in_nch = plan->in_channels;
+	int out_nch = plan->out_channels;
+	int ch;
+	int i;
+	int n;
+
+	while (frames) {
+		n = MIN(frames, matrix_frames_without_wrap(source, x, sink, y));
+		for (i = 0; i < n; i++) {
+			for (ch = 0; ch < out_nch; ch++)
+				y[ch] = plan->src_channel[ch] == MATRIX_CHANNEL_NONE ?
+					0 : x[plan->src_channel[ch]];
+
+			x += in_nch;
+			y += out_nch;
+		}
+
+		x = audio_stream_wrap(source, x);
+		y = audio_stream_wrap(sink, y);
+		frames -= n;
+	}
+}
+#endif /* CONFIG_FORMAT_S16LE */
+
+#if CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
+static void matrix_copy_s32(const struct comp_dev *dev,
+			    const struct audio_stream *source,
+			    struct audio_stream *sink, uint32_t frames)
+{
+	struct matrix_comp_data *cd = comp_get_drvdata(dev);
+	const struct matrix_plan *plan = &cd->plan;
+	int32_t *x = source->r_ptr;
+	int32_t *y = sink->w_ptr;
+	int in_nch = plan->in_channels;
+	int out_nch = plan->out_channels;
+	int ch;
+	int i;
+	int n;
+
+	while (frames) {
+		n = MIN(frames, matrix_frames_without_wrap(source, x, sink, y));
+		for (i = 0; i < n; i++) {
+			for (ch = 0; ch < out_nch; ch++)
+				y[ch] = plan->src_channel[ch] == MATRIX_CHANNEL_NONE ?
+					0 : x[plan->src_channel[ch]];
+
+			x += in_nch;
+			y += out_nch;
+		}
+
+		x = audio_stream_wrap(source, x);
+		y = audio_stream_wrap(sink, y);
+		frames -= n;
+	}
+}
+#endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE */
+
+/*
+ * Dense processing of same source and sink formats. The channel counts are
+ * constants in the callers so the compiler unrolls the loops over channels.
+ * The sum of Qx.y x Q2.14 products is shifted back to Qx.y.
+ */
+
+#if CONFIG_FORMAT_S16LE
+static inline void matrix_dense_s16(const struct comp_dev *dev,
+				    const struct audio_stream *source,
+				    struct audio_stream *sink, uint32_t frames,
+				    const int in_nch, const int out_nch)
+{
+	struct matrix_comp_data *cd = comp_get_drvdata(dev);
+	const int16_t *coef;
+	int16_t *x = source->r_ptr;
+	int16_t *y = sink->w_ptr;
+	int64_t acc;
+	int i;
+	int j;
+	int k;
+	int n;
+
+	while (frames) {
+		n = MIN(frames, matrix_frames_without_wrap(source, x, sink, y));
+		for (i = 0; i < n; i++) {
+			coef = cd->plan.coef;
+			for (j = 0; j < out_nch; j++) {
+				acc = 0;
+				for (k = 0; k < in_nch; k++)
+					acc += (int32_t)x[k] * coef[k];
+
+				y[j] = sat_int16(Q_SHIFT_RND(acc, 29, 15));
+				coef += in_nch;
+			}
+
+			x += in_nch;
+			y += out_nch;
+		}
+
+		x = audio_stream_wrap(source, x);
+		y = audio_stream_wrap(sink, y);
+		frames -= n;
+	}
+}
+
+static void matrix_s16_1to2(const struct comp_dev *dev,
+			    const struct audio_stream *source,
+			    struct audio_stream *sink, uint32_t frames)
+{
+	matrix_dense_s16(dev, source, sink, frames, 1, 2);
+}
+
+static void matrix_s16_2to1(const struct comp_dev *dev,
+			    const struct audio_stream *source,
+			    struct audio_stream *sink, uint32_t frames)
+{
+	matrix_dense_s16(dev, source, sink, frames, 2, 1);
+}
+
+static void matrix_s16_2to6(const struct comp_dev *dev,
+			    const struct audio_stream *source,
+			    struct audio_stream *sink, uint32_t frames)
+{
+	matrix_dense_s16(dev, source, sink, frames, 2, 6);
+}
+
+static void matrix_s16_6to2(const struct comp_dev *dev,
+			    const struct audio_stream *source,
+			    struct audio_stream *sink, uint32_t frames)
+{
+	matrix_dense_s16(dev, source, sink, frames, 6, 2);
+}
+
+static void matrix_s16_8to2(const struct comp_dev *dev,
+			    const struct audio_stream *source,
+			    struct audio_stream *sink, uint32_t frames)
+{
+	matrix_dense_s16(dev, source, sink, frames, 8, 2);
+}
+#endif /* CONFIG_FORMAT_S16LE */
+
+#if CONFIG_FORMAT_S24LE
+static inline void matrix_dense_s24(const struct comp_dev *dev,
+				    const struct audio_stream *source,
+				    struct audio_stream *sink, uint32_t frames,
+				    const int in_nch, const int out_nch)
+{
+	struct matrix_comp_data *cd = comp_get_drvdata(dev);
+	const int16_t *coef;
+	int32_t *x = source->r_ptr;
+	int32_t *y = sink->w_ptr;
+	int64_t acc;
+	int i;
+	int j;
+	int k;
+	int n;
+
+	while (frames) {
+		n = MIN(frames, matrix_frames_without_wrap(source, x, sink, y));
+		for (i = 0; i < n; i++) {
+			coef = cd->plan.coef;
+			for (j = 0; j < out_nch; j++) {
+				acc = 0;
+				for (k = 0; k < in_nch; k++)
+					acc += (int64_t)sign_extend_s24(x[k]) *
+						coef[k];
+
+				y[j] = sat_int24(Q_SHIFT_RND(acc, 37, 23));
+				coef += in_nch;
+			}
+
+			x += in_nch;
+			y += out_nch;
+		}
+
+		x = audio_stream_wrap(source, x);
+		y = audio_stream_wrap(sink, y);
+		frames -= n;
+	}
+}
+
+static void matrix_s24_1to2(const struct comp_dev *dev,
+			    const struct audio_stream *source,
+			    struct audio_stream *sink, uint32_t frames)
+{
+	matrix_dense_s24(dev, source, sink, frames, 1, 2);
+}
+
+static void matrix_s24_2to1(const struct comp_dev *dev,
+			    const struct audio_stream *source,
+			    struct audio_stream *sink, uint32_t frames)
+{
+	matrix_dense_s24(dev, source, sink, frames, 2, 1);
+}
+
+static void matrix_s24_2to6(const struct comp_dev *dev,
+			    const struct audio_stream *source,
+			    struct audio_stream *sink, uint32_t frames)
+{
+	matrix_dense_s24(dev, source, sink, frames, 2, 6);
+}
+
+static void matrix_s24_6to2(const struct comp_dev *dev,
+			    const struct audio_stream *source,
+			    struct audio_stream *sink, uint32_t frames)
+{
+	matrix_dense_s24(dev, source, sink, frames, 6, 2);
+}
+
+static void matrix_s24_8to2(const struct comp_dev *dev,
+			    const struct audio_stream *source,
+			    struct audio_stream *sink, uint32_t frames)
+{
+	matrix_dense_s24(dev, source, sink, frames, 8, 2);
+}
+#endif /* CONFIG_FORMAT_S24LE */
+
+#if CONFIG_FORMAT_S32LE
+static inline void matrix_dense_s32(const struct comp_dev *dev,
+				    const struct audio_stream *source,
+				    struct audio_stream *sink, uint32_t frames,
+				    const int in_nch, const int out_nch)
+{
+	struct matrix_comp_data *cd = comp_get_drvdata(dev);
+	const int16_t *coef;
+	int32_t *x = source->r_ptr;
+	int32_t *y = sink->w_ptr;
+	int64_t acc;
+	int i;
+	int j;
+	int k;
+	int n;
+
+	while (frames) {
+		n = MIN(frames, matrix_frames_without_wrap(source, x, sink, y));
+		for (i = 0; i < n; i++) {
+			coef = cd->plan.coef;
+			for (j = 0; j < out_nch; j++) {
+				acc = 0;
+				for (k = 0; k < in_nch; k++)
+					acc += (int64_t)x[k] * coef[k];
+
+				y[j] = sat_int32(Q_SHIFT_RND(acc, 45, 31));
+				coef += in_nch;
+			}
+
+			x += in_nch;
+			y += out_nch;
+		}
+
+		x = audio_stream_wrap(source, x);
+		y = audio_stream_wrap(sink, y);
+		frames -= n;
+	}
+}
+
+static void matrix_s32_1to2(const struct comp_dev *dev,
+			    const struct audio_stream *source,
+			    struct audio_stream *sink, uint32_t frames)
+{
+	matrix_dense_s32(dev, source, sink, frames, 1, 2);
+}
+
+static void matrix_s32_2to1(const struct comp_dev *dev,
+			    const struct audio_stream *source,
+			    struct audio_stream *sink, uint32_t frames)
+{
+	matrix_dense_s32(dev, source, sink, frames, 2, 1);
+}
+
+static void matrix_s32_2to6(const struct comp_dev *dev,
+			    const struct audio_stream *source,
+			    struct audio_stream *sink, uint32_t frames)
+{
+	matrix_dense_s32(dev, source, sink, frames, 2, 6);
+}
+
+static void matrix_s32_6to2(const struct comp_dev *dev,
+			    const struct audio_stream *source,
+			    struct audio_stream *sink, uint32_t frames)
+{
+	matrix_dense_s32(dev, source, sink, frames, 6, 2);
+}
+
+static void matrix_s32_8to2(const struct comp_dev *dev,
+			    const struct audio_stream *source,
+			    struct audio_stream *sink, uint32_t frames)
+{
+	matrix_dense_s32(dev, source, sink, frames, 8, 2);
+}
+#endif /* CONFIG_FORMAT_S32LE */
+
+const struct matrix_proc_fnmap matrix_copy_fnmap[] = {
+/* { FRAME_FORMAT , PROCESSING FUNCTION } */
+#if CONFIG_FORMAT_S16LE
+	{ SOF_IPC_FRAME_S16_LE, matrix_copy_s16 },
+#endif /* CONFIG_FORMAT_S16LE */
+
+#if CONFIG_FORMAT_S24LE
+	{ SOF_IPC_FRAME_S24_4LE, matrix_copy_s32 },
+#endif /* CONFIG_FORMAT_S24LE */
+
+#if CONFIG_FORMAT_S32LE
+	{ SOF_IPC_FRAME_S32_LE, matrix_copy_s32 },
+#endif /* CONFIG_FORMAT_S32LE */
+};
+
+const size_t matrix_copy_fncount = ARRAY_SIZE(matrix_copy_fnmap);
+
+const struct matrix_shape_fnmap matrix_dense_fnmap[] = {
+/* { FRAME_FORMAT , IN, OUT, PROCESSING FUNCTION } */
+#if CONFIG_FORMAT_S16LE
+	{ SOF_IPC_FRAME_S16_LE, 1, 2, matrix_s16_1to2 },
+	{ SOF_IPC_FRAME_S16_LE, 2, 1, matrix_s16_2to1 },
+	{ SOF_IPC_FRAME_S16_LE, 2, 6, matrix_s16_2to6 },
+	{ SOF_IPC_FRAME_S16_LE, 6, 2, matrix_s16_6to2 },
+	{ SOF_IPC_FRAME_S16_LE, 8, 2, matrix_s16_8to2 },
+#endif /* CONFIG_FORMAT_S16LE */
+
+#if CONFIG_FORMAT_S24LE
+	{ SOF_IPC_FRAME_S24_4LE, 1, 2, matrix_s24_1to2 },
+	{ SOF_IPC_FRAME_S24_4LE, 2, 1, matrix_s24_2to1 },
+	{ SOF_IPC_FRAME_S24_4LE, 2, 6, matrix_s24_2to6 },
+	{ SOF_IPC_FRAME_S24_4LE, 6, 2, matrix_s24_6to2 },
+	{ SOF_IPC_FRAME_S24_4LE, 8, 2, matrix_s24_8to2 },
+#endif /* CONFIG_FORMAT_S24LE */
+
+#if CONFIG_FORMAT_S32LE
+	{ SOF_IPC_FRAME_S32_LE, 1, 2, matrix_s32_1to2 },
+	{ SOF_IPC_FRAME_S32_LE, 2, 1, matrix_s32_2to1 },
+	{ SOF_IPC_FRAME_S32_LE, 2, 6, matrix_s32_2to6 },
+	{ SOF_IPC_FRAME_S32_LE, 6, 2, matrix_s32_6to2 },
+	{ SOF_IPC_FRAME_S32_LE, 8, 2, matrix_s32_8to2 },
+#endif /* CONFIG_FORMAT_S32LE */
+};
+
+const size_t matrix_dense_fncount = ARRAY_SIZE(matrix_dense_fnmap);
@@ -7,6 +7,7 @@
 
 #include <sof/audio/buffer.h>
 #include <sof/audio/component_ext.h>
+#include <sof/audio/fusion.h>
 #include <sof/audio/pipeline.h>
 #include <sof/debug/panic.h>
 #include <sof/drivers/interrupt.h>
@@ -14,9 +15,11 @@
 #include <sof/drivers/timer.h>
 #include <sof/lib/agent.h>
 #include <sof/lib/alloc.h>
+#include <sof/lib/cache.h>
 #include <sof/lib/clk.h>
 #include <sof/lib/mailbox.h>
 #include <sof/lib/mm_heap.h>
+#include <sof/lib/seqlock.h>
 #include <sof/lib/uuid.h>
 #include <sof/list.h>
 #include <sof/math/numbers.h>
@@ -263,6 +266,10 @@ int pipeline_complete(struct pipeline *p, struct comp_dev *source,
 	p->sink_comp = sink;
 	p->status = COMP_STATE_READY;
 
+#if CONFIG_PIPELINE_BUFFER_PLANNER
+	pipeline_buffers_plan(p);
+#endif
+
 	/* show heap status */
 	heap_trace_all(0);
 
@@ -610,6 +617,73 @@ static int pipeline_comp_task_init(struct pipeline *p)
 	return 0;
 }
 
+#if CONFIG_COMP_INPLACE
+static bool pipeline_list_is_single(struct list_item *list)
+{
+	return !list_is_empty(list) && list->next->next == list;
+}
+
+/* Links the buffers of an in-place component, which are both in its own
+ * pipeline and have the same size and format, so the component reads and
+ * writes the same memory.
+ */
+static void pipeline_comp_inplace_link(struct comp_dev *current)
+{
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+
+	if (!(current->drv->flags & COMP_DRV_INPLACE) ||
+	    !pipeline_list_is_single(&current->bsource_list) ||
+	    !pipeline_list_is_single(&current->bsink_list))
+		return;
+
+	source = list_first_item(&current->bsource_list, struct comp_buffer,
+				 sink_list);
+	sink = list_first_item(&current->bsink_list, struct comp_buffer,
+			       source_list);
+
+	if (!source->source || source->source->pipeline != current->pipeline ||
+	    !sink->sink || sink->sink->pipeline != current->pipeline ||
+	    source->inter_core || sink->inter_core)
+		return;
+
+#if CONFIG_PIPELINE_BUFFER_PLANNER
+	if (source->arena || sink->arena)
+		return;
+#endif
+
+#if CONFIG_COMP_DAI_ZERO_COPY
+	/* DAI DMA can be already set up on the storage of its buffer */
+	if (comp_get_endpoint_type(source->source) == COMP_ENDPOINT_DAI ||
+	    comp_get_endpoint_type(sink->sink) == COMP_ENDPOINT_DAI)
+		return;
+#endif
+
+	if (source->stream.size != sink->stream.size ||
+	    source->stream.frame_fmt != sink->stream.frame_fmt ||
+	    source->stream.channels != sink->stream.channels)
+		return;
+
+	pipe_dbg(current->pipeline, "pipeline_comp_inplace_link(), current->comp.id = %u",
+		 dev_comp_id(current));
+
+	buffer_inplace_link(source, sink);
+}
+
+static void pipeline_comp_inplace_unlink(struct comp_dev *current)
+{
+	struct comp_buffer *sink;
+
+	if (!(current->drv->flags & COMP_DRV_INPLACE) ||
+	    list_is_empty(&current->bsink_list))
+		return;
+
+	sink = list_first_item(&current->bsink_list, struct comp_buffer,
+			       source_list);
+	buffer_inplace_unlink(sink);
+}
+#endif
+
 static int pipeline_comp_prepare(struct comp_dev *current,
 				 struct comp_buffer *calling_buf,
 				 struct pipeline_walk_context *ctx, int dir)
@@ -651,6 +725,10 @@ static int pipeline_comp_prepare(struct comp_dev *current,
 	if (err < 0 || err == PPL_STATUS_PATH_STOP)
 		return err;
 
+#if CONFIG_COMP_INPLACE
+	pipeline_comp_inplace_link(current);
+#endif
+
 	return pipeline_for_each_comp(current, ctx, dir);
 }
 
@@ -679,6 +757,10 @@ int pipeline_prepare(struct pipeline *p, struct comp_dev *dev)
 
 	p->status = COMP_STATE_PREPARE;
 
+#if CONFIG_PIPELINE_FUSION
+	pipeline_fusion_build(p);
+#endif
+
 	return ret;
 }
 
@@ -932,6 +1014,14 @@ static int pipeline_comp_reset(struct comp_dev *current,
 	if (err < 0 || err == PPL_STATUS_PATH_STOP)
 		return err;
 
+#if CONFIG_COMP_INPLACE
+	pipeline_comp_inplace_unlink(current);
+#endif
+
+#if CONFIG_PIPELINE_FUSION
+	pipeline_fusion_free(current);
+#endif
+
 	return pipeline_for_each_comp(current, ctx, dir);
 }
 
@@ -983,18 +1073,49 @@ static int pipeline_comp_copy(struct comp_dev *current,
 		err = comp_copy(current);
 		if (err < 0 || err == PPL_STATUS_PATH_STOP)
 			return err;
+
+#if CONFIG_PIPELINE_BUFFER_PLANNER
+		err = pipeline_buffers_check(current);
+		if (err < 0)
+			return err;
+#endif
 	}
 
 	err = pipeline_for_each_comp(current, ctx, dir);
 	if (err < 0 || err == PPL_STATUS_PATH_STOP)
 		return err;
 
-	if (dir == PPL_DIR_UPSTREAM)
+	if (dir == PPL_DIR_UPSTREAM) {
 		err = comp_copy(current);
 
+#if CONFIG_PIPELINE_BUFFER_PLANNER
+		if (!err)
+			err = pipeline_buffers_check(current);
+#endif
+	}
+
 	return err;
 }
 
+#if CONFIG_PIPELINE_CACHE_BATCH
+/* traces cache lines done/requested per pass on the shared buffers */
+static void pipeline_cache_stats(struct pipeline *p)
+{
+	struct pipeline_cache_stats *stats = &p->cache;
+
+	if (++stats->passes < PIPELINE_CACHE_STATS_PASSES)
+		return;
+
+	pipe_info(p, "cache lines per pass inv %u/%u wb %u/%u",
+		  stats->inv_lines / PIPELINE_CACHE_STATS_PASSES,
+		  stats->inv_req / PIPELINE_CACHE_STATS_PASSES,
+		  stats->wb_lines / PIPELINE_CACHE_STATS_PASSES,
+		  stats->wb_req / PIPELINE_CACHE_STATS_PASSES);
+
+	memset(stats, 0, sizeof(*stats));
+}
+#endif
+
 /* Copy data across all pipeline components.
  * For capture pipelines it always starts from source component
  * and continues downstream and for playback pipelines it first
@@ -1028,6 +1149,10 @@ static int pipeline_copy(struct pipeline *p)
 		pipe_err(p, "pipeline_copy(): ret = %d, start->comp.id = %u, dir = %u",
 			 ret, dev_comp_id(start), dir);
 
+#if CONFIG_PIPELINE_CACHE_BATCH
+	pipeline_cache_stats(p);
+#endif
+
 	return ret;
 }
 
@@ -1078,6 +1203,36 @@ void pipeline_get_timestamp(struct pipeline *p, struct comp_dev *host,
 	posn->timestamp_ns = p->ipc_pipe.period * 1000;
 }
 
+#if CONFIG_STREAM_POSN_SEQLOCK
+void pipeline_posn_write(struct pipeline *p,
+			 const struct sof_ipc_stream_posn *posn)
+{
+	/* sequence number starts the record */
+	uint32_t *seq = (uint32_t *)(MAILBOX_STREAM_BASE + p->posn_offset -
+				     PPL_POSN_SLOT_POSN);
+	uint32_t flags;
+
+	/* IPC and LL updates of the same slot are on the same core */
+	irq_local_disable(flags);
+
+	seqlock_write_begin(seq);
+	dcache_writeback_region(seq, sizeof(*seq));
+
+	mailbox_stream_write(p->posn_offset, posn, sizeof(*posn));
+
+	seqlock_write_end(seq);
+	dcache_writeback_region(seq, sizeof(*seq));
+
+	irq_local_enable(flags);
+}
+#else
+void pipeline_posn_write(struct pipeline *p,
+			 const struct sof_ipc_stream_posn *posn)
+{
+	mailbox_stream_write(p->posn_offset, posn, sizeof(*posn));
+}
+#endif
+
 static int pipeline_comp_xrun(struct comp_dev *current,
 			      struct comp_buffer *calling_buf,
 			      struct pipeline_walk_context *ctx, int dir)
@@ -1089,8 +1244,7 @@ static int pipeline_comp_xrun(struct comp_dev *current,
 		platform_host_timestamp(current, ppl_data->posn);
 
 		/* send XRUN to host */
-		mailbox_stream_write(ppl_data->p->posn_offset, ppl_data->posn,
-				     sizeof(*ppl_data->posn));
+		pipeline_posn_write(ppl_data->p, ppl_data->posn);
 		ipc_msg_send(ppl_data->p->msg, ppl_data->posn, true);
 	}
 
@@ -368,6 +368,25 @@ static int selector_trigger(struct comp_dev *dev, int cmd)
 		PPL_STATUS_PATH_STOP : ret;
 }
 
+/**
+ * \brief Copies selected channels from source to sink stream.
+ * \param[in,out] dev Selector base component device.
+ * \param[in] source Source stream.
+ * \param[in,out] sink Sink stream.
+ * \param[in] frames Number of frames to process.
+ * \return Error code.
+ */
+static int selector_process(struct comp_dev *dev,
+			    const struct audio_stream *source,
+			    struct audio_stream *sink, uint32_t frames)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	cd->sel_func(dev, sink, source, frames);
+
+	return 0;
+}
+
 /**
  * \brief Copies and processes stream data.
  * \param[in,out] dev Selector base component device.
@@ -375,7 +394,6 @@ static int selector_trigger(struct comp_dev *dev, int cmd)
  */
 static int selector_copy(struct comp_dev *dev)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
 	struct comp_buffer *sink;
 	struct comp_buffer *source;
 	uint32_t frames;
@@ -409,7 +427,7 @@ static int selector_copy(struct comp_dev *dev)
 
 	/* copy selected channels from in to out */
 	buffer_invalidate(source, source_bytes);
-	cd->sel_func(dev, &sink->stream, &source->stream, frames);
+	selector_process(dev, &source->stream, &sink->stream, frames);
 	buffer_writeback(sink, sink_bytes);
 
 	/* calculate new free and available */
@@ -525,6 +543,7 @@ static const struct comp_driver comp_selector = {
 	.type	= SOF_COMP_SELECTOR,
 	.uid	= SOF_RT_UUID(selector_uuid),
 	.tctx	= &selector_tr,
+	.flags	= COMP_DRV_INPLACE | COMP_DRV_DRAIN,
 	.ops	= {
 		.create		= selector_new,
 		.free		= selector_free,
@@ -532,6 +551,7 @@ static const struct comp_driver comp_selector = {
 		.cmd		= selector_cmd,
 		.trigger	= selector_trigger,
 		.copy		= selector_copy,
+		.process	= selector_process,
 		.prepare	= selector_prepare,
 		.reset		= selector_reset,
 	},
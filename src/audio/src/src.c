@@ -15,23 +15,30 @@
 #include <sof/debug/panic.h>
 #include <sof/drivers/ipc.h>
 #include <sof/lib/alloc.h>
+#include <sof/lib/cache.h>
 #include <sof/lib/memory.h>
 #include <sof/lib/uuid.h>
 #include <sof/list.h>
 #include <sof/math/numbers.h>
 #include <sof/platform.h>
+#include <sof/spinlock.h>
 #include <sof/string.h>
 #include <sof/ut.h>
 #include <sof/trace/trace.h>
 #include <ipc/control.h>
 #include <ipc/stream.h>
 #include <ipc/topology.h>
+#include <user/src.h>
 #include <user/trace.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
-#if SRC_SHORT || CONFIG_COMP_SRC_TINY
+#if CONFIG_COMP_SRC_IPC
+/* No built-in conversions, the delay lines are limited as for the std set */
+#include <sof/audio/coefficients/src/src_std_int32_define.h>
+#elif SRC_SHORT || CONFIG_COMP_SRC_TINY
 #include <sof/audio/coefficients/src/src_tiny_int16_define.h>
 #include <sof/audio/coefficients/src/src_tiny_int16_table.h>
 #else
@@ -49,6 +56,13 @@
 #define MAX_FIR_DELAY_SIZE_XNCH (PLATFORM_MAX_CHANNELS * MAX_FIR_DELAY_SIZE)
 #define MAX_OUT_DELAY_SIZE_XNCH (PLATFORM_MAX_CHANNELS * MAX_OUT_DELAY_SIZE)
 
+/* Coefficient type of the filter core, the loaded blobs must match it */
+#if SRC_SHORT
+typedef int16_t src_coef_t;
+#else
+typedef int32_t src_coef_t;
+#endif
+
 static const struct comp_driver comp_src;
 
 /* c1c5326d-8390-46b4-aa47-95c3beca6550 */
@@ -57,10 +71,45 @@ DECLARE_SOF_RT_UUID("src", src_uuid, 0xc1c5326d, 0x8390, 0x46b4,
 
 DECLARE_TR_CTX(src_tr, SOF_UUID(src_uuid), LOG_LEVEL_INFO);
 
+/* Conversion defined in a coefficients blob */
+struct src_coef_conv {
+	int source_rate;
+	int sink_rate;
+	struct src_stage stage[SOF_SRC_MAX_STAGES];
+};
+
+/* Coefficients blob instantiated at run-time. The same blob received by
+ * several SRC instances is loaded once and shared by reference.
+ */
+struct src_coef_bank {
+	struct list_item list;		/* in src_banks list */
+	uint32_t crc;			/* crc32 of the blob */
+	int ref_count;			/* SRC instances using the bank */
+	int num_conversions;
+	size_t data_size;		/* conversions and copy of the blob */
+	struct src_coef_conv *conv;	/* coefs point to the blob copy */
+	struct sof_src_config *blob;	/* copy of the blob after conv */
+};
+
+/* all loaded coefficient banks */
+struct src_banks {
+	spinlock_t lock;		/* protects list and ref counts */
+	struct list_item list;
+};
+
+static SHARED_DATA struct src_banks src_banks;
+
+/* Stage for a 1:1 conversion or unused 2nd stage of a 1 stage conversion */
+static struct src_stage src_stage_copy = { 0, 0, 1, 1, 1, 1, 1, 0, -1, NULL };
+
 /* src component private data */
 struct comp_data {
 	struct polyphase_src src;
 	struct src_param param;
+	struct comp_data_blob_handler *model_handler;
+	struct src_coef_bank *bank;		/* provides current conversion */
+	struct src_coef_bank *loaded_bank;	/* loaded from own blob */
+	uint32_t bank_get_pos;			/* loaded blob read position */
 	int32_t *delay_lines;
 	uint32_t sink_rate;
 	uint32_t source_rate;
@@ -94,6 +143,7 @@ static int src_out_delay_length(struct src_stage *s)
 	return 1 + (s->num_of_subfilters - 1) * s->odm;
 }
 
+#if !CONFIG_COMP_SRC_IPC
 /* Returns index of a matching sample rate */
 static int src_find_fs(int fs_list[], int list_length, int fs)
 {
@@ -105,13 +155,395 @@ static int src_find_fs(int fs_list[], int list_length, int fs)
 	}
 	return -EINVAL;
 }
+#endif
+
+static struct src_banks *src_banks_get(void)
+{
+	return platform_shared_get(&src_banks, sizeof(src_banks));
+}
+
+static void src_bank_put(struct src_coef_bank *bank)
+{
+	struct src_banks *banks = src_banks_get();
+	uint32_t flags;
+	bool release;
+
+	if (!bank)
+		return;
+
+	spin_lock_irq(&banks->lock, flags);
+
+	release = !--bank->ref_count;
+	if (release)
+		list_item_del(&bank->list);
+
+	platform_shared_commit(banks, sizeof(*banks));
+
+	spin_unlock_irq(&banks->lock, flags);
+
+	if (release) {
+		rfree(bank->conv);
+		rfree(bank);
+	}
+}
+
+static void src_stage_set(struct src_stage *stage,
+			  const struct sof_src_stage *s, const void *coefs)
+{
+	struct src_stage tmp = {
+		.idm = s->idm,
+		.odm = s->odm,
+		.num_of_subfilters = s->num_of_subfilters,
+		.subfilter_length = s->subfilter_length,
+		.filter_length = s->filter_length,
+		.blk_in = s->blk_in,
+		.blk_out = s->blk_out,
+		.halfband = s->halfband,
+		.shift = s->shift,
+		.coefs = coefs,
+	};
+	int ret;
+
+	/* the stage members are const */
+	ret = memcpy_s(stage, sizeof(*stage), &tmp, sizeof(tmp));
+	assert(!ret);
+}
+
+/* Output shift range of the stages generated by tools/tune/src */
+#define SRC_STAGE_SHIFT_MAX	3
+
+/* Checks the polyphase stepping of a stage. The input step is less than
+ * the input block and the output step less than the output block, which
+ * is one sample per subfilter. Only interpolating stages reading a single
+ * input sample with all the subfilters have idm 0 and only stages with a
+ * single subfilter have odm 0.
+ */
+static bool src_stage_is_valid(const struct sof_src_stage *s)
+{
+	if (s->blk_in < 1 || s->blk_out != s->num_of_subfilters)
+		return false;
+
+	if (s->blk_in == 1 ? s->idm != 0 : s->idm < 1 || s->idm >= s->blk_in)
+		return false;
+
+	if (s->num_of_subfilters == 1 ? s->odm != 0 :
+	    s->odm < 1 || s->odm >= s->blk_out)
+		return false;
+
+	return s->shift >= 0 && s->shift <= SRC_STAGE_SHIFT_MAX &&
+		(s->halfband == 0 || s->halfband == 1);
+}
+
+/* Walks through the conversions of a coefficients blob. The stages are
+ * set up to conv when it is given, otherwise the blob is only validated.
+ */
+static int src_blob_parse(struct comp_dev *dev, struct sof_src_config *config,
+			  struct src_coef_conv *conv)
+{
+	struct sof_src_conversion *c;
+	struct sof_src_stage *s;
+	uint8_t *pos = (uint8_t *)config->data;
+	uint8_t *end = (uint8_t *)config + config->size;
+	size_t coefs_size;
+	int i;
+	int j;
+
+	for (i = 0; i < config->num_conversions; i++) {
+		c = (struct sof_src_conversion *)pos;
+		if (end - pos < sizeof(*c)) {
+			comp_err(dev, "src_blob_parse(): conversion %d truncated",
+				 i);
+			return -EINVAL;
+		}
+
+		pos += sizeof(*c);
+		if (!c->source_rate || !c->sink_rate || !c->num_stages ||
+		    c->num_stages > SOF_SRC_MAX_STAGES) {
+			comp_err(dev, "src_blob_parse(): conversion %d invalid, num_stages = %u",
+				 i, c->num_stages);
+			return -EINVAL;
+		}
+
+		for (j = 0; j < c->num_stages; j++) {
+			s = (struct sof_src_stage *)pos;
+			if (end - pos < sizeof(*s)) {
+				comp_err(dev, "src_blob_parse(): conversion %d stage %d truncated",
+					 i, j);
+				return -EINVAL;
+			}
+
+			pos += sizeof(*s);
+
+			/* Optimized SRC requires subfilter length multiple
+			 * of 4 that also keeps the coefficients aligned.
+			 */
+			if (s->num_of_subfilters < 1 ||
+			    s->subfilter_length < 4 ||
+			    (s->subfilter_length & 0x3) > 0 ||
+			    s->filter_length != s->num_of_subfilters *
+						s->subfilter_length ||
+			    !src_stage_is_valid(s)) {
+				comp_err(dev, "src_blob_parse(): conversion %d stage %d invalid, filter_length = %d",
+					 i, j, s->filter_length);
+				return -EINVAL;
+			}
+
+			coefs_size = s->filter_length * sizeof(src_coef_t);
+			if (end - pos < coefs_size) {
+				comp_err(dev, "src_blob_parse(): conversion %d stage %d coefficients truncated",
+					 i, j);
+				return -EINVAL;
+			}
+
+			if (conv)
+				src_stage_set(&conv[i].stage[j], s, pos);
+
+			pos += coefs_size;
+		}
+
+		if (conv) {
+			conv[i].source_rate = c->source_rate;
+			conv[i].sink_rate = c->sink_rate;
+			if (c->num_stages == 1)
+				memcpy_s(&conv[i].stage[1],
+					 sizeof(conv[i].stage[1]),
+					 &src_stage_copy, sizeof(src_stage_copy));
+		}
+	}
+
+	return 0;
+}
+
+static struct src_coef_bank *src_bank_new(struct comp_dev *dev,
+					  struct sof_src_config *config,
+					  uint32_t crc)
+{
+	struct src_banks *banks = src_banks_get();
+	struct src_coef_bank *bank;
+	size_t conv_size = config->num_conversions *
+			   sizeof(struct src_coef_conv);
+	uint32_t flags;
+	int ret;
+
+	/* the list member and reference count are updated by all cores */
+	bank = rzalloc(SOF_MEM_ZONE_RUNTIME, SOF_MEM_FLAG_SHARED,
+		       SOF_MEM_CAPS_RAM, sizeof(*bank));
+	if (!bank)
+		return NULL;
+
+	bank->data_size = conv_size + config->size;
+	bank->conv = rballoc(0, SOF_MEM_CAPS_RAM, bank->data_size);
+	if (!bank->conv) {
+		comp_err(dev, "src_bank_new(): failed to alloc %u bytes",
+			 bank->data_size);
+		rfree(bank);
+		return NULL;
+	}
+
+	bank->blob = (struct sof_src_config *)((uint8_t *)bank->conv +
+					       conv_size);
+	ret = memcpy_s(bank->blob, config->size, config, config->size);
+	assert(!ret);
+
+	/* stage coefs point to the copy, the blob is validated already */
+	src_blob_parse(dev, bank->blob, bank->conv);
+	dcache_writeback_region(bank->conv, bank->data_size);
+
+	bank->crc = crc;
+	bank->ref_count = 1;
+	bank->num_conversions = config->num_conversions;
+
+	spin_lock_irq(&banks->lock, flags);
+	list_item_prepend(&bank->list, &banks->list);
+	platform_shared_commit(banks, sizeof(*banks));
+	spin_unlock_irq(&banks->lock, flags);
+
+	return bank;
+}
+
+static size_t src_bank_blob_size(struct src_coef_bank *bank)
+{
+	return bank->data_size -
+		bank->num_conversions * sizeof(struct src_coef_conv);
+}
+
+/* Banks are shared only for identical blobs, crc32 can collide */
+static bool src_bank_has_blob(struct src_coef_bank *bank,
+			      struct sof_src_config *config)
+{
+	dcache_invalidate_region(bank->blob, config->size);
+
+	return !memcmp(bank->blob, config, config->size);
+}
+
+/* Instantiates the coefficients blob received by the component. The blob
+ * is shared by reference if another SRC instance has loaded it already.
+ * The received copy of the blob is released after loading.
+ */
+static int src_bank_load(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct src_banks *banks = src_banks_get();
+	struct src_coef_bank *bank = NULL;
+	struct sof_src_config *config;
+	struct list_item *blist;
+	size_t size;
+	uint32_t crc = 0;
+	uint32_t flags;
+	int ret;
+
+	config = comp_get_data_blob(cd->model_handler, &size, &crc);
+	if (!config)
+		return 0;
+
+	if (size < sizeof(*config) || size > SOF_SRC_MAX_SIZE ||
+	    config->size != size) {
+		comp_err(dev, "src_bank_load(): invalid blob size %u", size);
+		ret = -EINVAL;
+		goto out;
+	}
+
+	if (config->coef_bits != 8 * sizeof(src_coef_t) ||
+	    config->num_conversions > SOF_SRC_MAX_CONVERSIONS) {
+		comp_err(dev, "src_bank_load(): coef_bits = %u, num_conversions = %u not supported",
+			 config->coef_bits, config->num_conversions);
+		ret = -EINVAL;
+		goto out;
+	}
+
+	ret = src_blob_parse(dev, config, NULL);
+	if (ret < 0)
+		goto out;
+
+	/* the candidate is held while the blobs are compared unlocked */
+	spin_lock_irq(&banks->lock, flags);
+	list_for_item(blist, &banks->list) {
+		bank = container_of(blist, struct src_coef_bank, list);
+		if (bank->crc == crc &&
+		    src_bank_blob_size(bank) == config->size) {
+			bank->ref_count++;
+			break;
+		}
+		bank = NULL;
+	}
+	platform_shared_commit(banks, sizeof(*banks));
+	spin_unlock_irq(&banks->lock, flags);
+
+	if (bank && !src_bank_has_blob(bank, config)) {
+		src_bank_put(bank);
+		bank = NULL;
+	}
+
+	if (!bank) {
+		bank = src_bank_new(dev, config, crc);
+		if (!bank) {
+			ret = -ENOMEM;
+			goto out;
+		}
+	}
 
-/* Calculates buffers to allocate for a SRC mode */
+	comp_info(dev, "src_bank_load(), %d conversions, crc 0x%08x",
+		  bank->num_conversions, crc);
+
+	src_bank_put(cd->loaded_bank);
+	cd->loaded_bank = bank;
+	cd->bank_get_pos = 0;
+
+out:
+	comp_init_data_blob(cd->model_handler, 0, NULL);
+	return ret;
+}
+
+static struct src_coef_conv *src_bank_find(struct src_coef_bank *bank,
+					   int fs_in, int fs_out)
+{
+	int i;
+
+	dcache_invalidate_region(bank->conv, bank->num_conversions *
+				 sizeof(struct src_coef_conv));
+
+	for (i = 0; i < bank->num_conversions; i++) {
+		if (bank->conv[i].source_rate == fs_in &&
+		    bank->conv[i].sink_rate == fs_out)
+			return &bank->conv[i];
+	}
+
+	return NULL;
+}
+
+/* Finds the stages for a conversion from the loaded banks and then from
+ * the built-in tables. The bank providing the stages is held in cd->bank.
+ */
+static int src_stages_get(struct comp_dev *dev, int fs_in, int fs_out)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct src_banks *banks = src_banks_get();
+	struct src_param *a = &cd->param;
+	struct src_coef_bank *bank = NULL;
+	struct src_coef_conv *conv = NULL;
+	struct list_item *blist;
+	uint32_t flags;
+#if !CONFIG_COMP_SRC_IPC
+	int idx_in;
+	int idx_out;
+#endif
+
+	src_bank_put(cd->bank);
+	cd->bank = NULL;
+	a->stage1 = NULL;
+	a->stage2 = NULL;
+
+	/* Same rates are copied and need no coefficients */
+	if (fs_in == fs_out) {
+		a->stage1 = &src_stage_copy;
+		a->stage2 = &src_stage_copy;
+		return 0;
+	}
+
+	spin_lock_irq(&banks->lock, flags);
+	list_for_item(blist, &banks->list) {
+		bank = container_of(blist, struct src_coef_bank, list);
+		conv = src_bank_find(bank, fs_in, fs_out);
+		if (conv) {
+			bank->ref_count++;
+			break;
+		}
+	}
+	platform_shared_commit(banks, sizeof(*banks));
+	spin_unlock_irq(&banks->lock, flags);
+
+	if (conv) {
+		dcache_invalidate_region(bank->conv, bank->data_size);
+		cd->bank = bank;
+		a->stage1 = &conv->stage[0];
+		a->stage2 = &conv->stage[1];
+		return 0;
+	}
+
+#if !CONFIG_COMP_SRC_IPC
+	idx_in = src_find_fs(src_in_fs, NUM_IN_FS, fs_in);
+	idx_out = src_find_fs(src_out_fs, NUM_OUT_FS, fs_out);
+
+	/* A deleted in/out rate combination has zero stage1 length */
+	if (idx_in >= 0 && idx_out >= 0 &&
+	    src_table1[idx_out][idx_in]->filter_length > 0) {
+		a->stage1 = src_table1[idx_out][idx_in];
+		a->stage2 = src_table2[idx_out][idx_in];
+		return 0;
+	}
+#endif
+
+	comp_err(dev, "src_stages_get(): no coefficients for fs_in = %d, fs_out = %d",
+		 fs_in, fs_out);
+	return -EINVAL;
+}
+
+/* Calculates buffers to allocate for a SRC mode, the stages must be set */
 int src_buffer_lengths(struct src_param *a, int fs_in, int fs_out, int nch,
 		       int source_frames)
 {
-	struct src_stage *stage1;
-	struct src_stage *stage2;
+	struct src_stage *stage1 = a->stage1;
+	struct src_stage *stage2 = a->stage2;
 	int r1;
 
 	if (nch > PLATFORM_MAX_CHANNELS) {
@@ -121,27 +553,16 @@ int src_buffer_lengths(struct src_param *a, int fs_in, int fs_out, int nch,
 		return -EINVAL;
 	}
 
-	a->nch = nch;
-	a->idx_in = src_find_fs(src_in_fs, NUM_IN_FS, fs_in);
-	a->idx_out = src_find_fs(src_out_fs, NUM_OUT_FS, fs_out);
-
-	/* Check that both in and out rates are supported */
-	if (a->idx_in < 0 || a->idx_out < 0) {
+	/* Check that the conversion is supported */
+	if (!stage1 || !stage2) {
 		comp_cl_err(&comp_src, "src_buffer_lengths(): rates not supported, fs_in: %u, fs_out: %u",
 			    fs_in, fs_out);
 		return -EINVAL;
 	}
 
-	stage1 = src_table1[a->idx_out][a->idx_in];
-	stage2 = src_table2[a->idx_out][a->idx_in];
-
-	/* Check from stage1 parameter for a deleted in/out rate combination.*/
-	if (stage1->filter_length < 1) {
-		comp_cl_err(&comp_src, "src_buffer_lengths(): Non-supported combination sfs_in = %d, fs_out = %d",
-			    fs_in, fs_out);
-		return -EINVAL;
-	}
-
+	a->nch = nch;
+	a->fs_in = fs_in;
+	a->fs_out = fs_out;
 	a->fir_s1 = nch * src_fir_delay_length(stage1);
 	a->out_s1 = nch * src_out_delay_length(stage1);
 
@@ -265,18 +686,14 @@ void src_polyphase_reset(struct polyphase_src *src)
 int src_polyphase_init(struct polyphase_src *src, struct src_param *p,
 		       int32_t *delay_lines_start)
 {
-	struct src_stage *stage1;
-	struct src_stage *stage2;
 	int n_stages;
 	int ret;
 
-	if (p->idx_in < 0 || p->idx_out < 0)
+	if (!p->stage1 || !p->stage2)
 		return -EINVAL;
 
 	/* Get setup for 2 stage conversion */
-	stage1 = src_table1[p->idx_out][p->idx_in];
-	stage2 = src_table2[p->idx_out][p->idx_in];
-	ret = init_stages(stage1, stage2, src, p, 2, delay_lines_start);
+	ret = init_stages(p->stage1, p->stage2, src, p, 2, delay_lines_start);
 	if (ret < 0)
 		return -EINVAL;
 
@@ -287,7 +704,7 @@ int src_polyphase_init(struct polyphase_src *src, struct src_param *p,
 	 * tap.
 	 */
 	n_stages = (src->stage2->filter_length == 1) ? 1 : 2;
-	if (p->idx_in == p->idx_out)
+	if (p->fs_in == p->fs_out)
 		n_stages = 0;
 
 	/* If filter length for first stage is zero this is a deleted
@@ -485,6 +902,15 @@ static struct comp_dev *src_new(const struct comp_driver *drv,
 
 	comp_set_drvdata(dev, cd);
 
+	/* component model data handler for run-time loaded coefficients */
+	cd->model_handler = comp_data_blob_handler_new(dev);
+	if (!cd->model_handler) {
+		comp_cl_err(&comp_src, "src_new(): comp_data_blob_handler_new() failed.");
+		rfree(cd);
+		rfree(dev);
+		return NULL;
+	}
+
 	cd->delay_lines = NULL;
 	cd->src_func = src_fallback;
 	cd->polyphase_func = NULL;
@@ -504,6 +930,10 @@ static void src_free(struct comp_dev *dev)
 	if (cd->delay_lines)
 		rfree(cd->delay_lines);
 
+	src_bank_put(cd->bank);
+	src_bank_put(cd->loaded_bank);
+	comp_data_blob_handler_free(cd->model_handler);
+
 	rfree(cd);
 	rfree(dev);
 }
@@ -593,6 +1023,18 @@ static int src_params(struct comp_dev *dev,
 	comp_info(dev, "src_params(), sourceb->channels = %u, sinkb->channels = %u, dev->frames = %u",
 		  sourceb->stream.channels,
 		  sinkb->stream.channels, dev->frames);
+
+	/* Coefficients received since previous params are taken in use */
+	err = src_bank_load(dev);
+	if (err < 0) {
+		comp_err(dev, "src_params(): src_bank_load() failed");
+		return err;
+	}
+
+	err = src_stages_get(dev, cd->source_rate, cd->sink_rate);
+	if (err < 0)
+		return err;
+
 	err = src_buffer_lengths(&cd->param, cd->source_rate,
 				 cd->sink_rate,
 				 sourceb->stream.channels, cd->source_frames);
@@ -662,6 +1104,89 @@ static int src_ctrl_cmd(struct comp_dev *dev, struct sof_ipc_ctrl_data *cdata)
 	return -EINVAL;
 }
 
+/* Returns the loaded blob from the bank copy as comp_data_blob_get_cmd()
+ * does for a blob not yet loaded.
+ */
+static int src_bank_get_cmd(struct comp_dev *dev,
+			    struct sof_ipc_ctrl_data *cdata, int max_size)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct src_coef_bank *bank = cd->loaded_bank;
+	uint32_t size = src_bank_blob_size(bank);
+	int ret;
+
+	/* reset read position in case of copying first element */
+	if (!cdata->msg_index)
+		cd->bank_get_pos = 0;
+
+	if (cdata->num_elems > max_size ||
+	    cdata->num_elems > size - cd->bank_get_pos) {
+		comp_err(dev, "src_bank_get_cmd(): invalid cdata->num_elems %d",
+			 cdata->num_elems);
+		return -EINVAL;
+	}
+
+	dcache_invalidate_region((uint8_t *)bank->blob + cd->bank_get_pos,
+				 cdata->num_elems);
+	ret = memcpy_s(cdata->data->data, max_size,
+		       (uint8_t *)bank->blob + cd->bank_get_pos,
+		       cdata->num_elems);
+	assert(!ret);
+
+	cdata->data->abi = SOF_ABI_VERSION;
+	cdata->data->size = size;
+	cd->bank_get_pos += cdata->num_elems;
+
+	return 0;
+}
+
+static int src_cmd_get_data(struct comp_dev *dev,
+			    struct sof_ipc_ctrl_data *cdata, int max_size)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int ret = 0;
+
+	switch (cdata->cmd) {
+	case SOF_CTRL_CMD_BINARY:
+		comp_info(dev, "src_cmd_get_data(), SOF_CTRL_CMD_BINARY");
+
+		/* the received blob is released once loaded to a bank */
+		if (cd->loaded_bank &&
+		    !comp_get_data_blob(cd->model_handler, NULL, NULL))
+			ret = src_bank_get_cmd(dev, cdata, max_size);
+		else
+			ret = comp_data_blob_get_cmd(cd->model_handler, cdata,
+						     max_size);
+		break;
+	default:
+		comp_err(dev, "src_cmd_get_data(): invalid cdata->cmd");
+		ret = -EINVAL;
+		break;
+	}
+	return ret;
+}
+
+/* The coefficients are loaded to the shared banks in next params() */
+static int src_cmd_set_data(struct comp_dev *dev,
+			    struct sof_ipc_ctrl_data *cdata)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int ret = 0;
+
+	switch (cdata->cmd) {
+	case SOF_CTRL_CMD_BINARY:
+		comp_info(dev, "src_cmd_set_data(), SOF_CTRL_CMD_BINARY");
+		ret = comp_data_blob_set_cmd(cd->model_handler, cdata);
+		break;
+	default:
+		comp_err(dev, "src_cmd_set_data(): invalid cdata->cmd");
+		ret = -EINVAL;
+		break;
+	}
+
+	return ret;
+}
+
 /* used to pass standard and bespoke commands (with data) to component */
 static int src_cmd(struct comp_dev *dev, int cmd, void *data,
 		   int max_data_size)
@@ -671,8 +1196,17 @@ static int src_cmd(struct comp_dev *dev, int cmd, void *data,
 
 	comp_info(dev, "src_cmd()");
 
-	if (cmd == COMP_CMD_SET_VALUE)
+	switch (cmd) {
+	case COMP_CMD_SET_VALUE:
 		ret = src_ctrl_cmd(dev, cdata);
+		break;
+	case COMP_CMD_SET_DATA:
+		ret = src_cmd_set_data(dev, cdata);
+		break;
+	case COMP_CMD_GET_DATA:
+		ret = src_cmd_get_data(dev, cdata, max_data_size);
+		break;
+	}
 
 	return ret;
 }
@@ -901,6 +1435,10 @@ static int src_reset(struct comp_dev *dev)
 	cd->src_func = src_fallback;
 	src_polyphase_reset(&cd->src);
 
+	/* the shared bank is looked up again in params() */
+	src_bank_put(cd->bank);
+	cd->bank = NULL;
+
 	comp_set_state(dev, COMP_TRIGGER_RESET);
 	return 0;
 }
@@ -927,6 +1465,12 @@ static SHARED_DATA struct comp_driver_info comp_src_info = {
 
 UT_STATIC void sys_comp_src_init(void)
 {
+	struct src_banks *banks = src_banks_get();
+
+	list_init(&banks->list);
+	spinlock_init(&banks->lock);
+	platform_shared_commit(banks, sizeof(*banks));
+
 	comp_register(platform_shared_get(&comp_src_info,
 					  sizeof(comp_src_info)));
 }
@@ -14,6 +14,7 @@
 
 #include <sof/audio/format.h>
 #include <sof/audio/src/src.h>
+#include <sof/platform.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -22,11 +23,13 @@
 static inline void fir_filter_generic(int32_t *rp, const void *cp, int32_t *wp0,
 				      int32_t *fir_start, int32_t *fir_end,
 				      const int fir_delay_length,
-				      const int taps_x_nch,
+				      const int taps, const int taps_x_nch,
 				      const int shift, const int nch)
 {
+	int64_t y[PLATFORM_MAX_CHANNELS];
 	int64_t y0;
 	int64_t y1;
+	int64_t c;
 	int32_t *data;
 	const int16_t *coef;
 	int i;
@@ -82,41 +85,47 @@ static inline void fir_filter_generic(int32_t *rp, const void *cp, int32_t *wp0,
 		return;
 	}
 
-	for (j = 0; j < nch; j++) {
-		/* Decrement data pointer to next channel start. Note that
-		 * initialization code ensures that circular wrap does not
-		 * happen mid-frame.
-		 */
-		data = d--;
-
-		/* Initialize to half LSB for rounding, prepare for FIR core */
-		y0 = rnd;
-		coef = (const int16_t *)cp;
-		frames = fir_end - data + nch - j - 1; /* Frames until wrap */
-		n1 = (taps_x_nch < frames) ? taps_x_nch : frames;
-		n2 = taps_x_nch - n1;
-
-		/* The FIR is calculated as Q1.15 x Q1.31 -> Q2.46. The
-		 * output shift includes the shift by 15 for Qx.46 to
-		 * Qx.31.
-		 */
-		for (i = 0; i < n1; i += nch) {
-			y0 += (int64_t)(*coef) * (*data);
-			coef++;
-			data += nch;
-		}
-		if (data >= fir_end)
-			data -= fir_delay_length;
+	/* All channels of a frame are filtered with the same coefficient
+	 * that is loaded once. The frames until the circular wrap and the
+	 * frames after it are filtered in two linear passes. Note that
+	 * initialization code ensures that circular wrap does not happen
+	 * mid-frame.
+	 */
+	for (j = 0; j < nch; j++)
+		y[j] = rnd; /* Half LSB for rounding */
+
+	coef = (const int16_t *)cp;
+	data = d;
+	frames = (fir_end - data + nch - 1) / nch; /* Frames until wrap */
+	n1 = (taps < frames) ? taps : frames;
+	n2 = taps - n1;
+
+	/* The FIR is calculated as Q1.15 x Q1.31 -> Q2.46. The
+	 * output shift includes the shift by 15 for Qx.46 to
+	 * Qx.31. Channel j sample is at offset -j from the frame.
+	 */
+	for (i = 0; i < n1; i++) {
+		c = *coef;
+		for (j = 0; j < nch; j++)
+			y[j] += c * data[-j];
+
+		coef++;
+		data += nch;
+	}
+	if (data >= fir_end)
+		data -= fir_delay_length;
 
-		for (i = 0; i < n2; i += nch) {
-			y0 += (int64_t)(*coef) * (*data);
-			coef++;
-			data += nch;
-		}
+	for (i = 0; i < n2; i++) {
+		c = *coef;
+		for (j = 0; j < nch; j++)
+			y[j] += c * data[-j];
 
-		*wp = sat_int32(y0 >> qshift);
-		wp++;
+		coef++;
+		data += nch;
 	}
+
+	for (j = 0; j < nch; j++)
+		wp[j] = sat_int32(y[j] >> qshift);
 }
 
 #else /* 32bit coefficients version */
@@ -124,11 +133,13 @@ static inline void fir_filter_generic(int32_t *rp, const void *cp, int32_t *wp0,
 static inline void fir_filter_generic(int32_t *rp, const void *cp, int32_t *wp0,
 				      int32_t *fir_start, int32_t *fir_end,
 				      int fir_delay_length,
-				      const int taps_x_nch, const int shift,
-				      const int nch)
+				      const int taps, const int taps_x_nch,
+				      const int shift, const int nch)
 {
+	int64_t y[PLATFORM_MAX_CHANNELS];
 	int64_t y0;
 	int64_t y1;
+	int64_t c;
 	int32_t *data;
 	const int32_t *coef;
 	int i;
@@ -184,40 +195,47 @@ static inline void fir_filter_generic(int32_t *rp, const void *cp, int32_t *wp0,
 		return;
 	}
 
-	for (j = 0; j < nch; j++) {
-		/* Decrement data pointer to next channel start. Note that
-		 * initialization code ensures that circular wrap does not
-		 * happen mid-frame.
-		 */
-		data = d--;
+	/* All channels of a frame are filtered with the same coefficient
+	 * that is loaded once. The frames until the circular wrap and the
+	 * frames after it are filtered in two linear passes. Note that
+	 * initialization code ensures that circular wrap does not happen
+	 * mid-frame.
+	 */
+	for (j = 0; j < nch; j++)
+		y[j] = rnd; /* Half LSB for rounding */
+
+	coef = (const int32_t *)cp;
+	data = d;
+	frames = (fir_end - data + nch - 1) / nch; /* Frames until wrap */
+	n1 = (taps < frames) ? taps : frames;
+	n2 = taps - n1;
+
+	/* The FIR is calculated as Q1.23 x Q1.31 -> Q2.54. The
+	 * output shift includes the shift by 23 for Qx.54 to
+	 * Qx.31. Channel j sample is at offset -j from the frame.
+	 */
+	for (i = 0; i < n1; i++) {
+		c = *coef >> 8;
+		for (j = 0; j < nch; j++)
+			y[j] += c * data[-j];
+
+		coef++;
+		data += nch;
+	}
+	if (data >= fir_end)
+		data -= fir_delay_length;
 
-		/* Initialize to half LSB for rounding, prepare for FIR core */
-		y0 = rnd;
-		coef = (const int32_t *)cp;
-		frames = fir_end - data + nch - j - 1; /* Frames until wrap */
-		n1 = (taps_x_nch < frames) ? taps_x_nch : frames;
-		n2 = taps_x_nch - n1;
+	for (i = 0; i < n2; i++) {
+		c = *coef >> 8;
+		for (j = 0; j < nch; j++)
+			y[j] += c * data[-j];
 
-		/* The FIR is calculated as Q1.23 x Q1.31 -> Q2.54. The
-		 * output shift includes the shift by 23 for Qx.54 to
-		 * Qx.31.
-		 */
-		for (i = 0; i < n1; i += nch) {
-			y0 += (int64_t)(*coef >> 8) * (*data);
-			coef++;
-			data += nch;
-		}
-		if (data >= fir_end)
-			data -= fir_delay_length;
-
-		for (i = 0; i < n2; i += nch) {
-			y0 += (int64_t)(*coef >> 8) * (*data);
-			coef++;
-			data += nch;
-		}
-		*wp = sat_int32(y0 >> qshift);
-		wp++;
+		coef++;
+		data += nch;
 	}
+
+	for (j = 0; j < nch; j++)
+		wp[j] = sat_int32(y[j] >> qshift);
 }
 
 #endif /* 32bit coefficients version */
@@ -291,7 +309,8 @@ void src_polyphase_stage_cir(struct src_stage_prm *s)
 		for (i = 0; i < cfg->num_of_subfilters; i++) {
 			fir_filter_generic(rp, cp, wp,
 					   fir_delay, fir_end, fir_length,
-					   taps_x_nch, cfg->shift, nch);
+					   cfg->subfilter_length, taps_x_nch,
+					   cfg->shift, nch);
 			wp += nch_x_odm;
 			cp = (char *)cp + subfilter_size;
 			src_inc_wrap(&wp, out_delay_end, out_size);
@@ -392,7 +411,8 @@ void src_polyphase_stage_cir_s16(struct src_stage_prm *s)
 		for (i = 0; i < cfg->num_of_subfilters; i++) {
 			fir_filter_generic(rp, cp, wp,
 					   fir_delay, fir_end, fir_length,
-					   taps_x_nch, cfg->shift, nch);
+					   cfg->subfilter_length, taps_x_nch,
+					   cfg->shift, nch);
 			wp += nch_x_odm;
 			cp = (char *)cp + subfilter_size;
 			src_inc_wrap(&wp, out_delay_end, out_size);
@@ -25,6 +25,7 @@
 #include <sof/math/fir_generic.h>
 #include <sof/math/fir_hifi2ep.h>
 #include <sof/math/fir_hifi3.h>
+#include <sof/math/numbers.h>
 #include <sof/trace/trace.h>
 #include <sof/ut.h>
 #include <errno.h>
@@ -47,25 +48,42 @@ DECLARE_TR_CTX(tdfb_tr, SOF_UUID(tdfb_uuid), LOG_LEVEL_INFO);
 #if CONFIG_FORMAT_S16LE
 static inline void set_s16_fir(struct tdfb_comp_data *cd)
 {
+#if CONFIG_COMP_TDFB_FREQ
+	if (cd->freq) {
+		cd->tdfb_func = tdfb_freq_s16;
+		return;
+	}
+#endif
 	cd->tdfb_func = tdfb_fir_s16;
 }
 #endif /* CONFIG_FORMAT_S16LE */
 #if CONFIG_FORMAT_S24LE
 static inline void set_s24_fir(struct tdfb_comp_data *cd)
 {
+#if CONFIG_COMP_TDFB_FREQ
+	if (cd->freq) {
+		cd->tdfb_func = tdfb_freq_s24;
+		return;
+	}
+#endif
 	cd->tdfb_func = tdfb_fir_s24;
 }
 #endif /* CONFIG_FORMAT_S24LE */
 #if CONFIG_FORMAT_S32LE
 static inline void set_s32_fir(struct tdfb_comp_data *cd)
 {
+#if CONFIG_COMP_TDFB_FREQ
+	if (cd->freq) {
+		cd->tdfb_func = tdfb_freq_s32;
+		return;
+	}
+#endif
 	cd->tdfb_func = tdfb_fir_s32;
 }
 #endif /* CONFIG_FORMAT_S32LE */
 
-static inline int set_func(struct comp_dev *dev)
+static inline int set_func(struct comp_dev *dev, struct tdfb_comp_data *cd)
 {
-	struct tdfb_comp_data *cd = comp_get_drvdata(dev);
 	struct comp_buffer *sourceb;
 
 	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
@@ -112,41 +130,94 @@ static void tdfb_free_delaylines(struct tdfb_comp_data *cd)
 	rfree(cd->fir_delay);
 	cd->fir_delay = NULL;
 	cd->fir_delay_size = 0;
-	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
+	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++) {
 		fir[i].delay = NULL;
+#if TDFB_GENERIC
+		cd->delay[i] = NULL;
+#endif
+	}
+
+#if CONFIG_COMP_TDFB_FREQ
+	tdfb_freq_free(cd);
+#endif
 }
 
-static int tdfb_init_coef(struct tdfb_comp_data *cd, int source_nch,
-			  int sink_nch)
+static int tdfb_check_config(struct tdfb_comp_data *cd, size_t size,
+			     int sink_nch)
 {
-	struct sof_fir_coef_data *coef_data;
 	struct sof_tdfb_config *config = cd->config;
-	int16_t *coefp;
-	int size_sum = 0;
-	int max_ch;
-	int s;
-	int i;
 
-	/* Sanity checks */
+	/* Sanity checks, the coefficients parsing is bound by config->size */
+	if (config->size < sizeof(*config) || config->size > size) {
+		comp_cl_err(&comp_tdfb, "tdfb_check_config(), invalid size %u for blob of %u bytes",
+			    config->size, size);
+		return -EINVAL;
+	}
+
 	if (config->num_output_channels > PLATFORM_MAX_CHANNELS ||
 	    !config->num_output_channels) {
-		comp_cl_err(&comp_tdfb, "tdfb_init_coef(), invalid num_output_channels %d",
+		comp_cl_err(&comp_tdfb, "tdfb_check_config(), invalid num_output_channels %d",
 			    config->num_output_channels);
 		return -EINVAL;
 	}
 
 	if (config->num_output_channels != sink_nch) {
-		comp_cl_err(&comp_tdfb, "tdfb_init_coef(), stream output channels count %d does not match configuration %d",
+		comp_cl_err(&comp_tdfb, "tdfb_check_config(), stream output channels count %d does not match configuration %d",
 			    sink_nch, config->num_output_channels);
 		return -EINVAL;
 	}
 
 	if (config->num_filters > SOF_TDFB_FIR_MAX_COUNT) {
-		comp_cl_err(&comp_tdfb, "tdfb_init_coef(), invalid num_filters %d",
+		comp_cl_err(&comp_tdfb, "tdfb_check_config(), invalid num_filters %d",
 			    config->num_filters);
 		return -EINVAL;
 	}
 
+	switch (config->mode) {
+	case SOF_TDFB_MODE_TIME:
+#if CONFIG_COMP_TDFB_FREQ
+	case SOF_TDFB_MODE_FREQ:
+#endif
+		break;
+	default:
+		comp_cl_err(&comp_tdfb, "tdfb_check_config(), unsupported mode %d",
+			    config->mode);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* Convert the output mix bit masks to output channel lists */
+static void tdfb_init_mix(struct tdfb_comp_data *cd)
+{
+	struct sof_tdfb_config *config = cd->config;
+	int om;
+	int ch;
+	int i;
+
+	for (i = 0; i < config->num_filters; i++) {
+		om = cd->output_channel_mix[i];
+		cd->mix_count[i] = 0;
+		for (ch = 0; ch < config->num_output_channels; ch++) {
+			if (om & 1)
+				cd->mix_idx[i][cd->mix_count[i]++] = ch;
+
+			om = om >> 1;
+		}
+	}
+}
+
+static int tdfb_init_coef(struct tdfb_comp_data *cd, int source_nch)
+{
+	struct sof_fir_coef_data *coef_data;
+	struct sof_tdfb_config *config = cd->config;
+	int16_t *coefp;
+	int size_sum = 0;
+	int max_ch;
+	int s;
+	int i;
+
 	coefp = ASSUME_ALIGNED(&config->data[0], 2);
 	for (i = 0; i < config->num_filters; i++) {
 		/* Get delay line size */
@@ -193,6 +264,10 @@ static int tdfb_init_coef(struct tdfb_comp_data *cd, int source_nch,
 
 static void tdfb_init_delay(struct tdfb_comp_data *cd)
 {
+#if TDFB_GENERIC
+	/* The filters of an input channel share its delay line */
+	tdfb_shared_delay_init(cd);
+#else
 	int32_t *fir_delay = cd->fir_delay;
 	int i;
 
@@ -201,20 +276,50 @@ static void tdfb_init_delay(struct tdfb_comp_data *cd)
 		if (cd->fir[i].length > 0)
 			fir_init_delay(&cd->fir[i], &fir_delay);
 	}
+#endif
 }
 
-static int tdfb_setup(struct tdfb_comp_data *cd, int source_nch, int sink_nch)
+static int tdfb_setup(struct tdfb_comp_data *cd, size_t size, int source_nch,
+		      int sink_nch)
 {
 	int delay_size;
+	int ret;
 
 	/* Free existing FIR channels data if it was allocated */
 	tdfb_free_delaylines(cd);
 
+	ret = tdfb_check_config(cd, size, sink_nch);
+	if (ret < 0)
+		return ret;
+
+#if CONFIG_COMP_TDFB_FREQ
+	if (cd->config->mode == SOF_TDFB_MODE_FREQ) {
+		ret = tdfb_freq_setup(cd, source_nch);
+		if (ret < 0) {
+			comp_cl_err(&comp_tdfb, "tdfb_setup(), frequency mode setup failed %d",
+				    ret);
+			return ret;
+		}
+
+		tdfb_init_mix(cd);
+		return 0;
+	}
+#endif
+
 	/* Set coefficients for each channel from coefficient blob */
-	delay_size = tdfb_init_coef(cd, source_nch, sink_nch);
+	delay_size = tdfb_init_coef(cd, source_nch);
 	if (delay_size < 0)
 		return delay_size; /* Contains error code */
 
+	tdfb_init_mix(cd);
+
+#if TDFB_GENERIC
+	/* One delay line per used input channel instead of per filter */
+	delay_size = tdfb_shared_delay_size(cd);
+	if (delay_size < 0)
+		return delay_size;
+#endif
+
 	/* If all channels were set to bypass there's no need to
 	 * allocate delay. Just return with success.
 	 */
@@ -237,6 +342,89 @@ static int tdfb_setup(struct tdfb_comp_data *cd, int source_nch, int sink_nch)
 	return 0;
 }
 
+/* Builds the filters for a blob received while streaming in the IPC
+ * context, so that copy() only needs to swap to them.
+ */
+static int tdfb_blob_prepare(struct comp_dev *dev, void *data, size_t size,
+			     void **prepared)
+{
+	struct tdfb_comp_data *cd = comp_get_drvdata(dev);
+	struct tdfb_comp_data *new_cd;
+	struct comp_buffer *sourceb;
+	struct comp_buffer *sinkb;
+	int ret;
+
+	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
+				  sink_list);
+	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
+				source_list);
+
+	new_cd = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+			 sizeof(*new_cd));
+	if (!new_cd)
+		return -ENOMEM;
+
+	new_cd->model_handler = cd->model_handler;
+	new_cd->config = data;
+	ret = tdfb_setup(new_cd, size, sourceb->stream.channels,
+			 sinkb->stream.channels);
+	if (ret < 0) {
+		comp_err(dev, "tdfb_blob_prepare(), failed FIR setup");
+		goto err;
+	}
+
+	/* The new configuration can change the processing mode */
+	ret = set_func(dev, new_cd);
+	if (ret < 0)
+		goto err;
+
+	*prepared = new_cd;
+	return 0;
+
+err:
+	tdfb_free_delaylines(new_cd);
+	rfree(new_cd);
+	return ret;
+}
+
+/* The state is swapped in place in small chunks, it's too large for the
+ * stack and nothing can be allocated in copy().
+ */
+static void tdfb_blob_swap(struct comp_dev *dev, void *prepared)
+{
+	uint8_t *a = comp_get_drvdata(dev);
+	uint8_t *b = prepared;
+	uint8_t tmp[64];
+	size_t left = sizeof(struct tdfb_comp_data);
+	size_t n;
+	int ret;
+
+	while (left) {
+		n = MIN(left, sizeof(tmp));
+		ret = memcpy_s(tmp, sizeof(tmp), a, n);
+		assert(!ret);
+		ret = memcpy_s(a, n, b, n);
+		assert(!ret);
+		ret = memcpy_s(b, n, tmp, n);
+		assert(!ret);
+		a += n;
+		b += n;
+		left -= n;
+	}
+}
+
+static void tdfb_blob_free(struct comp_dev *dev, void *prepared)
+{
+	tdfb_free_delaylines(prepared);
+	rfree(prepared);
+}
+
+static const struct comp_data_blob_ops tdfb_blob_ops = {
+	.prepare = tdfb_blob_prepare,
+	.swap = tdfb_blob_swap,
+	.free = tdfb_blob_free,
+};
+
 /*
  * End of algorithm code. Next the standard component methods.
  */
@@ -299,6 +487,8 @@ static struct comp_dev *tdfb_new(const struct comp_driver *drv,
 		return NULL;
 	}
 
+	comp_data_blob_set_ops(cd->model_handler, &tdfb_blob_ops);
+
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
 		fir_reset(&cd->fir[i]);
 
@@ -406,7 +596,6 @@ static int tdfb_copy(struct comp_dev *dev)
 	struct comp_buffer *sourceb;
 	struct comp_buffer *sinkb;
 	struct tdfb_comp_data *cd = comp_get_drvdata(dev);
-	int ret;
 	int n;
 
 	comp_dbg(dev, "tdfb_copy()");
@@ -416,15 +605,9 @@ static int tdfb_copy(struct comp_dev *dev)
 	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
 				source_list);
 
-	/* Check for changed configuration */
-	if (comp_is_new_data_blob_available(cd->model_handler)) {
+	/* Switch to the filters prepared for a changed configuration */
+	if (comp_is_new_data_blob_available(cd->model_handler))
 		cd->config = comp_get_data_blob(cd->model_handler, NULL, NULL);
-		ret = tdfb_setup(cd, sourceb->stream.channels, sinkb->stream.channels);
-		if (ret < 0) {
-			comp_err(dev, "tdfb_copy(), failed FIR setup");
-			return ret;
-		}
-	}
 
 	/* Get source, sink, number of frames etc. to process. */
 	comp_get_copy_limits(sourceb, sinkb, &cl);
@@ -451,6 +634,7 @@ static int tdfb_prepare(struct comp_dev *dev)
 	struct tdfb_comp_data *cd = comp_get_drvdata(dev);
 	struct comp_buffer *sourceb;
 	struct comp_buffer *sinkb;
+	size_t size;
 	int ret;
 
 	comp_info(dev, "tdfb_prepare()");
@@ -469,9 +653,10 @@ static int tdfb_prepare(struct comp_dev *dev)
 				struct comp_buffer, source_list);
 
 	/* Initialize filter */
-	cd->config = comp_get_data_blob(cd->model_handler, NULL, NULL);
+	cd->config = comp_get_data_blob(cd->model_handler, &size, NULL);
 	if (cd->config) {
-		ret = tdfb_setup(cd, sourceb->stream.channels, sinkb->stream.channels);
+		ret = tdfb_setup(cd, size, sourceb->stream.channels,
+				 sinkb->stream.channels);
 		if (ret < 0) {
 			comp_err(dev, "tdfb_prepare() error: tdfb_setup failed.");
 			goto err;
@@ -481,7 +666,7 @@ static int tdfb_prepare(struct comp_dev *dev)
 		memset(cd->in, 0, TDFB_IN_BUF_LENGTH * sizeof(int32_t));
 		memset(cd->out, 0, TDFB_IN_BUF_LENGTH * sizeof(int32_t));
 
-		ret = set_func(dev);
+		ret = set_func(dev, cd);
 		return ret;
 	}
 
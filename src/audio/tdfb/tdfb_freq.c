@@ -0,0 +1,366 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/*
+ * Frequency domain filter and sum for TDFB. Every input channel used by the
+ * filters is transformed once per hop of fft_size / 2 frames with the last
+ * fft_size frames as the window. Each filter multiplies the spectrum of its
+ * input channel with its complex weights and the products are summed to the
+ * spectra of the output channels. The inverse transforms of the output
+ * spectra give with overlap-save the last fft_size / 2 frames as output.
+ * The processing adds a latency of one hop.
+ */
+
+#include <ipc/topology.h>
+#include <sof/audio/format.h>
+#include <sof/audio/tdfb/tdfb_comp.h>
+#include <sof/lib/alloc.h>
+#include <sof/lib/memory.h>
+#include <sof/math/fft.h>
+#include <sof/platform.h>
+#include <sof/string.h>
+#include <user/tdfb.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+static int tdfb_freq_size_log2(int fft_size)
+{
+	int len_log2 = 0;
+
+	while ((1 << len_log2) < fft_size)
+		len_log2++;
+
+	return (1 << len_log2) == fft_size ? len_log2 : -EINVAL;
+}
+
+static int tdfb_freq_init_coef(struct tdfb_comp_data *cd,
+			       struct tdfb_freq_data *fd, int source_nch)
+{
+	struct sof_tdfb_config *config = cd->config;
+	struct sof_tdfb_freq_coef_data *coef_data;
+	int16_t *coefp;
+	int16_t *end;
+	int ch;
+	int i;
+
+	/* The blob size is checked against config->size by tdfb_setup() */
+	coefp = ASSUME_ALIGNED(&config->data[0], 2);
+	end = (int16_t *)((uint8_t *)config + config->size);
+	for (i = 0; i < config->num_filters; i++) {
+		if (end - coefp < SOF_TDFB_FREQ_COEF_NHEADER)
+			return -EINVAL;
+
+		coef_data = (struct sof_tdfb_freq_coef_data *)coefp;
+		if (!i) {
+			fd->fft_size = coef_data->fft_size;
+			if (fd->fft_size > SOF_TDFB_FFT_MAX_SIZE ||
+			    tdfb_freq_size_log2(fd->fft_size) <
+			    FFT_MIN_LEN_LOG2)
+				return -EINVAL;
+		}
+
+		if (coef_data->fft_size != fd->fft_size)
+			return -EINVAL;
+
+		/* header and the weights of bins 0 .. fft_size / 2 */
+		if (end - coefp < SOF_TDFB_FREQ_COEF_NHEADER + fd->fft_size + 2)
+			return -EINVAL;
+
+		fd->weights[i] = ASSUME_ALIGNED(&coef_data->coef[0], 4);
+		fd->out_shift[i] = coef_data->out_shift;
+		coefp += SOF_TDFB_FREQ_COEF_NHEADER + fd->fft_size + 2;
+	}
+
+	/* Get shortcuts to input and output configuration */
+	if (end - coefp < 3 * config->num_filters)
+		return -EINVAL;
+
+	cd->input_channel_select = coefp;
+	cd->output_channel_mix = coefp + config->num_filters;
+	cd->output_stream_mix = coefp + 2 * config->num_filters;
+
+	for (i = 0; i < config->num_filters; i++) {
+		ch = cd->input_channel_select[i];
+		if (ch < 0 || ch >= source_nch || ch >= PLATFORM_MAX_CHANNELS)
+			return -EINVAL;
+	}
+
+	return 0;
+}
+
+int tdfb_freq_setup(struct tdfb_comp_data *cd, int source_nch)
+{
+	struct sof_tdfb_config *config = cd->config;
+	struct tdfb_freq_data *fd;
+	bool used[PLATFORM_MAX_CHANNELS] = { false };
+	size_t size;
+	int num_in = 0;
+	int out_nch = config->num_output_channels;
+	int32_t *data;
+	int ret;
+	int ch;
+	int i;
+	int n;
+
+	if (!config->num_filters)
+		return -EINVAL;
+
+	fd = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM, sizeof(*fd));
+	if (!fd)
+		return -ENOMEM;
+
+	cd->freq = fd;
+	ret = tdfb_freq_init_coef(cd, fd, source_nch);
+	if (ret < 0)
+		goto err;
+
+	for (i = 0; i < config->num_filters; i++)
+		used[cd->input_channel_select[i]] = true;
+
+	for (ch = 0; ch < PLATFORM_MAX_CHANNELS; ch++)
+		num_in += used[ch];
+
+	/* Twiddle factors, input spectrum, output spectra, input windows
+	 * and output hop in a single chunk.
+	 */
+	n = fd->fft_size;
+	fd->hop = n >> 1;
+	size = (n / 2 + n + out_nch * n) * sizeof(struct icomplex32) +
+		(num_in * n + out_nch * fd->hop) * sizeof(int32_t);
+	fd->buffers = rballoc(0, SOF_MEM_CAPS_RAM, size);
+	if (!fd->buffers) {
+		ret = -ENOMEM;
+		goto err;
+	}
+
+	memset(fd->buffers, 0, size);
+	fft_plan_init(&fd->plan, fd->buffers, tdfb_freq_size_log2(n));
+	fd->spec = fd->plan.twiddle + n / 2;
+	for (ch = 0; ch < out_nch; ch++)
+		fd->mix[ch] = fd->spec + n * (ch + 1);
+
+	data = (int32_t *)(fd->spec + n * (out_nch + 1));
+	for (ch = 0; ch < PLATFORM_MAX_CHANNELS; ch++) {
+		if (!used[ch])
+			continue;
+
+		fd->in[ch] = data;
+		data += n;
+	}
+
+	fd->out = data;
+	fd->fill = 0;
+	return 0;
+
+err:
+	tdfb_freq_free(cd);
+	return ret;
+}
+
+void tdfb_freq_free(struct tdfb_comp_data *cd)
+{
+	if (!cd->freq)
+		return;
+
+	rfree(cd->freq->buffers);
+	rfree(cd->freq);
+	cd->freq = NULL;
+}
+
+/* Transform the input windows, apply the weights and produce next hop */
+static void tdfb_freq_block(struct tdfb_comp_data *cd, int out_nch)
+{
+	struct sof_tdfb_config *config = cd->config;
+	struct tdfb_freq_data *fd = cd->freq;
+	struct icomplex32 *spec = fd->spec;
+	struct icomplex32 *y;
+	int16_t *w;
+	int32_t *x;
+	int32_t yr;
+	int32_t yi;
+	int shift;
+	int half = fd->fft_size >> 1;
+	int ch;
+	int i;
+	int k;
+	int m;
+
+	for (ch = 0; ch < out_nch; ch++)
+		memset(fd->mix[ch], 0, (half + 1) * sizeof(struct icomplex32));
+
+	for (ch = 0; ch < PLATFORM_MAX_CHANNELS; ch++) {
+		x = fd->in[ch];
+		if (!x)
+			continue;
+
+		for (k = 0; k < fd->fft_size; k++) {
+			spec[k].real = x[k];
+			spec[k].imag = 0;
+		}
+
+		fft_execute_32(&fd->plan, spec, false);
+
+		/* Q1.31 x Q1.15 -> Q5.27 to fit max. 16 filters sum */
+		for (i = 0; i < config->num_filters; i++) {
+			if (cd->input_channel_select[i] != ch)
+				continue;
+
+			w = fd->weights[i];
+			shift = 15 + fd->out_shift[i] + 4;
+			for (k = 0; k <= half; k++) {
+				yr = ((int64_t)w[2 * k] * spec[k].real -
+				      (int64_t)w[2 * k + 1] * spec[k].imag) >>
+					shift;
+				yi = ((int64_t)w[2 * k] * spec[k].imag +
+				      (int64_t)w[2 * k + 1] * spec[k].real) >>
+					shift;
+				for (m = 0; m < cd->mix_count[i]; m++) {
+					y = &fd->mix[cd->mix_idx[i][m]][k];
+					y->real += yr;
+					y->imag += yi;
+				}
+			}
+		}
+
+		/* Slide the window by a hop */
+		for (k = 0; k < fd->fft_size - fd->hop; k++)
+			x[k] = x[k + fd->hop];
+	}
+
+	for (ch = 0; ch < out_nch; ch++) {
+		/* Spectrum of real output is conjugate symmetric */
+		y = fd->mix[ch];
+		for (k = 1; k < half; k++) {
+			y[fd->fft_size - k].real = y[k].real;
+			y[fd->fft_size - k].imag = -y[k].imag;
+		}
+
+		fft_execute_32(&fd->plan, y, true);
+
+		/* Overlap-save, the last hop of the inverse is valid */
+		for (k = 0; k < fd->hop; k++)
+			fd->out[k * out_nch + ch] =
+				y[fd->fft_size - fd->hop + k].real;
+	}
+}
+
+/* Store input sample of a channel to its window if it's used */
+static inline void tdfb_freq_write(struct tdfb_freq_data *fd, int ch,
+				   int32_t x)
+{
+	if (ch < PLATFORM_MAX_CHANNELS && fd->in[ch])
+		fd->in[ch][fd->fft_size - fd->hop + fd->fill] = x;
+}
+
+/* Output of current frame is read before advancing to next frame */
+static inline void tdfb_freq_advance(struct tdfb_comp_data *cd, int out_nch)
+{
+	struct tdfb_freq_data *fd = cd->freq;
+
+	if (++fd->fill == fd->hop) {
+		tdfb_freq_block(cd, out_nch);
+		fd->fill = 0;
+	}
+}
+
+#if CONFIG_FORMAT_S16LE
+void tdfb_freq_s16(struct tdfb_comp_data *cd,
+		   const struct audio_stream *source,
+		   struct audio_stream *sink, int frames)
+{
+	int16_t *x;
+	int16_t *y;
+	int32_t *out;
+	int ch;
+	int j;
+	int in_nch = source->channels;
+	int out_nch = sink->channels;
+	int idx_in = 0;
+	int idx_out = 0;
+
+	for (j = 0; j < frames; j++) {
+		for (ch = 0; ch < in_nch; ch++) {
+			x = audio_stream_read_frag_s16(source, idx_in++);
+			tdfb_freq_write(cd->freq, ch, *x << 16);
+		}
+
+		out = &cd->freq->out[cd->freq->fill * out_nch];
+		for (ch = 0; ch < out_nch; ch++) {
+			y = audio_stream_write_frag_s16(sink, idx_out++);
+			*y = sat_int16(Q_SHIFT_RND(out[ch], 27, 15));
+		}
+
+		tdfb_freq_advance(cd, out_nch);
+	}
+}
+#endif
+
+#if CONFIG_FORMAT_S24LE
+void tdfb_freq_s24(struct tdfb_comp_data *cd,
+		   const struct audio_stream *source,
+		   struct audio_stream *sink, int frames)
+{
+	int32_t *x;
+	int32_t *y;
+	int32_t *out;
+	int ch;
+	int j;
+	int in_nch = source->channels;
+	int out_nch = sink->channels;
+	int idx_in = 0;
+	int idx_out = 0;
+
+	for (j = 0; j < frames; j++) {
+		for (ch = 0; ch < in_nch; ch++) {
+			x = audio_stream_read_frag_s32(source, idx_in++);
+			tdfb_freq_write(cd->freq, ch, *x << 8);
+		}
+
+		out = &cd->freq->out[cd->freq->fill * out_nch];
+		for (ch = 0; ch < out_nch; ch++) {
+			y = audio_stream_write_frag_s32(sink, idx_out++);
+			*y = sat_int24(Q_SHIFT_RND(out[ch], 27, 23));
+		}
+
+		tdfb_freq_advance(cd, out_nch);
+	}
+}
+#endif
+
+#if CONFIG_FORMAT_S32LE
+void tdfb_freq_s32(struct tdfb_comp_data *cd,
+		   const struct audio_stream *source,
+		   struct audio_stream *sink, int frames)
+{
+	int32_t *x;
+	int32_t *y;
+	int32_t *out;
+	int ch;
+	int j;
+	int in_nch = source->channels;
+	int out_nch = sink->channels;
+	int idx_in = 0;
+	int idx_out = 0;
+
+	for (j = 0; j < frames; j++) {
+		for (ch = 0; ch < in_nch; ch++) {
+			x = audio_stream_read_frag_s32(source, idx_in++);
+			tdfb_freq_write(cd->freq, ch, *x);
+		}
+
+		/* In Q5.27 to Q1.31 conversion rounding is not applicable
+		 * so just shift left by 4.
+		 */
+		out = &cd->freq->out[cd->freq->fill * out_nch];
+		for (ch = 0; ch < out_nch; ch++) {
+			y = audio_stream_write_frag_s32(sink, idx_out++);
+			*y = sat_int32((int64_t)out[ch] << 4);
+		}
+
+		tdfb_freq_advance(cd, out_nch);
+	}
+}
+#endif
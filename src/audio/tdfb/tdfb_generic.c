@@ -14,64 +14,165 @@
 
 #include <sof/math/fir_generic.h>
 
+#include <sof/math/numbers.h>
+#include <errno.h>
+#include <stdint.h>
+
+/*
+ * All filters reading the same input channel share one delay line. A line
+ * holds the history needed by the longest filter of the channel followed by
+ * a block of new input samples, so the filters are computed over the block
+ * without circular wrap handling.
+ */
+
+int tdfb_shared_delay_size(struct tdfb_comp_data *cd)
+{
+	struct sof_tdfb_config *cfg = cd->config;
+	int size = 0;
+	int ch;
+	int i;
+
+	for (ch = 0; ch < PLATFORM_MAX_CHANNELS; ch++) {
+		cd->delay[ch] = NULL;
+		cd->delay_history[ch] = -1;
+	}
+
+	for (i = 0; i < cfg->num_filters; i++) {
+		ch = cd->input_channel_select[i];
+		if (ch < 0 || ch >= PLATFORM_MAX_CHANNELS)
+			return -EINVAL;
+
+		cd->delay_history[ch] = MAX(cd->delay_history[ch],
+					    cd->fir[i].length - 1);
+	}
+
+	for (ch = 0; ch < PLATFORM_MAX_CHANNELS; ch++) {
+		if (cd->delay_history[ch] >= 0)
+			size += cd->delay_history[ch] + TDFB_BLOCK_FRAMES;
+	}
+
+	return size * sizeof(int32_t);
+}
+
+void tdfb_shared_delay_init(struct tdfb_comp_data *cd)
+{
+	int32_t *data = cd->fir_delay;
+	int ch;
+
+	for (ch = 0; ch < PLATFORM_MAX_CHANNELS; ch++) {
+		if (cd->delay_history[ch] < 0)
+			continue;
+
+		cd->delay[ch] = data;
+		data += cd->delay_history[ch] + TDFB_BLOCK_FRAMES;
+	}
+}
+
+/* Run all filters for the block in delay lines and mix to out_block */
+static void tdfb_filter_block(struct tdfb_comp_data *cd, int out_nch,
+			      int frames)
+{
+	struct sof_tdfb_config *cfg = cd->config;
+	struct fir_state_32x16 *filter;
+	int64_t y0;
+	int64_t y1;
+	int32_t *data;
+	int32_t *out;
+	int16_t *coef;
+	int32_t z0;
+	int32_t z1;
+	int shift;
+	int ch;
+	int i;
+	int j;
+	int k;
+	int n;
+
+	memset(cd->out_block, 0, frames * out_nch * sizeof(int32_t));
+
+	for (i = 0; i < cfg->num_filters; i++) {
+		filter = &cd->fir[i];
+		ch = cd->input_channel_select[i];
+		data = cd->delay[ch] + cd->delay_history[ch];
+		shift = 15 + filter->out_shift;
+		for (j = 0; j < frames; j += 2) {
+			/* Compute two successive outputs with the same
+			 * coefficient loads. Data is Q1.31, coef is Q1.15,
+			 * product is Q2.46.
+			 */
+			y0 = 0;
+			y1 = 0;
+			coef = filter->coef;
+			for (n = 0; n < filter->length; n++) {
+				y0 += (int64_t)coef[n] * data[j - n];
+				y1 += (int64_t)coef[n] * data[j + 1 - n];
+			}
+
+			/* Q2.46 -> Q1.31 as in fir_32x16(), then to Q5.27 to
+			 * fit max. 16 filters sum to a channel.
+			 */
+			z0 = sat_int32(y0 >> shift) >> 4;
+			z1 = sat_int32(y1 >> shift) >> 4;
+			out = &cd->out_block[j * out_nch];
+			for (k = 0; k < cd->mix_count[i]; k++) {
+				out[cd->mix_idx[i][k]] += z0;
+				out[cd->mix_idx[i][k] + out_nch] += z1;
+			}
+		}
+	}
+
+	/* Keep the history of the block for the next one */
+	for (ch = 0; ch < PLATFORM_MAX_CHANNELS; ch++) {
+		data = cd->delay[ch];
+		if (!data)
+			continue;
+
+		for (n = 0; n < cd->delay_history[ch]; n++)
+			data[n] = data[n + frames];
+	}
+}
+
+/* Store input sample of a channel to its delay line if it's used */
+static inline void tdfb_delay_write(struct tdfb_comp_data *cd, int ch,
+				    int frame, int32_t x)
+{
+	if (ch < PLATFORM_MAX_CHANNELS && cd->delay[ch])
+		cd->delay[ch][cd->delay_history[ch] + frame] = x;
+}
+
 #if CONFIG_FORMAT_S16LE
 void tdfb_fir_s16(struct tdfb_comp_data *cd,
 		  const struct audio_stream *source,
 		  struct audio_stream *sink, int frames)
 {
-	struct sof_tdfb_config *cfg = cd->config;
-	struct fir_state_32x16 *filter;
-	int32_t y0;
-	int32_t y1;
 	int16_t *x;
 	int16_t *y;
-	int is2;
-	int is;
-	int om;
+	int ch;
 	int i;
 	int j;
-	int k;
+	int n;
 	int in_nch = source->channels;
 	int out_nch = sink->channels;
 	int idx_in = 0;
 	int idx_out = 0;
 
-	for (j = 0; j < (frames >> 1); j++) {
-		/* Clear output mix*/
-		memset(cd->out, 0,  2 * out_nch * sizeof(int32_t));
-
-		/* Read two frames from all input channels */
-		for (i = 0; i < 2 * in_nch; i++) {
-			x = audio_stream_read_frag_s16(source, idx_in++);
-			cd->in[i] = *x << 16;
-		}
+	for (; frames > 0; frames -= n) {
+		n = MIN(frames, TDFB_BLOCK_FRAMES);
 
-		/* Run and mix all filters to their output channel */
-		for (i = 0; i < cfg->num_filters; i++) {
-			is = cd->input_channel_select[i];
-			is2 = is + in_nch;
-			om = cd->output_channel_mix[i];
-			filter = &cd->fir[i];
-			/* Process sample and successive sample. This follows
-			 * optimized FIR version implementation that processes
-			 * two samples per call. The output is stored as Q5.27
-			 * to fit max. 16 filters sum to a channel.
-			 */
-			y0 = fir_32x16(filter, cd->in[is]) >> 4;
-			y1 = fir_32x16(filter, cd->in[is2]) >> 4;
-			for (k = 0; k < out_nch; k++) {
-				if (om & 1) {
-					cd->out[k] += y0;
-					cd->out[k + out_nch] += y1;
-				}
-				om = om >> 1;
+		/* Read the block from all input channels */
+		for (j = 0; j < n; j++) {
+			for (ch = 0; ch < in_nch; ch++) {
+				x = audio_stream_read_frag_s16(source, idx_in++);
+				tdfb_delay_write(cd, ch, j, *x << 16);
 			}
 		}
 
-		/* Write two frames of output */
-		for (i = 0; i < 2 * out_nch; i++) {
+		tdfb_filter_block(cd, out_nch, n);
+
+		/* Write the block of output */
+		for (i = 0; i < n * out_nch; i++) {
 			y = audio_stream_write_frag_s16(sink, idx_out++);
-			*y = sat_int16(Q_SHIFT_RND(cd->out[i], 27, 15));
+			*y = sat_int16(Q_SHIFT_RND(cd->out_block[i], 27, 15));
 		}
 	}
 }
@@ -82,59 +183,34 @@ void tdfb_fir_s24(struct tdfb_comp_data *cd,
 		  const struct audio_stream *source,
 		  struct audio_stream *sink, int frames)
 {
-	struct sof_tdfb_config *cfg = cd->config;
-	struct fir_state_32x16 *filter;
-	int32_t y0;
-	int32_t y1;
 	int32_t *x;
 	int32_t *y;
-	int is2;
-	int is;
-	int om;
+	int ch;
 	int i;
 	int j;
-	int k;
+	int n;
 	int in_nch = source->channels;
 	int out_nch = sink->channels;
 	int idx_in = 0;
 	int idx_out = 0;
 
-	for (j = 0; j < (frames >> 1); j++) {
-		/* Clear output mix*/
-		memset(cd->out, 0,  2 * out_nch * sizeof(int32_t));
-
-		/* Read two frames from all input channels */
-		for (i = 0; i < 2 * in_nch; i++) {
-			x = audio_stream_read_frag_s32(source, idx_in++);
-			cd->in[i] = *x << 8;
-		}
+	for (; frames > 0; frames -= n) {
+		n = MIN(frames, TDFB_BLOCK_FRAMES);
 
-		/* Run and mix all filters to their output channel */
-		for (i = 0; i < cfg->num_filters; i++) {
-			is = cd->input_channel_select[i];
-			is2 = is + in_nch;
-			om = cd->output_channel_mix[i];
-			filter = &cd->fir[i];
-			/* Process sample and successive sample. This follows
-			 * optimized FIR version implementation that processes
-			 * two samples per call. The output is stored as Q5.27
-			 * to fit max. 16 filters sum to a channel.
-			 */
-			y0 = fir_32x16(filter, cd->in[is]) >> 4;
-			y1 = fir_32x16(filter, cd->in[is2]) >> 4;
-			for (k = 0; k < out_nch; k++) {
-				if (om & 1) {
-					cd->out[k] += y0;
-					cd->out[k + out_nch] += y1;
-				}
-				om = om >> 1;
+		/* Read the block from all input channels */
+		for (j = 0; j < n; j++) {
+			for (ch = 0; ch < in_nch; ch++) {
+				x = audio_stream_read_frag_s32(source, idx_in++);
+				tdfb_delay_write(cd, ch, j, *x << 8);
 			}
 		}
 
-		/* Write two frames of output */
-		for (i = 0; i < 2 * out_nch; i++) {
+		tdfb_filter_block(cd, out_nch, n);
+
+		/* Write the block of output */
+		for (i = 0; i < n * out_nch; i++) {
 			y = audio_stream_write_frag_s32(sink, idx_out++);
-			*y = sat_int24(Q_SHIFT_RND(cd->out[i], 27, 23));
+			*y = sat_int24(Q_SHIFT_RND(cd->out_block[i], 27, 23));
 		}
 	}
 }
@@ -145,61 +221,36 @@ void tdfb_fir_s32(struct tdfb_comp_data *cd,
 		  const struct audio_stream *source,
 		  struct audio_stream *sink, int frames)
 {
-	struct sof_tdfb_config *cfg = cd->config;
-	struct fir_state_32x16 *filter;
-	int32_t y0;
-	int32_t y1;
 	int32_t *x;
 	int32_t *y;
-	int is2;
-	int is;
-	int om;
+	int ch;
 	int i;
 	int j;
-	int k;
+	int n;
 	int in_nch = source->channels;
 	int out_nch = sink->channels;
 	int idx_in = 0;
 	int idx_out = 0;
 
-	for (j = 0; j < (frames >> 1); j++) {
-		/* Clear output mix*/
-		memset(cd->out, 0,  2 * out_nch * sizeof(int32_t));
+	for (; frames > 0; frames -= n) {
+		n = MIN(frames, TDFB_BLOCK_FRAMES);
 
-		/* Read two frames from all input channels */
-		for (i = 0; i < 2 * in_nch; i++) {
-			x = audio_stream_read_frag_s32(source, idx_in++);
-			cd->in[i] = *x;
-		}
-
-		/* Run and mix all filters to their output channel */
-		for (i = 0; i < cfg->num_filters; i++) {
-			is = cd->input_channel_select[i];
-			is2 = is + in_nch;
-			om = cd->output_channel_mix[i];
-			filter = &cd->fir[i];
-			/* Process sample and successive sample. This follows
-			 * optimized FIR version implementation that processes
-			 * two samples per call. The output is stored as Q5.27
-			 * to fit max. 16 filters sum to a channel.
-			 */
-			y0 = fir_32x16(filter, cd->in[is]) >> 4;
-			y1 = fir_32x16(filter, cd->in[is2]) >> 4;
-			for (k = 0; k < out_nch; k++) {
-				if (om & 1) {
-					cd->out[k] += y0;
-					cd->out[k + out_nch] += y1;
-				}
-				om = om >> 1;
+		/* Read the block from all input channels */
+		for (j = 0; j < n; j++) {
+			for (ch = 0; ch < in_nch; ch++) {
+				x = audio_stream_read_frag_s32(source, idx_in++);
+				tdfb_delay_write(cd, ch, j, *x);
 			}
 		}
 
-		/* Write two frames of output. In Q5.27 to Q1.31 conversion
+		tdfb_filter_block(cd, out_nch, n);
+
+		/* Write the block of output. In Q5.27 to Q1.31 conversion
 		 * rounding is not applicable so just shift left by 4.
 		 */
-		for (i = 0; i < 2 * out_nch; i++) {
+		for (i = 0; i < n * out_nch; i++) {
 			y = audio_stream_write_frag_s32(sink, idx_out++);
-			*y = sat_int32((int64_t)cd->out[i] << 4);
+			*y = sat_int32((int64_t)cd->out_block[i] << 4);
 		}
 	}
 }
@@ -49,122 +49,268 @@ DECLARE_SOF_RT_UUID("pga", volume_uuid, 0xb77e677e, 0x5ff4, 0x4188,
 
 DECLARE_TR_CTX(volume_tr, SOF_UUID(volume_uuid), LOG_LEVEL_INFO);
 
+/* ln(2) in Q1.31 for the exponential ramp ratio */
+#define VOL_LN2_Q31	Q_CONVERT_FLOAT(0.6931471806, 31)
+
+/**
+ * \brief Sets up zero crossing search of channels with pending volume change.
+ * \param[in,out] cd Volume component private data.
+ * \param[in] channels Number of channels.
+ * \param[in] frames Number of frames.
+ * \return Number of channels waiting for zero crossing.
+ *
+ * Channels without a change take the current volume from the chunk start,
+ * the others keep the previous volume until the crossing.
+ */
+static uint32_t vol_zc_init(struct comp_data *cd, uint32_t channels,
+			    uint32_t frames)
+{
+	uint32_t pending = 0;
+	uint32_t channel;
+
+	for (channel = 0; channel < channels; channel++) {
+		if (cd->zc_volume[channel] == cd->volume[channel]) {
+			cd->zc_frames[channel] = 0;
+		} else {
+			cd->zc_frames[channel] = frames;
+			pending++;
+		}
+	}
+
+	/* samples are not followed without pending changes */
+	if (!pending)
+		cd->zc_sync = false;
+
+	return pending;
+}
+
+/**
+ * \brief Updates volume kept until zero crossing after a processed chunk.
+ * \param[in,out] cd Volume component private data.
+ * \param[in] frames Number of processed frames.
+ *
+ * Channels that crossed zero continue with the current volume. The others
+ * keep waiting for the crossing in the next chunks, up to zc_max_wait frames.
+ */
+UT_STATIC void vol_zc_update(struct comp_data *cd, uint32_t frames)
+{
+	int i;
+
+	for (i = 0; i < cd->channels; i++) {
+		if (cd->zc_frames[i] < frames) {
+			cd->zc_volume[i] = cd->volume[i];
+			cd->zc_wait[i] = 0;
+			continue;
+		}
+
+		cd->zc_wait[i] += frames;
+		if (cd->zc_wait[i] >= cd->zc_max_wait) {
+			cd->zc_volume[i] = cd->volume[i];
+			cd->zc_wait[i] = 0;
+		}
+	}
+}
+
 #if CONFIG_FORMAT_S16LE
 /**
- * \brief Used to find nearest zero crossing frame for 16 bit format.
- * \param[in,out] source Source buffer.
+ * \brief Used to find first zero crossing of channels for 16 bit format.
+ * \param[in,out] cd Volume component private data.
+ * \param[in] source Source buffer.
  * \param[in] frames Number of frames.
- * \param[in,out] prev_sum Previous sum of channel samples.
+ *
+ * All channels of a frame are checked in one pass over the contiguous spans
+ * of the buffer. The sign of the last sample of each channel is kept for
+ * the next call, so a crossing right at the chunk start is found too.
  */
-static uint32_t vol_zc_get_s16(const struct audio_stream *source,
-			       uint32_t frames, int64_t *prev_sum)
+UT_STATIC void vol_zc_get_s16(struct comp_data *cd,
+			      const struct audio_stream *source,
+			      uint32_t frames)
 {
-	uint32_t buff_frag = frames * source->channels - 1;
-	uint32_t curr_frames = frames;
+	int16_t *x = source->r_ptr;
+	uint32_t channels = source->channels;
+	uint32_t pending;
+	uint32_t frame = 0;
 	uint32_t channel;
-	int16_t *src;
-	int32_t sum;
+	uint32_t n;
 	uint32_t i;
+	int32_t sample;
+
+	pending = vol_zc_init(cd, channels, frames);
+	if (!pending)
+		return;
 
-	for (i = 0; i < frames; i++) {
-		sum = 0;
+	if (!cd->zc_sync) {
+		for (channel = 0; channel < channels; channel++)
+			cd->zc_prev[channel] = x[channel];
+	}
+
+	while (pending && frame < frames) {
+		n = MIN(audio_stream_frames_without_wrap(source, x),
+			frames - frame);
+
+		for (i = 0; pending && i < n; i++) {
+			for (channel = 0; channel < channels; channel++) {
+				sample = x[channel];
+				if (cd->zc_frames[channel] == frames &&
+				    (!sample || (sample ^ cd->zc_prev[channel]) < 0)) {
+					cd->zc_frames[channel] = frame + i;
+					pending--;
+				}
+
+				cd->zc_prev[channel] = sample;
+			}
 
-		for (channel = 0; channel < source->channels; channel++) {
-			src = audio_stream_read_frag_s16(source, buff_frag);
-			sum += *src;
-			buff_frag--;
+			x += channels;
 		}
 
-		/* first sign change */
-		if ((sum ^ *prev_sum) < 0)
-			return curr_frames;
+		frame += i;
+		x = audio_stream_wrap(source, x);
+	}
 
-		*prev_sum = sum;
-		curr_frames--;
+	/* the scan stopped early, continue from the end of the chunk */
+	if (frame < frames) {
+		x = audio_stream_read_frag_s16(source, (frames - 1) * channels);
+		for (channel = 0; channel < channels; channel++)
+			cd->zc_prev[channel] = x[channel];
 	}
 
-	/* sign change not detected, process all samples */
-	return frames;
+	cd->zc_sync = true;
 }
 
 #endif /* CONFIG_FORMAT_S16LE */
 
 #if CONFIG_FORMAT_S24LE
 /**
- * \brief Used to find nearest zero crossing frame for 24 in 32 bit format.
- * \param[in,out] source Source buffer.
+ * \brief Used to find first zero crossing of channels for 24 in 32 bit format.
+ * \param[in,out] cd Volume component private data.
+ * \param[in] source Source buffer.
  * \param[in] frames Number of frames.
- * \param[in,out] prev_sum Previous sum of channel samples.
+ *
+ * All channels of a frame are checked in one pass over the contiguous spans
+ * of the buffer. The sign of the last sample of each channel is kept for
+ * the next call, so a crossing right at the chunk start is found too.
  */
-static uint32_t vol_zc_get_s24(const struct audio_stream *source,
-			       uint32_t frames, int64_t *prev_sum)
+UT_STATIC void vol_zc_get_s24(struct comp_data *cd,
+			      const struct audio_stream *source,
+			      uint32_t frames)
 {
-	uint32_t buff_frag = frames * source->channels - 1;
-	uint32_t curr_frames = frames;
+	int32_t *x = source->r_ptr;
+	uint32_t channels = source->channels;
+	uint32_t pending;
+	uint32_t frame = 0;
 	uint32_t channel;
-	int32_t *src;
-	int64_t sum;
+	uint32_t n;
 	uint32_t i;
+	int32_t sample;
+
+	pending = vol_zc_init(cd, channels, frames);
+	if (!pending)
+		return;
 
-	for (i = 0; i < frames; i++) {
-		sum = 0;
+	if (!cd->zc_sync) {
+		for (channel = 0; channel < channels; channel++)
+			cd->zc_prev[channel] = sign_extend_s24(x[channel]);
+	}
+
+	while (pending && frame < frames) {
+		n = MIN(audio_stream_frames_without_wrap(source, x),
+			frames - frame);
+
+		for (i = 0; pending && i < n; i++) {
+			for (channel = 0; channel < channels; channel++) {
+				sample = sign_extend_s24(x[channel]);
+				if (cd->zc_frames[channel] == frames &&
+				    (!sample || (sample ^ cd->zc_prev[channel]) < 0)) {
+					cd->zc_frames[channel] = frame + i;
+					pending--;
+				}
+
+				cd->zc_prev[channel] = sample;
+			}
 
-		for (channel = 0; channel < source->channels; channel++) {
-			src = audio_stream_read_frag_s32(source, buff_frag);
-			sum += sign_extend_s24(*src);
-			buff_frag--;
+			x += channels;
 		}
 
-		/* first sign change */
-		if ((sum ^ *prev_sum) < 0)
-			return curr_frames;
+		frame += i;
+		x = audio_stream_wrap(source, x);
+	}
 
-		*prev_sum = sum;
-		curr_frames--;
+	/* the scan stopped early, continue from the end of the chunk */
+	if (frame < frames) {
+		x = audio_stream_read_frag_s32(source, (frames - 1) * channels);
+		for (channel = 0; channel < channels; channel++)
+			cd->zc_prev[channel] = sign_extend_s24(x[channel]);
 	}
 
-	/* sign change not detected, process all samples */
-	return frames;
+	cd->zc_sync = true;
 }
 
 #endif /* CONFIG_FORMAT_S24LE */
 
 #if CONFIG_FORMAT_S32LE
 /**
- * \brief Used to find nearest zero crossing frame for 32 bit format.
- * \param[in,out] source Source buffer.
+ * \brief Used to find first zero crossing of channels for 32 bit format.
+ * \param[in,out] cd Volume component private data.
+ * \param[in] source Source buffer.
  * \param[in] frames Number of frames.
- * \param[in,out] prev_sum Previous sum of channel samples.
+ *
+ * All channels of a frame are checked in one pass over the contiguous spans
+ * of the buffer. The sign of the last sample of each channel is kept for
+ * the next call, so a crossing right at the chunk start is found too.
  */
-static uint32_t vol_zc_get_s32(const struct audio_stream *source,
-			       uint32_t frames, int64_t *prev_sum)
+UT_STATIC void vol_zc_get_s32(struct comp_data *cd,
+			      const struct audio_stream *source,
+			      uint32_t frames)
 {
-	uint32_t buff_frag = frames * source->channels - 1;
-	uint32_t curr_frames = frames;
+	int32_t *x = source->r_ptr;
+	uint32_t channels = source->channels;
+	uint32_t pending;
+	uint32_t frame = 0;
 	uint32_t channel;
-	int32_t *src;
-	int64_t sum;
+	uint32_t n;
 	uint32_t i;
+	int32_t sample;
+
+	pending = vol_zc_init(cd, channels, frames);
+	if (!pending)
+		return;
 
-	for (i = 0; i < frames; i++) {
-		sum = 0;
+	if (!cd->zc_sync) {
+		for (channel = 0; channel < channels; channel++)
+			cd->zc_prev[channel] = x[channel];
+	}
+
+	while (pending && frame < frames) {
+		n = MIN(audio_stream_frames_without_wrap(source, x),
+			frames - frame);
+
+		for (i = 0; pending && i < n; i++) {
+			for (channel = 0; channel < channels; channel++) {
+				sample = x[channel];
+				if (cd->zc_frames[channel] == frames &&
+				    (!sample || (sample ^ cd->zc_prev[channel]) < 0)) {
+					cd->zc_frames[channel] = frame + i;
+					pending--;
+				}
+
+				cd->zc_prev[channel] = sample;
+			}
 
-		for (channel = 0; channel < source->channels; channel++) {
-			src = audio_stream_read_frag_s32(source, buff_frag);
-			sum += *src;
-			buff_frag--;
+			x += channels;
 		}
 
-		/* first sign change */
-		if ((sum ^ *prev_sum) < 0)
-			return curr_frames;
+		frame += i;
+		x = audio_stream_wrap(source, x);
+	}
 
-		*prev_sum = sum;
-		curr_frames--;
+	/* the scan stopped early, continue from the end of the chunk */
+	if (frame < frames) {
+		x = audio_stream_read_frag_s32(source, (frames - 1) * channels);
+		for (channel = 0; channel < channels; channel++)
+			cd->zc_prev[channel] = x[channel];
 	}
 
-	/* sign change not detected, process all samples */
-	return frames;
+	cd->zc_sync = true;
 }
 
 #endif /* CONFIG_FORMAT_S32LE */
@@ -209,19 +355,24 @@ static void vol_sync_host(struct comp_dev *dev, unsigned int num_channels)
 /**
  * \brief Ramps volume changes over time.
  * \param[in,out] dev Volume base component device.
+ *
+ * The ramp gain is advanced per frame by the ramp processing functions, the
+ * current volume is updated with the gain reached by them.
  */
 static void volume_ramp(struct comp_dev *dev)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t vol;
-	int32_t ramp_time;
 	int i;
 	bool ramp_finished = true;
 
 	/* No need to ramp in idle state, jump volume to request. */
 	if (dev->state == COMP_STATE_READY) {
-		for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
+		for (i = 0; i < PLATFORM_MAX_CHANNELS; i++) {
 			cd->volume[i] = cd->tvolume[i];
+			cd->ramp_gain[i] = (int64_t)cd->volume[i] <<
+				VOL_RAMP_FRAC_BITS;
+			cd->ramp_left[i] = 0;
+		}
 
 		vol_sync_host(dev, PLATFORM_MAX_CHANNELS);
 		cd->ramp_finished = true;
@@ -234,53 +385,11 @@ static void volume_ramp(struct comp_dev *dev)
 	 */
 	cd->vol_ramp_active = true;
 
-	/* Current ramp time in Q29.3 milliseconds. Note that max. ramp length
-	 * can be 1.3s at 192 kHz rate and 5.5s at 48 kHz rate without
-	 * exceeding int32_t range. Value 8000 is 1000 for converting to
-	 * milliseconds times 8 (2 ^ 3) for fraction.
-	 */
-	ramp_time = cd->vol_ramp_elapsed_frames * 8000 / cd->sample_rate;
-
-
-	/* Update each volume if it's not at target for active channels */
+	/* Update each volume with the ramp gain for active channels */
 	for (i = 0; i < cd->channels; i++) {
-		/* skip if target reached */
-		if (cd->volume[i] == cd->tvolume[i])
-			continue;
-
-		/* Update volume gain with ramp. The ramp gain value is
-		 * calculated from previous gain and ramp time. The slope
-		 * coefficient is calculated in volume_set_chan().
-		 */
-		vol = cd->rvolume[i] + ramp_time * cd->ramp_coef[i];
-		if (cd->volume[i] < cd->tvolume[i]) {
-			/* ramp up, check if ramp completed */
-			if (vol >= cd->tvolume[i] || vol >= cd->vol_max) {
-				cd->ramp_coef[i] = 0;
-				cd->volume[i] = cd->tvolume[i];
-			} else {
-				ramp_finished = false;
-				cd->volume[i] = vol;
-			}
-		} else {
-			/* ramp down */
-			if (vol <= 0) {
-				/* cannot ramp down below 0 */
-				cd->volume[i] = cd->tvolume[i];
-				cd->ramp_coef[i] = 0;
-			} else {
-				/* ramp completed ? */
-				if (vol <= cd->tvolume[i] ||
-				    vol <= cd->vol_min) {
-					cd->ramp_coef[i] = 0;
-					cd->volume[i] = cd->tvolume[i];
-				} else {
-					ramp_finished = false;
-					cd->volume[i] = vol;
-				}
-			}
-		}
-
+		cd->volume[i] = cd->ramp_gain[i] >> VOL_RAMP_FRAC_BITS;
+		if (cd->ramp_left[i])
+			ramp_finished = false;
 	}
 
 	if (ramp_finished) {
@@ -372,6 +481,8 @@ static struct comp_dev *volume_new(const struct comp_driver *drv,
 	}
 
 	cd->vol_ramp_active = false;
+	cd->ramp_log = vol->ramp == SOF_VOLUME_LOG ||
+		vol->ramp == SOF_VOLUME_LOG_ZC;
 	cd->channels = 0; /* To be set in prepare() */
 
 	comp_info(dev, "vol->initial_ramp = %d, vol->ramp = %d, vol->min_value = %d, vol->max_value = %d",
@@ -396,6 +507,100 @@ static void volume_free(struct comp_dev *dev)
 	rfree(dev);
 }
 
+/**
+ * \brief Calculates base 2 logarithm of a positive integer.
+ * \param[in] x Positive value.
+ * \return Logarithm in Q6.26.
+ *
+ * The fraction bits are found one at a time by squaring the normalized
+ * value, it's used only when the volume is set.
+ */
+UT_STATIC int32_t vol_log2(int32_t x)
+{
+	uint32_t m;
+	int32_t y;
+	int msb = 0;
+	int i;
+
+	while (x >> (msb + 1))
+		msb++;
+
+	/* normalize to Q2.30 in 1.0 .. 2.0 range */
+	m = (uint32_t)x << (30 - msb);
+	y = msb << 26;
+
+	for (i = 25; i >= 0; i--) {
+		m = ((uint64_t)m * m) >> 30;
+		if (m >= (2u << 30)) {
+			m >>= 1;
+			y |= 1 << i;
+		}
+	}
+
+	return y;
+}
+
+/**
+ * \brief Calculates e^x - 1 for exponential ramp ratio.
+ * \param[in] x Argument in Q1.31, -ln(2) .. ln(2).
+ * \return Result in Q1.31.
+ *
+ * The Taylor series is summed until the terms vanish. Unlike e^x the result
+ * keeps full precision for the small arguments of long ramps.
+ */
+UT_STATIC int32_t vol_expm1(int32_t x)
+{
+	int64_t term = x;
+	int64_t sum = 0;
+	int k = 1;
+
+	while (term) {
+		sum += term;
+		k++;
+		term = ((term * x) >> 31) / k;
+	}
+
+	return MIN(sum, INT32_MAX);
+}
+
+/**
+ * \brief Sets up exponential ramp of a channel.
+ * \param[in,out] cd Volume component private data.
+ * \param[in] chan Channel number.
+ * \param[in] frames Ramp length for the full volume range.
+ * \param[in] constant_rate_ramp Scale the ramp length with transition.
+ *
+ * The gain is multiplied by e^(ln(target / volume) / frames) every frame.
+ * Mute is replaced by VOL_RAMP_LOG_FLOOR, transitions faster than 6 dB per
+ * frame are done at once.
+ */
+static void volume_set_chan_log(struct comp_data *cd, int chan,
+				uint64_t frames, bool constant_rate_ramp)
+{
+	int32_t start = MAX(cd->volume[chan], VOL_RAMP_LOG_FLOOR);
+	int32_t end = MAX(cd->tvolume[chan], VOL_RAMP_LOG_FLOOR);
+	int32_t delta = vol_log2(end) - vol_log2(start);
+	int32_t range;
+	int64_t ln;
+
+	/* constant dB rate over the log range of the volume */
+	if (constant_rate_ramp && cd->vol_ramp_range > 0) {
+		range = vol_log2(MAX(cd->vol_max, VOL_RAMP_LOG_FLOOR)) -
+			vol_log2(MAX(cd->vol_min, VOL_RAMP_LOG_FLOOR));
+		if (range > 0)
+			frames = frames * ABS(delta) / range;
+	}
+
+	/* Q6.26 x Q1.31 gives Q7.57, ln is Q1.31 */
+	ln = ((int64_t)delta * VOL_LN2_Q31) >> 26;
+	if (!ln || !frames || ABS(ln) >= frames * VOL_LN2_Q31)
+		return;
+
+	cd->ramp_gain[chan] = (int64_t)start << VOL_RAMP_FRAC_BITS;
+	cd->ramp_ratio[chan] = vol_expm1(ln / (int64_t)frames);
+	cd->ramp_left[chan] = frames;
+}
+
 /**
  * \brief Sets channel target volume.
  * \param[in,out] dev Volume base component device.
@@ -405,16 +610,15 @@ static void volume_free(struct comp_dev *dev)
  *	      and variable time length ramp. When false do
  *	      a fixed length and variable rate ramp.
  */
-static inline int volume_set_chan(struct comp_dev *dev, int chan,
-				  int32_t vol, bool constant_rate_ramp)
+UT_STATIC int volume_set_chan(struct comp_dev *dev, int chan, int32_t vol,
+			      bool constant_rate_ramp)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	struct sof_ipc_comp_volume *pga =
 		COMP_GET_IPC(dev, sof_ipc_comp_volume);
 	int32_t v = vol;
 	int32_t delta;
-	int32_t delta_abs;
-	int32_t coef;
+	uint64_t frames;
 
 	/* Limit received volume gain to MIN..MAX range before applying it.
 	 * MAX is needed for now for the generic C gain arithmetics to prevent
@@ -436,65 +640,57 @@ static inline int volume_set_chan(struct comp_dev *dev, int chan,
 	}
 
 	cd->tvolume[chan] = v;
-	cd->rvolume[chan] = cd->volume[chan];
-	cd->vol_ramp_elapsed_frames = 0;
+	cd->ramp_gain[chan] = (int64_t)cd->volume[chan] << VOL_RAMP_FRAC_BITS;
+	cd->ramp_left[chan] = 0;
+
+	/* The ramp length (initial_ramp [ms]) describes time of mute
+	 * to vol_max unmuting. Normally the volume ramp has a
+	 * constant slope defined this way and variable completion
+	 * time. However in streaming start it is feasible to apply
+	 * the entire topology defined ramp time to unmute to any used
+	 * volume. In this case the ramp rate is not constant. Note
+	 * also the legacy mode without known vol_ramp_range where the
+	 * volume transition always uses the topology defined time.
+	 */
+	frames = (uint64_t)pga->initial_ramp * cd->sample_rate / 1000;
 
 	/* Check ramp type */
 	switch (pga->ramp) {
 	case SOF_VOLUME_LINEAR:
 	case SOF_VOLUME_LINEAR_ZC:
-		/* Get volume transition delta and absolute value */
+		/* Get volume transition delta */
 		delta = cd->tvolume[chan] - cd->volume[chan];
-		delta_abs = ABS(delta);
-
-		/* The ramp length (initial_ramp [ms]) describes time of mute
-		 * to vol_max unmuting. Normally the volume ramp has a
-		 * constant linear slope defined this way and variable
-		 * completion time. However in streaming start it is feasible
-		 * to apply the entire topology defined ramp time to unmute to
-		 * any used volume. In this case the ramp rate is not constant.
-		 * Note also the legacy mode without known vol_ramp_range where
-		 * the volume transition always uses the topology defined time.
-		 */
-		if (pga->initial_ramp > 0) {
-			if (constant_rate_ramp && cd->vol_ramp_range > 0)
-				coef = cd->vol_ramp_range;
-			else
-				coef = delta_abs;
 
-			/* Divide and round to nearest. Note that there will
-			 * be some accumulated error in ramp time the longer
-			 * the ramp and the smaller the transition is.
-			 */
-			coef = (2 * coef / pga->initial_ramp + 1) >> 1;
-		} else {
-			coef = delta_abs;
-		}
-
-		/* Scale coefficient by 1/8, round */
-		coef = ((coef >> 2) + 1) >> 1;
+		if (constant_rate_ramp && cd->vol_ramp_range > 0)
+			frames = frames * ABS(delta) / cd->vol_ramp_range;
 
-		/* Ensure ramp coefficient is at least min. non-zero
-		 * fractional value.
+		/* Gain step per frame in Q8.32, the ramp is interpolated
+		 * by the processing functions.
 		 */
-		coef = MAX(coef, 1);
-
-		/* Invert sign for volume down ramp step */
-		if (delta < 0)
-			coef = -coef;
-
-		cd->ramp_coef[chan] = coef;
-		comp_dbg(dev, "cd->ramp_coef[%d] = %d", chan,
-			 cd->ramp_coef[chan]);
+		if (delta && frames) {
+			cd->ramp_step[chan] = ((int64_t)delta <<
+					       VOL_RAMP_FRAC_BITS) /
+					      (int64_t)frames;
+			cd->ramp_left[chan] = frames;
+		}
 		break;
 	case SOF_VOLUME_LOG:
 	case SOF_VOLUME_LOG_ZC:
+		volume_set_chan_log(cd, chan, frames, constant_rate_ramp);
+		break;
 	default:
 		comp_err(dev, "volume_set_chan(): invalid ramp type %d",
 			 pga->ramp);
 		return -EINVAL;
 	}
 
+	/* without ramp the gain changes at once */
+	if (!cd->ramp_left[chan])
+		cd->ramp_gain[chan] = (int64_t)v << VOL_RAMP_FRAC_BITS;
+
+	comp_dbg(dev, "volume_set_chan(), chan = %d, ramp_left = %u",
+		 chan, cd->ramp_left[chan]);
+
 	return 0;
 }
 
@@ -698,22 +894,51 @@ static int volume_trigger(struct comp_dev *dev, int cmd)
 }
 
 /**
- * \brief Copies and processes stream data.
+ * \brief Scales stream data, ramping the volume if needed.
  * \param[in,out] dev Volume base component device.
+ * \param[in] source Source stream.
+ * \param[in,out] sink Sink stream.
+ * \param[in] frames Number of frames to process.
  * \return Error code.
  */
-static int volume_copy(struct comp_dev *dev)
+static int volume_process(struct comp_dev *dev,
+			  const struct audio_stream *source,
+			  struct audio_stream *sink, uint32_t frames)
 {
 	struct sof_ipc_comp_volume *pga =
 		COMP_GET_IPC(dev, sof_ipc_comp_volume);
-	struct comp_copy_limits c;
 	struct comp_data *cd = comp_get_drvdata(dev);
+	bool zc = pga->ramp == SOF_VOLUME_LINEAR_ZC ||
+		pga->ramp == SOF_VOLUME_LOG_ZC;
+
+	/* with ZC ramping channels change volume at own ZC offset */
+	if (zc)
+		cd->zc_get(cd, source, frames);
+
+	/* copy and scale volume, ramps are interpolated per frame */
+	if (cd->ramp_finished) {
+		cd->scale_vol(dev, sink, source, frames);
+	} else {
+		cd->ramp_vol(dev, sink, source, frames);
+		volume_ramp(dev);
+	}
+
+	if (zc)
+		vol_zc_update(cd, frames);
+
+	return 0;
+}
+
+/**
+ * \brief Copies and processes stream data.
+ * \param[in,out] dev Volume base component device.
+ * \return Error code.
+ */
+static int volume_copy(struct comp_dev *dev)
+{
+	struct comp_copy_limits c;
 	struct comp_buffer *source;
 	struct comp_buffer *sink;
-	uint32_t source_bytes;
-	uint32_t sink_bytes;
-	uint32_t frames;
-	int64_t prev_sum = 0;
 
 	comp_dbg(dev, "volume_copy()");
 
@@ -728,39 +953,16 @@ static int volume_copy(struct comp_dev *dev)
 	comp_dbg(dev, "volume_copy(), source_bytes = 0x%x, sink_bytes = 0x%x",
 		 c.source_bytes, c.sink_bytes);
 
-	while (c.frames) {
-		if (cd->ramp_finished || cd->vol_ramp_frames > c.frames) {
-			/* without ramping process all at once */
-			frames = c.frames;
-		} else if (pga->ramp == SOF_VOLUME_LINEAR_ZC) {
-			/* with ZC ramping look for next ZC offset */
-			frames = cd->zc_get(&source->stream,
-					    cd->vol_ramp_frames, &prev_sum);
-		} else {
-			/* without ZC process max ramp chunk */
-			frames = cd->vol_ramp_frames;
-		}
-
-		source_bytes = frames * c.source_frame_bytes;
-		sink_bytes = frames * c.sink_frame_bytes;
-
-		/* copy and scale volume */
-		buffer_invalidate(source, source_bytes);
-		cd->scale_vol(dev, &sink->stream, &source->stream, frames);
-		buffer_writeback(sink, sink_bytes);
+	if (!c.frames)
+		return 0;
 
-		/* calculate new free and available */
-		comp_update_buffer_produce(sink, sink_bytes);
-		comp_update_buffer_consume(source, source_bytes);
+	buffer_invalidate(source, c.source_bytes);
+	volume_process(dev, &source->stream, &sink->stream, c.frames);
+	buffer_writeback(sink, c.sink_bytes);
 
-		if (cd->vol_ramp_active)
-			cd->vol_ramp_elapsed_frames += frames;
-
-		if (!cd->ramp_finished)
-			volume_ramp(dev);
-
-		c.frames -= frames;
-	}
+	/* calculate new free and available */
+	comp_update_buffer_produce(sink, c.sink_bytes);
+	comp_update_buffer_consume(source, c.source_bytes);
 
 	return 0;
 }
@@ -801,9 +1003,7 @@ static int volume_prepare(struct comp_dev *dev)
 	struct comp_data *cd = comp_get_drvdata(dev);
 	struct comp_buffer *sinkb;
 	struct sof_ipc_comp_config *config = dev_comp_config(dev);
-	struct sof_ipc_comp_volume *pga;
 	uint32_t sink_period_bytes;
-	int ramp_update_us;
 	int ret;
 	int i;
 
@@ -839,6 +1039,13 @@ static int volume_prepare(struct comp_dev *dev)
 		goto err;
 	}
 
+	cd->ramp_vol = vol_get_ramp_function(dev);
+	if (!cd->ramp_vol) {
+		comp_err(dev, "volume_prepare(): invalid cd->ramp_vol");
+		ret = -EINVAL;
+		goto err;
+	}
+
 	cd->zc_get = vol_get_zc_function(dev);
 	if (!cd->zc_get) {
 		comp_err(dev, "volume_prepare(): invalid cd->zc_get");
@@ -862,32 +1069,14 @@ static int volume_prepare(struct comp_dev *dev)
 		volume_set_chan(dev, i, cd->tvolume[i], false);
 		if (cd->volume[i] != cd->tvolume[i])
 			cd->ramp_finished = false;
+
+		cd->zc_volume[i] = cd->volume[i];
+		cd->zc_frames[i] = 0;
+		cd->zc_wait[i] = 0;
 	}
 
-	/* Determine ramp update rate depending on requested ramp length. To
-	 * ensure evenly updated gain envelope with limited fraction resolution
-	 * four presets are used.
-	 */
-	pga = COMP_GET_IPC(dev, sof_ipc_comp_volume);
-	if (pga->initial_ramp < VOL_RAMP_UPDATE_THRESHOLD_FASTEST_MS)
-		ramp_update_us = VOL_RAMP_UPDATE_FASTEST_US;
-	else if (pga->initial_ramp < VOL_RAMP_UPDATE_THRESHOLD_FAST_MS)
-		ramp_update_us = VOL_RAMP_UPDATE_FAST_US;
-	else if (pga->initial_ramp < VOL_RAMP_UPDATE_THRESHOLD_SLOW_MS)
-		ramp_update_us = VOL_RAMP_UPDATE_SLOW_US;
-	else
-		ramp_update_us = VOL_RAMP_UPDATE_SLOWEST_US;
-
-	/* The volume ramp is updated at least once per copy(). If the ramp update
-	 * period is larger than schedule period the frames count for update is set
-	 * to copy schedule equivalent number of frames. This also prevents a divide
-	 * by zero to happen with a combinations of topology parameters for the volume
-	 * component and the pipeline.
-	 */
-	if (ramp_update_us > dev->period)
-		cd->vol_ramp_frames = dev->frames;
-	else
-		cd->vol_ramp_frames = dev->frames / (dev->period / ramp_update_us);
+	cd->zc_sync = false;
+	cd->zc_max_wait = cd->sample_rate * VOL_ZC_MAX_WAIT_MS / 1000;
 
 	return 0;
 
@@ -914,12 +1103,14 @@ static const struct comp_driver comp_volume = {
 	.type	= SOF_COMP_VOLUME,
 	.uid	= SOF_RT_UUID(volume_uuid),
 	.tctx	= &volume_tr,
+	.flags	= COMP_DRV_INPLACE | COMP_DRV_DRAIN,
 	.ops	= {
 		.create		= volume_new,
 		.free		= volume_free,
 		.cmd		= volume_cmd,
 		.trigger	= volume_trigger,
 		.copy		= volume_copy,
+		.process	= volume_process,
 		.prepare	= volume_prepare,
 		.reset		= volume_reset,
 	},
@@ -67,7 +67,44 @@ static void vol_s24_to_s24(struct comp_dev *dev, struct audio_stream *sink,
 			src = audio_stream_read_frag_s32(source, buff_frag);
 			dest = audio_stream_write_frag_s32(sink, buff_frag);
 
-			*dest = vol_mult_s24_to_s24(*src, cd->volume[channel]);
+			*dest = vol_mult_s24_to_s24(*src,
+						    vol_chan_gain(cd, channel, i));
+
+			buff_frag++;
+		}
+	}
+}
+
+/**
+ * \brief Volume ramp processing from 24/32 bit to 24/32 bit.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in,out] source Source buffer.
+ * \param[in] frames Number of frames to process.
+ *
+ * Copy and scale volume from 24/32 bit source buffer to 24/32 bit
+ * destination buffer with the gain ramped per frame.
+ */
+static void vol_s24_to_s24_ramp(struct comp_dev *dev,
+				struct audio_stream *sink,
+				const struct audio_stream *source,
+				uint32_t frames)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int32_t *src;
+	int32_t *dest;
+	int32_t i;
+	uint32_t channel;
+	uint32_t buff_frag = 0;
+
+	/* Samples are Q1.23 --> Q1.23 and volume is Q8.16 */
+	for (i = 0; i < frames; i++) {
+		for (channel = 0; channel < sink->channels; channel++) {
+			src = audio_stream_read_frag_s32(source, buff_frag);
+			dest = audio_stream_write_frag_s32(sink, buff_frag);
+
+			*dest = vol_mult_s24_to_s24
+				(*src, vol_ramp_chan_gain(cd, channel, i));
 
 			buff_frag++;
 		}
@@ -103,7 +140,44 @@ static void vol_s32_to_s32(struct comp_dev *dev, struct audio_stream *sink,
 			dest = audio_stream_write_frag_s32(sink, buff_frag);
 
 			*dest = q_multsr_sat_32x32
-				(*src, cd->volume[channel],
+				(*src, vol_chan_gain(cd, channel, i),
+				 Q_SHIFT_BITS_64(31, 16, 31));
+
+			buff_frag++;
+		}
+	}
+}
+
+/**
+ * \brief Volume ramp processing from 32 bit to 32 bit.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in,out] source Source buffer.
+ * \param[in] frames Number of frames to process.
+ *
+ * Copy and scale volume from 32 bit source buffer to 32 bit
+ * destination buffer with the gain ramped per frame.
+ */
+static void vol_s32_to_s32_ramp(struct comp_dev *dev,
+				struct audio_stream *sink,
+				const struct audio_stream *source,
+				uint32_t frames)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int32_t *src;
+	int32_t *dest;
+	int32_t i;
+	uint32_t channel;
+	uint32_t buff_frag = 0;
+
+	/* Samples are Q1.31 --> Q1.31 and volume is Q8.16 */
+	for (i = 0; i < frames; i++) {
+		for (channel = 0; channel < sink->channels; channel++) {
+			src = audio_stream_read_frag_s32(source, buff_frag);
+			dest = audio_stream_write_frag_s32(sink, buff_frag);
+
+			*dest = q_multsr_sat_32x32
+				(*src, vol_ramp_chan_gain(cd, channel, i),
 				 Q_SHIFT_BITS_64(31, 16, 31));
 
 			buff_frag++;
@@ -140,7 +214,44 @@ static void vol_s16_to_s16(struct comp_dev *dev, struct audio_stream *sink,
 			dest = audio_stream_write_frag_s16(sink, buff_frag);
 
 			*dest = q_multsr_sat_32x32_16
-				(*src, cd->volume[channel],
+				(*src, vol_chan_gain(cd, channel, i),
+				 Q_SHIFT_BITS_32(15, 16, 15));
+
+			buff_frag++;
+		}
+	}
+}
+
+/**
+ * \brief Volume ramp processing from 16 bit to 16 bit.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in,out] source Source buffer.
+ * \param[in] frames Number of frames to process.
+ *
+ * Copy and scale volume from 16 bit source buffer to 16 bit
+ * destination buffer with the gain ramped per frame.
+ */
+static void vol_s16_to_s16_ramp(struct comp_dev *dev,
+				struct audio_stream *sink,
+				const struct audio_stream *source,
+				uint32_t frames)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int16_t *src;
+	int16_t *dest;
+	int32_t i;
+	uint32_t channel;
+	uint32_t buff_frag = 0;
+
+	/* Samples are Q1.15 --> Q1.15 and volume is Q8.16 */
+	for (i = 0; i < frames; i++) {
+		for (channel = 0; channel < sink->channels; channel++) {
+			src = audio_stream_read_frag_s16(source, buff_frag);
+			dest = audio_stream_write_frag_s16(sink, buff_frag);
+
+			*dest = q_multsr_sat_32x32_16
+				(*src, vol_ramp_chan_gain(cd, channel, i),
 				 Q_SHIFT_BITS_32(15, 16, 15));
 
 			buff_frag++;
@@ -151,13 +262,13 @@ static void vol_s16_to_s16(struct comp_dev *dev, struct audio_stream *sink,
 
 const struct comp_func_map func_map[] = {
 #if CONFIG_FORMAT_S16LE
-	{ SOF_IPC_FRAME_S16_LE, vol_s16_to_s16 },
+	{ SOF_IPC_FRAME_S16_LE, vol_s16_to_s16, vol_s16_to_s16_ramp },
 #endif /* CONFIG_FORMAT_S16LE */
 #if CONFIG_FORMAT_S24LE
-	{ SOF_IPC_FRAME_S24_4LE, vol_s24_to_s24 },
+	{ SOF_IPC_FRAME_S24_4LE, vol_s24_to_s24, vol_s24_to_s24_ramp },
 #endif /* CONFIG_FORMAT_S24LE */
 #if CONFIG_FORMAT_S32LE
-	{ SOF_IPC_FRAME_S32_LE, vol_s32_to_s32 },
+	{ SOF_IPC_FRAME_S32_LE, vol_s32_to_s32, vol_s32_to_s32_ramp },
 #endif /* CONFIG_FORMAT_S32LE */
 };
 
@@ -66,7 +66,67 @@ static void vol_s24_to_s24_s32(struct comp_dev *dev, struct audio_stream *sink,
 			AE_L32_XC(in_sample, in, sizeof(ae_int32));
 
 			/* Load volume */
-			volume = (ae_f32x2)cd->volume[channel];
+			volume = (ae_f32x2)vol_chan_gain(cd, channel, i);
+
+			/* Multiply the input sample */
+			mult = AE_MULF32S_LL(volume, AE_SLAA32(in_sample, 8));
+
+			/* Multiplication of Q1.31 x Q1.31 gives Q1.63.
+			 * Now multiplication is Q8.16 x Q1.31, the result
+			 * is Q9.48. Need to shift right by one to get Q17.47
+			 * compatible format for round.
+			 */
+			out_sample = AE_ROUND32F48SSYM(AE_SRAI64(mult, 1));
+
+			/* Shift for S24_LE */
+			out_sample = AE_SRAA32RS(out_sample, shift);
+			out_sample = AE_SLAA32S(out_sample, shift);
+			out_sample = AE_SRAA32(out_sample, shift);
+
+			/* Set sink as circular buffer */
+			vol_setup_circular(sink);
+
+			/* Store the output sample */
+			AE_S32_L_XC(out_sample, out, sizeof(ae_int32));
+		}
+	}
+}
+
+/**
+ * \brief HiFi3 enabled volume ramp from 24/32 bit to 24/32 or 32 bit.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in,out] source Source buffer.
+ * \param[in] frames Number of frames to process.
+ */
+static void vol_s24_to_s24_s32_ramp(struct comp_dev *dev,
+				    struct audio_stream *sink,
+				    const struct audio_stream *source,
+				    uint32_t frames)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	ae_f64 mult;
+	ae_f32x2 in_sample = AE_ZERO32();
+	ae_f32x2 out_sample;
+	ae_f32x2 volume;
+	size_t channel;
+	int i;
+	int shift = 8;
+	ae_int32 *in = (ae_int32 *)source->r_ptr;
+	ae_int32 *out = (ae_int32 *)sink->w_ptr;
+
+	/* Main processing loop */
+	for (i = 0; i < frames; i++) {
+		/* Processing per channel */
+		for (channel = 0; channel < sink->channels; channel++) {
+			/* Set source as circular buffer */
+			vol_setup_circular(source);
+
+			/* Load the input sample */
+			AE_L32_XC(in_sample, in, sizeof(ae_int32));
+
+			/* Load volume and advance the ramp */
+			volume = (ae_f32x2)vol_ramp_chan_gain(cd, channel, i);
 
 			/* Multiply the input sample */
 			mult = AE_MULF32S_LL(volume, AE_SLAA32(in_sample, 8));
@@ -127,7 +187,67 @@ static void vol_s32_to_s24_s32(struct comp_dev *dev, struct audio_stream *sink,
 			AE_L32_XC(in_sample, in, sizeof(ae_int32));
 
 			/* Load volume */
-			volume = (ae_f32x2)cd->volume[channel];
+			volume = (ae_f32x2)vol_chan_gain(cd, channel, i);
+
+			/* Multiply the input sample */
+			mult = AE_MULF32S_LL(volume, in_sample);
+
+			/* Multiplication of Q1.31 x Q1.31 gives Q1.63.
+			 * Now multiplication is Q8.16 x Q1.31, the result
+			 * is Q9.48. Need to shift right by one to get Q17.47
+			 * compatible format for round.
+			 */
+			out_sample = AE_ROUND32F48SSYM(AE_SRAI64(mult, 1));
+
+			/* Shift for S24_LE */
+			out_sample = AE_SRAA32RS(out_sample, shift);
+			out_sample = AE_SLAA32S(out_sample, shift);
+			out_sample = AE_SRAA32(out_sample, shift);
+
+			/* Set sink as circular buffer */
+			vol_setup_circular(sink);
+
+			/* Store the output sample */
+			AE_S32_L_XC(out_sample, out, sizeof(ae_int32));
+		}
+	}
+}
+
+/**
+ * \brief HiFi3 enabled volume ramp from 32 bit to 24/32 or 32 bit.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in,out] source Source buffer.
+ * \param[in] frames Number of frames to process.
+ */
+static void vol_s32_to_s24_s32_ramp(struct comp_dev *dev,
+				    struct audio_stream *sink,
+				    const struct audio_stream *source,
+				    uint32_t frames)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	ae_f64 mult;
+	ae_f32x2 in_sample = AE_ZERO32();
+	ae_f32x2 out_sample;
+	ae_f32x2 volume;
+	size_t channel;
+	int shift = 0;
+	int i;
+	ae_int32 *in = (ae_int32 *)source->r_ptr;
+	ae_int32 *out = (ae_int32 *)sink->w_ptr;
+
+	/* Main processing loop */
+	for (i = 0; i < frames; i++) {
+		/* Processing per channel */
+		for (channel = 0; channel < sink->channels; channel++) {
+			/* Set source as circular buffer */
+			vol_setup_circular(source);
+
+			/* Load the input sample */
+			AE_L32_XC(in_sample, in, sizeof(ae_int32));
+
+			/* Load volume and advance the ramp */
+			volume = (ae_f32x2)vol_ramp_chan_gain(cd, channel, i);
 
 			/* Multiply the input sample */
 			mult = AE_MULF32S_LL(volume, in_sample);
@@ -186,7 +306,61 @@ static void vol_s16_to_s16(struct comp_dev *dev, struct audio_stream *sink,
 			AE_L16_XC(in_sample, in, sizeof(ae_int16));
 
 			/* Load volume */
-			volume = (ae_f32x2)cd->volume[channel];
+			volume = (ae_f32x2)vol_chan_gain(cd, channel, i);
+
+			/* Multiply the input sample */
+			mult = AE_MULF32X16_L0(volume, in_sample);
+
+			/* Multiply of Q1.31 x Q1.15 gives Q1.47. Multiply of
+			 * Q8.16 x Q1.15 gives Q8.32, so need to shift left
+			 * by 31 to get Q1.63. Sample is Q1.31.
+			 */
+			out_sample = AE_ROUND32F64SSYM(AE_SLAI64S(mult, 31));
+
+			/* Set sink as circular buffer */
+			vol_setup_circular(sink);
+
+			/* Round to Q1.15 and store the output sample */
+			AE_S16_0_XC(AE_ROUND16X4F32SSYM(out_sample, out_sample),
+				    out, sizeof(ae_int16));
+		}
+	}
+}
+
+/**
+ * \brief HiFi3 enabled volume ramp from 16 bit to 16 bit.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in,out] source Source buffer.
+ * \param[in] frames Number of frames to process.
+ */
+static void vol_s16_to_s16_ramp(struct comp_dev *dev,
+				struct audio_stream *sink,
+				const struct audio_stream *source,
+				uint32_t frames)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	ae_f64 mult;
+	ae_f32x2 volume;
+	ae_f32x2 out_sample;
+	ae_f16x4 in_sample = AE_ZERO16();
+	size_t channel;
+	int i;
+	ae_int16 *in = (ae_int16 *)source->r_ptr;
+	ae_int16 *out = (ae_int16 *)sink->w_ptr;
+
+	/* Main processing loop */
+	for (i = 0; i < frames; i++) {
+		/* Processing per channel */
+		for (channel = 0; channel < sink->channels; channel++) {
+			/* Set source as circular buffer */
+			vol_setup_circular(source);
+
+			/* Load the input sample */
+			AE_L16_XC(in_sample, in, sizeof(ae_int16));
+
+			/* Load volume and advance the ramp */
+			volume = (ae_f32x2)vol_ramp_chan_gain(cd, channel, i);
 
 			/* Multiply the input sample */
 			mult = AE_MULF32X16_L0(volume, in_sample);
@@ -210,13 +384,15 @@ static void vol_s16_to_s16(struct comp_dev *dev, struct audio_stream *sink,
 
 const struct comp_func_map func_map[] = {
 #if CONFIG_FORMAT_S16LE
-	{ SOF_IPC_FRAME_S16_LE, vol_s16_to_s16 },
+	{ SOF_IPC_FRAME_S16_LE, vol_s16_to_s16, vol_s16_to_s16_ramp },
 #endif
 #if CONFIG_FORMAT_S24LE
-	{ SOF_IPC_FRAME_S24_4LE, vol_s24_to_s24_s32 },
+	{ SOF_IPC_FRAME_S24_4LE, vol_s24_to_s24_s32,
+	  vol_s24_to_s24_s32_ramp },
 #endif
 #if CONFIG_FORMAT_S32LE
-	{ SOF_IPC_FRAME_S32_LE, vol_s32_to_s24_s32 },
+	{ SOF_IPC_FRAME_S32_LE, vol_s32_to_s24_s32,
+	  vol_s32_to_s24_s32_ramp },
 #endif
 };
 
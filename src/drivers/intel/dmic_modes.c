@@ -0,0 +1,576 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/coefficients/pdm_decim/pdm_decim_fir.h>
+#include <sof/audio/coefficients/pdm_decim/pdm_decim_table.h>
+#include <sof/audio/format.h>
+#include <sof/drivers/dmic_modes.h>
+#include <sof/lib/uuid.h>
+#include <sof/math/numbers.h>
+#include <sof/trace/trace.h>
+#include <user/trace.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* 83945b09-bd3b-44cd-b823-7e1db4aea9ea */
+DECLARE_SOF_UUID("dmic-modes", dmic_modes_uuid, 0x83945b09, 0xbd3b, 0x44cd,
+		 0xb8, 0x23, 0x7e, 0x1d, 0xb4, 0xae, 0xa9, 0xea);
+
+DECLARE_TR_CTX(dmic_modes_tr, SOF_UUID(dmic_modes_uuid), LOG_LEVEL_INFO);
+
+#define DMIC_MAX_MODES 50
+
+/* HW FIR pipeline needs 5 additional cycles per channel for internal
+ * operations. This is used in MAX filter length check.
+ */
+#define DMIC_FIR_PIPELINE_OVERHEAD 5
+
+/* Minimum OSR is always applied for 48 kHz and less sample rates */
+#define DMIC_MIN_OSR  50
+
+/* These are used as guideline for configuring > 48 kHz sample rates. The
+ * minimum OSR can be relaxed down to 40 (use 3.84 MHz clock for 96 kHz).
+ */
+#define DMIC_HIGH_RATE_MIN_FS	64000
+#define DMIC_HIGH_RATE_OSR_MIN	40
+
+struct decim_modes {
+	int16_t clkdiv[DMIC_MAX_MODES];
+	int16_t mcic[DMIC_MAX_MODES];
+	int16_t mfir[DMIC_MAX_MODES];
+	int num_of_modes;
+};
+
+struct matched_modes {
+	int16_t clkdiv[DMIC_MAX_MODES];
+	int16_t mcic[DMIC_MAX_MODES];
+	int16_t mfir_a[DMIC_MAX_MODES];
+	int16_t mfir_b[DMIC_MAX_MODES];
+	int num_of_modes;
+};
+
+struct dmic_modes_cache_entry {
+	struct dmic_modes_request req;
+	struct dmic_configuration cfg;
+};
+
+/* Search results, replaced in round robin order when full. The DMIC
+ * configuration requests are serialized by IPC so no locking is needed.
+ */
+struct dmic_modes_cache {
+	struct dmic_modes_cache_entry entry[DMIC_MODES_CACHE_SIZE];
+	int count;
+	int next;
+};
+
+static struct dmic_modes_cache modes_cache;
+
+/* This function returns a raw list of potential microphone clock and decimation
+ * modes for achieving requested sample rates. The search is constrained by
+ * decimation HW capabililies and setup parameters. The parameters such as
+ * microphone clock min/max and duty cycle requirements need be checked from
+ * used microphone component datasheet.
+ */
+static void find_modes(const struct dmic_modes_request *req,
+		       struct decim_modes *modes, uint32_t fs)
+{
+	int ioclk = req->ioclk;
+	int clkdiv_min;
+	int clkdiv_max;
+	int clkdiv;
+	int c1;
+	int du_min;
+	int du_max;
+	int pdmclk;
+	int osr;
+	int mfir;
+	int mcic;
+	int ioclk_test;
+	int osr_min = DMIC_MIN_OSR;
+	int j;
+	int i = 0;
+
+	/* Defaults, empty result */
+	modes->num_of_modes = 0;
+
+	/* The FIFO is not requested if sample rate is set to zero. Just
+	 * return in such case with num_of_modes as zero.
+	 */
+	if (fs == 0)
+		return;
+
+	/* Override DMIC_MIN_OSR for very high sample rates, use as minimum
+	 * the nominal clock for the high rates.
+	 */
+	if (fs >= DMIC_HIGH_RATE_MIN_FS)
+		osr_min = DMIC_HIGH_RATE_OSR_MIN;
+
+	/* Check for sane pdm clock, min 100 kHz, max ioclk/2 */
+	if (req->pdmclk_max < DMIC_HW_PDM_CLK_MIN ||
+	    req->pdmclk_max > ioclk / 2) {
+		tr_err(&dmic_modes_tr, "find_modes():  pdm clock max not in range");
+		return;
+	}
+	if (req->pdmclk_min < DMIC_HW_PDM_CLK_MIN ||
+	    req->pdmclk_min > req->pdmclk_max) {
+		tr_err(&dmic_modes_tr, "find_modes():  pdm clock min not in range");
+		return;
+	}
+
+	/* Check for sane duty cycle */
+	if (req->duty_min > req->duty_max) {
+		tr_err(&dmic_modes_tr, "find_modes(): duty cycle min > max");
+		return;
+	}
+	if (req->duty_min < DMIC_HW_DUTY_MIN ||
+	    req->duty_min > DMIC_HW_DUTY_MAX) {
+		tr_err(&dmic_modes_tr, "find_modes():  pdm clock min not in range");
+		return;
+	}
+	if (req->duty_max < DMIC_HW_DUTY_MIN ||
+	    req->duty_max > DMIC_HW_DUTY_MAX) {
+		tr_err(&dmic_modes_tr, "find_modes(): pdm clock max not in range");
+		return;
+	}
+
+	/* Min and max clock dividers */
+	clkdiv_min = ceil_divide(ioclk, req->pdmclk_max);
+	clkdiv_min = MAX(clkdiv_min, DMIC_HW_CIC_DECIM_MIN);
+	clkdiv_max = ioclk / req->pdmclk_min;
+
+	/* Loop possible clock dividers and check based on resulting
+	 * oversampling ratio that CIC and FIR decimation ratios are
+	 * feasible. The ratios need to be integers. Also the mic clock
+	 * duty cycle need to be within limits.
+	 */
+	for (clkdiv = clkdiv_min; clkdiv <= clkdiv_max; clkdiv++) {
+		/* Calculate duty cycle for this clock divider. Note that
+		 * odd dividers cause non-50% duty cycle.
+		 */
+		c1 = clkdiv >> 1;
+		du_min = 100 * c1 / clkdiv;
+		du_max = 100 - du_min;
+
+		/* Calculate PDM clock rate and oversampling ratio. */
+		pdmclk = ioclk / clkdiv;
+		osr = pdmclk / fs;
+
+		/* Check that OSR constraints is met and clock duty cycle does
+		 * not exceed microphone specification. If exceed proceed to
+		 * next clkdiv.
+		 */
+		if (osr < osr_min || du_min < req->duty_min ||
+		    du_max > req->duty_max)
+			continue;
+
+		/* Loop FIR decimation factors candidates. If the
+		 * integer divided decimation factors and clock dividers
+		 * as multiplied with sample rate match the IO clock
+		 * rate the division was exact and such decimation mode
+		 * is possible. Then check that CIC decimation constraints
+		 * are met. The passed decimation modes are added to array.
+		 */
+		for (j = 0; fir_list[j]; j++) {
+			mfir = fir_list[j]->decim_factor;
+
+			/* Skip if previous decimation factor was the same */
+			if (j > 1 && fir_list[j - 1]->decim_factor == mfir)
+				continue;
+
+			mcic = osr / mfir;
+			ioclk_test = fs * mfir * mcic * clkdiv;
+
+			if (ioclk_test == ioclk &&
+			    mcic >= DMIC_HW_CIC_DECIM_MIN &&
+			    mcic <= DMIC_HW_CIC_DECIM_MAX &&
+			    i < DMIC_MAX_MODES) {
+				modes->clkdiv[i] = clkdiv;
+				modes->mcic[i] = mcic;
+				modes->mfir[i] = mfir;
+				i++;
+			}
+		}
+	}
+
+	modes->num_of_modes = i;
+}
+
+/* The previous raw modes list contains sane configuration possibilities. When
+ * there is request for both FIFOs A and B operation this function returns
+ * list of compatible settings.
+ */
+static void match_modes(struct matched_modes *c, struct decim_modes *a,
+			struct decim_modes *b)
+{
+	int16_t idx[DMIC_MAX_MODES];
+	int idx_length;
+	int i;
+	int n;
+	int m;
+
+	/* Check if previous search got results. */
+	c->num_of_modes = 0;
+	if (a->num_of_modes == 0 && b->num_of_modes == 0) {
+		/* Nothing to do */
+		return;
+	}
+
+	/* Ensure that num_of_modes is sane. */
+	if (a->num_of_modes > DMIC_MAX_MODES ||
+	    b->num_of_modes > DMIC_MAX_MODES)
+		return;
+
+	/* Check for request only for FIFO A or B. In such case pass list for
+	 * A or B as such.
+	 */
+	if (b->num_of_modes == 0) {
+		c->num_of_modes = a->num_of_modes;
+		for (i = 0; i < a->num_of_modes; i++) {
+			c->clkdiv[i] = a->clkdiv[i];
+			c->mcic[i] = a->mcic[i];
+			c->mfir_a[i] = a->mfir[i];
+			c->mfir_b[i] = 0; /* Mark FIR B as non-used */
+		}
+		return;
+	}
+
+	if (a->num_of_modes == 0) {
+		c->num_of_modes = b->num_of_modes;
+		for (i = 0; i < b->num_of_modes; i++) {
+			c->clkdiv[i] = b->clkdiv[i];
+			c->mcic[i] = b->mcic[i];
+			c->mfir_b[i] = b->mfir[i];
+			c->mfir_a[i] = 0; /* Mark FIR A as non-used */
+		}
+		return;
+	}
+
+	/* Merge a list of compatible modes */
+	i = 0;
+	for (n = 0; n < a->num_of_modes; n++) {
+		/* Find all indices of values a->clkdiv[n] in b->clkdiv[] */
+		idx_length = find_equal_int16(idx, b->clkdiv, a->clkdiv[n],
+					      b->num_of_modes, 0);
+		for (m = 0; m < idx_length; m++) {
+			if (b->mcic[idx[m]] == a->mcic[n]) {
+				c->clkdiv[i] = a->clkdiv[n];
+				c->mcic[i] = a->mcic[n];
+				c->mfir_a[i] = a->mfir[n];
+				c->mfir_b[i] = b->mfir[idx[m]];
+				i++;
+			}
+		}
+		c->num_of_modes = i;
+	}
+}
+
+/* Finds a suitable FIR decimation filter from the included set */
+static struct pdm_decim *get_fir(struct dmic_configuration *cfg, int ioclk,
+				 int mfir)
+{
+	int i;
+	int fs;
+	int cic_fs;
+	int fir_max_length;
+	struct pdm_decim *fir = NULL;
+
+	if (mfir <= 0)
+		return fir;
+
+	cic_fs = ioclk / cfg->clkdiv / cfg->mcic;
+	fs = cic_fs / mfir;
+	/* FIR max. length depends on available cycles and coef RAM
+	 * length. Exceeding this length sets HW overrun status and
+	 * overwrite of other register.
+	 */
+	fir_max_length = MIN(DMIC_HW_FIR_LENGTH_MAX,
+			     ioclk / fs / 2 -
+			     DMIC_FIR_PIPELINE_OVERHEAD);
+
+	i = 0;
+	/* Loop until NULL */
+	while (fir_list[i]) {
+		if (fir_list[i]->decim_factor == mfir) {
+			if (fir_list[i]->length <= fir_max_length) {
+				/* Store pointer, break from loop to avoid a
+				 * Possible other mode with lower FIR length.
+				 */
+				fir = fir_list[i];
+				break;
+			}
+			tr_info(&dmic_modes_tr, "get_fir(), Note length=%d exceeds max=%d",
+				fir_list[i]->length, fir_max_length);
+		}
+		i++;
+	}
+
+	return fir;
+}
+
+/* Calculate scale and shift to use for FIR coefficients. Scale is applied
+ * before write to HW coef RAM. Shift will be programmed to HW register.
+ */
+static int fir_coef_scale(int32_t *fir_scale, int *fir_shift, int add_shift,
+			  const int32_t coef[], int coef_length, int32_t gain)
+{
+	int32_t amax;
+	int32_t new_amax;
+	int32_t fir_gain;
+	int shift;
+
+	/* Multiply gain passed from CIC with output full scale. */
+	fir_gain = Q_MULTSR_32X32((int64_t)gain, DMIC_HW_SENS_Q28,
+				  DMIC_FIR_SCALE_Q, 28, DMIC_FIR_SCALE_Q);
+
+	/* Find the largest FIR coefficient value. */
+	amax = find_max_abs_int32((int32_t *)coef, coef_length);
+
+	/* Scale max. tap value with FIR gain. */
+	new_amax = Q_MULTSR_32X32((int64_t)amax, fir_gain, 31,
+				  DMIC_FIR_SCALE_Q, DMIC_FIR_SCALE_Q);
+	if (new_amax <= 0)
+		return -EINVAL;
+
+	/* Get left shifts count to normalize the fractional value as 32 bit.
+	 * We need right shifts count for scaling so need to invert. The
+	 * difference of Q31 vs. used Q format is added to get the correct
+	 * normalization right shift value.
+	 */
+	shift = 31 - DMIC_FIR_SCALE_Q - norm_int32(new_amax);
+
+	/* Add to shift for coef raw Q31 format shift and store to
+	 * configuration. Ensure range (fail should not happen with OK
+	 * coefficient set).
+	 */
+	*fir_shift = -shift + add_shift;
+	if (*fir_shift < DMIC_HW_FIR_SHIFT_MIN ||
+	    *fir_shift > DMIC_HW_FIR_SHIFT_MAX)
+		return -EINVAL;
+
+	/* Compensate shift into FIR coef scaler and store as Q4.20. */
+	if (shift < 0)
+		*fir_scale = fir_gain << -shift;
+	else
+		*fir_scale = fir_gain >> shift;
+
+	return 0;
+}
+
+/* This function selects with a simple criteria one mode to set up the
+ * decimator. For the settings chosen for FIFOs A and B output a lookup
+ * is done for FIR coefficients from the included coefficients tables.
+ * For some decimation factors there may be several length coefficient sets.
+ * It is due to possible restruction of decimation engine cycles per given
+ * sample rate. If the coefficients length is exceeded the lookup continues.
+ * Therefore the list of coefficient set must present the filters for a
+ * decimation factor in decreasing length order.
+ *
+ * Note: If there is no filter available an error is returned. The parameters
+ * should be reviewed for such case. If still a filter is missing it should be
+ * added into the included set. FIR decimation with a high factor usually
+ * needs compromizes into specifications and is not desirable.
+ */
+static int select_mode(const struct dmic_modes_request *req,
+		       struct dmic_configuration *cfg,
+		       struct matched_modes *modes)
+{
+	int32_t g_cic;
+	int32_t fir_in_max;
+	int32_t cic_out_max;
+	int32_t gain_to_fir;
+	int16_t idx[DMIC_MAX_MODES];
+	int16_t *mfir;
+	int n = 1;
+	int mmin;
+	int count;
+	int mcic;
+	int bits_cic;
+	int ret;
+
+	/* If there are more than one possibilities select a mode with lowest
+	 * FIR decimation factor. If there are several select mode with highest
+	 * ioclk divider to minimize microphone power consumption. The highest
+	 * clock divisors are in the end of list so select the last of list.
+	 * The minimum OSR criteria used in previous ensures that quality in
+	 * the candidates should be sufficient.
+	 */
+	if (modes->num_of_modes == 0) {
+		tr_err(&dmic_modes_tr, "select_mode(): no modes available");
+		return -EINVAL;
+	}
+
+	/* Valid modes presence is indicated with non-zero decimation
+	 * factor in 1st element. If FIR A is not used get decimation factors
+	 * from FIR B instead.
+	 */
+	if (modes->mfir_a[0] > 0)
+		mfir = modes->mfir_a;
+	else
+		mfir = modes->mfir_b;
+
+	mmin = find_min_int16(mfir, modes->num_of_modes);
+	count = find_equal_int16(idx, mfir, mmin, modes->num_of_modes, 0);
+	n = idx[count - 1];
+
+	/* Get microphone clock and decimation parameters for used mode from
+	 * the list.
+	 */
+	cfg->clkdiv = modes->clkdiv[n];
+	cfg->mfir_a = modes->mfir_a[n];
+	cfg->mfir_b = modes->mfir_b[n];
+	cfg->mcic = modes->mcic[n];
+	cfg->fir_a = NULL;
+	cfg->fir_b = NULL;
+
+	/* Find raw FIR coefficients to match the decimation factors of FIR
+	 * A and B.
+	 */
+	if (cfg->mfir_a > 0) {
+		cfg->fir_a = get_fir(cfg, req->ioclk, cfg->mfir_a);
+		if (!cfg->fir_a) {
+			tr_err(&dmic_modes_tr, "select_mode(): cannot find FIR coefficients, mfir_a = %u",
+			       cfg->mfir_a);
+			return -EINVAL;
+		}
+	}
+
+	if (cfg->mfir_b > 0) {
+		cfg->fir_b = get_fir(cfg, req->ioclk, cfg->mfir_b);
+		if (!cfg->fir_b) {
+			tr_err(&dmic_modes_tr, "select_mode(): cannot find FIR coefficients, mfir_b = %u",
+			       cfg->mfir_b);
+			return -EINVAL;
+		}
+	}
+
+	/* Calculate CIC shift from the decimation factor specific gain. The
+	 * gain of HW decimator equals decimation factor to power of 5.
+	 */
+	mcic = cfg->mcic;
+	g_cic = mcic * mcic * mcic * mcic * mcic;
+	if (g_cic < 0) {
+		/* Erroneous decimation factor and CIC gain */
+		tr_err(&dmic_modes_tr, "select_mode(): erroneous decimation factor and CIC gain");
+		return -EINVAL;
+	}
+
+	bits_cic = 32 - norm_int32(g_cic);
+	cfg->cic_shift = bits_cic - DMIC_HW_BITS_FIR_INPUT;
+
+	/* Calculate remaining gain to FIR in Q format used for gain
+	 * values.
+	 */
+	fir_in_max = INT_MAX(DMIC_HW_BITS_FIR_INPUT);
+	if (cfg->cic_shift >= 0)
+		cic_out_max = g_cic >> cfg->cic_shift;
+	else
+		cic_out_max = g_cic << -cfg->cic_shift;
+
+	gain_to_fir = (int32_t)((((int64_t)fir_in_max) << DMIC_FIR_SCALE_Q) /
+		cic_out_max);
+
+	/* Calculate FIR scale and shift */
+	if (cfg->mfir_a > 0) {
+		cfg->fir_a_length = cfg->fir_a->length;
+		ret = fir_coef_scale(&cfg->fir_a_scale, &cfg->fir_a_shift,
+				     cfg->fir_a->shift, cfg->fir_a->coef,
+				     cfg->fir_a->length, gain_to_fir);
+		if (ret < 0) {
+			/* Invalid coefficient set found, should not happen. */
+			tr_err(&dmic_modes_tr, "select_mode(): invalid coefficient set found");
+			return -EINVAL;
+		}
+	} else {
+		cfg->fir_a_scale = 0;
+		cfg->fir_a_shift = 0;
+		cfg->fir_a_length = 0;
+	}
+
+	if (cfg->mfir_b > 0) {
+		cfg->fir_b_length = cfg->fir_b->length;
+		ret = fir_coef_scale(&cfg->fir_b_scale, &cfg->fir_b_shift,
+				     cfg->fir_b->shift, cfg->fir_b->coef,
+				     cfg->fir_b->length, gain_to_fir);
+		if (ret < 0) {
+			/* Invalid coefficient set found, should not happen. */
+			tr_err(&dmic_modes_tr, "select_mode(): invalid coefficient set found");
+			return -EINVAL;
+		}
+	} else {
+		cfg->fir_b_scale = 0;
+		cfg->fir_b_shift = 0;
+		cfg->fir_b_length = 0;
+	}
+
+	return 0;
+}
+
+int dmic_modes_search(const struct dmic_modes_request *req,
+		      struct dmic_configuration *cfg)
+{
+	struct matched_modes modes_ab;
+	struct decim_modes modes_a;
+	struct decim_modes modes_b;
+
+	/* Match and select optimal decimators configuration for FIFOs A and B
+	 * paths. This setup phase is still abstract. Successful completion
+	 * points struct cfg to FIR coefficients and contains the scale value
+	 * to use for FIR coefficient RAM write as well as the CIC and FIR
+	 * shift values.
+	 */
+	find_modes(req, &modes_a, req->fs_a);
+	if (modes_a.num_of_modes == 0 && req->fs_a > 0) {
+		tr_err(&dmic_modes_tr, "dmic_modes_search(): No modes found for FIFO A");
+		return -EINVAL;
+	}
+
+	find_modes(req, &modes_b, req->fs_b);
+	if (modes_b.num_of_modes == 0 && req->fs_b > 0) {
+		tr_err(&dmic_modes_tr, "dmic_modes_search(): No modes found for FIFO B");
+		return -EINVAL;
+	}
+
+	match_modes(&modes_ab, &modes_a, &modes_b);
+	return select_mode(req, cfg, &modes_ab);
+}
+
+static bool dmic_modes_request_equal(const struct dmic_modes_request *a,
+				     const struct dmic_modes_request *b)
+{
+	return a->ioclk == b->ioclk && a->fs_a == b->fs_a &&
+		a->fs_b == b->fs_b && a->pdmclk_min == b->pdmclk_min &&
+		a->pdmclk_max == b->pdmclk_max &&
+		a->duty_min == b->duty_min && a->duty_max == b->duty_max;
+}
+
+int dmic_modes_get(const struct dmic_modes_request *req,
+		   struct dmic_configuration *cfg)
+{
+	struct dmic_modes_cache_entry *entry;
+	int ret;
+	int i;
+
+	for (i = 0; i < modes_cache.count; i++) {
+		entry = &modes_cache.entry[i];
+		if (dmic_modes_request_equal(&entry->req, req)) {
+			*cfg = entry->cfg;
+			return 0;
+		}
+	}
+
+	ret = dmic_modes_search(req, cfg);
+	if (ret < 0)
+		return ret;
+
+	/* Only successful searches are remembered */
+	entry = &modes_cache.entry[modes_cache.next];
+	entry->req = *req;
+	entry->cfg = *cfg;
+	modes_cache.next = (modes_cache.next + 1) % DMIC_MODES_CACHE_SIZE;
+	if (modes_cache.count < DMIC_MODES_CACHE_SIZE)
+		modes_cache.count++;
+
+	return 0;
+}
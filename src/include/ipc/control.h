@@ -114,6 +114,15 @@ struct sof_ipc_ctrl_value_comp {
 	};
 } __attribute__((packed));
 
+/**
+ * Control data flags.
+ * SOF_IPC_CTRL_FLAG_DEFERRED lets the FW acknowledge a binary data set with
+ * SOF_IPC_COMP_DEFERRED and report the result later with the
+ * SOF_IPC_COMP_DEFERRED_DONE notification, both use
+ * struct sof_ipc_ctrl_deferred.
+ */
+#define SOF_IPC_CTRL_FLAG_DEFERRED	(1 << 0)	/**< ABI3.19 */
+
 /**
  * Generic control data.
  */
@@ -132,9 +141,10 @@ struct sof_ipc_ctrl_data {
 	uint32_t elems_remaining;	/**< elems remaining if sent in parts */
 
 	uint32_t msg_index;	/**< index for large messages sent in parts */
+	uint32_t flags;		/**< SOF_IPC_CTRL_FLAG_, ABI3.19 */
 
 	/* reserved for future use */
-	uint32_t reserved[6];
+	uint32_t reserved[5];
 
 	/* control data - add new types if needed */
 	union {
@@ -147,6 +157,20 @@ struct sof_ipc_ctrl_data {
 	};
 } __attribute__((packed));
 
+/**
+ * Deferred control data set acknowledge and completion, ABI3.19.
+ * The error of the acknowledge tells if the command was queued, the error of
+ * the completion is the result of the command.
+ */
+struct sof_ipc_ctrl_deferred {
+	struct sof_ipc_reply rhdr;
+	uint32_t comp_id;
+	uint32_t seq;		/**< matches acknowledge with completion */
+
+	/* reserved for future use */
+	uint32_t reserved[2];
+} __attribute__((packed));
+
 /** Event type */
 enum sof_ipc_ctrl_event_type {
 	SOF_CTRL_EVENT_GENERIC = 0,	/**< generic event */
@@ -231,6 +231,8 @@
 #define SOF_IPC_COMP_SET_DATA			SOF_CMD_TYPE(0x003)
 #define SOF_IPC_COMP_GET_DATA			SOF_CMD_TYPE(0x004)
 #define SOF_IPC_COMP_NOTIFICATION		SOF_CMD_TYPE(0x005)
+#define SOF_IPC_COMP_DEFERRED			SOF_CMD_TYPE(0x006) /**< ABI3.19 */
+#define SOF_IPC_COMP_DEFERRED_DONE		SOF_CMD_TYPE(0x007) /**< ABI3.19 */
 
 /** @} */
 
@@ -153,4 +153,18 @@ struct sof_ipc_stream_posn {
 	int32_t xrun_size;	/**< XRUN size in bytes */
 } __attribute__((packed));
 
+/**
+ * Position record polled by the host without IPC. The stream position
+ * offset given to the host points to the posn member, so the record starts
+ * 8 bytes before it. FW makes seq odd while it updates posn. The host reads
+ * seq, copies posn and reads seq again, the copy is valid if seq was even
+ * and didn't change. FW uses the record only when it sets
+ * SOF_IPC_INFO_POSN_SEQ in the fw_ready flags. ABI3.21.
+ */
+struct sof_ipc_stream_posn_seq {
+	uint32_t seq;		/**< update sequence number */
+	uint32_t reserved;
+	struct sof_ipc_stream_posn posn;
+} __attribute__((packed));
+
 #endif /* __IPC_STREAM_H__ */
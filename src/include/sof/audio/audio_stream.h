@@ -568,6 +568,10 @@ static inline int audio_stream_copy(const struct audio_stream *source,
 	uint32_t bytes_copied;
 	int ret;
 
+	/* in-place buffers already hold the data */
+	if (src == snk)
+		return samples;
+
 	while (bytes) {
 		bytes_src = audio_stream_bytes_without_wrap(source, src);
 		bytes_snk = audio_stream_bytes_without_wrap(sink, snk);
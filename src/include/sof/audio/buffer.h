@@ -83,6 +83,16 @@ extern struct tr_ctx buffer_tr;
 #define BUFF_PARAMS_RATE	BIT(2)
 #define BUFF_PARAMS_CHANNELS	BIT(3)
 
+#if CONFIG_PIPELINE_BUFFER_PLANNER
+/* data storage shared by buffers which are never live at the same time */
+struct buffer_arena {
+	void *addr;
+	uint32_t size;
+	uint32_t caps;
+	uint32_t users;		/* number of buffers using the storage */
+};
+#endif
+
 /* audio component buffer - connects 2 audio components together in pipeline */
 struct comp_buffer {
 	spinlock_t *lock;		/* locking mechanism */
@@ -112,6 +122,21 @@ struct comp_buffer {
 
 	bool hw_params_configured; /**< indicates whether hw params were set */
 	bool walking;	/**< indicates if the buffer is being walking */
+
+#if CONFIG_PIPELINE_BUFFER_PLANNER
+	struct buffer_arena *arena;	/**< shared storage, NULL if private */
+#endif
+
+#if CONFIG_PIPELINE_CACHE_BATCH
+	uint32_t inv_bytes;	/**< data from r_ptr already invalidated */
+#endif
+
+#if CONFIG_COMP_INPLACE
+	/* buffers of in-place components sharing the storage */
+	struct comp_buffer *inplace_source;	/**< upstream buffer */
+	struct comp_buffer *inplace_sink;	/**< downstream buffer */
+	void *private_addr;	/**< own storage while using the upstream one */
+#endif
 };
 
 struct buffer_cb_transact {
@@ -159,18 +184,47 @@ struct comp_buffer *buffer_new(struct sof_ipc_buffer *desc);
 int buffer_set_size(struct comp_buffer *buffer, uint32_t size);
 void buffer_free(struct comp_buffer *buffer);
 
+#if CONFIG_PIPELINE_BUFFER_PLANNER
+/* moves buffer data to the arena, the private storage is freed */
+void buffer_attach_arena(struct comp_buffer *buffer,
+			 struct buffer_arena *arena);
+
+/* moves buffer data from the arena to new private storage */
+int buffer_detach_arena(struct comp_buffer *buffer);
+#endif
+
+#if CONFIG_COMP_INPLACE
+/* sink buffer of an in-place component starts to use the source storage */
+void buffer_inplace_link(struct comp_buffer *source, struct comp_buffer *sink);
+
+/* buffer returns to its own storage */
+void buffer_inplace_unlink(struct comp_buffer *buffer);
+#endif
+
 /* called by a component after producing data into this buffer */
 void comp_update_buffer_produce(struct comp_buffer *buffer, uint32_t bytes);
 
 /* called by a component after consuming data from this buffer */
 void comp_update_buffer_consume(struct comp_buffer *buffer, uint32_t bytes);
 
+#if CONFIG_PIPELINE_CACHE_BATCH
+/* invalidates all the available data once it's first requested */
+void buffer_invalidate_batch(struct comp_buffer *buffer, uint32_t bytes);
+
+/* accounts the request, data is written back when it's produced */
+void buffer_writeback_batch(struct comp_buffer *buffer, uint32_t bytes);
+#endif
+
 static inline void buffer_invalidate(struct comp_buffer *buffer, uint32_t bytes)
 {
 	if (!buffer->inter_core)
 		return;
 
+#if CONFIG_PIPELINE_CACHE_BATCH
+	buffer_invalidate_batch(buffer, bytes);
+#else
 	audio_stream_invalidate(&buffer->stream, bytes);
+#endif
 }
 
 static inline void buffer_writeback(struct comp_buffer *buffer, uint32_t bytes)
@@ -178,7 +232,11 @@ static inline void buffer_writeback(struct comp_buffer *buffer, uint32_t bytes)
 	if (!buffer->inter_core)
 		return;
 
+#if CONFIG_PIPELINE_CACHE_BATCH
+	buffer_writeback_batch(buffer, bytes);
+#else
 	audio_stream_writeback(&buffer->stream, bytes);
+#endif
 }
 
 /**
@@ -240,6 +298,10 @@ static inline void buffer_reset_pos(struct comp_buffer *buffer, void *data)
 	/* reset rw pointers and avail/free bytes counters */
 	audio_stream_reset(&buffer->stream);
 
+#if CONFIG_PIPELINE_CACHE_BATCH
+	buffer->inv_bytes = 0;
+#endif
+
 	/* clear buffer contents */
 	buffer_zero(buffer);
 
@@ -253,6 +315,10 @@ static inline void buffer_init(struct comp_buffer *buffer, uint32_t size,
 
 	/* addr should be set in alloc function */
 	audio_stream_init(&buffer->stream, buffer->stream.addr, size);
+
+#if CONFIG_PIPELINE_CACHE_BATCH
+	buffer->inv_bytes = 0;
+#endif
 }
 
 static inline void buffer_reset_params(struct comp_buffer *buffer, void *data)
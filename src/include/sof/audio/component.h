@@ -116,6 +116,20 @@ struct dai_hw_params;
 #define COMP_ATTR_HOST_BUFFER	1	/**< Comp host buffer attribute */
 /** @}*/
 
+/** \name Component driver capabilities
+ *  @{
+ */
+/** Reads each sample before writing the output sample to the same place,
+ *  so source and sink buffer can share the storage.
+ */
+#define COMP_DRV_INPLACE	BIT(0)
+/** Consumes all the data of the source buffer in each copy when the sink
+ *  buffer has room for the output, so the source buffer holds no data
+ *  between the copies of the pipeline.
+ */
+#define COMP_DRV_DRAIN		BIT(1)
+/** @}*/
+
 /** \name Trace macros
  *  @{
  */
@@ -327,6 +341,17 @@ struct comp_ops {
 	 */
 	int (*copy)(struct comp_dev *dev);
 
+	/**
+	 * Processes frames from source to sink stream without committing
+	 * the buffers, used when the component is fused with its neighbours.
+	 * @param dev Component device.
+	 * @param source Source stream, read from its read pointer.
+	 * @param sink Sink stream, written from its write pointer.
+	 * @param frames Number of frames to process.
+	 */
+	int (*process)(struct comp_dev *dev, const struct audio_stream *source,
+		       struct audio_stream *sink, uint32_t frames);
+
 	/**
 	 * Retrieves component rendering position.
 	 * @param dev Component device.
@@ -389,6 +414,7 @@ struct comp_driver {
 	const struct sof_uuid *uid;	/**< Address to UUID value */
 	struct tr_ctx *tctx;		/**< Pointer to trace context */
 	struct comp_ops ops;		/**< component operations */
+	uint32_t flags;			/**< COMP_DRV_ capabilities */
 };
 
 /** \brief Holds constant pointer to component driver */
@@ -446,6 +472,10 @@ struct comp_dev {
 	struct perf_cnt_data pcd;
 #endif
 
+#if CONFIG_PIPELINE_FUSION
+	struct comp_fusion *fusion;	/**< fused run, NULL if not fused */
+#endif
+
 	/**
 	 * IPC config object header - MUST be at end as it's
 	 * variable size/type
@@ -765,6 +795,27 @@ static inline int comp_get_state(struct comp_dev *req_dev, struct comp_dev *dev)
 
 struct comp_data_blob_handler;
 
+/**
+ * Optional callbacks of a data blob handler, allow a component to build the
+ * data derived from a blob, e.g. filter coefficients and delay lines, in the
+ * IPC context instead of the copy() of the next period.
+ */
+struct comp_data_blob_ops {
+	/**
+	 * Prepares the data for the fully received blob while streaming,
+	 * an error rejects the blob.
+	 */
+	int (*prepare)(struct comp_dev *dev, void *data, size_t size,
+		       void **prepared);
+	/**
+	 * Called from comp_get_data_blob() when switching to the new blob,
+	 * exchanges the data in use with the prepared one.
+	 */
+	void (*swap)(struct comp_dev *dev, void *prepared);
+	/** Frees the prepared or swapped out data. */
+	void (*free)(struct comp_dev *dev, void *prepared);
+};
+
 /**
  * Returns data blob. In case when new data blob is available it returns new
  * one. Function returns also data blob size in case when size pointer is given.
@@ -822,6 +873,16 @@ int comp_data_blob_get_cmd(struct comp_data_blob_handler *blob_handler,
  */
 struct comp_data_blob_handler *comp_data_blob_handler_new(struct comp_dev *dev);
 
+/**
+ * Sets callbacks preparing the data derived from a new blob outside of
+ * copy(), see struct comp_data_blob_ops.
+ *
+ * @param blob_handler Data blob handler
+ * @param ops Callbacks
+ */
+void comp_data_blob_set_ops(struct comp_data_blob_handler *blob_handler,
+			    const struct comp_data_blob_ops *ops);
+
 /**
  * Free data blob handler.
  *
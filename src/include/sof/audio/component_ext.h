@@ -17,6 +17,7 @@
 #define __SOF_AUDIO_COMPONENT_INT_H__
 
 #include <sof/audio/component.h>
+#include <sof/audio/fusion.h>
 #include <sof/drivers/idc.h>
 #include <sof/list.h>
 #include <ipc/topology.h>
@@ -202,7 +203,12 @@ static inline int comp_copy(struct comp_dev *dev)
 	/* copy only if we are the owner of the component */
 	if (cpu_is_me(dev->comp.core)) {
 		perf_cnt_init(&dev->pcd);
+#if CONFIG_PIPELINE_FUSION
+		ret = dev->fusion ? comp_fusion_copy(dev) :
+			dev->drv->ops.copy(dev);
+#else
 		ret = dev->drv->ops.copy(dev);
+#endif
 		perf_cnt_stamp(&dev->pcd, comp_perf_info, dev);
 	}
 	comp_shared_commit(dev);
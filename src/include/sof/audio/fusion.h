@@ -0,0 +1,57 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+/**
+ * \file include/sof/audio/fusion.h
+ * \brief Fused processing of adjacent components
+ *
+ * A run of adjacent components with the process operation is copied by its
+ * first component in blocks of frames, which pass all the components of the
+ * run through two small scratch blocks. Data of the intermediate buffers is
+ * neither written nor committed.
+ */
+
+#ifndef __SOF_AUDIO_FUSION_H__
+#define __SOF_AUDIO_FUSION_H__
+
+#include <stdint.h>
+
+struct comp_dev;
+struct pipeline;
+
+/** \brief Max number of components in a fused run. */
+#define COMP_FUSION_MAX		8
+
+/** \brief Frames processed by all components of a run at once. */
+#define COMP_FUSION_BLOCK_FRAMES	64
+
+/** \brief Fused run of components. */
+struct comp_fusion {
+	struct comp_dev *comps[COMP_FUSION_MAX];	/**< in copy order */
+	int num_comps;
+	void *scratch[2];	/**< blocks between the components */
+	uint32_t scratch_size;
+};
+
+/**
+ * \brief Fuses the runs of adjacent prepared components of the pipeline.
+ * \param[in] p Pipeline.
+ */
+void pipeline_fusion_build(struct pipeline *p);
+
+/**
+ * \brief Splits the fused run of the component back to components.
+ * \param[in] dev Any component of the run.
+ */
+void pipeline_fusion_free(struct comp_dev *dev);
+
+/**
+ * \brief Copies the fused run, called for each component of the run.
+ * \param[in] dev Component of the run.
+ * \return Error code.
+ */
+int comp_fusion_copy(struct comp_dev *dev);
+
+#endif /* __SOF_AUDIO_FUSION_H__ */
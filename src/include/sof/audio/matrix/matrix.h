@@ -0,0 +1,121 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_AUDIO_MATRIX_MATRIX_H__
+#define __SOF_AUDIO_MATRIX_MATRIX_H__
+
+#include <sof/bit.h>
+#include <sof/platform.h>
+#include <ipc/stream.h>
+#include <user/matrix.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct audio_stream;
+struct comp_dev;
+
+#define MATRIX_MAX_TERMS (PLATFORM_MAX_CHANNELS * PLATFORM_MAX_CHANNELS)
+
+/* Coefficient of 1.0, copied outputs have only this gain */
+#define MATRIX_COEF_UNITY BIT(SOF_MATRIX_COEF_QY)
+
+/* Output channel value of src_channel[] for silent outputs */
+#define MATRIX_CHANNEL_NONE -1
+
+typedef void (*matrix_func)(const struct comp_dev *dev,
+			    const struct audio_stream *source,
+			    struct audio_stream *sink,
+			    uint32_t frames);
+
+/* Non-zero coefficient of the matrix */
+struct matrix_term {
+	uint8_t in_channel;			/**< source channel */
+	int16_t coef;				/**< gain in Q2.14 */
+};
+
+/* Mixing plan built from the configuration blob */
+struct matrix_plan {
+	int16_t coef[MATRIX_MAX_TERMS];		/**< out x in gains, Q2.14 */
+	struct matrix_term term[MATRIX_MAX_TERMS]; /**< non-zero gains by output */
+	uint8_t term_count[PLATFORM_MAX_CHANNELS]; /**< non-zero gains of output */
+	int8_t src_channel[PLATFORM_MAX_CHANNELS]; /**< copied input channel */
+	uint16_t in_channels;			/**< source channels count */
+	uint16_t out_channels;			/**< sink channels count */
+	matrix_func func;			/**< processing function */
+};
+
+/* Matrix component private data */
+struct matrix_comp_data {
+	struct matrix_plan plan;		/**< mixing plan in use */
+	struct comp_data_blob_handler *model_handler;
+	struct sof_matrix_config *config;	/**< pointer to setup blob */
+	enum sof_ipc_frame source_format;	/**< source frame format */
+	enum sof_ipc_frame sink_format;		/**< sink frame format */
+};
+
+/* Processing function for a frame format */
+struct matrix_proc_fnmap {
+	enum sof_ipc_frame frame_fmt;
+	matrix_func matrix_proc_func;
+};
+
+/* Processing function for a frame format and fixed channel counts */
+struct matrix_shape_fnmap {
+	enum sof_ipc_frame frame_fmt;
+	uint16_t in_channels;
+	uint16_t out_channels;
+	matrix_func matrix_proc_func;
+};
+
+extern const struct matrix_proc_fnmap matrix_copy_fnmap[];
+extern const size_t matrix_copy_fncount;
+extern const struct matrix_shape_fnmap matrix_dense_fnmap[];
+extern const size_t matrix_dense_fncount;
+
+void matrix_identity(const struct comp_dev *dev,
+		     const struct audio_stream *source,
+		     struct audio_stream *sink, uint32_t frames);
+
+void matrix_generic(const struct comp_dev *dev,
+		    const struct audio_stream *source,
+		    struct audio_stream *sink, uint32_t frames);
+
+/**
+ * \brief Returns matrix function copying channels without gains.
+ */
+static inline matrix_func matrix_find_copy_func(enum sof_ipc_frame fmt)
+{
+	int i;
+
+	for (i = 0; i < matrix_copy_fncount; i++)
+		if (fmt == matrix_copy_fnmap[i].frame_fmt)
+			return matrix_copy_fnmap[i].matrix_proc_func;
+
+	return NULL;
+}
+
+/**
+ * \brief Returns matrix function optimized for the channel counts.
+ */
+static inline matrix_func matrix_find_dense_func(enum sof_ipc_frame fmt,
+						 uint16_t in_channels,
+						 uint16_t out_channels)
+{
+	int i;
+
+	for (i = 0; i < matrix_dense_fncount; i++)
+		if (fmt == matrix_dense_fnmap[i].frame_fmt &&
+		    in_channels == matrix_dense_fnmap[i].in_channels &&
+		    out_channels == matrix_dense_fnmap[i].out_channels)
+			return matrix_dense_fnmap[i].matrix_proc_func;
+
+	return NULL;
+}
+
+#ifdef UNIT_TEST
+void sys_comp_matrix_init(void);
+#endif
+
+#endif /* __SOF_AUDIO_MATRIX_MATRIX_H__ */
@@ -20,6 +20,7 @@
 #include <user/trace.h>
 #include <errno.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 struct comp_buffer;
@@ -86,8 +87,31 @@ extern struct tr_ctx pipe_tr;
 #define PPL_DIR_DOWNSTREAM	0
 #define PPL_DIR_UPSTREAM	1
 
+/* position slot in the stream region and position offset in the slot */
+#if CONFIG_STREAM_POSN_SEQLOCK
+#define PPL_POSN_SLOT_SIZE	sizeof(struct sof_ipc_stream_posn_seq)
+#define PPL_POSN_SLOT_POSN	offsetof(struct sof_ipc_stream_posn_seq, posn)
+#else
+#define PPL_POSN_SLOT_SIZE	sizeof(struct sof_ipc_stream_posn)
+#define PPL_POSN_SLOT_POSN	0
+#endif
+
 #define PPL_POSN_OFFSETS \
-	(MAILBOX_STREAM_SIZE / sizeof(struct sof_ipc_stream_posn))
+	(MAILBOX_STREAM_SIZE / PPL_POSN_SLOT_SIZE)
+
+#if CONFIG_PIPELINE_CACHE_BATCH
+/* number of passes the cache statistics are averaged over */
+#define PIPELINE_CACHE_STATS_PASSES	1024
+
+/* data cache lines of buffers shared with other cores */
+struct pipeline_cache_stats {
+	uint32_t inv_lines;	/* invalidated lines */
+	uint32_t inv_req;	/* lines requested to be invalidated */
+	uint32_t wb_lines;	/* written back lines */
+	uint32_t wb_req;	/* lines requested to be written back */
+	uint32_t passes;	/* pipeline copies since the last trace */
+};
+#endif
 
 /*
  * Audio pipeline.
@@ -115,6 +139,10 @@ struct pipeline {
 	/* position update */
 	uint32_t posn_offset;		/* position update array offset*/
 	struct ipc_msg *msg;
+
+#if CONFIG_PIPELINE_CACHE_BATCH
+	struct pipeline_cache_stats cache;	/* cache maintenance */
+#endif
 };
 
 /* static pipeline */
@@ -155,7 +183,8 @@ static inline int pipeline_posn_offset_get(uint32_t *posn_offset)
 
 	for (i = 0; i < PPL_POSN_OFFSETS; ++i) {
 		if (!pipeline_posn->posn_offset[i]) {
-			*posn_offset = i * sizeof(struct sof_ipc_stream_posn);
+			*posn_offset = i * PPL_POSN_SLOT_SIZE +
+				PPL_POSN_SLOT_POSN;
 			pipeline_posn->posn_offset[i] = true;
 			ret = 0;
 			break;
@@ -176,7 +205,7 @@ static inline int pipeline_posn_offset_get(uint32_t *posn_offset)
 static inline void pipeline_posn_offset_put(uint32_t posn_offset)
 {
 	struct pipeline_posn *pipeline_posn = pipeline_posn_get();
-	int i = posn_offset / sizeof(struct sof_ipc_stream_posn);
+	int i = posn_offset / PPL_POSN_SLOT_SIZE;
 
 	spin_lock(&pipeline_posn->lock);
 
@@ -200,6 +229,16 @@ static inline bool pipeline_is_timer_driven(struct pipeline *p)
 	return p->ipc_pipe.time_domain == SOF_TIME_DOMAIN_TIMER;
 }
 
+/* checks if pipeline has a relaxed deadline and runs in deep buffer mode */
+static inline bool pipeline_is_deep_buffer(struct pipeline *p)
+{
+#if CONFIG_LL_TICK_COALESCING
+	return p->ipc_pipe.period >= CONFIG_PIPELINE_DEEP_BUFFER_PERIOD;
+#else
+	return false;
+#endif
+}
+
 /* checks if pipeline is scheduled on this core */
 static inline bool pipeline_is_this_cpu(struct pipeline *p)
 {
@@ -219,6 +258,14 @@ int pipeline_connect(struct comp_dev *comp, struct comp_buffer *buffer,
 int pipeline_complete(struct pipeline *p, struct comp_dev *source,
 		      struct comp_dev *sink);
 
+#if CONFIG_PIPELINE_BUFFER_PLANNER
+/* share storage of intermediate buffers which are never live together */
+void pipeline_buffers_plan(struct pipeline *p);
+
+/* moves shared source buffers still holding data to private storage */
+int pipeline_buffers_check(struct comp_dev *dev);
+#endif
+
 /* pipeline parameters */
 int pipeline_params(struct pipeline *p, struct comp_dev *cd,
 		    struct sof_ipc_pcm_params *params);
@@ -248,6 +295,10 @@ void pipeline_schedule_copy(struct pipeline *p, uint64_t start);
 void pipeline_get_timestamp(struct pipeline *p, struct comp_dev *host_dev,
 			    struct sof_ipc_stream_posn *posn);
 
+/* write stream position to the host visible position slot */
+void pipeline_posn_write(struct pipeline *p,
+			 const struct sof_ipc_stream_posn *posn);
+
 /* notify host that we have XRUN */
 void pipeline_xrun(struct pipeline *p, struct comp_dev *dev, int32_t bytes);
 
@@ -11,7 +11,11 @@
 #include <stddef.h>
 #include <stdint.h>
 
+struct src_stage;
+
 struct src_param {
+	struct src_stage *stage1;
+	struct src_stage *stage2;
 	int fir_s1;
 	int fir_s2;
 	int out_s1;
@@ -23,8 +27,8 @@ struct src_param {
 	int blk_out;
 	int stage1_times;
 	int stage2_times;
-	int idx_in;
-	int idx_out;
+	int fs_in;
+	int fs_out;
 	int nch;
 };
 
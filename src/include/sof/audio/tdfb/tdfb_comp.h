@@ -13,6 +13,9 @@
 #include <sof/math/fir_generic.h>
 #include <sof/math/fir_hifi2ep.h>
 #include <sof/math/fir_hifi3.h>
+#if CONFIG_COMP_TDFB_FREQ
+#include <sof/math/fft.h>
+#endif
 #include <user/tdfb.h>
 
 /* Select optimized code variant when xt-xcc compiler is used */
@@ -39,6 +42,26 @@
 #define TDFB_IN_BUF_LENGTH (2 * PLATFORM_MAX_CHANNELS)
 #define TDFB_OUT_BUF_LENGTH (2 * PLATFORM_MAX_CHANNELS)
 
+/* Frames processed at once by the generic filter bank, must be even */
+#define TDFB_BLOCK_FRAMES 64
+
+#if CONFIG_COMP_TDFB_FREQ
+/* Overlap-save filter bank state for SOF_TDFB_MODE_FREQ */
+struct tdfb_freq_data {
+	struct fft_plan plan;
+	struct icomplex32 *spec;	    /**< input channel spectrum */
+	struct icomplex32 *mix[PLATFORM_MAX_CHANNELS]; /**< out spectrum */
+	int32_t *in[PLATFORM_MAX_CHANNELS]; /**< input ch FFT window */
+	int32_t *out;			    /**< hop frames of output */
+	int16_t *weights[SOF_TDFB_FIR_MAX_COUNT]; /**< complex weights */
+	int out_shift[SOF_TDFB_FIR_MAX_COUNT]; /**< weights output shift */
+	int fft_size;			    /**< FFT size in frames */
+	int hop;			    /**< new frames per FFT */
+	int fill;			    /**< frames in current hop */
+	void *buffers;			    /**< allocated RAM */
+};
+#endif
+
 /* TDFB component private data */
 
 struct tdfb_comp_data {
@@ -53,12 +76,54 @@ struct tdfb_comp_data {
 	int16_t *output_stream_mix;         /**< for each FIR define stream */
 	size_t fir_delay_size;              /**< allocated size */
 	bool config_ready;                  /**< set when fully received */
+	int16_t mix_idx[SOF_TDFB_FIR_MAX_COUNT][PLATFORM_MAX_CHANNELS];
+					    /**< out chs of each filter */
+	int16_t mix_count[SOF_TDFB_FIR_MAX_COUNT]; /**< out chs count */
+#if CONFIG_COMP_TDFB_FREQ
+	struct tdfb_freq_data *freq;	    /**< set in frequency mode */
+#endif
+#if TDFB_GENERIC
+	int32_t *delay[PLATFORM_MAX_CHANNELS]; /**< input ch shared delay */
+	int delay_history[PLATFORM_MAX_CHANNELS]; /**< past samples in delay */
+	int32_t out_block[PLATFORM_MAX_CHANNELS * TDFB_BLOCK_FRAMES];
+					    /**< output block mix buffer */
+#endif
 	void (*tdfb_func)(struct tdfb_comp_data *cd,
 			  const struct audio_stream *source,
 			  struct audio_stream *sink,
 			  int frames);
 };
 
+#if TDFB_GENERIC
+int tdfb_shared_delay_size(struct tdfb_comp_data *cd);
+
+void tdfb_shared_delay_init(struct tdfb_comp_data *cd);
+#endif
+
+#if CONFIG_COMP_TDFB_FREQ
+int tdfb_freq_setup(struct tdfb_comp_data *cd, int source_nch);
+
+void tdfb_freq_free(struct tdfb_comp_data *cd);
+
+#if CONFIG_FORMAT_S16LE
+void tdfb_freq_s16(struct tdfb_comp_data *cd,
+		   const struct audio_stream *source,
+		   struct audio_stream *sink, int frames);
+#endif
+
+#if CONFIG_FORMAT_S24LE
+void tdfb_freq_s24(struct tdfb_comp_data *cd,
+		   const struct audio_stream *source,
+		   struct audio_stream *sink, int frames);
+#endif
+
+#if CONFIG_FORMAT_S32LE
+void tdfb_freq_s32(struct tdfb_comp_data *cd,
+		   const struct audio_stream *source,
+		   struct audio_stream *sink, int frames);
+#endif
+#endif /* CONFIG_COMP_TDFB_FREQ */
+
 #if CONFIG_FORMAT_S16LE
 void tdfb_fir_s16(struct tdfb_comp_data *cd,
 		  const struct audio_stream *source,
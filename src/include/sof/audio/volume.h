@@ -22,10 +22,12 @@
 #include <sof/trace/trace.h>
 #include <ipc/stream.h>
 #include <user/trace.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
 struct comp_buffer;
+struct comp_data;
 struct sof_ipc_ctrl_value_chan;
 
 #define CONFIG_GENERIC
@@ -45,21 +47,23 @@ struct sof_ipc_ctrl_value_chan;
 //** \brief Volume gain Qx.y fractional y number of bits. */
 #define VOL_QXY_Y 16
 
+/** \brief Volume ramp gain fraction bits added to the Q8.16 gain. */
+#define VOL_RAMP_FRAC_BITS	16
+
 /**
- * \brief Volume ramp update rate in microseconds.
- * Update volume gain value every 125 to 1000 us. The faster gain ramps need
- * higher update rate to avoid annoying zipper noise sound. The below
- * values were tested subjectively for constraint of 125 microseconds
- * multiple gain update rate.
+ * \brief Exponential ramp lowest gain, about -60 dB.
+ * Exponential ramps from mute start at this gain and ramps to mute end at
+ * it, the gain jumps from or to zero.
  */
-#define VOL_RAMP_UPDATE_SLOWEST_US	1000
-#define VOL_RAMP_UPDATE_SLOW_US		500
-#define VOL_RAMP_UPDATE_FAST_US		250
-#define VOL_RAMP_UPDATE_FASTEST_US	125
+#define VOL_RAMP_LOG_FLOOR	(VOL_ZERO_DB >> 10)
 
-#define VOL_RAMP_UPDATE_THRESHOLD_SLOW_MS	128
-#define VOL_RAMP_UPDATE_THRESHOLD_FAST_MS	64
-#define VOL_RAMP_UPDATE_THRESHOLD_FASTEST_MS	32
+/**
+ * \brief Longest wait for zero crossing of a channel.
+ * With zero crossing ramps a channel keeps the previous volume until its
+ * signal crosses zero. Signals without crossings, like DC or silence with an
+ * offset, take the new volume after this time.
+ */
+#define VOL_ZC_MAX_WAIT_MS	50
 
 /**
  * \brief Volume maximum value.
@@ -82,10 +86,12 @@ typedef void (*vol_scale_func)(struct comp_dev *dev, struct audio_stream *sink,
 			       uint32_t frames);
 
 /**
- * \brief volume interface for function getting nearest zero crossing frame
+ * \brief volume interface for function finding the first zero crossing
+ * frame of each channel with a pending gain change
  */
-typedef uint32_t (*vol_zc_func)(const struct audio_stream *source,
-				uint32_t frames, int64_t *prev_sum);
+typedef void (*vol_zc_func)(struct comp_data *cd,
+			    const struct audio_stream *source,
+			    uint32_t frames);
 
 /**
  * \brief Volume component private data.
@@ -97,27 +103,35 @@ struct comp_data {
 	int32_t volume[SOF_IPC_MAX_CHANNELS];	/**< current volume */
 	int32_t tvolume[SOF_IPC_MAX_CHANNELS];	/**< target volume */
 	int32_t mvolume[SOF_IPC_MAX_CHANNELS];	/**< mute volume */
-	int32_t rvolume[SOF_IPC_MAX_CHANNELS];	/**< ramp start volume */
-	int32_t ramp_coef[SOF_IPC_MAX_CHANNELS]; /**< parameter for slope */
+	int64_t ramp_gain[SOF_IPC_MAX_CHANNELS]; /**< ramp gain in Q8.32 */
+	int64_t ramp_step[SOF_IPC_MAX_CHANNELS]; /**< linear gain step per frame */
+	int32_t ramp_ratio[SOF_IPC_MAX_CHANNELS]; /**< exp ratio - 1 in Q1.31 */
+	uint32_t ramp_left[SOF_IPC_MAX_CHANNELS]; /**< frames until target */
+	int32_t zc_volume[SOF_IPC_MAX_CHANNELS]; /**< volume until zero cross */
+	uint32_t zc_frames[SOF_IPC_MAX_CHANNELS]; /**< frames until zero cross */
+	int32_t zc_prev[SOF_IPC_MAX_CHANNELS];	/**< last scanned sample */
+	uint32_t zc_wait[SOF_IPC_MAX_CHANNELS];	/**< frames waited for cross */
+	uint32_t zc_max_wait;			/**< max frames to wait */
 	int32_t vol_min;			/**< minimum volume */
 	int32_t vol_max;			/**< maximum volume */
 	int32_t	vol_ramp_range;			/**< max ramp transition */
-	/**< max number of frames to process per ramp transition */
-	uint32_t vol_ramp_frames;
-	uint32_t vol_ramp_elapsed_frames;	/**< frames since transition */
 	uint32_t sample_rate;			/**< stream sample rate in Hz */
 	unsigned int channels;			/**< current channels count */
 	bool muted[SOF_IPC_MAX_CHANNELS];	/**< set if channel is muted */
 	bool vol_ramp_active;			/**< set if volume is ramped */
 	bool ramp_finished;			/**< control ramp launch */
+	bool ramp_log;				/**< set for exponential ramps */
+	bool zc_sync;		/**< set if zc_prev is the previous sample */
 	vol_scale_func scale_vol;	/**< volume processing function */
-	vol_zc_func zc_get; /**< function getting nearest zero crossing frame */
+	vol_scale_func ramp_vol;	/**< volume ramp processing function */
+	vol_zc_func zc_get; /**< function finding zero crossings of channels */
 };
 
 /** \brief Volume processing functions map. */
 struct comp_func_map {
 	uint16_t frame_fmt;	/**< frame format */
 	vol_scale_func func;	/**< volume processing function */
+	vol_scale_func ramp_func; /**< volume ramp processing function */
 };
 
 /** \brief Map of formats with dedicated processing functions. */
@@ -132,6 +146,69 @@ struct comp_zc_func_map {
 	vol_zc_func func;	/**< volume zc function */
 };
 
+/**
+ * \brief Returns channel volume for a frame of the processed chunk.
+ * \param[in] cd Volume component private data.
+ * \param[in] channel Channel number.
+ * \param[in] frame Frame index in the chunk.
+ *
+ * With zero crossing ramps each channel keeps the previous volume until its
+ * own zero crossing, zc_frames is zero for other ramp types.
+ */
+static inline int32_t vol_chan_gain(const struct comp_data *cd,
+				    uint32_t channel, uint32_t frame)
+{
+	return frame < cd->zc_frames[channel] ? cd->zc_volume[channel] :
+		cd->volume[channel];
+}
+
+/**
+ * \brief Returns channel ramp gain for the next frame and advances the ramp.
+ * \param[in,out] cd Volume component private data.
+ * \param[in] channel Channel number.
+ *
+ * Linear ramps add a constant step to the gain every frame, exponential ramps
+ * add the gain multiplied by the ratio. The step and the ratio are computed
+ * in volume_set_chan(). The last frame of the ramp sets the target volume so
+ * the accumulated rounding error is not left in the gain.
+ */
+static inline int32_t vol_ramp_next(struct comp_data *cd, uint32_t channel)
+{
+	int64_t gain = cd->ramp_gain[channel];
+
+	if (!cd->ramp_left[channel])
+		return gain >> VOL_RAMP_FRAC_BITS;
+
+	if (!--cd->ramp_left[channel])
+		cd->ramp_gain[channel] = (int64_t)cd->tvolume[channel] <<
+			VOL_RAMP_FRAC_BITS;
+	else if (cd->ramp_log)
+		/* Q8.24 x Q1.31 gives Q9.55, step is Q8.32 */
+		cd->ramp_gain[channel] = gain + (((gain >> 8) *
+			cd->ramp_ratio[channel]) >> 23);
+	else
+		cd->ramp_gain[channel] = gain + cd->ramp_step[channel];
+
+	return gain >> VOL_RAMP_FRAC_BITS;
+}
+
+/**
+ * \brief Returns channel volume for a frame of a ramped chunk.
+ * \param[in,out] cd Volume component private data.
+ * \param[in] channel Channel number.
+ * \param[in] frame Frame index in the chunk.
+ *
+ * Frames must be requested in order, the ramp is advanced for each of them.
+ * The ramp also continues while the channel waits for zero crossing.
+ */
+static inline int32_t vol_ramp_chan_gain(struct comp_data *cd,
+					 uint32_t channel, uint32_t frame)
+{
+	int32_t gain = vol_ramp_next(cd, channel);
+
+	return frame < cd->zc_frames[channel] ? cd->zc_volume[channel] : gain;
+}
+
 /**
  * \brief Retrievies volume processing function.
  * \param[in,out] dev Volume base component device.
@@ -155,8 +232,53 @@ static inline vol_scale_func vol_get_processing_function(struct comp_dev *dev)
 	return NULL;
 }
 
+/**
+ * \brief Retrieves volume ramp processing function.
+ * \param[in,out] dev Volume base component device.
+ */
+static inline vol_scale_func vol_get_ramp_function(struct comp_dev *dev)
+{
+	struct comp_buffer *sinkb;
+	int i;
+
+	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
+				source_list);
+
+	/* map the volume ramp function for source and sink buffers */
+	for (i = 0; i < func_count; i++) {
+		if (sinkb->stream.frame_fmt != func_map[i].frame_fmt)
+			continue;
+
+		return func_map[i].ramp_func;
+	}
+
+	return NULL;
+}
+
 #ifdef UNIT_TEST
 void sys_comp_volume_init(void);
+
+int32_t vol_log2(int32_t x);
+
+int32_t vol_expm1(int32_t x);
+
+int volume_set_chan(struct comp_dev *dev, int chan, int32_t vol,
+		    bool constant_rate_ramp);
+
+void vol_zc_update(struct comp_data *cd, uint32_t frames);
+
+#if CONFIG_FORMAT_S16LE
+void vol_zc_get_s16(struct comp_data *cd, const struct audio_stream *source,
+		    uint32_t frames);
+#endif /* CONFIG_FORMAT_S16LE */
+#if CONFIG_FORMAT_S24LE
+void vol_zc_get_s24(struct comp_data *cd, const struct audio_stream *source,
+		    uint32_t frames);
+#endif /* CONFIG_FORMAT_S24LE */
+#if CONFIG_FORMAT_S32LE
+void vol_zc_get_s32(struct comp_data *cd, const struct audio_stream *source,
+		    uint32_t frames);
+#endif /* CONFIG_FORMAT_S32LE */
 #endif
 
 #endif /* __SOF_AUDIO_VOLUME_H__ */
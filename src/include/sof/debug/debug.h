@@ -35,7 +35,8 @@
 	SOF_IPC_INFO_BUILD |						\
 	(IS_ENABLED(CONFIG_DEBUG_LOCKS) ? SOF_IPC_INFO_LOCKS : 0) |	\
 	(IS_ENABLED(CONFIG_DEBUG_LOCKS_VERBOSE) ? SOF_IPC_INFO_LOCKSV : 0) | \
-	(IS_ENABLED(CONFIG_GDB_DEBUG) ? SOF_IPC_INFO_GDB : 0)		\
+	(IS_ENABLED(CONFIG_GDB_DEBUG) ? SOF_IPC_INFO_GDB : 0) |		\
+	(IS_ENABLED(CONFIG_STREAM_POSN_SEQLOCK) ? SOF_IPC_INFO_POSN_SEQ : 0) \
 )
 
 /* dump file and line to start of mailbox or shared memory */
@@ -126,7 +127,8 @@
 (									\
 	(IS_ENABLED(CONFIG_DEBUG_LOCKS) ? SOF_IPC_INFO_LOCKS : 0) |	\
 	(IS_ENABLED(CONFIG_DEBUG_LOCKS_VERBOSE) ? SOF_IPC_INFO_LOCKSV : 0) | \
-	(IS_ENABLED(CONFIG_GDB_DEBUG) ? SOF_IPC_INFO_GDB : 0)		\
+	(IS_ENABLED(CONFIG_GDB_DEBUG) ? SOF_IPC_INFO_GDB : 0) |		\
+	(IS_ENABLED(CONFIG_STREAM_POSN_SEQLOCK) ? SOF_IPC_INFO_POSN_SEQ : 0) \
 )
 
 #define dbg() do {} while (0)
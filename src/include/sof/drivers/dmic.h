@@ -54,33 +54,12 @@
 
 #include <sof/audio/format.h>
 #include <sof/bit.h>
+#include <sof/drivers/dmic_modes.h>
 #include <sof/lib/dai.h>
 #include <sof/lib/wait.h>
 #include <sof/schedule/task.h>
 #include <stdint.h>
 
-/* Parameters used in modes computation */
-#define DMIC_HW_BITS_CIC		26
-#define DMIC_HW_BITS_FIR_COEF		20
-#define DMIC_HW_BITS_FIR_GAIN		20
-#define DMIC_HW_BITS_FIR_INPUT		22
-#define DMIC_HW_BITS_FIR_OUTPUT		24
-#define DMIC_HW_BITS_FIR_INTERNAL	26
-#define DMIC_HW_BITS_GAIN_OUTPUT	22
-#define DMIC_HW_FIR_LENGTH_MAX		250
-#define DMIC_HW_CIC_SHIFT_MIN		-8
-#define DMIC_HW_CIC_SHIFT_MAX		4
-#define DMIC_HW_FIR_SHIFT_MIN		0
-#define DMIC_HW_FIR_SHIFT_MAX		8
-#define DMIC_HW_CIC_DECIM_MIN		5
-#define DMIC_HW_CIC_DECIM_MAX		31 /* Note: Limited by BITS_CIC */
-#define DMIC_HW_FIR_DECIM_MIN		2
-#define DMIC_HW_FIR_DECIM_MAX		20 /* Note: Practical upper limit */
-#define DMIC_HW_SENS_Q28		Q_CONVERT_FLOAT(1.0, 28) /* Q1.28 */
-#define DMIC_HW_PDM_CLK_MIN		100000 /* Note: Practical min value */
-#define DMIC_HW_DUTY_MIN		20 /* Note: Practical min value */
-#define DMIC_HW_DUTY_MAX		80 /* Note: Practical max value */
-
 /* DMIC register offsets */
 
 /* Global registers */
@@ -0,0 +1,85 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+/* DMIC decimation modes search. The search depends only on the requested
+ * rates and microphone constraints and on the decimator capabilities, so
+ * it can be run and tested without the DMIC hardware.
+ */
+
+#ifndef __SOF_DRIVERS_DMIC_MODES_H__
+#define __SOF_DRIVERS_DMIC_MODES_H__
+
+#include <sof/audio/coefficients/pdm_decim/pdm_decim_fir.h>
+#include <sof/audio/format.h>
+#include <stdint.h>
+
+/* Parameters used in modes computation */
+#define DMIC_HW_BITS_CIC		26
+#define DMIC_HW_BITS_FIR_COEF		20
+#define DMIC_HW_BITS_FIR_GAIN		20
+#define DMIC_HW_BITS_FIR_INPUT		22
+#define DMIC_HW_BITS_FIR_OUTPUT		24
+#define DMIC_HW_BITS_FIR_INTERNAL	26
+#define DMIC_HW_BITS_GAIN_OUTPUT	22
+#define DMIC_HW_FIR_LENGTH_MAX		250
+#define DMIC_HW_CIC_SHIFT_MIN		-8
+#define DMIC_HW_CIC_SHIFT_MAX		4
+#define DMIC_HW_FIR_SHIFT_MIN		0
+#define DMIC_HW_FIR_SHIFT_MAX		8
+#define DMIC_HW_CIC_DECIM_MIN		5
+#define DMIC_HW_CIC_DECIM_MAX		31 /* Note: Limited by BITS_CIC */
+#define DMIC_HW_FIR_DECIM_MIN		2
+#define DMIC_HW_FIR_DECIM_MAX		20 /* Note: Practical upper limit */
+#define DMIC_HW_SENS_Q28		Q_CONVERT_FLOAT(1.0, 28) /* Q1.28 */
+#define DMIC_HW_PDM_CLK_MIN		100000 /* Note: Practical min value */
+#define DMIC_HW_DUTY_MIN		20 /* Note: Practical min value */
+#define DMIC_HW_DUTY_MAX		80 /* Note: Practical max value */
+
+/* Internal precision in gains computation, e.g. Q4.28 in int32_t */
+#define DMIC_FIR_SCALE_Q 28
+
+/* Number of remembered search results */
+#define DMIC_MODES_CACHE_SIZE 4
+
+/* Search request, also the key of the results cache */
+struct dmic_modes_request {
+	uint32_t ioclk;		/* DMIC IO clock in Hz */
+	uint32_t fs_a;		/* FIFO A rate in Hz, zero if not used */
+	uint32_t fs_b;		/* FIFO B rate in Hz, zero if not used */
+	uint32_t pdmclk_min;	/* Microphone clock min in Hz */
+	uint32_t pdmclk_max;	/* Microphone clock max in Hz */
+	uint32_t duty_min;	/* Microphone clock duty cycle min in % */
+	uint32_t duty_max;	/* Microphone clock duty cycle max in % */
+};
+
+struct dmic_configuration {
+	struct pdm_decim *fir_a;
+	struct pdm_decim *fir_b;
+	int clkdiv;
+	int mcic;
+	int mfir_a;
+	int mfir_b;
+	int cic_shift;
+	int fir_a_shift;
+	int fir_b_shift;
+	int fir_a_length;
+	int fir_b_length;
+	int32_t fir_a_scale;
+	int32_t fir_b_scale;
+};
+
+/* Runs the full search and returns in cfg the selected decimators
+ * configuration for FIFOs A and B.
+ */
+int dmic_modes_search(const struct dmic_modes_request *req,
+		      struct dmic_configuration *cfg);
+
+/* As dmic_modes_search() but returns a remembered result if the same
+ * request has been searched before.
+ */
+int dmic_modes_get(const struct dmic_modes_request *req,
+		   struct dmic_configuration *cfg);
+
+#endif /* __SOF_DRIVERS_DMIC_MODES_H__ */
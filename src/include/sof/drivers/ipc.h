@@ -40,6 +40,7 @@ struct sof_ipc_host_buffer;
 struct sof_ipc_pipe_comp_connect;
 struct sof_ipc_pipe_new;
 struct sof_ipc_stream_posn;
+struct ipc_deferred;
 struct ipc_msg;
 
 #define COMP_TYPE_COMPONENT	1
@@ -100,6 +101,10 @@ struct ipc {
 	/* processing task */
 	struct task ipc_task;
 
+#if CONFIG_IPC_DEFERRED
+	struct ipc_deferred *deferred;	/* commands with deferred replies */
+#endif
+
 	void *private;
 };
 
@@ -232,6 +237,35 @@ enum task_state ipc_platform_do_cmd(void *data);
 
 void ipc_platform_complete_cmd(void *data);
 
+#if CONFIG_IPC_DEFERRED
+/**
+ * \brief Initializes the queue of commands with deferred replies.
+ * @param ipc Global IPC context
+ * @return 0 if succeeded, error code otherwise.
+ */
+int ipc_deferred_init(struct ipc *ipc);
+
+/**
+ * \brief Queues or holds the command if it can't run now.
+ * @param ipc Global IPC context
+ * @param hdr IPC command header
+ * @return true if the command is not processed by ipc_cmd().
+ *
+ * Binary data sets flagged with SOF_IPC_CTRL_FLAG_DEFERRED are acknowledged
+ * and queued. Stream position and value commands of components without
+ * queued work overtake the queue, any other command is held in the mailbox
+ * without reply until the queue is drained.
+ */
+bool ipc_deferred_cmd(struct ipc *ipc, struct sof_ipc_cmd_hdr *hdr);
+
+/**
+ * \brief Checks if the last command is held until the queue is drained.
+ * @param ipc Global IPC context
+ * @return true if the host must not be told the command is done.
+ */
+bool ipc_deferred_held(struct ipc *ipc);
+#endif
+
 void ipc_free(struct ipc *ipc);
 
 void ipc_schedule_process(struct ipc *ipc);
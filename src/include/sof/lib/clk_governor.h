@@ -0,0 +1,48 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_LIB_CLK_GOVERNOR_H__
+#define __SOF_LIB_CLK_GOVERNOR_H__
+
+#include <sof/lib/clk.h>
+#include <stdint.h>
+
+/* load driven cpu clock selection, one instance per core */
+struct clk_governor {
+	int clk;			/* governed cpu clock */
+	uint32_t cur_idx;		/* frequency index in use */
+	uint32_t next_idx;		/* frequency index to switch to */
+	uint64_t window;		/* measurement window in timer ticks */
+	uint64_t window_start;		/* timer value at window start */
+	uint64_t run_start;		/* timer value at ll run start */
+	uint64_t busy;			/* ll busy ticks in the window */
+};
+
+/**
+ * \brief Selects the frequency for the measured load.
+ * \param[in] freqs Frequency table in ascending order.
+ * \param[in] num Number of frequencies in the table.
+ * \param[in] cur_idx Index of the frequency the load was measured at.
+ * \param[in] busy Busy time in the window.
+ * \param[in] elapsed Length of the window in the same unit.
+ * \param[in] headroom Utilization percentage to be kept free.
+ * \param[in] hysteresis Extra free percentage needed to go down.
+ * \return Index of the lowest frequency keeping the headroom.
+ */
+uint32_t clk_governor_select_idx(const struct freq_table *freqs, uint32_t num,
+				 uint32_t cur_idx, uint64_t busy,
+				 uint64_t elapsed, uint32_t headroom,
+				 uint32_t hysteresis);
+
+/* returns the governor of the current core, created on first call */
+struct clk_governor *clk_governor_get(void);
+
+void clk_governor_run_start(struct clk_governor *gov);
+
+void clk_governor_run_end(struct clk_governor *gov);
+
+void clk_governor_update(struct clk_governor *gov);
+
+#endif /* __SOF_LIB_CLK_GOVERNOR_H__ */
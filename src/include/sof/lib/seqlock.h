@@ -0,0 +1,54 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+/*
+ * Sequence lock for data with a single writer and lock-free readers, e.g.
+ * records in memory shared with the host. The writer makes the sequence
+ * number odd for the time of the update. A reader copies the data between
+ * reading the sequence number twice and retries if the number was odd or
+ * has changed, since then the copy may be torn.
+ */
+
+#ifndef __SOF_LIB_SEQLOCK_H__
+#define __SOF_LIB_SEQLOCK_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+static inline void seqlock_write_begin(uint32_t *seq)
+{
+	(*seq)++;
+
+	/* odd sequence is visible before the data changes */
+	__sync_synchronize();
+}
+
+static inline void seqlock_write_end(uint32_t *seq)
+{
+	/* data is complete before the sequence is even again */
+	__sync_synchronize();
+
+	(*seq)++;
+}
+
+static inline uint32_t seqlock_read_begin(const uint32_t *seq)
+{
+	uint32_t start = *seq;
+
+	__sync_synchronize();
+
+	return start;
+}
+
+/* returns true if the data read since seqlock_read_begin() is invalid */
+static inline bool seqlock_read_retry(const uint32_t *seq,
+				      uint32_t start)
+{
+	__sync_synchronize();
+
+	return (start & 1) || *seq != start;
+}
+
+#endif /* __SOF_LIB_SEQLOCK_H__ */
@@ -0,0 +1,38 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_MATH_FFT_H__
+#define __SOF_MATH_FFT_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FFT_MIN_LEN_LOG2	2
+#define FFT_MAX_LEN_LOG2	10
+
+/* Complex number with Q1.31 real and imaginary parts */
+struct icomplex32 {
+	int32_t real;
+	int32_t imag;
+};
+
+struct fft_plan {
+	uint32_t size;			/* Number of points, power of two */
+	uint32_t len_log2;		/* Base two logarithm of size */
+	struct icomplex32 *twiddle;	/* size / 2 twiddle factors */
+};
+
+/* Sets the plan and computes the twiddle factors to the caller provided
+ * array of size / 2 elements.
+ */
+int fft_plan_init(struct fft_plan *plan, struct icomplex32 *twiddle,
+		  uint32_t len_log2);
+
+/* In-place radix-2 FFT. The forward transform output is scaled by 1 / size
+ * to avoid overflow. The inverse transform is not scaled and saturates.
+ */
+void fft_execute_32(struct fft_plan *plan, struct icomplex32 *x, bool ifft);
+
+#endif /* __SOF_MATH_FFT_H__ */
@@ -0,0 +1,62 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+/**
+ * \file include/sof/pairing_heap.h
+ * \brief Intrusive min pairing heap
+ *
+ * Nodes are embedded in the queued objects, so no memory is allocated by
+ * the heap. Insert and peek of the minimum are O(1), removal of any node
+ * is O(log n) amortized. Nodes with equal keys are kept in insertion order.
+ */
+
+#ifndef __SOF_PAIRING_HEAP_H__
+#define __SOF_PAIRING_HEAP_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct pairing_heap_node {
+	struct pairing_heap_node *child;	/* first child */
+	struct pairing_heap_node *next;		/* next sibling */
+	struct pairing_heap_node *prev;		/* previous sibling or parent */
+	uint64_t key;
+	uint32_t order;				/* insertion order */
+};
+
+struct pairing_heap {
+	struct pairing_heap_node *root;
+	uint32_t order;
+	uint32_t count;
+};
+
+static inline void pairing_heap_init(struct pairing_heap *heap)
+{
+	heap->root = NULL;
+	heap->order = 0;
+	heap->count = 0;
+}
+
+static inline bool pairing_heap_is_empty(const struct pairing_heap *heap)
+{
+	return !heap->root;
+}
+
+/* returns node with the smallest key or NULL if the heap is empty */
+static inline struct pairing_heap_node *
+pairing_heap_peek(const struct pairing_heap *heap)
+{
+	return heap->root;
+}
+
+void pairing_heap_insert(struct pairing_heap *heap,
+			 struct pairing_heap_node *node, uint64_t key);
+
+/* node must be in the heap */
+void pairing_heap_remove(struct pairing_heap *heap,
+			 struct pairing_heap_node *node);
+
+#endif /* __SOF_PAIRING_HEAP_H__ */
@@ -14,6 +14,7 @@
 #include <sof/lib/cpu.h>
 #include <sof/lib/clk.h>
 #include <sof/lib/memory.h>
+#include <sof/math/numbers.h>
 #include <sof/sof.h>
 #include <sof/spinlock.h>
 #include <sof/trace/trace.h>
@@ -53,6 +54,10 @@ struct ll_schedule_domain {
 	void *priv_data;		/**< pointer to private data */
 	bool registered[CONFIG_CORE_COUNT];		/**< registered cores */
 	bool enabled[CONFIG_CORE_COUNT];		/**< enabled cores */
+#if CONFIG_LL_TICK_COALESCING
+	uint64_t next_tick[CONFIG_CORE_COUNT];	/**< earliest task start */
+	bool coalesced;			/**< ticks skipped until next run */
+#endif
 	const struct ll_schedule_domain_ops *ops;	/**< domain ops */
 };
 
@@ -60,6 +65,21 @@ struct ll_schedule_domain {
 
 #define ll_sch_domain_get_pdata(domain) ((domain)->priv_data)
 
+#if CONFIG_LL_TICK_COALESCING
+/* returns the earliest task start over the registered cores */
+static inline uint64_t domain_next_tick(struct ll_schedule_domain *domain)
+{
+	uint64_t next = UINT64_MAX;
+	int i;
+
+	for (i = 0; i < CONFIG_CORE_COUNT; i++)
+		if (domain->registered[i])
+			next = MIN(next, domain->next_tick[i]);
+
+	return next == UINT64_MAX ? 0 : next;
+}
+#endif
+
 static inline struct ll_schedule_domain *timer_domain_get(void)
 {
 	return sof_get()->platform_timer_domain;
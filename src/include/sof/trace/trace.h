@@ -87,6 +87,18 @@ static inline struct trace *trace_get(void)
 #define trace_unused(class, ctx, id_1, id_2, format, ...) \
 	UNUSED(ctx, id_1, id_2, ##__VA_ARGS__)
 
+/*
+ * Trace entry point specialized for a given argument count.
+ * _TRACE_LOG_FUNC_DECL(2) expands to declaration of
+ * void _trace_log_2(bool send_atomic, ..., uint32_t param0, uint32_t param1)
+ * so record size is known at compile time and no va_list is involved.
+ */
+#define _TRACE_LOG_FUNC_DECL(arg_count)					\
+	void META_CONCAT(_trace_log_, arg_count)(bool send_atomic,	\
+		const void *log_entry, const struct tr_ctx *ctx,	\
+		uint32_t lvl, uint32_t id_1, uint32_t id_2		\
+		META_SEQ_FROM_0_TO(arg_count, META_SEQ_STEP_param_uint32_t))
+
 struct trace_filter {
 	uint32_t uuid_id;	/**< type id, or 0 when not important */
 	int32_t comp_id;	/**< component id or -1 when not important */
@@ -139,6 +151,12 @@ void trace_init(struct sof *sof);
 void trace_log(bool send_atomic, const void *log_entry,
 	       const struct tr_ctx *ctx, uint32_t lvl, uint32_t id_1,
 	       uint32_t id_2, int arg_count, ...);
+_TRACE_LOG_FUNC_DECL(0);
+_TRACE_LOG_FUNC_DECL(1);
+_TRACE_LOG_FUNC_DECL(2);
+_TRACE_LOG_FUNC_DECL(3);
+_TRACE_LOG_FUNC_DECL(4);
+int trace_rate_limit_set(uint32_t lvl, uint32_t burst, uint32_t window_ms);
 struct sof_ipc_trace_filter_elem *trace_filter_fill(struct sof_ipc_trace_filter_elem *elem,
 						    struct sof_ipc_trace_filter_elem *end,
 						    struct trace_filter *filter);
@@ -191,6 +209,9 @@ _thrown_from_macro_BASE_LOG_in_trace_h
 #define STATIC_ASSERT_ARG_SIZE(...) \
 	META_MAP(1, trace_check_size_uint32, __VA_ARGS__)
 
+/* used with META_MAP to produce , (uint32_t)(a0) , (uint32_t)(a1) ... */
+#define _TRACE_ARG_UINT32(arg) , (uint32_t)(arg)
+
 #define _log_message(atomic, lvl, comp_class, ctx, id_1, id_2,		\
 		     format, ...)					\
 do {									\
@@ -201,9 +222,10 @@ do {									\
 			META_COUNT_VARAGS_BEFORE_COMPILE(__VA_ARGS__),	\
 		BASE_LOG_ASSERT_FAIL_MSG				\
 	);								\
-	trace_log(atomic, &log_entry, ctx, lvl, id_1, id_2,		\
-		  META_COUNT_VARAGS_BEFORE_COMPILE(__VA_ARGS__),	\
-		  ##__VA_ARGS__);					\
+	META_CONCAT(_trace_log_,					\
+		    META_COUNT_VARAGS_BEFORE_COMPILE(__VA_ARGS__))	\
+		(atomic, &log_entry, ctx, lvl, id_1, id_2		\
+		 META_MAP(1, _TRACE_ARG_UINT32, __VA_ARGS__));		\
 } while (0)
 
 #else /* CONFIG_LIBRARY */
@@ -246,6 +268,9 @@ static inline void trace_off(void) { }
 static inline void trace_init(struct sof *sof) { }
 static inline int trace_filter_update(const struct trace_filter *filter)
 	{ return 0; }
+static inline int trace_rate_limit_set(uint32_t lvl, uint32_t burst,
+				       uint32_t window_ms)
+	{ return 0; }
 
 #endif /* CONFIG_TRACE */
 
@@ -0,0 +1,38 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __USER_MATRIX_H__
+#define __USER_MATRIX_H__
+
+#include <stdint.h>
+
+#define SOF_MATRIX_MAX_SIZE 1024	/* Max size for coef data in bytes */
+#define SOF_MATRIX_COEF_QY 14		/* Coefficients are Q2.14 */
+
+/*
+ * sof_matrix_config coef[]
+ *
+ * int16_t out_ch0[in_channels];  Gains of input channels to output ch0
+ * int16_t out_ch1[in_channels];  Gains of input channels to output ch1
+ *		...
+ * int16_t out_chN[in_channels];  Gains of input channels to output chN
+ *
+ * Output rows with a single coefficient of 1.0 and zeros elsewhere, e.g.
+ * identity, channel permutation or mono to stereo duplication, are copied
+ * without multiplications. Rows of zeros output silence.
+ */
+
+struct sof_matrix_config {
+	uint32_t size;			/* Size of entire struct */
+	uint16_t in_channels;		/* Source stream channels count */
+	uint16_t out_channels;		/* Sink stream channels count */
+
+	/* reserved */
+	uint32_t reserved32[4];		/* For future */
+
+	int16_t coef[];			/* out_channels x in_channels Q2.14 */
+} __attribute__((packed));
+
+#endif /* __USER_MATRIX_H__ */
@@ -0,0 +1,67 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __USER_SRC_H__
+#define __USER_SRC_H__
+
+#include <stdint.h>
+
+#define SOF_SRC_MAX_SIZE 131072		/* Max size for coef data in bytes */
+#define SOF_SRC_MAX_CONVERSIONS 64	/* A blob can define max 64 ratios */
+#define SOF_SRC_MAX_STAGES 2		/* Conversion is done in 1 or 2 stages */
+
+/*
+ * Run-time SRC coefficients blob, ABI3.22.
+ *
+ * sof_src_config data[]
+ *
+ * Repeated num_conversions times:
+ *
+ * struct sof_src_conversion conversion;
+ * Repeated conversion.num_stages times:
+ *     struct sof_src_stage stage;
+ *     intN_t coefs[stage.filter_length];  N is coef_bits, multiple of 4 taps
+ *
+ * The stage parameters are the same as in the polyphase filter headers
+ * generated by tools/tune/src. A conversion with one stage is run as single
+ * stage SRC. The coefficients format must match the SRC build, 16 bits for
+ * the tiny set and the gcc built firmware, otherwise 32 bits.
+ */
+
+/* Polyphase filter stage, ABI3.22 */
+struct sof_src_stage {
+	int32_t idm;
+	int32_t odm;
+	int32_t num_of_subfilters;
+	int32_t subfilter_length;
+	int32_t filter_length;
+	int32_t blk_in;
+	int32_t blk_out;
+	int32_t halfband;
+	int32_t shift;
+	uint32_t reserved;		/* To keep coefs 64 bit aligned */
+} __attribute__((packed));
+
+/* Conversion between a pair of rates, ABI3.22 */
+struct sof_src_conversion {
+	uint32_t source_rate;		/* Hz */
+	uint32_t sink_rate;		/* Hz */
+	uint32_t num_stages;		/* 1 or 2 */
+	uint32_t reserved;		/* For future */
+} __attribute__((packed));
+
+/* Coefficients blob header, ABI3.22 */
+struct sof_src_config {
+	uint32_t size;			/* Size of entire struct */
+	uint16_t num_conversions;	/* Number of in/out rate pairs */
+	uint16_t coef_bits;		/* 16 or 32 */
+
+	/* reserved */
+	uint32_t reserved32[4];		/* For future */
+
+	uint32_t data[];
+} __attribute__((packed));
+
+#endif /* __USER_SRC_H__ */
@@ -10,10 +10,15 @@
 
 #include <stdint.h>
 
-#define SOF_TDFB_MAX_SIZE 4096		/* Max size for coef data in bytes */
+#define SOF_TDFB_MAX_SIZE 16384	/* Max size for coef data in bytes, ABI3.23 */
 #define SOF_TDFB_FIR_MAX_LENGTH 256	/* Max length for individual filter */
 #define SOF_TDFB_FIR_MAX_COUNT 16	/* A blob can define max 8 FIR EQs */
 #define SOF_TDFB_MAX_STREAMS 8		/* Support 1..8 sinks */
+#define SOF_TDFB_FFT_MAX_SIZE 512	/* Max FFT size in frequency mode */
+
+/* ABI3.23, older firmware runs every blob in time domain */
+#define SOF_TDFB_MODE_TIME	0	/* FIR filters in time domain */
+#define SOF_TDFB_MODE_FREQ	1	/* Complex weights in STFT domain */
 
 /*
  * sof_tdfb_config data[]
@@ -26,6 +31,10 @@
  * int16_t output_channel_mix[num_filters];
  * int16_t output_stream_mix[num_filters];
  *
+ * In SOF_TDFB_MODE_FREQ the filters are struct sof_tdfb_freq_coef_data
+ * instead with the same FFT size for all. The filtering is done with
+ * overlap-save, fft_size / 2 new frames per FFT, so the equivalent impulse
+ * response of the weights must not be longer than fft_size / 2 + 1 taps.
  */
 
 struct sof_tdfb_config {
@@ -33,7 +42,7 @@ struct sof_tdfb_config {
 	uint16_t num_filters;		/* Total number of filters */
 	uint16_t num_output_channels;    /* Total number of output channels */
 	uint16_t num_output_streams;	/* one source, N output sinks */
-	uint16_t reserved16;		/* To keep data 32 bit aligned */
+	uint16_t mode;			/* SOF_TDFB_MODE_, ABI3.23 */
 
 	/* reserved */
 	uint32_t reserved32[4];		/* For future */
@@ -41,4 +50,20 @@ struct sof_tdfb_config {
 	int16_t data[];
 } __attribute__((packed));
 
+/* Frequency domain filter, ABI3.23 */
+struct sof_tdfb_freq_coef_data {
+	int16_t fft_size;	/* Power of two FFT size */
+	int16_t out_shift;	/* Amount of right shifts at output */
+
+	/* reserved */
+	uint32_t reserved[4];
+
+	int16_t coef[];		/* Q1.15 real and imaginary part pairs of
+				 * complex weights for bins 0 .. fft_size / 2
+				 */
+} __attribute__((packed));
+
+#define SOF_TDFB_FREQ_COEF_NHEADER \
+	(sizeof(struct sof_tdfb_freq_coef_data) / sizeof(int16_t))
+
 #endif /* __USER_TDFB_H__ */
@@ -0,0 +1,320 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/*
+ * Binary control data sets flagged by the host with SOF_IPC_CTRL_FLAG_DEFERRED
+ * are copied to a queue and acknowledged at once with a sequence number. A low
+ * priority EDF task applies them in order and reports each result with the
+ * SOF_IPC_COMP_DEFERRED_DONE notification.
+ *
+ * Stream position and value commands of components without queued work
+ * overtake the queue. Any other command may depend on the queued work, so it
+ * is held in the mailbox without reply and processed again once the worker
+ * has drained the queue.
+ */
+
+#include <sof/audio/component_ext.h>
+#include <sof/debug/panic.h>
+#include <sof/drivers/ipc.h>
+#include <sof/drivers/timer.h>
+#include <sof/lib/alloc.h>
+#include <sof/lib/clk.h>
+#include <sof/lib/cpu.h>
+#include <sof/lib/mailbox.h>
+#include <sof/lib/memory.h>
+#include <sof/lib/uuid.h>
+#include <sof/list.h>
+#include <sof/platform.h>
+#include <sof/schedule/edf_schedule.h>
+#include <sof/schedule/schedule.h>
+#include <sof/schedule/task.h>
+#include <sof/spinlock.h>
+#include <sof/string.h>
+#include <sof/trace/trace.h>
+#include <ipc/control.h>
+#include <ipc/header.h>
+#include <ipc/stream.h>
+#include <user/trace.h>
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* d4dc5541-b5b6-4a3b-b606-403bea06d1c4 */
+DECLARE_SOF_UUID("ipc-deferred", ipc_deferred_uuid, 0xd4dc5541, 0xb5b6, 0x4a3b,
+		 0xb6, 0x06, 0x40, 0x3b, 0xea, 0x06, 0xd1, 0xc4);
+
+/* global and command type of the message */
+#define IPC_DEFERRED_TYPE(cmd) \
+	((cmd) & (SOF_GLB_TYPE_MASK | SOF_CMD_TYPE_MASK))
+
+struct ipc_deferred_cmd {
+	struct ipc_msg *msg;	/* completion notification */
+	uint32_t seq;
+	uint32_t data[SOF_IPC_MSG_MAX_SIZE / sizeof(uint32_t)];
+};
+
+struct ipc_deferred {
+	struct ipc_deferred_cmd cmds[CONFIG_IPC_DEFERRED_QUEUE];
+	uint32_t head;		/* next command to execute */
+	uint32_t count;		/* number of queued commands */
+	uint32_t seq;		/* sequence number of the last queued command */
+	bool active;		/* worker checks the queue again before exit */
+	bool held;		/* mailbox command waits for the worker exit */
+	struct task task;
+};
+
+static struct sof_ipc_ctrl_data *ipc_deferred_data(struct ipc_deferred_cmd *cmd)
+{
+	return (struct sof_ipc_ctrl_data *)cmd->data;
+}
+
+/* checks if the component has queued work */
+static bool ipc_deferred_queued(struct ipc_deferred *dfr, uint32_t comp_id)
+{
+	struct ipc_deferred_cmd *cmd;
+	uint32_t i;
+
+	for (i = 0; i < dfr->count; i++) {
+		cmd = dfr->cmds + (dfr->head + i) % CONFIG_IPC_DEFERRED_QUEUE;
+		if (ipc_deferred_data(cmd)->comp_id == comp_id)
+			return true;
+	}
+
+	return false;
+}
+
+/* checks if the command asks for deferred processing and can have it */
+static bool ipc_deferred_allowed(struct ipc *ipc, struct sof_ipc_cmd_hdr *hdr)
+{
+	struct sof_ipc_ctrl_data *cdata = (struct sof_ipc_ctrl_data *)hdr;
+	struct ipc_comp_dev *icd;
+
+	if (IPC_DEFERRED_TYPE(hdr->cmd) !=
+	    (SOF_IPC_GLB_COMP_MSG | SOF_IPC_COMP_SET_DATA) ||
+	    hdr->size < sizeof(*cdata) ||
+	    !(cdata->flags & SOF_IPC_CTRL_FLAG_DEFERRED))
+		return false;
+
+	/* components of other cores are processed by IDC as before */
+	icd = ipc_get_comp_by_id(ipc, cdata->comp_id);
+
+	return icd && icd->type == COMP_TYPE_COMPONENT && cpu_is_me(icd->core);
+}
+
+/* checks if the command doesn't depend on the queued work */
+static bool ipc_deferred_overtakes(struct ipc_deferred *dfr,
+				   struct sof_ipc_cmd_hdr *hdr)
+{
+	struct sof_ipc_ctrl_data *cdata = (struct sof_ipc_ctrl_data *)hdr;
+
+	switch (IPC_DEFERRED_TYPE(hdr->cmd)) {
+	case SOF_IPC_GLB_STREAM_MSG | SOF_IPC_STREAM_POSITION:
+		return true;
+	case SOF_IPC_GLB_COMP_MSG | SOF_IPC_COMP_SET_VALUE:
+	case SOF_IPC_GLB_COMP_MSG | SOF_IPC_COMP_GET_VALUE:
+		return hdr->size >= sizeof(*cdata) &&
+			!ipc_deferred_queued(dfr, cdata->comp_id);
+	default:
+		return false;
+	}
+}
+
+bool ipc_deferred_cmd(struct ipc *ipc, struct sof_ipc_cmd_hdr *hdr)
+{
+	struct ipc_deferred *dfr = ipc->deferred;
+	struct ipc_deferred_cmd *cmd = NULL;
+	struct sof_ipc_ctrl_deferred ack = {
+		.rhdr.hdr = {
+			.cmd = SOF_IPC_GLB_COMP_MSG | SOF_IPC_COMP_DEFERRED,
+			.size = sizeof(ack),
+		},
+	};
+	bool allowed = ipc_deferred_allowed(ipc, hdr);
+	bool ready;
+	bool kick = false;
+	bool held;
+	uint32_t flags;
+	int ret;
+
+	spin_lock_irq(&ipc->lock, flags);
+
+	/* worker may have seen the queue empty but not have exited yet */
+	ready = dfr->active ||
+		(dfr->task.state != SOF_TASK_STATE_QUEUED &&
+		 dfr->task.state != SOF_TASK_STATE_RUNNING);
+
+	if (allowed && ready && dfr->count < CONFIG_IPC_DEFERRED_QUEUE) {
+		cmd = dfr->cmds + (dfr->head + dfr->count) %
+			CONFIG_IPC_DEFERRED_QUEUE;
+
+		/* previous completion of the slot is not sent yet */
+		if (!list_is_empty(&cmd->msg->list))
+			cmd = NULL;
+	}
+
+	if (cmd) {
+		ret = memcpy_s(cmd->data, sizeof(cmd->data), hdr, hdr->size);
+		assert(!ret);
+
+		cmd->seq = ++dfr->seq;
+		dfr->count++;
+
+		if (!dfr->active) {
+			dfr->active = true;
+			kick = true;
+		}
+
+		ack.comp_id = ipc_deferred_data(cmd)->comp_id;
+		ack.seq = cmd->seq;
+	} else {
+		dfr->held = (dfr->count && !ipc_deferred_overtakes(dfr, hdr)) ||
+			(allowed && !ready);
+	}
+
+	held = dfr->held;
+
+	platform_shared_commit(dfr, sizeof(*dfr));
+
+	spin_unlock_irq(&ipc->lock, flags);
+
+	if (!cmd)
+		return held;
+
+	tr_dbg(&ipc_tr, "ipc: comp %d data deferred seq %u", ack.comp_id,
+	       ack.seq);
+
+	mailbox_hostbox_write(0, &ack, sizeof(ack));
+
+	if (kick)
+		schedule_task(&dfr->task, 0, 0);
+
+	return true;
+}
+
+bool ipc_deferred_held(struct ipc *ipc)
+{
+	return ipc->deferred->held;
+}
+
+static int ipc_deferred_exec(struct ipc *ipc, struct sof_ipc_ctrl_data *cdata)
+{
+	struct ipc_comp_dev *icd;
+	int ret;
+
+	icd = ipc_get_comp_by_id(ipc, cdata->comp_id);
+	if (!icd || icd->type != COMP_TYPE_COMPONENT) {
+		tr_err(&ipc_tr, "ipc: deferred comp %d not found",
+		       cdata->comp_id);
+		return -ENODEV;
+	}
+
+	ret = comp_cmd(icd->cd, COMP_CMD_SET_DATA, cdata,
+		       SOF_IPC_MSG_MAX_SIZE);
+	if (ret < 0) {
+		tr_err(&ipc_tr, "ipc: deferred comp %d cmd %u failed %d",
+		       cdata->comp_id, cdata->cmd, ret);
+		return ret;
+	}
+
+	platform_shared_commit(icd, sizeof(*icd));
+
+	return 0;
+}
+
+static enum task_state ipc_deferred_run(void *data)
+{
+	struct ipc *ipc = data;
+	struct ipc_deferred *dfr = ipc->deferred;
+	struct ipc_deferred_cmd *cmd = dfr->cmds + dfr->head;
+	struct sof_ipc_ctrl_data *cdata = ipc_deferred_data(cmd);
+	struct sof_ipc_ctrl_deferred done = {
+		.rhdr.hdr = {
+			.cmd = SOF_IPC_GLB_COMP_MSG | SOF_IPC_COMP_DEFERRED_DONE,
+			.size = sizeof(done),
+		},
+		.comp_id = cdata->comp_id,
+		.seq = cmd->seq,
+	};
+	uint32_t flags;
+	bool more;
+
+	done.rhdr.error = ipc_deferred_exec(ipc, cdata);
+
+	ipc_msg_send(cmd->msg, &done, false);
+
+	spin_lock_irq(&ipc->lock, flags);
+
+	dfr->head = (dfr->head + 1) % CONFIG_IPC_DEFERRED_QUEUE;
+	dfr->count--;
+	more = dfr->count > 0;
+	dfr->active = more;
+
+	platform_shared_commit(dfr, sizeof(*dfr));
+
+	spin_unlock_irq(&ipc->lock, flags);
+
+	return more ? SOF_TASK_STATE_RESCHEDULE : SOF_TASK_STATE_COMPLETED;
+}
+
+/* called by the scheduler once the worker has exited */
+static void ipc_deferred_complete(void *data)
+{
+	struct ipc *ipc = data;
+	struct ipc_deferred *dfr = ipc->deferred;
+	uint32_t flags;
+	bool held;
+
+	spin_lock_irq(&ipc->lock, flags);
+
+	held = dfr->held;
+	dfr->held = false;
+
+	platform_shared_commit(dfr, sizeof(*dfr));
+
+	spin_unlock_irq(&ipc->lock, flags);
+
+	/* command held in the mailbox is processed again */
+	if (held)
+		ipc_schedule_process(ipc);
+}
+
+static uint64_t ipc_deferred_deadline(void *data)
+{
+	return platform_timer_get(timer_get()) +
+		clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK,
+				  CONFIG_IPC_DEFERRED_DEADLINE_MS);
+}
+
+static const struct task_ops ipc_deferred_task_ops = {
+	.run		= ipc_deferred_run,
+	.complete	= ipc_deferred_complete,
+	.get_deadline	= ipc_deferred_deadline,
+};
+
+int ipc_deferred_init(struct ipc *ipc)
+{
+	struct ipc_deferred *dfr;
+	int i;
+
+	dfr = rzalloc(SOF_MEM_ZONE_SYS, SOF_MEM_FLAG_SHARED, SOF_MEM_CAPS_RAM,
+		      sizeof(*dfr));
+	if (!dfr)
+		return -ENOMEM;
+
+	for (i = 0; i < CONFIG_IPC_DEFERRED_QUEUE; i++) {
+		dfr->cmds[i].msg =
+			ipc_msg_init(SOF_IPC_GLB_COMP_MSG |
+				     SOF_IPC_COMP_DEFERRED_DONE,
+				     sizeof(struct sof_ipc_ctrl_deferred));
+		if (!dfr->cmds[i].msg)
+			return -ENOMEM;
+	}
+
+	ipc->deferred = dfr;
+
+	return schedule_task_init_edf(&dfr->task, SOF_UUID(ipc_deferred_uuid),
+				      &ipc_deferred_task_ops, ipc, 0, 0);
+}
@@ -8,6 +8,7 @@
 #include <sof/drivers/ipc.h>
 #include <sof/lib/dma.h>
 #include <sof/lib/uuid.h>
+#include <sof/math/numbers.h>
 #include <sof/platform.h>
 #include <sof/trace/dma-trace.h>
 #include <sof/trace/trace.h>
@@ -104,10 +105,11 @@ int dma_copy_to_host_nowait(struct dma_copy *dc, struct dma_sg_config *host_sg,
 	/* configure local DMA elem */
 	local_sg_elem.dest = host_sg_elem->dest + offset;
 	local_sg_elem.src = (uint32_t)local_ptr;
-	if (size >= HOST_PAGE_SIZE - offset)
-		local_sg_elem.size = HOST_PAGE_SIZE - offset;
-	else
-		local_sg_elem.size = size;
+
+	/* host elem may span several contiguous pages, stop at page end */
+	local_sg_elem.size = MIN(size, MIN(host_sg_elem->size - offset,
+					   HOST_PAGE_SIZE -
+					   offset % HOST_PAGE_SIZE));
 
 	config.elem_array.elems = &local_sg_elem;
 	config.elem_array.count = 1;
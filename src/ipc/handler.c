@@ -381,8 +381,7 @@ static int ipc_stream_position(uint32_t header)
 	pipeline_get_timestamp(pcm_dev->cd->pipeline, pcm_dev->cd, &posn);
 
 	/* copy positions to stream region */
-	mailbox_stream_write(pcm_dev->cd->pipeline->posn_offset,
-			     &posn, sizeof(posn));
+	pipeline_posn_write(pcm_dev->cd->pipeline, &posn);
 
 	platform_shared_commit(pcm_dev, sizeof(*pcm_dev));
 
@@ -1382,6 +1381,12 @@ void ipc_cmd(struct sof_ipc_cmd_hdr *hdr)
 		goto out;
 	}
 
+#if CONFIG_IPC_DEFERRED
+	/* queued commands are acknowledged, held ones run later */
+	if (ipc_deferred_cmd(ipc_get(), hdr))
+		return;
+#endif
+
 	type = iGS(hdr->cmd);
 
 	switch (type) {
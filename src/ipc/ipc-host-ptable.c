@@ -14,10 +14,26 @@
 #include <errno.h>
 #include <stdint.h>
 
+/* physical address of the page i in the compressed 20 bit page table */
+static uint32_t ipc_page_addr(const uint8_t *page_table, uint32_t i)
+{
+	uint32_t idx = (((i << 2) + i)) >> 1;
+	uint32_t phy_addr = page_table[idx] | (page_table[idx + 1] << 8)
+				| (page_table[idx + 2] << 16);
+
+	if (i & 0x1)
+		phy_addr <<= 8;
+	else
+		phy_addr <<= 12;
+
+	return phy_addr & 0xfffff000;
+}
+
 /*
  * Parse the host page tables and create the audio DMA SG configuration
  * for host audio DMA buffer. This involves creating a dma_sg_elem for each
- * page table entry and adding each elem to a list in struct dma_sg_config.
+ * run of physically contiguous pages and adding each elem to a list in
+ * struct dma_sg_config.
  */
 static int ipc_parse_page_descriptors(uint8_t *page_table,
 				      struct sof_ipc_host_buffer *ring,
@@ -25,9 +41,11 @@ static int ipc_parse_page_descriptors(uint8_t *page_table,
 				      uint32_t direction)
 {
 	int i;
-	uint32_t idx;
+	uint32_t count;
+	uint32_t size;
 	uint32_t phy_addr;
-	struct dma_sg_elem *e;
+	uint32_t prev_addr = 0;
+	struct dma_sg_elem *e = NULL;
 
 	/* the ring size may be not multiple of the page size, the last
 	 * page may be not full used. The used size should be in range
@@ -40,41 +58,53 @@ static int ipc_parse_page_descriptors(uint8_t *page_table,
 		return -EINVAL;
 	}
 
+	/* every discontinuity starts a new element */
+	count = 1;
+	for (i = 1; i < ring->pages; i++) {
+		if (ipc_page_addr(page_table, i) !=
+		    ipc_page_addr(page_table, i - 1) + HOST_PAGE_SIZE)
+			count++;
+	}
+
 	elem_array->elems = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
-				    sizeof(struct dma_sg_elem) * ring->pages);
+				    sizeof(struct dma_sg_elem) * count);
 	if (!elem_array->elems) {
 		tr_err(&ipc_tr, "ipc_parse_page_descriptors(): There is no heap free with this block size: %d",
-		       sizeof(struct dma_sg_elem) * ring->pages);
+		       sizeof(struct dma_sg_elem) * count);
 		return -ENOMEM;
 	}
 
-	elem_array->count = ring->pages;
+	elem_array->count = count;
 
 	for (i = 0; i < ring->pages; i++) {
-		idx = (((i << 2) + i)) >> 1;
-		phy_addr = page_table[idx] | (page_table[idx + 1] << 8)
-				| (page_table[idx + 2] << 16);
+		phy_addr = ipc_page_addr(page_table, i);
 
-		if (i & 0x1)
-			phy_addr <<= 8;
+		/* the last page may be not full used */
+		if (i == (ring->pages - 1))
+			size = ring->size - HOST_PAGE_SIZE * i;
 		else
-			phy_addr <<= 12;
-		phy_addr &= 0xfffff000;
+			size = HOST_PAGE_SIZE;
 
-		e = elem_array->elems + i;
+		/* page continues the current element */
+		if (e && phy_addr == prev_addr + HOST_PAGE_SIZE) {
+			e->size += size;
+		} else {
+			e = e ? e + 1 : elem_array->elems;
 
-		if (direction == SOF_IPC_STREAM_PLAYBACK)
-			e->src = phy_addr;
-		else
-			e->dest = phy_addr;
+			if (direction == SOF_IPC_STREAM_PLAYBACK)
+				e->src = phy_addr;
+			else
+				e->dest = phy_addr;
 
-		/* the last page may be not full used */
-		if (i == (ring->pages - 1))
-			e->size = ring->size - HOST_PAGE_SIZE * i;
-		else
-			e->size = HOST_PAGE_SIZE;
+			e->size = size;
+		}
+
+		prev_addr = phy_addr;
 	}
 
+	tr_dbg(&ipc_tr, "ipc_parse_page_descriptors(): %d pages in %d elems",
+	       ring->pages, count);
+
 	return 0;
 }
 
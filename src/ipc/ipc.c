@@ -667,6 +667,10 @@ out:
 
 int ipc_init(struct sof *sof)
 {
+#if CONFIG_IPC_DEFERRED
+	int ret;
+#endif
+
 	tr_info(&ipc_tr, "ipc_init()");
 
 	/* init ipc data */
@@ -679,11 +683,28 @@ int ipc_init(struct sof *sof)
 	list_init(&sof->ipc->msg_list);
 	list_init(&sof->ipc->comp_list);
 
+#if CONFIG_IPC_DEFERRED
+	ret = ipc_deferred_init(sof->ipc);
+	if (ret < 0)
+		return ret;
+#endif
+
 	return platform_ipc_init(sof->ipc);
 }
 
+static void ipc_complete_cmd(void *data)
+{
+#if CONFIG_IPC_DEFERRED
+	/* host keeps waiting until the held command is processed */
+	if (ipc_deferred_held(data))
+		return;
+#endif
+
+	ipc_platform_complete_cmd(data);
+}
+
 struct task_ops ipc_task_ops = {
 	.run		= ipc_platform_do_cmd,
-	.complete	= ipc_platform_complete_cmd,
+	.complete	= ipc_complete_cmd,
 	.get_deadline	= ipc_task_deadline,
 };
@@ -20,6 +20,7 @@
 #include <sof/lib/memory.h>
 #include <sof/lib/uuid.h>
 #include <sof/debug/panic.h>
+#include <sof/math/numbers.h>
 #include <sof/platform.h>
 #include <sof/schedule/ll_schedule.h>
 #include <sof/schedule/schedule.h>
@@ -96,6 +97,11 @@ void sa_init(struct sof *sof, uint64_t timeout)
 	else
 		tr_info(&sa_tr, "sa_init(), timeout = %u", (unsigned int)timeout);
 
+#if CONFIG_LL_TICK_COALESCING
+	/* don't wake up the cores on every tick only for the checks */
+	timeout = MAX(timeout, CONFIG_PIPELINE_DEEP_BUFFER_PERIOD);
+#endif
+
 	sof->sa = rzalloc(SOF_MEM_ZONE_SYS, SOF_MEM_FLAG_SHARED,
 			  SOF_MEM_CAPS_RAM, sizeof(*sof->sa));
 
@@ -0,0 +1,180 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/*
+ * Load driven cpu clock governor. The low latency scheduler reports the
+ * busy time of its runs on each core. At the end of each measurement window
+ * the lowest frequency of the platform table that keeps the configured
+ * headroom for the measured load is selected. Going down needs additional
+ * free hysteresis to avoid toggling between two frequencies with a load
+ * close to the limit. Clock changes made by anyone reset the window, so the
+ * load is always measured at a single frequency.
+ */
+
+#include <sof/drivers/timer.h>
+#include <sof/lib/alloc.h>
+#include <sof/lib/clk.h>
+#include <sof/lib/clk_governor.h>
+#include <sof/lib/cpu.h>
+#include <sof/lib/memory.h>
+#include <sof/lib/notifier.h>
+#include <sof/lib/uuid.h>
+#include <sof/math/numbers.h>
+#include <sof/platform.h>
+#include <sof/trace/trace.h>
+#include <ipc/topology.h>
+#include <user/trace.h>
+#include <stdint.h>
+
+/* 1a013592-02b0-4f1a-bc87-3fd4a0a13611 */
+DECLARE_SOF_UUID("clk-governor", clk_governor_uuid, 0x1a013592, 0x02b0,
+		 0x4f1a, 0xbc, 0x87, 0x3f, 0xd4, 0xa0, 0xa1, 0x36, 0x11);
+
+DECLARE_TR_CTX(clk_gov_tr, SOF_UUID(clk_governor_uuid), LOG_LEVEL_INFO);
+
+/* accessed only by the owning core */
+static struct clk_governor *clk_governors[CONFIG_CORE_COUNT];
+
+/* lowest frequency with needed Hz below (100 - margin)% of it */
+static uint32_t clk_governor_lowest_idx(const struct freq_table *freqs,
+					uint32_t num, uint64_t needed,
+					uint32_t margin)
+{
+	uint32_t i;
+
+	for (i = 0; i < num; i++) {
+		if (needed * 100 <= (uint64_t)(100 - margin) * freqs[i].freq)
+			return i;
+	}
+
+	/* not enough even at max frequency */
+	return num - 1;
+}
+
+uint32_t clk_governor_select_idx(const struct freq_table *freqs, uint32_t num,
+				 uint32_t cur_idx, uint64_t busy,
+				 uint64_t elapsed, uint32_t headroom,
+				 uint32_t hysteresis)
+{
+	uint64_t needed;
+	uint32_t idx;
+
+	if (!elapsed)
+		return cur_idx;
+
+	/* Hz needed to run the load of the window */
+	needed = freqs[cur_idx].freq * MIN(busy, elapsed) / elapsed;
+
+	idx = clk_governor_lowest_idx(freqs, num, needed, headroom);
+	if (idx >= cur_idx)
+		return idx;
+
+	idx = clk_governor_lowest_idx(freqs, num, needed,
+				      headroom + hysteresis);
+
+	return MIN(idx, cur_idx);
+}
+
+/* starts new window at the frequency in use */
+static void clk_governor_reset(struct clk_governor *gov)
+{
+	struct clock_info *clk_info = clocks_get() + gov->clk;
+
+	gov->cur_idx = clk_info->current_freq_idx;
+	gov->next_idx = gov->cur_idx;
+	gov->window = clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK,
+					CONFIG_CLK_GOVERNOR_WINDOW_MS);
+	gov->window_start = platform_timer_get(timer_get());
+	gov->busy = 0;
+
+	platform_shared_commit(clk_info, sizeof(*clk_info));
+}
+
+static void clk_governor_notify(void *arg, enum notify_id type, void *data)
+{
+	struct clk_governor *gov = arg;
+	struct clock_notify_data *clk_data = data;
+
+	if (clk_data->message == CLOCK_NOTIFY_POST)
+		clk_governor_reset(gov);
+}
+
+struct clk_governor *clk_governor_get(void)
+{
+	struct clk_governor *gov = clk_governors[cpu_get_id()];
+
+	if (gov)
+		return gov;
+
+	gov = rzalloc(SOF_MEM_ZONE_SYS, 0, SOF_MEM_CAPS_RAM, sizeof(*gov));
+	if (!gov) {
+		tr_err(&clk_gov_tr, "clk_governor_get(): alloc failed");
+		return NULL;
+	}
+
+	gov->clk = CLK_CPU(cpu_get_id());
+	clk_governor_reset(gov);
+
+	notifier_register(gov, clocks_get() + gov->clk, NOTIFIER_ID_CPU_FREQ,
+			  clk_governor_notify, 0);
+
+	clk_governors[cpu_get_id()] = gov;
+
+	return gov;
+}
+
+void clk_governor_run_start(struct clk_governor *gov)
+{
+	if (gov)
+		gov->run_start = platform_timer_get(timer_get());
+}
+
+void clk_governor_run_end(struct clk_governor *gov)
+{
+	struct clock_info *clk_info;
+	uint64_t now;
+	uint64_t elapsed;
+
+	if (!gov)
+		return;
+
+	now = platform_timer_get(timer_get());
+	gov->busy += now - gov->run_start;
+
+	elapsed = now - gov->window_start;
+	if (elapsed < gov->window)
+		return;
+
+	clk_info = clocks_get() + gov->clk;
+	gov->next_idx = clk_governor_select_idx(clk_info->freqs,
+						clk_info->freqs_num,
+						gov->cur_idx, gov->busy,
+						elapsed,
+						CONFIG_CLK_GOVERNOR_HEADROOM,
+						CONFIG_CLK_GOVERNOR_HYSTERESIS);
+	gov->window_start = now;
+	gov->busy = 0;
+
+	platform_shared_commit(clk_info, sizeof(*clk_info));
+}
+
+void clk_governor_update(struct clk_governor *gov)
+{
+	struct clock_info *clk_info;
+	uint32_t freq;
+
+	if (!gov || gov->next_idx == gov->cur_idx)
+		return;
+
+	clk_info = clocks_get() + gov->clk;
+	freq = clk_info->freqs[gov->next_idx].freq;
+
+	platform_shared_commit(clk_info, sizeof(*clk_info));
+
+	tr_dbg(&clk_gov_tr, "clk_governor_update(): idx %u -> %u",
+	       gov->cur_idx, gov->next_idx);
+
+	/* the notification resets the window */
+	clock_set_freq(gov->clk, freq);
+}
@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/pairing_heap.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* order is compared as a difference to survive the counter wrap */
+static inline bool pairing_heap_before(const struct pairing_heap_node *a,
+				       const struct pairing_heap_node *b)
+{
+	if (a->key != b->key)
+		return a->key < b->key;
+
+	return (int32_t)(a->order - b->order) < 0;
+}
+
+/* Links two trees, the root with the larger key becomes the first child of
+ * the other one. The returned root keeps its next and prev links.
+ */
+static struct pairing_heap_node *pairing_heap_link(struct pairing_heap_node *a,
+						   struct pairing_heap_node *b)
+{
+	struct pairing_heap_node *tmp;
+
+	if (pairing_heap_before(b, a)) {
+		tmp = a;
+		a = b;
+		b = tmp;
+	}
+
+	b->prev = a;
+	b->next = a->child;
+	if (a->child)
+		a->child->prev = b;
+	a->child = b;
+
+	return a;
+}
+
+/* Two pass pairing of a sibling list into one tree. The first pass links
+ * the siblings in pairs from left to right and stacks the pairs, the
+ * second pass links the stacked pairs from right to left.
+ */
+static struct pairing_heap_node *
+pairing_heap_merge_pairs(struct pairing_heap_node *first)
+{
+	struct pairing_heap_node *stack = NULL;
+	struct pairing_heap_node *root = NULL;
+	struct pairing_heap_node *a;
+	struct pairing_heap_node *b;
+
+	while (first) {
+		a = first;
+		b = a->next;
+		if (b) {
+			first = b->next;
+			a = pairing_heap_link(a, b);
+		} else {
+			first = NULL;
+		}
+
+		a->next = stack;
+		stack = a;
+	}
+
+	while (stack) {
+		a = stack;
+		stack = a->next;
+		root = root ? pairing_heap_link(root, a) : a;
+	}
+
+	root->next = NULL;
+	root->prev = NULL;
+
+	return root;
+}
+
+void pairing_heap_insert(struct pairing_heap *heap,
+			 struct pairing_heap_node *node, uint64_t key)
+{
+	node->child = NULL;
+	node->next = NULL;
+	node->prev = NULL;
+	node->key = key;
+	node->order = heap->order++;
+
+	heap->root = heap->root ? pairing_heap_link(heap->root, node) : node;
+	heap->count++;
+}
+
+void pairing_heap_remove(struct pairing_heap *heap,
+			 struct pairing_heap_node *node)
+{
+	struct pairing_heap_node *sub = NULL;
+
+	if (node->child)
+		sub = pairing_heap_merge_pairs(node->child);
+
+	if (node == heap->root) {
+		heap->root = sub;
+	} else {
+		/* unlink from the parent or the previous sibling */
+		if (node->prev->child == node)
+			node->prev->child = node->next;
+		else
+			node->prev->next = node->next;
+		if (node->next)
+			node->next->prev = node->prev;
+
+		if (sub)
+			heap->root = pairing_heap_link(heap->root, sub);
+	}
+
+	node->child = NULL;
+	node->next = NULL;
+	node->prev = NULL;
+	heap->count--;
+}
@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/format.h>
+#include <sof/math/fft.h>
+#include <sof/math/trig.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+int fft_plan_init(struct fft_plan *plan, struct icomplex32 *twiddle,
+		  uint32_t len_log2)
+{
+	int32_t w;
+	uint32_t k;
+
+	if (len_log2 < FFT_MIN_LEN_LOG2 || len_log2 > FFT_MAX_LEN_LOG2)
+		return -EINVAL;
+
+	plan->size = 1 << len_log2;
+	plan->len_log2 = len_log2;
+	plan->twiddle = twiddle;
+
+	/* W(k) = exp(-j * 2 * pi * k / size), angle in Q4.28 */
+	for (k = 0; k < plan->size >> 1; k++) {
+		w = ((int64_t)PI_MUL2_Q4_28 * k) >> len_log2;
+		twiddle[k].real = sin_fixed(w + PI_DIV2_Q4_28);
+		twiddle[k].imag = -sin_fixed(w);
+	}
+
+	return 0;
+}
+
+static inline uint32_t fft_bit_reverse(uint32_t i, uint32_t len_log2)
+{
+	uint32_t r = 0;
+	uint32_t n;
+
+	for (n = 0; n < len_log2; n++) {
+		r = (r << 1) | (i & 1);
+		i >>= 1;
+	}
+
+	return r;
+}
+
+void fft_execute_32(struct fft_plan *plan, struct icomplex32 *x, bool ifft)
+{
+	struct icomplex32 *a;
+	struct icomplex32 *b;
+	struct icomplex32 tmp;
+	int64_t tr;
+	int64_t ti;
+	int32_t wr;
+	int32_t wi;
+	uint32_t half;
+	uint32_t step;
+	uint32_t i;
+	uint32_t j;
+	uint32_t k;
+	uint32_t r;
+
+	/* Permute input to bit reversed order */
+	for (i = 1; i < plan->size - 1; i++) {
+		r = fft_bit_reverse(i, plan->len_log2);
+		if (r > i) {
+			tmp = x[i];
+			x[i] = x[r];
+			x[r] = tmp;
+		}
+	}
+
+	/* Decimation in time butterflies, Q1.31 x Q1.31 -> Q1.31 */
+	for (half = 1; half < plan->size; half <<= 1) {
+		step = plan->size / (half << 1);
+		for (j = 0; j < half; j++) {
+			wr = plan->twiddle[j * step].real;
+			wi = ifft ? -plan->twiddle[j * step].imag :
+				plan->twiddle[j * step].imag;
+			for (k = j; k < plan->size; k += half << 1) {
+				a = &x[k];
+				b = &x[k + half];
+				tr = ((int64_t)wr * b->real -
+				      (int64_t)wi * b->imag) >> 31;
+				ti = ((int64_t)wr * b->imag +
+				      (int64_t)wi * b->real) >> 31;
+				if (ifft) {
+					b->real = sat_int32(a->real - tr);
+					b->imag = sat_int32(a->imag - ti);
+					a->real = sat_int32(a->real + tr);
+					a->imag = sat_int32(a->imag + ti);
+				} else {
+					b->real = (a->real - tr) >> 1;
+					b->imag = (a->imag - ti) >> 1;
+					a->real = (a->real + tr) >> 1;
+					a->imag = (a->imag + ti) >> 1;
+				}
+			}
+		}
+	}
+}
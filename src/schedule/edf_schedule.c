@@ -12,7 +12,8 @@
 #include <sof/lib/alloc.h>
 #include <sof/lib/clk.h>
 #include <sof/lib/uuid.h>
-#include <sof/list.h>
+#include <sof/math/numbers.h>
+#include <sof/pairing_heap.h>
 #include <sof/platform.h>
 #include <sof/schedule/edf_schedule.h>
 #include <sof/schedule/schedule.h>
@@ -22,6 +23,7 @@
 #include <errno.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 /* 77de2074-828c-4044-a40b-420b72749e8b */
 DECLARE_SOF_UUID("edf-schedule", edf_sched_uuid, 0x77de2074, 0x828c, 0x4044,
@@ -29,10 +31,27 @@ DECLARE_SOF_UUID("edf-schedule", edf_sched_uuid, 0x77de2074, 0x828c, 0x4044,
 
 DECLARE_TR_CTX(edf_tr, SOF_UUID(edf_sched_uuid), LOG_LEVEL_INFO);
 
+#if CONFIG_SCHEDULE_EDF_LATENCY
+/* Bucket 0 counts zero latencies and bucket n latencies from 2^(n - 1) to
+ * 2^n - 1 platform timer ticks, the last bucket counts also all longer ones.
+ */
+#define EDF_LATENCY_BUCKETS	16
+#define EDF_LATENCY_REPORT	256	/* samples per histogram trace */
+
+struct edf_latency {
+	uint32_t bucket[EDF_LATENCY_BUCKETS];
+	uint32_t count;
+	uint32_t peak;
+};
+#endif
+
 struct edf_schedule_data {
-	struct list_item list;	/* list of tasks in priority queue */
+	struct pairing_heap queue;	/* tasks ordered by deadline */
 	uint32_t clock;
 	int irq;
+#if CONFIG_SCHEDULE_EDF_LATENCY
+	struct edf_latency latency;	/* queued to first run time */
+#endif
 };
 
 const struct scheduler_ops schedule_edf_ops;
@@ -44,7 +63,7 @@ static void schedule_edf(void *data);
 static void schedule_edf_task_run(struct task *task, void *data)
 {
 	while (1) {
-		/* execute task run function and remove task from the list
+		/* execute task run function and remove task from the queue
 		 * only if completed
 		 */
 		if (task_run(task) == SOF_TASK_STATE_COMPLETED)
@@ -55,42 +74,52 @@ static void schedule_edf_task_run(struct task *task, void *data)
 	}
 }
 
+#if CONFIG_SCHEDULE_EDF_LATENCY
+static void edf_latency_record(struct edf_schedule_data *edf_sch,
+			       struct edf_task_pdata *edf_pdata)
+{
+	struct edf_latency *latency = &edf_sch->latency;
+	uint64_t delta = platform_timer_get(timer_get()) - edf_pdata->queued;
+	uint32_t ticks = MIN(delta, UINT32_MAX);
+	int i;
+
+	i = ticks ? 32 - clz(ticks) : 0;
+	latency->bucket[MIN(i, EDF_LATENCY_BUCKETS - 1)]++;
+
+	if (ticks > latency->peak) {
+		latency->peak = ticks;
+		tr_info(&edf_tr, "edf latency peak %u ticks", ticks);
+	}
+
+	if (++latency->count < EDF_LATENCY_REPORT)
+		return;
+
+	for (i = 0; i < EDF_LATENCY_BUCKETS; i += 4)
+		tr_info(&edf_tr, "edf latency histogram %u %u %u %u",
+			latency->bucket[i], latency->bucket[i + 1],
+			latency->bucket[i + 2], latency->bucket[i + 3]);
+
+	memset(latency->bucket, 0, sizeof(latency->bucket));
+	latency->count = 0;
+}
+#endif
+
 static void edf_scheduler_run(void *data)
 {
 	struct edf_schedule_data *edf_sch = data;
-	uint64_t deadline_next = SOF_TASK_DEADLINE_IDLE;
+	struct pairing_heap_node *node;
 	struct task *task_next = NULL;
-	struct list_item *tlist;
-	struct task *task;
-	uint64_t deadline;
 	uint32_t flags;
 
 	tr_dbg(&edf_tr, "edf_scheduler_run()");
 
 	irq_local_disable(flags);
 
-	/* find next task to run */
-	list_for_item(tlist, &edf_sch->list) {
-		task = container_of(tlist, struct task, list);
-
-		if (task->state != SOF_TASK_STATE_QUEUED &&
-		    task->state != SOF_TASK_STATE_RUNNING)
-			continue;
-
-		deadline = task_get_deadline(task);
-
-		if (deadline == SOF_TASK_DEADLINE_NOW) {
-			/* task needs to be scheduled ASAP */
-			task_next = task;
-			break;
-		}
-
-		/* get earliest deadline */
-		if (deadline <= deadline_next) {
-			deadline_next = deadline;
-			task_next = task;
-		}
-	}
+	/* next task to run is the one with the earliest deadline */
+	node = pairing_heap_peek(&edf_sch->queue);
+	if (node)
+		task_next = container_of(node, struct edf_task_pdata,
+					 node)->task;
 
 	irq_local_enable(flags);
 
@@ -104,6 +133,7 @@ static int schedule_edf_task(void *data, struct task *task, uint64_t start,
 			     uint64_t period)
 {
 	struct edf_schedule_data *edf_sch = data;
+	struct edf_task_pdata *edf_pdata = edf_sch_get_pdata(task);
 	uint32_t flags;
 	(void) period; /* not used */
 	(void) start; /* not used */
@@ -119,8 +149,12 @@ static int schedule_edf_task(void *data, struct task *task, uint64_t start,
 		return -EALREADY;
 	}
 
-	/* add task to the list */
-	list_item_append(&task->list, &edf_sch->list);
+	/* add task to the queue, the deadline is sampled only here */
+	pairing_heap_insert(&edf_sch->queue, &edf_pdata->node,
+			    task_get_deadline(task));
+#if CONFIG_SCHEDULE_EDF_LATENCY
+	edf_pdata->queued = platform_timer_get(timer_get());
+#endif
 
 	task->state = SOF_TASK_STATE_QUEUED;
 
@@ -153,6 +187,7 @@ int schedule_task_init_edf(struct task *task, const struct sof_uuid_entry *uid,
 		return -ENOMEM;
 	}
 
+	edf_pdata->task = task;
 	edf_sch_set_pdata(task, edf_pdata);
 
 	task->ops.complete = ops->complete;
@@ -187,6 +222,11 @@ static int schedule_edf_task_running(void *data, struct task *task)
 
 	tr_dbg(&edf_tr, "schedule_edf_task_running()");
 
+#if CONFIG_SCHEDULE_EDF_LATENCY
+	if (task->state == SOF_TASK_STATE_QUEUED)
+		edf_latency_record(data, edf_pdata);
+#endif
+
 	irq_local_disable(flags);
 
 	task_context_set(edf_pdata->ctx);
@@ -199,6 +239,8 @@ static int schedule_edf_task_running(void *data, struct task *task)
 
 static int schedule_edf_task_complete(void *data, struct task *task)
 {
+	struct edf_schedule_data *edf_sch = data;
+	struct edf_task_pdata *edf_pdata = edf_sch_get_pdata(task);
 	uint32_t flags;
 
 	tr_dbg(&edf_tr, "schedule_edf_task_complete()");
@@ -208,7 +250,7 @@ static int schedule_edf_task_complete(void *data, struct task *task)
 	task_complete(task);
 
 	task->state = SOF_TASK_STATE_COMPLETED;
-	list_item_del(&task->list);
+	pairing_heap_remove(&edf_sch->queue, &edf_pdata->node);
 
 	irq_local_enable(flags);
 
@@ -217,6 +259,8 @@ static int schedule_edf_task_complete(void *data, struct task *task)
 
 static int schedule_edf_task_cancel(void *data, struct task *task)
 {
+	struct edf_schedule_data *edf_sch = data;
+	struct edf_task_pdata *edf_pdata = edf_sch_get_pdata(task);
 	uint32_t flags;
 
 	tr_dbg(&edf_tr, "schedule_edf_task_cancel()");
@@ -226,7 +270,7 @@ static int schedule_edf_task_cancel(void *data, struct task *task)
 	/* cancel and delete only if queued */
 	if (task->state == SOF_TASK_STATE_QUEUED) {
 		task->state = SOF_TASK_STATE_CANCEL;
-		list_item_del(&task->list);
+		pairing_heap_remove(&edf_sch->queue, &edf_pdata->node);
 	}
 
 	irq_local_enable(flags);
@@ -236,11 +280,17 @@ static int schedule_edf_task_cancel(void *data, struct task *task)
 
 static int schedule_edf_task_free(void *data, struct task *task)
 {
+	struct edf_schedule_data *edf_sch = data;
 	struct edf_task_pdata *edf_pdata = edf_sch_get_pdata(task);
 	uint32_t flags;
 
 	irq_local_disable(flags);
 
+	/* the queue node is freed with the private data */
+	if (task->state == SOF_TASK_STATE_QUEUED ||
+	    task->state == SOF_TASK_STATE_RUNNING)
+		pairing_heap_remove(&edf_sch->queue, &edf_pdata->node);
+
 	task->state = SOF_TASK_STATE_FREE;
 
 	task_context_free(edf_pdata->ctx);
@@ -261,7 +311,7 @@ int scheduler_init_edf(void)
 
 	edf_sch = rzalloc(SOF_MEM_ZONE_SYS, 0, SOF_MEM_CAPS_RAM,
 			  sizeof(*edf_sch));
-	list_init(&edf_sch->list);
+	pairing_heap_init(&edf_sch->queue);
 	edf_sch->clock = PLATFORM_DEFAULT_CLOCK;
 
 	scheduler_init(SOF_SCHEDULE_EDF, &schedule_edf_ops, edf_sch);
@@ -295,8 +345,6 @@ static void scheduler_free_edf(void *data)
 	/* free main task context */
 	task_main_free();
 
-	list_item_del(&edf_sch->list);
-
 	irq_local_enable(flags);
 }
 
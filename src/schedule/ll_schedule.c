@@ -12,12 +12,14 @@
 #include <sof/drivers/timer.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/clk.h>
+#include <sof/lib/clk_governor.h>
 #include <sof/lib/cpu.h>
 #include <sof/lib/memory.h>
 #include <sof/lib/notifier.h>
 #include <sof/lib/perf_cnt.h>
 #include <sof/lib/uuid.h>
 #include <sof/list.h>
+#include <sof/math/numbers.h>
 #include <sof/platform.h>
 #include <sof/schedule/ll_schedule.h>
 #include <sof/schedule/ll_schedule_domain.h>
@@ -44,6 +46,9 @@ struct ll_schedule_data {
 	atomic_t num_tasks;			/* number of ll tasks */
 #if CONFIG_PERFORMANCE_COUNTERS
 	struct perf_cnt_data pcd;
+#endif
+#if CONFIG_CLK_GOVERNOR
+	struct clk_governor *gov;		/* clock governor of the core */
 #endif
 	struct ll_schedule_domain *domain;	/* scheduling domain */
 };
@@ -134,6 +139,49 @@ static void schedule_ll_tasks_execute(struct ll_schedule_data *sch,
 	platform_shared_commit(sch->domain, sizeof(*sch->domain));
 }
 
+#if CONFIG_LL_TICK_COALESCING
+/* returns the earliest start of the tasks on this core */
+static uint64_t schedule_ll_next_tick(struct ll_schedule_data *sch)
+{
+	struct list_item *tlist;
+	struct task *task;
+	uint64_t next = UINT64_MAX;
+
+	list_for_item(tlist, &sch->tasks) {
+		task = container_of(tlist, struct task, list);
+		next = MIN(next, task->start);
+	}
+
+	return next == UINT64_MAX ? 0 : next;
+}
+
+/* Added or rescheduled task must not wait for the coalesced tick,
+ * so the domain is set back to the next tick. Called with the domain
+ * lock held.
+ */
+static void schedule_ll_domain_uncoalesce(struct ll_schedule_data *sch)
+{
+	sch->domain->next_tick[cpu_get_id()] = 0;
+
+	if (sch->domain->coalesced)
+		domain_set(sch->domain, platform_timer_get(timer_get()));
+}
+
+static inline bool schedule_ll_domain_is_coalesced(struct ll_schedule_data *sch)
+{
+	return sch->domain->coalesced;
+}
+#else
+static inline void schedule_ll_domain_uncoalesce(struct ll_schedule_data *sch)
+{
+}
+
+static inline bool schedule_ll_domain_is_coalesced(struct ll_schedule_data *sch)
+{
+	return false;
+}
+#endif
+
 static void schedule_ll_clients_enable(struct ll_schedule_data *sch)
 {
 	int i;
@@ -175,6 +223,11 @@ static void schedule_ll_tasks_run(void *data)
 
 	last_tick = sch->domain->last_tick;
 
+#if CONFIG_LL_TICK_COALESCING
+	/* the coalesced tick has come */
+	sch->domain->coalesced = false;
+#endif
+
 	/* clear domain only if all clients are done */
 	/* TODO: no need for atomic operations,
 	 * already protected by spin_lock
@@ -187,6 +240,10 @@ static void schedule_ll_tasks_run(void *data)
 
 	spin_unlock(&sch->domain->lock);
 
+#if CONFIG_CLK_GOVERNOR
+	clk_governor_run_start(sch->gov);
+#endif
+
 	perf_cnt_init(&sch->pcd);
 
 	notifier_event(sch, NOTIFIER_ID_LL_PRE_RUN,
@@ -201,8 +258,16 @@ static void schedule_ll_tasks_run(void *data)
 
 	perf_cnt_stamp(&sch->pcd, perf_ll_sched_trace, sch);
 
+#if CONFIG_CLK_GOVERNOR
+	clk_governor_run_end(sch->gov);
+#endif
+
 	spin_lock(&sch->domain->lock);
 
+#if CONFIG_LL_TICK_COALESCING
+	sch->domain->next_tick[cpu_get_id()] = schedule_ll_next_tick(sch);
+#endif
+
 	/* reschedule only if all clients are done */
 	if (!num_clients)
 		schedule_ll_clients_reschedule(sch);
@@ -210,6 +275,11 @@ static void schedule_ll_tasks_run(void *data)
 	spin_unlock(&sch->domain->lock);
 
 	irq_local_enable(flags);
+
+#if CONFIG_CLK_GOVERNOR
+	/* clock changes notify the schedulers, so not under the lock */
+	clk_governor_update(sch->gov);
+#endif
 }
 
 static int schedule_ll_domain_set(struct ll_schedule_data *sch,
@@ -239,6 +309,8 @@ static int schedule_ll_domain_set(struct ll_schedule_data *sch,
 	if (total == 0)
 		/* First task in domain over all cores: actiivate it */
 		domain_set(sch->domain, platform_timer_get(timer_get()));
+	else
+		schedule_ll_domain_uncoalesce(sch);
 
 	if (total == 0 || !registered) {
 		/* First task on core: count and enable it */
@@ -464,14 +536,24 @@ static int reschedule_ll_task(void *data, struct task *task, uint64_t start)
 	uint32_t flags;
 	uint64_t time;
 
+	irq_local_disable(flags);
+
+	spin_lock(&sch->domain->lock);
+
+	/* The start is computed before the domain is set back, which moves
+	 * the last tick. A coalesced last tick is in the future, so the
+	 * start is then relative to the current time.
+	 */
 	time = sch->domain->ticks_per_ms * start / 1000;
 
-	if (sch->domain->synchronous)
+	if (sch->domain->synchronous || schedule_ll_domain_is_coalesced(sch))
 		time += platform_timer_get(timer_get());
 	else
 		time += sch->domain->last_tick;
 
-	irq_local_disable(flags);
+	schedule_ll_domain_uncoalesce(sch);
+
+	spin_unlock(&sch->domain->lock);
 
 	/* check to see if we are already scheduled */
 	list_for_item(tlist, &sch->tasks) {
@@ -543,6 +625,9 @@ static void ll_scheduler_notify(void *arg, enum notify_id type, void *data)
 		sch->domain->ticks_per_ms = clock_ms_to_ticks(sch->domain->clk,
 							      1);
 		ll_scheduler_recalculate_tasks(sch, clk_data);
+#if CONFIG_LL_TICK_COALESCING
+		sch->domain->next_tick[cpu_get_id()] = 0;
+#endif
 		platform_shared_commit(sch->domain, sizeof(*sch->domain));
 	}
 
@@ -559,6 +644,11 @@ int scheduler_init_ll(struct ll_schedule_domain *domain)
 	atomic_init(&sch->num_tasks, 0);
 	sch->domain = domain;
 
+#if CONFIG_CLK_GOVERNOR
+	/* shared by all the domains of the core */
+	sch->gov = clk_governor_get();
+#endif
+
 	/* notification of clock changes */
 	notifier_register(sch, NULL, NOTIFIER_CLK_CHANGE_ID(domain->clk),
 			  ll_scheduler_notify, 0);
@@ -234,6 +234,12 @@ static void timer_domain_set(struct ll_schedule_domain *domain, uint64_t start)
 #ifndef __ZEPHYR__
 	uint64_t ticks_req = start + ticks_tout;
 
+#if CONFIG_LL_TICK_COALESCING
+	/* skip the ticks without any task to run */
+	ticks_req = MAX(ticks_req, domain_next_tick(domain));
+	domain->coalesced = ticks_req > start + ticks_tout;
+#endif
+
 	ticks_set = platform_timer_set(timer_domain->timer, ticks_req);
 #else
 	uint64_t current = platform_timer_get(timer_domain->timer);
@@ -250,6 +256,12 @@ static void timer_domain_set(struct ll_schedule_domain *domain, uint64_t start)
 	if (ticks_req > current + ticks_tout)
 		ticks_req = current + ticks_tout;
 
+#if CONFIG_LL_TICK_COALESCING
+	/* skip the ticks without any task to run */
+	ticks_req = MAX(ticks_req, domain_next_tick(domain));
+	domain->coalesced = ticks_req > current + ticks_tout;
+#endif
+
 	ticks_req -= ticks_req % CYC_PER_TICK;
 	if (ticks_req < earliest_next) {
 		/* The earliest schedule point has to be rounded up */
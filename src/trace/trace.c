@@ -11,6 +11,7 @@
 #include <sof/drivers/timer.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/cache.h>
+#include <sof/lib/clk.h>
 #include <sof/lib/cpu.h>
 #include <sof/lib/mailbox.h>
 #include <sof/lib/memory.h>
@@ -23,13 +24,33 @@
 #include <sof/trace/trace.h>
 #include <ipc/topology.h>
 #include <user/trace.h>
+#include <errno.h>
 #include <stdarg.h>
 #include <stdint.h>
 
+/* 6f3a07b9-2d0e-4f7c-a41c-8e2b5c7d9f13 */
+DECLARE_SOF_UUID("trace", trace_uuid, 0x6f3a07b9, 0x2d0e, 0x4f7c,
+		 0xa4, 0x1c, 0x8e, 0x2b, 0x5c, 0x7d, 0x9f, 0x13);
+
+DECLARE_TR_CTX(trace_tr, SOF_UUID(trace_uuid), LOG_LEVEL_INFO);
+
+/* per log level rate limiter state */
+struct trace_rate_limit {
+	uint64_t window_start;	/* start of the current window in ticks */
+	uint64_t window_ticks;	/* window length in ticks */
+	uint32_t window_ms;	/* window length in ms, 0 means no limit */
+	uint32_t burst;		/* messages allowed within one window */
+	uint32_t count;		/* messages sent in the current window */
+	uint32_t suppressed;	/* messages dropped in the current window */
+};
+
 struct trace {
 	uint32_t pos ;	/* trace position */
 	uint32_t enable;
 	spinlock_t lock; /* locking mechanism */
+#if CONFIG_TRACE_RATE_LIMIT
+	struct trace_rate_limit limit[LOG_LEVEL_VERBOSE + 1];
+#endif
 };
 
 /* calculates total message size, both header and payload in bytes */
@@ -46,23 +67,21 @@ struct trace {
 
 #define TRACE_ID_MASK ((1 << TRACE_ID_LENGTH) - 1)
 
-static void put_header(uint32_t *dst, const struct sof_uuid_entry *uid,
-		       uint32_t id_1, uint32_t id_2,
-		       uint32_t entry, uint64_t timestamp)
+static inline void put_header(uint32_t *dst,
+			      const struct sof_uuid_entry *uid,
+			      uint32_t id_1, uint32_t id_2,
+			      uint32_t entry, uint64_t timestamp)
 {
+	struct log_entry_header *header = (struct log_entry_header *)dst;
 	struct timer *timer = timer_get();
-	struct log_entry_header header;
-	int ret;
-
-	header.uid = (uintptr_t)uid;
-	header.id_0 = id_1 & TRACE_ID_MASK;
-	header.id_1 = id_2 & TRACE_ID_MASK;
-	header.core_id = cpu_get_id();
-	header.timestamp = timestamp + timer->delta;
-	header.log_entry_address = entry;
 
-	ret = memcpy_s(dst, sizeof(header), &header, sizeof(header));
-	assert(!ret);
+	/* header is packed, so it can be filled in place */
+	header->uid = (uintptr_t)uid;
+	header->id_0 = id_1 & TRACE_ID_MASK;
+	header->id_1 = id_2 & TRACE_ID_MASK;
+	header->core_id = cpu_get_id();
+	header->timestamp = timestamp + timer->delta;
+	header->log_entry_address = entry;
 
 	platform_shared_commit(timer, sizeof(*timer));
 }
@@ -110,31 +129,132 @@ static inline bool trace_filter_pass(uint32_t lvl,
 	return lvl <= ctx->level;
 }
 
-void trace_log(bool send_atomic, const void *log_entry,
-	       const struct tr_ctx *ctx, uint32_t lvl, uint32_t id_1,
-	       uint32_t id_2, int arg_count, ...)
+#if CONFIG_TRACE_RATE_LIMIT
+/**
+ * \brief Runtime per level rate limiting
+ * \param send_atomic true when called from atomic context
+ * \param lvl log level
+ * \param timestamp current platform timer value
+ * \return false when message should be dropped, otherwise true
+ *
+ * Counters are not protected by the trace lock, so with several cores
+ * logging at once a window may let through slightly more than burst
+ * messages. This keeps the common path down to a few compares.
+ */
+static bool trace_rate_limit_pass(bool send_atomic, uint32_t lvl,
+				  uint64_t timestamp)
+{
+	struct trace_rate_limit *limit = &trace_get()->limit[lvl];
+	uint32_t suppressed;
+
+	if (!limit->window_ms)
+		return true;
+
+	if (timestamp - limit->window_start < limit->window_ticks) {
+		if (limit->count < limit->burst) {
+			limit->count++;
+			return true;
+		}
+
+		limit->suppressed++;
+		return false;
+	}
+
+	/* clocks are not available yet during early boot */
+	if (!clocks_get())
+		return true;
+
+	/* new window, report what has been dropped in the previous one */
+	suppressed = limit->suppressed;
+	limit->window_ticks = clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK,
+						limit->window_ms);
+	limit->window_start = timestamp;
+	limit->count = 1;
+	limit->suppressed = 0;
+
+	if (suppressed) {
+		if (send_atomic)
+			tr_warn_atomic(&trace_tr, "trace: %u messages at level %u suppressed",
+				       suppressed, lvl);
+		else
+			tr_warn(&trace_tr, "trace: %u messages at level %u suppressed",
+				suppressed, lvl);
+	}
+
+	return true;
+}
+
+int trace_rate_limit_set(uint32_t lvl, uint32_t burst, uint32_t window_ms)
+{
+	struct trace *trace = trace_get();
+	struct trace_rate_limit *limit;
+	uint32_t flags;
+
+	/* critical messages are never limited */
+	if (lvl <= LOG_LEVEL_CRITICAL || lvl > LOG_LEVEL_VERBOSE)
+		return -EINVAL;
+
+	limit = &trace->limit[lvl];
+
+	spin_lock_irq(&trace->lock, flags);
+
+	limit->window_ms = window_ms;
+	limit->window_ticks = 0;
+	limit->burst = burst;
+	limit->window_start = 0;
+	limit->count = 0;
+	limit->suppressed = 0;
+
+	platform_shared_commit(trace, sizeof(*trace));
+
+	spin_unlock_irq(&trace->lock, flags);
+
+	return 0;
+}
+#else
+static inline bool trace_rate_limit_pass(bool send_atomic, uint32_t lvl,
+					 uint64_t timestamp)
+{
+	return true;
+}
+
+int trace_rate_limit_set(uint32_t lvl, uint32_t burst, uint32_t window_ms)
+{
+	return -ENOTSUP;
+}
+#endif /* CONFIG_TRACE_RATE_LIMIT */
+
+/**
+ * \brief Checks whether message should be logged
+ * \param send_atomic true when called from atomic context
+ * \param lvl log level
+ * \param ctx trace context
+ * \param timestamp filled with current platform timer value
+ * \return false when message is filtered out, otherwise true
+ */
+static inline bool trace_log_pass(bool send_atomic, uint32_t lvl,
+				  const struct tr_ctx *ctx,
+				  uint64_t *timestamp)
 {
-	uint32_t data[MESSAGE_SIZE_DWORDS(_TRACE_EVENT_MAX_ARGUMENT_COUNT)];
-	const int message_size = MESSAGE_SIZE(arg_count);
 	struct trace *trace = trace_get();
-	va_list vl;
-	int i;
-#if CONFIG_TRACEM
-	unsigned long flags;
-#endif /* CONFIG_TRACEM */
 
 	if (!trace->enable || !trace_filter_pass(lvl, ctx)) {
 		platform_shared_commit(trace, sizeof(*trace));
-		return;
+		return false;
 	}
 
-	/* fill log content */
-	put_header(data, ctx->uuid_p, id_1, id_2, (uint32_t)log_entry,
-		   platform_timer_get(timer_get()));
-	va_start(vl, arg_count);
-	for (i = 0; i < arg_count; ++i)
-		data[PAYLOAD_OFFSET(i)] = va_arg(vl, uint32_t);
-	va_end(vl);
+	*timestamp = platform_timer_get(timer_get());
+
+	return trace_rate_limit_pass(send_atomic, lvl, *timestamp);
+}
+
+static inline void trace_log_send(bool send_atomic, uint32_t lvl,
+				  const uint32_t *data, int message_size)
+{
+#if CONFIG_TRACEM
+	struct trace *trace = trace_get();
+	unsigned long flags;
+#endif /* CONFIG_TRACEM */
 
 	/* send event by */
 	if (send_atomic)
@@ -146,18 +266,67 @@ void trace_log(bool send_atomic, const void *log_entry,
 	/* send event by mail box too. */
 	if (send_atomic) {
 		spin_lock_irq(&trace->lock, flags);
-		mtrace_event((const char *)data, MESSAGE_SIZE(arg_count));
+		mtrace_event((const char *)data, message_size);
 		spin_unlock_irq(&trace->lock, flags);
 	} else {
-		mtrace_event((const char *)data, MESSAGE_SIZE(arg_count));
+		mtrace_event((const char *)data, message_size);
 	}
 #else
 	/* send event by mail box if level is LOG_LEVEL_CRITICAL. */
 	if (lvl == LOG_LEVEL_CRITICAL)
-		mtrace_event((const char *)data, MESSAGE_SIZE(arg_count));
+		mtrace_event((const char *)data, message_size);
 #endif /* CONFIG_TRACEM */
 }
 
+void trace_log(bool send_atomic, const void *log_entry,
+	       const struct tr_ctx *ctx, uint32_t lvl, uint32_t id_1,
+	       uint32_t id_2, int arg_count, ...)
+{
+	uint32_t data[MESSAGE_SIZE_DWORDS(_TRACE_EVENT_MAX_ARGUMENT_COUNT)];
+	uint64_t timestamp;
+	va_list vl;
+	int i;
+
+	if (!trace_log_pass(send_atomic, lvl, ctx, &timestamp))
+		return;
+
+	/* fill log content */
+	put_header(data, ctx->uuid_p, id_1, id_2, (uint32_t)log_entry,
+		   timestamp);
+	va_start(vl, arg_count);
+	for (i = 0; i < arg_count; ++i)
+		data[PAYLOAD_OFFSET(i)] = va_arg(vl, uint32_t);
+	va_end(vl);
+
+	trace_log_send(send_atomic, lvl, data, MESSAGE_SIZE(arg_count));
+}
+
+#define _TRACE_PAYLOAD_STEP(i, _) \
+	data[PAYLOAD_OFFSET(i)] = META_CONCAT(param, i);
+
+/* defines _trace_log_N() with fixed size record and unrolled payload */
+#define _TRACE_LOG_FUNC_DEF(arg_count)					\
+_TRACE_LOG_FUNC_DECL(arg_count)						\
+{									\
+	uint32_t data[MESSAGE_SIZE_DWORDS(arg_count)];			\
+	uint64_t timestamp;						\
+									\
+	if (!trace_log_pass(send_atomic, lvl, ctx, &timestamp))	\
+		return;							\
+									\
+	put_header(data, ctx->uuid_p, id_1, id_2, (uint32_t)log_entry,	\
+		   timestamp);						\
+	META_SEQ_FROM_0_TO(arg_count, _TRACE_PAYLOAD_STEP)		\
+									\
+	trace_log_send(send_atomic, lvl, data, MESSAGE_SIZE(arg_count)); \
+}
+
+_TRACE_LOG_FUNC_DEF(0)
+_TRACE_LOG_FUNC_DEF(1)
+_TRACE_LOG_FUNC_DEF(2)
+_TRACE_LOG_FUNC_DEF(3)
+_TRACE_LOG_FUNC_DEF(4)
+
 struct sof_ipc_trace_filter_elem *trace_filter_fill(struct sof_ipc_trace_filter_elem *elem,
 						    struct sof_ipc_trace_filter_elem *end,
 						    struct trace_filter *filter)
@@ -363,6 +532,12 @@ void trace_init(struct sof *sof)
 	sof->trace->enable = 1;
 	sof->trace->pos = 0;
 	spinlock_init(&sof->trace->lock);
+#if CONFIG_TRACE_RATE_LIMIT
+	sof->trace->limit[LOG_LEVEL_VERBOSE].burst =
+		CONFIG_TRACE_RATE_LIMIT_BURST;
+	sof->trace->limit[LOG_LEVEL_VERBOSE].window_ms =
+		CONFIG_TRACE_RATE_LIMIT_WINDOW_MS;
+#endif
 
 	platform_shared_commit(sof->trace, sizeof(*sof->trace));
 
@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/component.h>
+#include <sof/audio/buffer.h>
+#include <sof/audio/pipeline.h>
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <cmocka.h>
+
+#define TEST_SIZE	1024
+
+/* producer and consumer pipelines on different cores */
+struct test_data {
+	struct pipeline source_p;
+	struct pipeline sink_p;
+	struct comp_dev source;
+	struct comp_dev sink;
+	struct comp_buffer *buffer;
+};
+
+static uint32_t test_lines(const void *addr, uint32_t bytes)
+{
+	uintptr_t start = (uintptr_t)addr;
+
+	return (start + bytes + PLATFORM_DCACHE_ALIGN - 1) /
+		PLATFORM_DCACHE_ALIGN - start / PLATFORM_DCACHE_ALIGN;
+}
+
+static int setup(void **state)
+{
+	struct test_data *td = calloc(1, sizeof(*td));
+	struct sof_ipc_buffer desc = {
+		.size = TEST_SIZE,
+	};
+
+	td->buffer = buffer_new(&desc);
+	td->buffer->inter_core = true;
+	td->source.pipeline = &td->source_p;
+	td->sink.pipeline = &td->sink_p;
+	td->buffer->source = &td->source;
+	td->buffer->sink = &td->sink;
+
+	*state = td;
+
+	return 0;
+}
+
+static int teardown(void **state)
+{
+	struct test_data *td = *state;
+
+	buffer_free(td->buffer);
+	free(td);
+
+	return 0;
+}
+
+static void test_buffer_cache_invalidate(void **state)
+{
+	struct test_data *td = *state;
+	struct audio_stream *stream = &td->buffer->stream;
+	struct pipeline_cache_stats *stats = &td->sink_p.cache;
+	uint32_t lines;
+
+	audio_stream_produce(stream, 256);
+
+	/* request of the whole buffer invalidates only the data */
+	buffer_invalidate(td->buffer, TEST_SIZE);
+	assert_int_equal(stats->inv_req, test_lines(stream->addr, TEST_SIZE));
+	assert_int_equal(stats->inv_lines, test_lines(stream->addr, 256));
+	assert_int_equal(td->buffer->inv_bytes, 256);
+
+	/* data is already invalidated */
+	lines = stats->inv_lines;
+	buffer_invalidate(td->buffer, 128);
+	assert_int_equal(stats->inv_lines, lines);
+
+	/* only the new data is invalidated after consume and produce */
+	comp_update_buffer_consume(td->buffer, 128);
+	assert_int_equal(td->buffer->inv_bytes, 128);
+	audio_stream_produce(stream, 64);
+	buffer_invalidate(td->buffer, 192);
+	assert_int_equal(stats->inv_lines,
+			 lines + test_lines((char *)stream->addr + 256, 64));
+	assert_int_equal(td->buffer->inv_bytes, 192);
+
+	/* nothing is counted to the producer */
+	assert_int_equal(td->source_p.cache.inv_req, 0);
+	assert_int_equal(td->source_p.cache.inv_lines, 0);
+}
+
+static void test_buffer_cache_wrap(void **state)
+{
+	struct test_data *td = *state;
+	struct audio_stream *stream = &td->buffer->stream;
+	struct pipeline_cache_stats *stats = &td->sink_p.cache;
+
+	/* data wraps the end of the buffer */
+	audio_stream_produce(stream, TEST_SIZE - 64);
+	audio_stream_consume(stream, TEST_SIZE - 64);
+	audio_stream_produce(stream, 192);
+
+	buffer_invalidate(td->buffer, 192);
+	assert_int_equal(stats->inv_lines,
+			 test_lines((char *)stream->addr + TEST_SIZE - 64, 64) +
+			 test_lines(stream->addr, 128));
+	assert_int_equal(td->buffer->inv_bytes, 192);
+}
+
+static void test_buffer_cache_writeback(void **state)
+{
+	struct test_data *td = *state;
+	struct audio_stream *stream = &td->buffer->stream;
+
+	/* write back requests are only counted */
+	buffer_writeback(td->buffer, 256);
+	assert_int_equal(td->source_p.cache.wb_req,
+			 test_lines(stream->addr, 256));
+	assert_int_equal(td->source_p.cache.wb_lines, 0);
+	assert_int_equal(td->sink_p.cache.wb_req, 0);
+}
+
+static void test_buffer_cache_local(void **state)
+{
+	struct test_data *td = *state;
+	struct audio_stream *stream = &td->buffer->stream;
+
+	td->buffer->inter_core = false;
+	audio_stream_produce(stream, 256);
+
+	buffer_invalidate(td->buffer, 256);
+	buffer_writeback(td->buffer, 256);
+
+	assert_int_equal(td->sink_p.cache.inv_req, 0);
+	assert_int_equal(td->sink_p.cache.inv_lines, 0);
+	assert_int_equal(td->source_p.cache.wb_req, 0);
+	assert_int_equal(td->buffer->inv_bytes, 0);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown(test_buffer_cache_invalidate,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_buffer_cache_wrap,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_buffer_cache_writeback,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_buffer_cache_local,
+						setup, teardown),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
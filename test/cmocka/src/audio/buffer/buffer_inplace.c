@@ -0,0 +1,212 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/component.h>
+#include <sof/audio/buffer.h>
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <cmocka.h>
+
+#define TEST_BUFFERS	3
+#define TEST_SIZE	256
+
+struct test_data {
+	struct comp_buffer *buffers[TEST_BUFFERS];
+	void *addr[TEST_BUFFERS];
+};
+
+static int setup(void **state)
+{
+	struct test_data *td = calloc(1, sizeof(*td));
+	struct sof_ipc_buffer desc = {
+		.size = TEST_SIZE,
+	};
+	int i;
+
+	for (i = 0; i < TEST_BUFFERS; i++) {
+		desc.comp.id = i;
+		td->buffers[i] = buffer_new(&desc);
+		td->addr[i] = td->buffers[i]->stream.addr;
+	}
+
+	*state = td;
+
+	return 0;
+}
+
+static int teardown(void **state)
+{
+	struct test_data *td = *state;
+	int i;
+
+	for (i = 0; i < TEST_BUFFERS; i++)
+		if (td->buffers[i])
+			buffer_free(td->buffers[i]);
+
+	free(td);
+
+	return 0;
+}
+
+/* in-place component adding one to each byte of its source */
+static void test_inplace_copy(struct comp_buffer *source,
+			      struct comp_buffer *sink, uint32_t bytes)
+{
+	uint8_t *x;
+	uint8_t *y;
+	uint32_t i;
+
+	assert_ptr_equal(source->stream.r_ptr, sink->stream.w_ptr);
+
+	for (i = 0; i < bytes; i++) {
+		x = audio_stream_read_frag(&source->stream, i, sizeof(*x));
+		y = audio_stream_write_frag(&sink->stream, i, sizeof(*y));
+		*y = *x + 1;
+	}
+
+	comp_update_buffer_produce(sink, bytes);
+	comp_update_buffer_consume(source, bytes);
+}
+
+static void test_buffer_inplace_link(void **state)
+{
+	struct test_data *td = *state;
+	struct comp_buffer **b = td->buffers;
+	int i;
+
+	buffer_inplace_link(b[0], b[1]);
+	buffer_inplace_link(b[1], b[2]);
+
+	for (i = 0; i < TEST_BUFFERS; i++) {
+		assert_ptr_equal(b[i]->stream.addr, td->addr[0]);
+		assert_ptr_equal(b[i]->stream.w_ptr, td->addr[0]);
+		assert_int_equal(b[i]->stream.size, TEST_SIZE);
+	}
+
+	buffer_inplace_unlink(b[1]);
+
+	/* downstream buffers follow the storage of the unlinked one */
+	assert_null(b[0]->inplace_sink);
+	assert_ptr_equal(b[1]->stream.addr, td->addr[1]);
+	assert_ptr_equal(b[2]->stream.addr, td->addr[1]);
+
+	buffer_inplace_unlink(b[2]);
+	assert_ptr_equal(b[2]->stream.addr, td->addr[2]);
+}
+
+/* capture pipelines are prepared from the last component upstream */
+static void test_buffer_inplace_link_upstream(void **state)
+{
+	struct test_data *td = *state;
+	struct comp_buffer **b = td->buffers;
+	int i;
+
+	buffer_inplace_link(b[1], b[2]);
+	buffer_inplace_link(b[0], b[1]);
+
+	for (i = 0; i < TEST_BUFFERS; i++)
+		assert_ptr_equal(b[i]->stream.addr, td->addr[0]);
+}
+
+static void test_buffer_inplace_free_bytes(void **state)
+{
+	struct test_data *td = *state;
+	struct comp_buffer **b = td->buffers;
+
+	buffer_inplace_link(b[0], b[1]);
+	buffer_inplace_link(b[1], b[2]);
+
+	comp_update_buffer_produce(b[0], 192);
+	test_inplace_copy(b[0], b[1], 128);
+	test_inplace_copy(b[1], b[2], 64);
+
+	assert_int_equal(audio_stream_get_avail_bytes(&b[0]->stream), 64);
+	assert_int_equal(audio_stream_get_avail_bytes(&b[1]->stream), 64);
+	assert_int_equal(audio_stream_get_avail_bytes(&b[2]->stream), 64);
+
+	/* only the space not used by any buffer of the group can be written */
+	assert_int_equal(audio_stream_get_free_bytes(&b[0]->stream), 64);
+	assert_int_equal(audio_stream_get_free_bytes(&b[1]->stream), 128);
+	assert_int_equal(audio_stream_get_free_bytes(&b[2]->stream), 192);
+
+	/* last consumer releases the space to the first producer */
+	comp_update_buffer_consume(b[2], 64);
+	assert_int_equal(audio_stream_get_free_bytes(&b[0]->stream), 128);
+}
+
+static void test_buffer_inplace_data(void **state)
+{
+	struct test_data *td = *state;
+	struct comp_buffer **b = td->buffers;
+	uint8_t *data;
+	uint32_t i;
+	int n;
+
+	buffer_inplace_link(b[0], b[1]);
+	buffer_inplace_link(b[1], b[2]);
+
+	/* run over the wrap a few times */
+	for (n = 0; n < 8; n++) {
+		for (i = 0; i < 96; i++) {
+			data = audio_stream_write_frag(&b[0]->stream, i,
+						       sizeof(*data));
+			*data = i;
+		}
+		comp_update_buffer_produce(b[0], 96);
+
+		test_inplace_copy(b[0], b[1], 96);
+		test_inplace_copy(b[1], b[2], 96);
+
+		for (i = 0; i < 96; i++) {
+			data = audio_stream_read_frag(&b[2]->stream, i,
+						      sizeof(*data));
+			assert_int_equal(*data, i + 2);
+		}
+		comp_update_buffer_consume(b[2], 96);
+
+		assert_int_equal(audio_stream_get_free_bytes(&b[0]->stream),
+				 TEST_SIZE);
+	}
+}
+
+static void test_buffer_inplace_free(void **state)
+{
+	struct test_data *td = *state;
+	struct comp_buffer **b = td->buffers;
+
+	buffer_inplace_link(b[0], b[1]);
+	buffer_inplace_link(b[1], b[2]);
+
+	/* freed buffer leaves the group with its storage */
+	buffer_free(b[0]);
+	b[0] = NULL;
+
+	assert_null(b[1]->inplace_source);
+	assert_ptr_equal(b[1]->stream.addr, td->addr[1]);
+	assert_ptr_equal(b[2]->stream.addr, td->addr[1]);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown(test_buffer_inplace_link,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_buffer_inplace_link_upstream,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_buffer_inplace_free_bytes,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_buffer_inplace_data,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_buffer_inplace_free,
+						setup, teardown),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
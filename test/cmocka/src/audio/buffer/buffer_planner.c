@@ -0,0 +1,308 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/component.h>
+#include <sof/audio/buffer.h>
+#include <sof/audio/pipeline.h>
+#include <sof/list.h>
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <cmocka.h>
+
+#define TEST_COMPS	7
+#define TEST_BUFFERS	(TEST_COMPS - 1)
+
+/* components of a long linear pipeline */
+#define TEST_LONG_COMPS	40
+
+struct test_data {
+	struct pipeline p;
+	struct comp_dev *comps[TEST_COMPS];
+	struct comp_buffer *buffers[TEST_BUFFERS];
+};
+
+static const struct comp_driver test_drv = {
+	.flags = COMP_DRV_DRAIN,
+};
+
+static const struct comp_driver test_drv_blocks;
+
+static struct comp_dev *test_comp_new(struct pipeline *p)
+{
+	struct comp_dev *dev = calloc(1, sizeof(*dev));
+
+	dev->drv = &test_drv;
+	dev->pipeline = p;
+	list_init(&dev->bsource_list);
+	list_init(&dev->bsink_list);
+
+	return dev;
+}
+
+static struct comp_buffer *test_buffer_new(uint32_t id, uint32_t size)
+{
+	struct sof_ipc_buffer desc = {
+		.comp.id = id,
+		.size = size,
+	};
+
+	return buffer_new(&desc);
+}
+
+static void test_connect(struct comp_dev *source, struct comp_buffer *buffer,
+			 struct comp_dev *sink)
+{
+	list_item_prepend(&buffer->source_list, &source->bsink_list);
+	buffer->source = source;
+	list_item_prepend(&buffer->sink_list, &sink->bsource_list);
+	buffer->sink = sink;
+}
+
+/* host -> b0 -> c1 -> b1 -> ... -> b5 -> dai */
+static int setup(void **state)
+{
+	struct test_data *td = calloc(1, sizeof(*td));
+	int i;
+
+	for (i = 0; i < TEST_COMPS; i++)
+		td->comps[i] = test_comp_new(&td->p);
+
+	for (i = 0; i < TEST_BUFFERS; i++) {
+		td->buffers[i] = test_buffer_new(i, 256 + 64 * i);
+		test_connect(td->comps[i], td->buffers[i], td->comps[i + 1]);
+	}
+
+	td->p.source_comp = td->comps[0];
+	td->p.sink_comp = td->comps[TEST_COMPS - 1];
+
+	*state = td;
+
+	return 0;
+}
+
+static int teardown(void **state)
+{
+	struct test_data *td = *state;
+	int i;
+
+	for (i = 0; i < TEST_BUFFERS; i++)
+		if (td->buffers[i])
+			buffer_free(td->buffers[i]);
+
+	for (i = 0; i < TEST_COMPS; i++)
+		free(td->comps[i]);
+
+	free(td);
+
+	return 0;
+}
+
+static void test_buffer_planner_linear(void **state)
+{
+	struct test_data *td = *state;
+	struct comp_buffer **b = td->buffers;
+	int i;
+
+	pipeline_buffers_plan(&td->p);
+
+	/* buffers of the first and last components stay private */
+	assert_null(b[0]->arena);
+	assert_null(b[TEST_BUFFERS - 1]->arena);
+
+	/* neighbours are live together in the copy of the component
+	 * between them, every other buffer shares the storage
+	 */
+	assert_non_null(b[1]->arena);
+	assert_non_null(b[2]->arena);
+	assert_ptr_equal(b[1]->arena, b[3]->arena);
+	assert_ptr_equal(b[2]->arena, b[4]->arena);
+	assert_ptr_not_equal(b[1]->arena, b[2]->arena);
+	assert_int_equal(b[1]->arena->users, 2);
+
+	/* arena fits the largest user */
+	assert_int_equal(b[1]->arena->size, b[3]->stream.size);
+	assert_int_equal(b[2]->arena->size, b[4]->stream.size);
+
+	for (i = 1; i < TEST_BUFFERS - 1; i++) {
+		assert_ptr_equal(b[i]->stream.addr, b[i]->arena->addr);
+		assert_int_equal(b[i]->stream.size, 256 + 64 * i);
+		assert_ptr_equal(b[i]->stream.w_ptr, b[i]->stream.addr);
+		assert_int_equal(audio_stream_get_free_bytes(&b[i]->stream),
+				 b[i]->stream.size);
+	}
+}
+
+static void test_buffer_planner_free(void **state)
+{
+	struct test_data *td = *state;
+	struct comp_buffer **b = td->buffers;
+	struct buffer_arena *arena;
+
+	pipeline_buffers_plan(&td->p);
+	arena = b[1]->arena;
+
+	/* storage stays until the last user is freed */
+	buffer_free(b[1]);
+	b[1] = NULL;
+	assert_int_equal(arena->users, 1);
+
+	comp_update_buffer_produce(b[3], b[3]->stream.size);
+	comp_update_buffer_consume(b[3], b[3]->stream.size);
+}
+
+static void test_buffer_planner_blocks(void **state)
+{
+	struct test_data *td = *state;
+	struct comp_buffer **b = td->buffers;
+
+	/* c3 can leave data in b2 after a copy, e.g. SRC consuming blocks */
+	td->comps[3]->drv = &test_drv_blocks;
+
+	pipeline_buffers_plan(&td->p);
+
+	assert_null(b[2]->arena);
+	assert_non_null(b[1]->arena);
+	assert_ptr_equal(b[1]->arena, b[3]->arena);
+	assert_null(b[4]->arena);
+}
+
+/* c2 can't drain b1 when its sink buffer is full */
+static void test_buffer_planner_data_left(void **state)
+{
+	struct test_data *td = *state;
+	struct comp_buffer **b = td->buffers;
+	struct buffer_arena *arena;
+	uint8_t *data;
+	int i;
+
+	pipeline_buffers_plan(&td->p);
+	arena = b[1]->arena;
+
+	/* drained buffers keep the shared storage */
+	comp_update_buffer_produce(b[1], 64);
+	comp_update_buffer_consume(b[1], 64);
+	assert_int_equal(pipeline_buffers_check(td->comps[2]), 0);
+	assert_ptr_equal(b[1]->arena, arena);
+
+	data = audio_stream_write_frag(&b[1]->stream, 0, 1);
+	for (i = 0; i < 32; i++)
+		data[i] = i;
+	comp_update_buffer_produce(b[1], 32);
+
+	/* data left is moved to private storage at the same offset */
+	assert_int_equal(pipeline_buffers_check(td->comps[2]), 0);
+	assert_null(b[1]->arena);
+	assert_ptr_not_equal(b[1]->stream.addr, arena->addr);
+	assert_int_equal(arena->users, 1);
+	assert_ptr_equal(b[3]->arena, arena);
+
+	assert_int_equal(audio_stream_get_avail_bytes(&b[1]->stream), 32);
+	assert_ptr_equal(b[1]->stream.r_ptr, (char *)b[1]->stream.addr + 64);
+	data = b[1]->stream.r_ptr;
+	for (i = 0; i < 32; i++)
+		assert_int_equal(data[i], i);
+}
+
+static void test_buffer_planner_long(void **state)
+{
+	struct comp_buffer *buffers[TEST_LONG_COMPS - 1];
+	struct comp_dev *comps[TEST_LONG_COMPS];
+	struct pipeline p = { 0 };
+	int i;
+
+	for (i = 0; i < TEST_LONG_COMPS; i++)
+		comps[i] = test_comp_new(&p);
+
+	for (i = 0; i < TEST_LONG_COMPS - 1; i++) {
+		buffers[i] = test_buffer_new(i, 256);
+		test_connect(comps[i], buffers[i], comps[i + 1]);
+	}
+
+	p.source_comp = comps[0];
+	p.sink_comp = comps[TEST_LONG_COMPS - 1];
+
+	pipeline_buffers_plan(&p);
+
+	/* all intermediate buffers are planned into two arenas */
+	for (i = 1; i < TEST_LONG_COMPS - 2; i++)
+		assert_ptr_equal(buffers[i]->arena,
+				 buffers[1 + (i + 1) % 2]->arena);
+
+	assert_int_equal(buffers[1]->arena->users, (TEST_LONG_COMPS - 2) / 2);
+	assert_int_equal(buffers[2]->arena->users, (TEST_LONG_COMPS - 3) / 2);
+
+	for (i = 0; i < TEST_LONG_COMPS - 1; i++)
+		buffer_free(buffers[i]);
+
+	for (i = 0; i < TEST_LONG_COMPS; i++)
+		free(comps[i]);
+}
+
+static void test_buffer_planner_branch(void **state)
+{
+	struct test_data *td = *state;
+	struct comp_buffer **b = td->buffers;
+	struct comp_buffer *branch;
+	struct comp_dev *sink;
+
+	/* buffers of c2 with a second sink are live until both sinks copy */
+	sink = test_comp_new(&td->p);
+	branch = test_buffer_new(TEST_BUFFERS, 256);
+	test_connect(td->comps[2], branch, sink);
+
+	pipeline_buffers_plan(&td->p);
+
+	assert_null(b[2]->arena);
+	assert_null(branch->arena);
+
+	/* b1 is drained by c2 before the sinks of c2 are copied */
+	assert_non_null(b[1]->arena);
+	assert_ptr_equal(b[1]->arena, b[3]->arena);
+	assert_null(b[4]->arena);
+
+	buffer_free(branch);
+	free(sink);
+}
+
+static void test_buffer_planner_inter_core(void **state)
+{
+	struct test_data *td = *state;
+	struct comp_buffer **b = td->buffers;
+
+	b[3]->inter_core = true;
+
+	pipeline_buffers_plan(&td->p);
+
+	assert_null(b[3]->arena);
+	assert_non_null(b[1]->arena);
+	assert_ptr_equal(b[1]->arena, b[4]->arena);
+	assert_null(b[2]->arena);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown(test_buffer_planner_linear,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_buffer_planner_free,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_buffer_planner_blocks,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_buffer_planner_data_left,
+						setup, teardown),
+		cmocka_unit_test(test_buffer_planner_long),
+		cmocka_unit_test_setup_teardown(test_buffer_planner_branch,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_buffer_planner_inter_core,
+						setup, teardown),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
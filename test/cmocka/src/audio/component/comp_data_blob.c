@@ -0,0 +1,282 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/component.h>
+#include <ipc/control.h>
+#include <kernel/abi.h>
+
+#include <errno.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+
+#define TEST_BLOB_SIZE		64
+#define TEST_BLOB_MAX_SIZE	(2 * TEST_BLOB_SIZE)
+
+/* data prepared from a blob, tagged with the first blob byte */
+struct test_prepared {
+	uint8_t tag;
+};
+
+struct test_data {
+	struct comp_dev dev;
+	struct comp_data_blob_handler *handler;
+	uint8_t in_use;		/* tag of the data the component uses */
+	int prepares;
+	int swaps;
+	int frees;
+	int prepare_ret;
+	uint32_t blob_size;	/* size of the last blob sent */
+	uint8_t ipc[sizeof(struct sof_ipc_ctrl_data) +
+		    sizeof(struct sof_abi_hdr) + TEST_BLOB_MAX_SIZE];
+};
+
+static int test_blob_prepare(struct comp_dev *dev, void *data, size_t size,
+			     void **prepared)
+{
+	struct test_data *td = container_of(dev, struct test_data, dev);
+	struct test_prepared *p;
+
+	assert_int_equal(size, td->blob_size);
+
+	td->prepares++;
+	if (td->prepare_ret < 0)
+		return td->prepare_ret;
+
+	p = malloc(sizeof(*p));
+	p->tag = *(uint8_t *)data;
+	*prepared = p;
+
+	return 0;
+}
+
+static void test_blob_swap(struct comp_dev *dev, void *prepared)
+{
+	struct test_data *td = container_of(dev, struct test_data, dev);
+	struct test_prepared *p = prepared;
+	uint8_t tag = td->in_use;
+
+	td->swaps++;
+	td->in_use = p->tag;
+	p->tag = tag;
+}
+
+static void test_blob_free(struct comp_dev *dev, void *prepared)
+{
+	struct test_data *td = container_of(dev, struct test_data, dev);
+
+	td->frees++;
+	free(prepared);
+}
+
+static const struct comp_data_blob_ops test_ops = {
+	.prepare = test_blob_prepare,
+	.swap = test_blob_swap,
+	.free = test_blob_free,
+};
+
+/* sends a blob of the size filled with the tag in fragments */
+static int test_set_size(struct test_data *td, uint8_t tag, uint32_t size,
+			 uint32_t fragment)
+{
+	struct sof_ipc_ctrl_data *cdata = (struct sof_ipc_ctrl_data *)td->ipc;
+	uint32_t sent = 0;
+	int ret;
+
+	memset(td->ipc, 0, sizeof(td->ipc));
+	cdata->data->size = size;
+	td->blob_size = size;
+
+	while (sent < size) {
+		cdata->num_elems = MIN(fragment, size - sent);
+		cdata->elems_remaining = size - sent - cdata->num_elems;
+		memset(cdata->data->data, tag, cdata->num_elems);
+
+		ret = comp_data_blob_set_cmd(td->handler, cdata);
+		if (ret < 0)
+			return ret;
+
+		sent += cdata->num_elems;
+		cdata->msg_index++;
+	}
+
+	return 0;
+}
+
+static int test_set(struct test_data *td, uint8_t tag, uint32_t fragment)
+{
+	return test_set_size(td, tag, TEST_BLOB_SIZE, fragment);
+}
+
+static uint8_t test_blob_tag(struct test_data *td)
+{
+	uint8_t *blob = comp_get_data_blob(td->handler, NULL, NULL);
+
+	return blob ? *blob : 0;
+}
+
+static int setup(void **state)
+{
+	struct test_data *td = calloc(1, sizeof(*td));
+
+	td->handler = comp_data_blob_handler_new(&td->dev);
+	comp_data_blob_set_ops(td->handler, &test_ops);
+	td->dev.state = COMP_STATE_ACTIVE;
+
+	*state = td;
+
+	return 0;
+}
+
+static int teardown(void **state)
+{
+	struct test_data *td = *state;
+
+	comp_data_blob_handler_free(td->handler);
+	free(td);
+
+	return 0;
+}
+
+static void test_comp_data_blob_ready(void **state)
+{
+	struct test_data *td = *state;
+
+	/* blob is used as such before streaming */
+	td->dev.state = COMP_STATE_READY;
+	assert_int_equal(test_set(td, 1, TEST_BLOB_SIZE), 0);
+
+	assert_false(comp_is_new_data_blob_available(td->handler));
+	assert_int_equal(test_blob_tag(td), 1);
+	assert_int_equal(td->prepares, 0);
+	assert_int_equal(td->swaps, 0);
+}
+
+static void test_comp_data_blob_swap(void **state)
+{
+	struct test_data *td = *state;
+
+	/* prepared once all the fragments are received */
+	assert_int_equal(test_set(td, 1, TEST_BLOB_SIZE / 4), 0);
+	assert_int_equal(td->prepares, 1);
+	assert_true(comp_is_new_data_blob_available(td->handler));
+
+	/* copy() swaps to the prepared data */
+	assert_int_equal(test_blob_tag(td), 1);
+	assert_int_equal(td->swaps, 1);
+	assert_int_equal(td->in_use, 1);
+	assert_false(comp_is_new_data_blob_available(td->handler));
+
+	/* the swapped out data is freed by the next blob */
+	assert_int_equal(td->frees, 0);
+	assert_int_equal(test_set(td, 2, TEST_BLOB_SIZE), 0);
+	assert_int_equal(td->frees, 1);
+
+	assert_int_equal(test_blob_tag(td), 2);
+	assert_int_equal(td->in_use, 2);
+}
+
+static void test_comp_data_blob_busy(void **state)
+{
+	struct test_data *td = *state;
+
+	/* next blob is rejected until the prepared one is swapped to */
+	assert_int_equal(test_set(td, 1, TEST_BLOB_SIZE), 0);
+	assert_int_equal(test_set(td, 2, TEST_BLOB_SIZE), -EBUSY);
+	assert_int_equal(td->prepares, 1);
+
+	assert_int_equal(test_blob_tag(td), 1);
+	assert_int_equal(td->in_use, 1);
+}
+
+static void test_comp_data_blob_invalid(void **state)
+{
+	struct test_data *td = *state;
+
+	assert_int_equal(test_set(td, 1, TEST_BLOB_SIZE), 0);
+	assert_int_equal(test_blob_tag(td), 1);
+
+	/* blob failing the preparation is dropped */
+	td->prepare_ret = -EINVAL;
+	assert_int_equal(test_set(td, 2, TEST_BLOB_SIZE), -EINVAL);
+	assert_false(comp_is_new_data_blob_available(td->handler));
+	assert_int_equal(td->in_use, 1);
+
+	/* and doesn't block the next one */
+	td->prepare_ret = 0;
+	assert_int_equal(test_set(td, 3, TEST_BLOB_SIZE), 0);
+	assert_int_equal(test_blob_tag(td), 3);
+	assert_int_equal(td->in_use, 3);
+}
+
+/* a rejected blob larger than the current one doesn't change its size */
+static void test_comp_data_blob_invalid_size(void **state)
+{
+	struct test_data *td = *state;
+	struct sof_ipc_ctrl_data *cdata = (struct sof_ipc_ctrl_data *)td->ipc;
+	uint8_t *blob;
+	size_t size;
+	int i;
+
+	assert_int_equal(test_set(td, 1, TEST_BLOB_SIZE), 0);
+	assert_int_equal(test_blob_tag(td), 1);
+
+	td->prepare_ret = -EINVAL;
+	assert_int_equal(test_set_size(td, 2, TEST_BLOB_MAX_SIZE,
+				       TEST_BLOB_SIZE), -EINVAL);
+
+	blob = comp_get_data_blob(td->handler, &size, NULL);
+	assert_int_equal(size, TEST_BLOB_SIZE);
+	assert_int_equal(*blob, 1);
+
+	/* the host reads back the current blob */
+	memset(td->ipc, 0, sizeof(td->ipc));
+	cdata->num_elems = TEST_BLOB_SIZE;
+	assert_int_equal(comp_data_blob_get_cmd(td->handler, cdata,
+						TEST_BLOB_MAX_SIZE), 0);
+	assert_int_equal(cdata->data->size, TEST_BLOB_SIZE);
+	blob = (uint8_t *)cdata->data->data;
+	for (i = 0; i < TEST_BLOB_SIZE; i++)
+		assert_int_equal(blob[i], 1);
+}
+
+static void test_comp_data_blob_free(void **state)
+{
+	struct test_data *td = *state;
+
+	assert_int_equal(test_set(td, 1, TEST_BLOB_SIZE), 0);
+	assert_int_equal(test_blob_tag(td), 1);
+	assert_int_equal(test_set(td, 2, TEST_BLOB_SIZE), 0);
+
+	/* both the swapped out and the pending data are freed */
+	comp_data_blob_handler_free(td->handler);
+	td->handler = NULL;
+	assert_int_equal(td->frees, 2);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown(test_comp_data_blob_ready,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_comp_data_blob_swap,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_comp_data_blob_busy,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_comp_data_blob_invalid,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_comp_data_blob_invalid_size,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_comp_data_blob_free,
+						setup, teardown),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,288 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include "../../util.h"
+
+#include <sof/audio/component_ext.h>
+#include <sof/audio/format.h>
+#include <sof/audio/matrix/matrix.h>
+#include <kernel/abi.h>
+#include <kernel/header.h>
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <cmocka.h>
+
+#define MATRIX_TEST_CHANNELS	2
+#define MATRIX_TEST_FRAMES	16
+
+#if CONFIG_FORMAT_S32LE
+#define MATRIX_TEST_FORMAT	SOF_IPC_FRAME_S32_LE
+#elif CONFIG_FORMAT_S24LE
+#define MATRIX_TEST_FORMAT	SOF_IPC_FRAME_S24_4LE
+#else
+#define MATRIX_TEST_FORMAT	SOF_IPC_FRAME_S16_LE
+#endif
+
+/* Q2.14 unity gain */
+#define G1	16384
+
+struct test_data {
+	struct comp_dev *dev;
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+};
+
+static const int16_t identity_2_2[] = { G1, 0, 0, G1 };
+static const int16_t swap_2_2[] = { 0, G1, G1, 0 };
+static const int16_t downmix_2_1[] = { G1, G1 };
+
+static int setup_group(void **state)
+{
+	sys_comp_init(sof_get());
+	sys_comp_matrix_init();
+
+	return 0;
+}
+
+static void init_matrix_config(struct sof_matrix_config *matrix,
+			       uint16_t in_channels, uint16_t out_channels,
+			       const int16_t *coef)
+{
+	size_t coef_size = in_channels * out_channels * sizeof(int16_t);
+
+	matrix->size = sizeof(*matrix) + coef_size;
+	matrix->in_channels = in_channels;
+	matrix->out_channels = out_channels;
+	memcpy_s(matrix->coef, coef_size, coef, coef_size);
+}
+
+static struct sof_ipc_comp_process *create_matrix_comp_ipc(void)
+{
+	size_t matrix_size = sizeof(struct sof_matrix_config) +
+		sizeof(identity_2_2);
+	struct sof_ipc_comp_process *ipc =
+		calloc(1, sizeof(*ipc) + matrix_size);
+
+	ipc->comp.hdr.size = sizeof(struct sof_ipc_comp_process);
+	ipc->comp.type = SOF_COMP_NONE;
+	ipc->config.hdr.size = sizeof(struct sof_ipc_comp_config);
+	ipc->size = matrix_size;
+
+	init_matrix_config((struct sof_matrix_config *)&ipc->data,
+			   MATRIX_TEST_CHANNELS, MATRIX_TEST_CHANNELS,
+			   identity_2_2);
+
+	return ipc;
+}
+
+/* sends the blob in one message, as the host does for small blobs */
+static int set_matrix_blob(struct comp_dev *dev, uint16_t in_channels,
+			   uint16_t out_channels, const int16_t *coef)
+{
+	size_t matrix_size = sizeof(struct sof_matrix_config) +
+		in_channels * out_channels * sizeof(int16_t);
+	size_t ipc_size = sizeof(struct sof_ipc_ctrl_data) +
+		sizeof(struct sof_abi_hdr) + matrix_size;
+	struct sof_ipc_ctrl_data *cdata = calloc(1, ipc_size);
+	int ret;
+
+	cdata->cmd = SOF_CTRL_CMD_BINARY;
+	cdata->num_elems = matrix_size;
+	cdata->data->magic = SOF_ABI_MAGIC;
+	cdata->data->abi = SOF_ABI_VERSION;
+	cdata->data->size = matrix_size;
+	init_matrix_config((struct sof_matrix_config *)cdata->data->data,
+			   in_channels, out_channels, coef);
+
+	ret = comp_cmd(dev, COMP_CMD_SET_DATA, cdata, ipc_size);
+	free(cdata);
+
+	return ret;
+}
+
+/* small values are passed unchanged by unity gains in every format */
+static int32_t test_sample(int frame, int channel)
+{
+	return (frame + 1) * 100 + channel;
+}
+
+static void write_sample(struct audio_stream *stream, int i, int32_t x)
+{
+	int16_t *y16;
+	int32_t *y32;
+
+	if (stream->frame_fmt == SOF_IPC_FRAME_S16_LE) {
+		y16 = audio_stream_write_frag_s16(stream, i);
+		*y16 = x;
+	} else {
+		y32 = audio_stream_write_frag_s32(stream, i);
+		*y32 = x;
+	}
+}
+
+static int32_t read_sample(struct audio_stream *stream, int i)
+{
+	int16_t *x16;
+	int32_t *x32;
+
+	if (stream->frame_fmt == SOF_IPC_FRAME_S16_LE) {
+		x16 = audio_stream_read_frag_s16(stream, i);
+		return *x16;
+	}
+
+	x32 = audio_stream_read_frag_s32(stream, i);
+	return *x32;
+}
+
+/* writes a period to the source and runs copy() on it */
+static void copy_period(struct test_data *td)
+{
+	struct audio_stream *source = &td->source->stream;
+	struct audio_stream *sink = &td->sink->stream;
+	int i;
+
+	for (i = 0; i < MATRIX_TEST_FRAMES * MATRIX_TEST_CHANNELS; i++)
+		write_sample(source, i, test_sample(i / MATRIX_TEST_CHANNELS,
+						    i % MATRIX_TEST_CHANNELS));
+
+	audio_stream_produce(source, MATRIX_TEST_FRAMES *
+			     audio_stream_frame_bytes(source));
+
+	assert_int_equal(comp_copy(td->dev), 0);
+	assert_int_equal(audio_stream_get_avail_frames(sink),
+			 MATRIX_TEST_FRAMES);
+}
+
+/* checks the copied period and consumes it from the sink */
+static void check_period(struct test_data *td, bool swapped)
+{
+	struct audio_stream *sink = &td->sink->stream;
+	int frame;
+	int ch;
+
+	for (frame = 0; frame < MATRIX_TEST_FRAMES; frame++)
+		for (ch = 0; ch < MATRIX_TEST_CHANNELS; ch++)
+			assert_int_equal(read_sample(sink, frame *
+						     MATRIX_TEST_CHANNELS + ch),
+					 test_sample(frame,
+						     swapped ? 1 - ch : ch));
+
+	audio_stream_consume(sink, MATRIX_TEST_FRAMES *
+			     audio_stream_frame_bytes(sink));
+}
+
+static int setup_test_case(void **state)
+{
+	struct test_data *td = test_calloc(1, sizeof(*td));
+	struct sof_ipc_comp_process *ipc = create_matrix_comp_ipc();
+	uint32_t frame_bytes = get_frame_bytes(MATRIX_TEST_FORMAT,
+					       MATRIX_TEST_CHANNELS);
+	int ret;
+
+	*state = td;
+
+	td->dev = comp_new((struct sof_ipc_comp *)ipc);
+	free(ipc);
+
+	if (!td->dev)
+		return -EINVAL;
+
+	td->source = create_test_source(td->dev, 0, MATRIX_TEST_FORMAT,
+					MATRIX_TEST_CHANNELS,
+					MATRIX_TEST_FRAMES * frame_bytes);
+	td->sink = create_test_sink(td->dev, 0, MATRIX_TEST_FORMAT,
+				    MATRIX_TEST_CHANNELS,
+				    MATRIX_TEST_FRAMES * frame_bytes);
+
+	ret = comp_prepare(td->dev);
+	if (ret < 0)
+		return ret;
+
+	return comp_trigger(td->dev, COMP_TRIGGER_START);
+}
+
+static int teardown_test_case(void **state)
+{
+	struct test_data *td = *state;
+
+	free_test_source(td->source);
+	free_test_sink(td->sink);
+
+	comp_free(td->dev);
+	test_free(td);
+
+	return 0;
+}
+
+/* a blob set while streaming is prepared in the IPC and swapped to only
+ * at the next copy()
+ */
+static void test_matrix_blob_set_active(void **state)
+{
+	struct test_data *td = *state;
+	struct matrix_comp_data *cd = comp_get_drvdata(td->dev);
+
+	assert_int_equal(td->dev->state, COMP_STATE_ACTIVE);
+	assert_ptr_equal(cd->plan.func, matrix_identity);
+
+	copy_period(td);
+	check_period(td, false);
+
+	assert_int_equal(set_matrix_blob(td->dev, MATRIX_TEST_CHANNELS,
+					 MATRIX_TEST_CHANNELS, swap_2_2), 0);
+	assert_ptr_equal(cd->plan.func, matrix_identity);
+
+	copy_period(td);
+	check_period(td, true);
+	assert_ptr_equal(cd->plan.func,
+			 matrix_find_copy_func(MATRIX_TEST_FORMAT));
+
+	/* the plan swapped out is freed by the next blob */
+	assert_int_equal(set_matrix_blob(td->dev, MATRIX_TEST_CHANNELS,
+					 MATRIX_TEST_CHANNELS, identity_2_2),
+			 0);
+
+	copy_period(td);
+	check_period(td, false);
+	assert_ptr_equal(cd->plan.func, matrix_identity);
+}
+
+/* a blob changing the channel counts is rejected while streaming and the
+ * current plan stays in use
+ */
+static void test_matrix_blob_set_active_channels(void **state)
+{
+	struct test_data *td = *state;
+	struct matrix_comp_data *cd = comp_get_drvdata(td->dev);
+
+	assert_int_equal(set_matrix_blob(td->dev, MATRIX_TEST_CHANNELS, 1,
+					 downmix_2_1), -EINVAL);
+	assert_false(comp_is_new_data_blob_available(cd->model_handler));
+
+	copy_period(td);
+	check_period(td, false);
+	assert_ptr_equal(cd->plan.func, matrix_identity);
+	assert_int_equal(cd->plan.out_channels, MATRIX_TEST_CHANNELS);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown(test_matrix_blob_set_active,
+						setup_test_case,
+						teardown_test_case),
+		cmocka_unit_test_setup_teardown(test_matrix_blob_set_active_channels,
+						setup_test_case,
+						teardown_test_case),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, setup_group, NULL);
+}
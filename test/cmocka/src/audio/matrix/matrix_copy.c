@@ -0,0 +1,338 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include "../../util.h"
+
+#include <sof/audio/component_ext.h>
+#include <sof/audio/format.h>
+#include <sof/audio/matrix/matrix.h>
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <cmocka.h>
+
+#define MATRIX_TEST_FRAMES	16
+
+/* frames processed before the test so that the streams wrap */
+#define MATRIX_TEST_OFFSET	5
+
+/* Q2.14 test gains */
+#define G1	16384	/* 1.0 */
+#define GH	8192	/* 0.5 */
+#define GS	11585	/* 0.707 */
+#define GM	(-8192)	/* -0.5 */
+#define G2	32767	/* ~2.0 */
+
+enum matrix_test_func {
+	MATRIX_TEST_IDENTITY,
+	MATRIX_TEST_COPY,
+	MATRIX_TEST_DENSE,
+	MATRIX_TEST_GENERIC,
+};
+
+struct test_data {
+	const char *name;
+	uint16_t in_channels;
+	uint16_t out_channels;
+	int16_t coef[MATRIX_MAX_TERMS];
+	enum sof_ipc_frame source_format;
+	enum sof_ipc_frame sink_format;
+	enum matrix_test_func func;
+	struct comp_dev *dev;
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+};
+
+static struct test_data test_cases[] = {
+#if CONFIG_FORMAT_S16LE
+	{ "identity_s16le", 2, 2, { G1, 0, 0, G1 },
+	  SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, MATRIX_TEST_IDENTITY },
+	{ "downmix_2_1_s16le", 2, 1, { GH, GH },
+	  SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, MATRIX_TEST_DENSE },
+	{ "sparse_3_2_s16le", 3, 2, { G1, 0, GM, 0, G2, GS },
+	  SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, MATRIX_TEST_GENERIC },
+#endif /* CONFIG_FORMAT_S16LE */
+#if CONFIG_FORMAT_S24LE
+	{ "mono_to_stereo_s24le", 1, 2, { G1, G1 },
+	  SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, MATRIX_TEST_COPY },
+	{ "pan_1_2_s24le", 1, 2, { GS, G2 },
+	  SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, MATRIX_TEST_DENSE },
+#endif /* CONFIG_FORMAT_S24LE */
+#if CONFIG_FORMAT_S32LE
+	{ "swap_s32le", 2, 2, { 0, G1, G1, 0 },
+	  SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S32_LE, MATRIX_TEST_COPY },
+	{ "pick_mute_s32le", 2, 3, { 0, G1, 0, 0, G1, 0 },
+	  SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S32_LE, MATRIX_TEST_COPY },
+	{ "upmix_2_6_s32le", 2, 6,
+	  { G1, 0, 0, G1, GS, GS, GH, GH, GS, GM, GM, GS },
+	  SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S32_LE, MATRIX_TEST_DENSE },
+#endif /* CONFIG_FORMAT_S32LE */
+#if PLATFORM_MAX_CHANNELS >= 8
+#if CONFIG_FORMAT_S16LE
+	{ "downmix_6_2_s16le", 6, 2,
+	  { G1, 0, GS, GS, GS, 0, 0, G1, GS, GS, 0, GS },
+	  SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, MATRIX_TEST_DENSE },
+#endif /* CONFIG_FORMAT_S16LE */
+#if CONFIG_FORMAT_S24LE
+	{ "downmix_8_2_s24le", 8, 2,
+	  { G1, 0, GS, GS, GS, 0, GS, 0, 0, G1, GS, GS, 0, GS, 0, GS },
+	  SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, MATRIX_TEST_DENSE },
+#endif /* CONFIG_FORMAT_S24LE */
+#endif /* PLATFORM_MAX_CHANNELS >= 8 */
+#if CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S32LE
+	{ "identity_s16le_s32le", 2, 2, { G1, 0, 0, G1 },
+	  SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S32_LE, MATRIX_TEST_GENERIC },
+	{ "downmix_2_1_s32le_s16le", 2, 1, { G1, G1 },
+	  SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S16_LE, MATRIX_TEST_GENERIC },
+#endif /* CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S32LE */
+#if CONFIG_FORMAT_S24LE && CONFIG_FORMAT_S32LE
+	{ "upmix_1_2_s32le_s24le", 1, 2, { GH, G1 },
+	  SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S24_4LE, MATRIX_TEST_GENERIC },
+#endif /* CONFIG_FORMAT_S24LE && CONFIG_FORMAT_S32LE */
+};
+
+static int setup_group(void **state)
+{
+	sys_comp_init(sof_get());
+	sys_comp_matrix_init();
+
+	return 0;
+}
+
+static struct sof_ipc_comp_process *create_matrix_comp_ipc(struct test_data *td)
+{
+	size_t ipc_size = sizeof(struct sof_ipc_comp_process);
+	size_t coef_size = td->in_channels * td->out_channels *
+		sizeof(int16_t);
+	size_t matrix_size = sizeof(struct sof_matrix_config) + coef_size;
+	struct sof_ipc_comp_process *ipc = calloc(1, ipc_size + matrix_size);
+	struct sof_matrix_config *matrix =
+		(struct sof_matrix_config *)&ipc->data;
+
+	ipc->comp.hdr.size = sizeof(struct sof_ipc_comp_process);
+	ipc->comp.type = SOF_COMP_NONE;
+	ipc->config.hdr.size = sizeof(struct sof_ipc_comp_config);
+	ipc->size = matrix_size;
+
+	matrix->size = matrix_size;
+	matrix->in_channels = td->in_channels;
+	matrix->out_channels = td->out_channels;
+	memcpy_s(matrix->coef, coef_size, td->coef, coef_size);
+
+	return ipc;
+}
+
+/* test signal in Q1.31, full scale values saturate with gains over 1.0 */
+static int32_t test_sample(int frame, int channel)
+{
+	return (int32_t)((uint32_t)(frame * 7 + channel * 3) * 0x12345679u +
+			 (channel & 1 ? 0x80000000u : 0));
+}
+
+static void write_sample(struct audio_stream *stream, int i, int32_t x)
+{
+	int16_t *y16;
+	int32_t *y32;
+
+	switch (stream->frame_fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		y16 = audio_stream_write_frag_s16(stream, i);
+		*y16 = x >> 16;
+		break;
+	case SOF_IPC_FRAME_S24_4LE:
+		y32 = audio_stream_write_frag_s32(stream, i);
+		*y32 = x >> 8;
+		break;
+	default:
+		y32 = audio_stream_write_frag_s32(stream, i);
+		*y32 = x;
+		break;
+	}
+}
+
+static int32_t read_sample(struct audio_stream *stream, int i)
+{
+	int16_t *x16;
+	int32_t *x32;
+
+	if (stream->frame_fmt == SOF_IPC_FRAME_S16_LE) {
+		x16 = audio_stream_read_frag_s16(stream, i);
+		return *x16;
+	}
+
+	x32 = audio_stream_read_frag_s32(stream, i);
+	return *x32;
+}
+
+/* input sample as read by the matrix, in Q1.31 */
+static int64_t input_sample(enum sof_ipc_frame fmt, int frame, int channel)
+{
+	int32_t x = test_sample(frame, channel);
+
+	switch (fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		return (int64_t)(x >> 16) << 16;
+	case SOF_IPC_FRAME_S24_4LE:
+		return (int64_t)(x >> 8) << 8;
+	default:
+		return x;
+	}
+}
+
+static int32_t expected_sample(struct test_data *td, int frame, int channel)
+{
+	int64_t max = td->sink_format == SOF_IPC_FRAME_S16_LE ? INT16_MAX :
+		td->sink_format == SOF_IPC_FRAME_S24_4LE ? INT24_MAXVALUE :
+		INT32_MAX;
+	int shift = SOF_MATRIX_COEF_QY +
+		(td->sink_format == SOF_IPC_FRAME_S16_LE ? 16 :
+		 td->sink_format == SOF_IPC_FRAME_S24_4LE ? 8 : 0);
+	int64_t acc = 0;
+	int64_t y;
+	int in;
+
+	for (in = 0; in < td->in_channels; in++)
+		acc += input_sample(td->source_format, frame, in) *
+			td->coef[channel * td->in_channels + in];
+
+	/* round to nearest, half up */
+	y = (acc + ((int64_t)1 << (shift - 1))) >> shift;
+	if (y > max)
+		return max;
+	if (y < -max - 1)
+		return -max - 1;
+
+	return y;
+}
+
+static void prepare_source(struct test_data *td)
+{
+	struct audio_stream *stream;
+	uint32_t frame_bytes = get_frame_bytes(td->source_format,
+					       td->in_channels);
+	int i;
+	int ch;
+
+	td->source = create_test_source(td->dev, 0, td->source_format,
+					td->in_channels,
+					MATRIX_TEST_FRAMES * frame_bytes);
+	stream = &td->source->stream;
+
+	audio_stream_produce(stream, MATRIX_TEST_OFFSET * frame_bytes);
+	audio_stream_consume(stream, MATRIX_TEST_OFFSET * frame_bytes);
+
+	for (i = 0; i < MATRIX_TEST_FRAMES; i++)
+		for (ch = 0; ch < td->in_channels; ch++)
+			write_sample(stream, i * td->in_channels + ch,
+				     test_sample(i, ch));
+
+	audio_stream_produce(stream, MATRIX_TEST_FRAMES * frame_bytes);
+}
+
+static void prepare_sink(struct test_data *td)
+{
+	struct audio_stream *stream;
+	uint32_t frame_bytes = get_frame_bytes(td->sink_format,
+					       td->out_channels);
+
+	td->sink = create_test_sink(td->dev, 0, td->sink_format,
+				    td->out_channels,
+				    MATRIX_TEST_FRAMES * frame_bytes);
+	stream = &td->sink->stream;
+
+	audio_stream_produce(stream, MATRIX_TEST_OFFSET * frame_bytes);
+	audio_stream_consume(stream, MATRIX_TEST_OFFSET * frame_bytes);
+}
+
+static int setup_test_case(void **state)
+{
+	struct test_data *td = *((struct test_data **)state);
+	struct sof_ipc_comp_process *ipc = create_matrix_comp_ipc(td);
+
+	td->dev = comp_new((struct sof_ipc_comp *)ipc);
+	free(ipc);
+
+	if (!td->dev)
+		return -EINVAL;
+
+	prepare_source(td);
+	prepare_sink(td);
+
+	return comp_prepare(td->dev);
+}
+
+static int teardown_test_case(void **state)
+{
+	struct test_data *td = *((struct test_data **)state);
+
+	free_test_source(td->source);
+	free_test_sink(td->sink);
+
+	comp_free(td->dev);
+
+	return 0;
+}
+
+static matrix_func expected_func(struct test_data *td)
+{
+	switch (td->func) {
+	case MATRIX_TEST_IDENTITY:
+		return matrix_identity;
+	case MATRIX_TEST_COPY:
+		return matrix_find_copy_func(td->source_format);
+	case MATRIX_TEST_DENSE:
+		return matrix_find_dense_func(td->source_format,
+					      td->in_channels,
+					      td->out_channels);
+	default:
+		return matrix_generic;
+	}
+}
+
+static void test_matrix_copy(void **state)
+{
+	struct test_data *td = *((struct test_data **)state);
+	struct matrix_comp_data *cd = comp_get_drvdata(td->dev);
+	int32_t expected[MATRIX_TEST_FRAMES * PLATFORM_MAX_CHANNELS];
+	int32_t output[MATRIX_TEST_FRAMES * PLATFORM_MAX_CHANNELS];
+	int samples = MATRIX_TEST_FRAMES * td->out_channels;
+	int i;
+
+	assert_non_null(cd->plan.func);
+	assert_ptr_equal(cd->plan.func, expected_func(td));
+
+	assert_int_equal(comp_copy(td->dev), 0);
+	assert_int_equal(audio_stream_get_avail_frames(&td->sink->stream),
+			 MATRIX_TEST_FRAMES);
+
+	for (i = 0; i < samples; i++) {
+		expected[i] = expected_sample(td, i / td->out_channels,
+					      i % td->out_channels);
+		output[i] = read_sample(&td->sink->stream, i);
+	}
+
+	assert_memory_equal(output, expected, samples * sizeof(int32_t));
+}
+
+int main(void)
+{
+	struct CMUnitTest tests[ARRAY_SIZE(test_cases)];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(test_cases); i++) {
+		tests[i].name = test_cases[i].name;
+		tests[i].test_func = test_matrix_copy;
+		tests[i].initial_state = &test_cases[i];
+		tests[i].setup_func = setup_test_case;
+		tests[i].teardown_func = teardown_test_case;
+	}
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, setup_group, NULL);
+}
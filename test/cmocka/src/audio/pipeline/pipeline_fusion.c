@@ -0,0 +1,286 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/component.h>
+#include <sof/audio/buffer.h>
+#include <sof/audio/fusion.h>
+#include <sof/audio/pipeline.h>
+#include <sof/list.h>
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <cmocka.h>
+
+#define TEST_COMPS	5
+#define TEST_BUFFERS	(TEST_COMPS - 1)
+#define TEST_SIZE	1024
+#define TEST_FRAMES	200
+
+/* doubles both channels */
+static int test_gain_process(struct comp_dev *dev,
+			     const struct audio_stream *source,
+			     struct audio_stream *sink, uint32_t frames)
+{
+	int16_t *x;
+	int16_t *y;
+	uint32_t i;
+
+	for (i = 0; i < frames * source->channels; i++) {
+		x = audio_stream_read_frag_s16(source, i);
+		y = audio_stream_write_frag_s16(sink, i);
+		*y = *x * 2;
+	}
+
+	return 0;
+}
+
+/* selects the left channel and adds one */
+static int test_select_process(struct comp_dev *dev,
+			       const struct audio_stream *source,
+			       struct audio_stream *sink, uint32_t frames)
+{
+	int16_t *x;
+	int16_t *y;
+	uint32_t i;
+
+	for (i = 0; i < frames; i++) {
+		x = audio_stream_read_frag_s16(source, i * source->channels);
+		y = audio_stream_write_frag_s16(sink, i);
+		*y = *x + 1;
+	}
+
+	return 0;
+}
+
+static const struct comp_driver test_endpoint_drv;
+
+static const struct comp_driver test_gain_drv = {
+	.ops = {
+		.process = test_gain_process,
+	},
+};
+
+static const struct comp_driver test_select_drv = {
+	.ops = {
+		.process = test_select_process,
+	},
+};
+
+struct test_data {
+	struct pipeline p;
+	struct comp_dev *comps[TEST_COMPS];
+	struct comp_buffer *buffers[TEST_BUFFERS];
+};
+
+static struct comp_dev *test_comp_new(struct pipeline *p,
+				      const struct comp_driver *drv)
+{
+	struct comp_dev *dev = calloc(1, sizeof(*dev));
+
+	dev->pipeline = p;
+	dev->drv = drv;
+	list_init(&dev->bsource_list);
+	list_init(&dev->bsink_list);
+
+	return dev;
+}
+
+static struct comp_buffer *test_buffer_new(uint32_t id, uint32_t channels)
+{
+	struct sof_ipc_buffer desc = {
+		.comp.id = id,
+		.size = TEST_SIZE,
+	};
+	struct comp_buffer *buffer = buffer_new(&desc);
+
+	buffer->stream.frame_fmt = SOF_IPC_FRAME_S16_LE;
+	buffer->stream.channels = channels;
+
+	return buffer;
+}
+
+static void test_connect(struct comp_dev *source, struct comp_buffer *buffer,
+			 struct comp_dev *sink)
+{
+	list_item_prepend(&buffer->source_list, &source->bsink_list);
+	buffer->source = source;
+	list_item_prepend(&buffer->sink_list, &sink->bsource_list);
+	buffer->sink = sink;
+}
+
+/* host -> b0 -> gain -> b1 -> gain -> b2 -> select -> b3 -> dai */
+static int setup(void **state)
+{
+	struct test_data *td = calloc(1, sizeof(*td));
+	int i;
+
+	td->comps[0] = test_comp_new(&td->p, &test_endpoint_drv);
+	td->comps[1] = test_comp_new(&td->p, &test_gain_drv);
+	td->comps[2] = test_comp_new(&td->p, &test_gain_drv);
+	td->comps[3] = test_comp_new(&td->p, &test_select_drv);
+	td->comps[4] = test_comp_new(&td->p, &test_endpoint_drv);
+
+	for (i = 0; i < TEST_BUFFERS; i++) {
+		td->buffers[i] = test_buffer_new(i, i < 3 ? 2 : 1);
+		test_connect(td->comps[i], td->buffers[i], td->comps[i + 1]);
+	}
+
+	td->p.source_comp = td->comps[0];
+	td->p.sink_comp = td->comps[TEST_COMPS - 1];
+
+	*state = td;
+
+	return 0;
+}
+
+static int teardown(void **state)
+{
+	struct test_data *td = *state;
+	int i;
+
+	pipeline_fusion_free(td->comps[1]);
+	pipeline_fusion_free(td->comps[2]);
+
+	for (i = 0; i < TEST_BUFFERS; i++)
+		buffer_free(td->buffers[i]);
+
+	for (i = 0; i < TEST_COMPS; i++)
+		free(td->comps[i]);
+
+	free(td);
+
+	return 0;
+}
+
+static void test_pipeline_fusion_build(void **state)
+{
+	struct test_data *td = *state;
+	struct comp_dev **c = td->comps;
+
+	pipeline_fusion_build(&td->p);
+
+	assert_null(c[0]->fusion);
+	assert_null(c[4]->fusion);
+	assert_non_null(c[1]->fusion);
+	assert_ptr_equal(c[1]->fusion, c[2]->fusion);
+	assert_ptr_equal(c[1]->fusion, c[3]->fusion);
+	assert_int_equal(c[1]->fusion->num_comps, 3);
+	assert_ptr_equal(c[1]->fusion->comps[0], c[1]);
+
+	/* building again keeps the runs */
+	pipeline_fusion_build(&td->p);
+	assert_int_equal(c[1]->fusion->num_comps, 3);
+
+	pipeline_fusion_free(c[3]);
+	assert_null(c[1]->fusion);
+	assert_null(c[2]->fusion);
+}
+
+static void test_pipeline_fusion_inter_core(void **state)
+{
+	struct test_data *td = *state;
+	struct comp_dev **c = td->comps;
+
+	td->buffers[1]->inter_core = true;
+
+	pipeline_fusion_build(&td->p);
+
+	/* single component is not a run */
+	assert_null(c[1]->fusion);
+	assert_non_null(c[2]->fusion);
+	assert_ptr_equal(c[2]->fusion, c[3]->fusion);
+	assert_int_equal(c[2]->fusion->num_comps, 2);
+}
+
+static void test_pipeline_fusion_arena(void **state)
+{
+	struct test_data *td = *state;
+	struct comp_dev **c = td->comps;
+	struct buffer_arena arena = { 0 };
+
+	/* b1 shares the storage of a planned buffer */
+	td->buffers[1]->arena = &arena;
+
+	pipeline_fusion_build(&td->p);
+
+	assert_null(c[1]->fusion);
+	assert_non_null(c[2]->fusion);
+	assert_ptr_equal(c[2]->fusion, c[3]->fusion);
+
+	pipeline_fusion_free(c[2]);
+	td->buffers[1]->arena = NULL;
+
+	/* the run can't write its source storage */
+	td->buffers[0]->arena = &arena;
+	td->buffers[3]->arena = &arena;
+
+	pipeline_fusion_build(&td->p);
+
+	assert_non_null(c[1]->fusion);
+	assert_int_equal(c[1]->fusion->num_comps, 2);
+	assert_ptr_equal(c[1]->fusion, c[2]->fusion);
+	assert_null(c[3]->fusion);
+
+	td->buffers[0]->arena = NULL;
+	td->buffers[3]->arena = NULL;
+}
+
+static void test_pipeline_fusion_copy(void **state)
+{
+	struct test_data *td = *state;
+	struct comp_buffer **b = td->buffers;
+	int16_t *x;
+	int i;
+
+	/* start close to the end of the source to wrap in the copy */
+	comp_update_buffer_produce(b[0], TEST_SIZE - 64);
+	comp_update_buffer_consume(b[0], TEST_SIZE - 64);
+
+	for (i = 0; i < TEST_FRAMES * 2; i++) {
+		x = audio_stream_write_frag_s16(&b[0]->stream, i);
+		*x = i;
+	}
+	comp_update_buffer_produce(b[0], TEST_FRAMES * 4);
+
+	pipeline_fusion_build(&td->p);
+
+	/* other components of the run don't copy */
+	assert_int_equal(comp_fusion_copy(td->comps[2]), 0);
+	assert_int_equal(audio_stream_get_avail_bytes(&b[0]->stream),
+			 TEST_FRAMES * 4);
+
+	assert_int_equal(comp_fusion_copy(td->comps[1]), 0);
+
+	assert_int_equal(audio_stream_get_avail_bytes(&b[0]->stream), 0);
+	assert_int_equal(audio_stream_get_avail_bytes(&b[1]->stream), 0);
+	assert_int_equal(audio_stream_get_avail_bytes(&b[2]->stream), 0);
+	assert_int_equal(audio_stream_get_avail_bytes(&b[3]->stream),
+			 TEST_FRAMES * 2);
+
+	for (i = 0; i < TEST_FRAMES; i++) {
+		x = audio_stream_read_frag_s16(&b[3]->stream, i);
+		assert_int_equal(*x, i * 2 * 4 + 1);
+	}
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown(test_pipeline_fusion_build,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_pipeline_fusion_inter_core,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_pipeline_fusion_arena,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_pipeline_fusion_copy,
+						setup, teardown),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/common.h>
+#include <sof/compiler_attributes.h>
+#include <sof/audio/src/src.h>
+#include <sof/audio/src/src_config.h>
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+
+/* The multichannel stage kernel must produce for every channel the same
+ * output as the two channels kernel does for the channel alone.
+ */
+
+#define TEST_MAX_CHANNELS	8
+#define TEST_TIMES		16
+#define TEST_MAX_TAPS		48
+#define TEST_MAX_BLK		3
+#define TEST_DELAY_SIZE		1024
+#define TEST_BUF_SIZE		(TEST_TIMES * TEST_MAX_BLK * TEST_MAX_CHANNELS)
+
+#if SRC_SHORT
+typedef int16_t test_coef_t;
+#define TEST_COEF_SCALE		12
+#else
+typedef int32_t test_coef_t;
+#define TEST_COEF_SCALE		28
+#endif
+
+struct src_stage_test_parameters {
+	int idm;
+	int odm;
+	int num_of_subfilters;
+	int subfilter_length;
+	int blk_in;
+	int blk_out;
+	int shift;
+	int channels;
+};
+
+static test_coef_t coefs[TEST_MAX_TAPS] __aligned(8);
+static int32_t fir_delay[TEST_DELAY_SIZE] __aligned(8);
+static int32_t out_delay[TEST_DELAY_SIZE] __aligned(8);
+static int32_t input[TEST_BUF_SIZE];
+static int32_t output[TEST_BUF_SIZE];
+static int32_t ref_input[TEST_BUF_SIZE];
+static int32_t ref_output[TEST_BUF_SIZE];
+static uint32_t seed = 1;
+
+static int32_t test_rand(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return (int32_t)seed;
+}
+
+static void run_stage(struct src_stage *stage, int32_t *x, int32_t *y,
+		      int nch)
+{
+	struct src_state state;
+	struct src_stage_prm prm;
+	int fir_size = nch * (stage->subfilter_length +
+		(stage->num_of_subfilters - 1) * stage->idm + stage->blk_in);
+	int out_size = nch * (1 + (stage->num_of_subfilters - 1) *
+			      stage->odm);
+	int in_words = TEST_TIMES * stage->blk_in * nch;
+	int out_words = TEST_TIMES * stage->blk_out * nch;
+
+	assert_true(fir_size <= TEST_DELAY_SIZE);
+	assert_true(out_size <= TEST_DELAY_SIZE);
+
+	memset(fir_delay, 0, sizeof(fir_delay));
+	memset(out_delay, 0, sizeof(out_delay));
+	state.fir_delay_size = fir_size;
+	state.out_delay_size = out_size;
+	state.fir_delay = fir_delay;
+	state.out_delay = out_delay;
+	state.fir_wp = &fir_delay[fir_size - 1];
+	state.out_rp = out_delay;
+
+	prm.nch = nch;
+	prm.times = TEST_TIMES;
+	prm.x_rptr = x;
+	prm.x_end_addr = x + in_words;
+	prm.x_size = in_words * sizeof(int32_t);
+	prm.y_wptr = y;
+	prm.y_addr = y;
+	prm.y_end_addr = y + out_words;
+	prm.y_size = out_words * sizeof(int32_t);
+	prm.shift = 0;
+	prm.state = &state;
+	prm.stage = stage;
+
+	src_polyphase_stage_cir(&prm);
+}
+
+static void test_audio_src_stage_channels(void **state)
+{
+	struct src_stage_test_parameters *p = *state;
+	struct src_stage stage = {
+		.idm = p->idm,
+		.odm = p->odm,
+		.num_of_subfilters = p->num_of_subfilters,
+		.subfilter_length = p->subfilter_length,
+		.filter_length = p->num_of_subfilters * p->subfilter_length,
+		.blk_in = p->blk_in,
+		.blk_out = p->blk_out,
+		.halfband = 0,
+		.shift = p->shift,
+		.coefs = coefs,
+	};
+	int nch = p->channels;
+	int frames_in = TEST_TIMES * p->blk_in;
+	int frames_out = TEST_TIMES * p->blk_out;
+	int ch;
+	int i;
+
+	for (i = 0; i < stage.filter_length; i++)
+		coefs[i] = test_rand() >> (8 * sizeof(int32_t) -
+					   TEST_COEF_SCALE);
+
+	/* Keep some headroom to not saturate the output */
+	for (i = 0; i < frames_in * nch; i++)
+		input[i] = test_rand() >> 2;
+
+	run_stage(&stage, input, output, nch);
+
+	for (ch = 0; ch < nch; ch++) {
+		for (i = 0; i < frames_in; i++) {
+			ref_input[2 * i] = input[i * nch + ch];
+			ref_input[2 * i + 1] = input[i * nch + ch];
+		}
+
+		run_stage(&stage, ref_input, ref_output, 2);
+
+		for (i = 0; i < frames_out; i++)
+			assert_int_equal(output[i * nch + ch],
+					 ref_output[2 * i]);
+	}
+}
+
+/* Decimation by three and 3:2 interpolation stages from the tiny set */
+static struct src_stage_test_parameters parameters[] = {
+	{ 1, 0, 1, 48, 3, 1, 2, 1 },
+	{ 1, 0, 1, 48, 3, 1, 2, 3 },
+	{ 1, 0, 1, 48, 3, 1, 2, 4 },
+	{ 1, 0, 1, 48, 3, 1, 2, 6 },
+	{ 1, 0, 1, 48, 3, 1, 2, 8 },
+	{ 1, 2, 3, 16, 2, 3, 0, 1 },
+	{ 1, 2, 3, 16, 2, 3, 0, 3 },
+	{ 1, 2, 3, 16, 2, 3, 0, 4 },
+	{ 1, 2, 3, 16, 2, 3, 0, 6 },
+	{ 1, 2, 3, 16, 2, 3, 0, 8 },
+};
+
+int main(void)
+{
+	struct CMUnitTest tests[ARRAY_SIZE(parameters)];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(parameters); i++) {
+		tests[i].name = "test_audio_src_stage_channels";
+		tests[i].test_func = test_audio_src_stage_channels;
+		tests[i].setup_func = NULL;
+		tests[i].teardown_func = NULL;
+		tests[i].initial_state = &parameters[i];
+	}
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -33,7 +33,8 @@ struct vol_test_state {
 	struct comp_dev *dev;
 	struct comp_buffer *sink;
 	struct comp_buffer *source;
-	void (*verify)(struct comp_dev *dev, struct comp_buffer *sink, struct comp_buffer *source);
+	void (*verify)(struct comp_data *cd, struct comp_buffer *sink,
+		       struct comp_buffer *source);
 };
 
 struct vol_test_parameters {
@@ -43,7 +44,11 @@ struct vol_test_parameters {
 	uint32_t buffer_size_ms;
 	uint32_t source_format;
 	uint32_t sink_format;
-	void (*verify)(struct comp_dev *dev, struct comp_buffer *sink, struct comp_buffer *source);
+	void (*verify)(struct comp_data *cd, struct comp_buffer *sink,
+		       struct comp_buffer *source);
+	uint32_t zc_frames;
+	int32_t ramp_volume;
+	bool ramp_log;
 };
 
 static void set_volume(int32_t *vol, int32_t value, uint32_t channels)
@@ -54,12 +59,44 @@ static void set_volume(int32_t *vol, int32_t value, uint32_t channels)
 		vol[i] = value;
 }
 
+/* ramps end in the middle of the processed frames */
+static void set_ramp(struct comp_data *cd,
+		     struct vol_test_parameters *parameters)
+{
+	int32_t delta = parameters->ramp_volume - parameters->volume;
+	int i;
+
+	cd->ramp_log = parameters->ramp_log;
+	for (i = 0; i < parameters->channels; i++) {
+		cd->tvolume[i] = parameters->ramp_volume;
+		cd->ramp_gain[i] = (int64_t)parameters->volume <<
+			VOL_RAMP_FRAC_BITS;
+		cd->ramp_left[i] = parameters->frames / 2 + i;
+		cd->ramp_step[i] = ((int64_t)delta << VOL_RAMP_FRAC_BITS) /
+			cd->ramp_left[i];
+		/* gain ratio about 1 +- 1 / 16 per frame */
+		cd->ramp_ratio[i] = delta > 0 ? INT32_MAX / 16 :
+			INT32_MIN / 16;
+	}
+}
+
+/* gain of a frame, ramps are advanced as in processing */
+static int32_t test_chan_gain(struct comp_data *cd, uint32_t channel,
+			      uint32_t frame)
+{
+	if (cd->ramp_finished)
+		return vol_chan_gain(cd, channel, frame);
+
+	return vol_ramp_chan_gain(cd, channel, frame);
+}
+
 static int setup(void **state)
 {
 	struct vol_test_parameters *parameters = *state;
 	struct vol_test_state *vol_state;
 	struct comp_data *cd;
 	uint32_t size = 0;
+	int i;
 
 	/* allocate new state */
 	vol_state = test_malloc(sizeof(*vol_state));
@@ -69,7 +106,7 @@ static int setup(void **state)
 	vol_state->dev->frames = parameters->frames;
 
 	/* allocate and set new data */
-	cd = test_malloc(sizeof(*cd));
+	cd = test_calloc(1, sizeof(*cd));
 	comp_set_drvdata(vol_state->dev, cd);
 
 	list_init(&vol_state->dev->bsource_list);
@@ -91,8 +128,22 @@ static int setup(void **state)
 
 	/* set processing function and volume */
 	cd->scale_vol = vol_get_processing_function(vol_state->dev);
+	cd->ramp_vol = vol_get_ramp_function(vol_state->dev);
 	set_volume(cd->volume, parameters->volume, parameters->channels);
 
+	/* channels ramp from the volume to ramp_volume */
+	if (parameters->ramp_volume)
+		set_ramp(cd, parameters);
+	else
+		cd->ramp_finished = true;
+
+	/* channels keep 0 dB volume until their own zero crossing */
+	if (parameters->zc_frames) {
+		set_volume(cd->zc_volume, VOL_ZERO_DB, parameters->channels);
+		for (i = 0; i < parameters->channels; i++)
+			cd->zc_frames[i] = parameters->zc_frames + i;
+	}
+
 	/* assigns verification function */
 	vol_state->verify = parameters->verify;
 
@@ -133,10 +184,9 @@ static void fill_source_s16(struct vol_test_state *vol_state)
 	}
 }
 
-static void verify_s16_to_s16(struct comp_dev *dev, struct comp_buffer *sink,
+static void verify_s16_to_s16(struct comp_data *cd, struct comp_buffer *sink,
 			      struct comp_buffer *source)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
 	const int16_t *src = (int16_t *)source->stream.r_ptr;
 	const int16_t *dst = (int16_t *)sink->stream.w_ptr;
 	double processed;
@@ -149,7 +199,7 @@ static void verify_s16_to_s16(struct comp_dev *dev, struct comp_buffer *sink,
 	for (i = 0; i < sink->stream.size / sizeof(uint16_t); i += channels) {
 		for (channel = 0; channel < channels; channel++) {
 			processed = src[i + channel] *
-				(double)cd->volume[channel] /
+				(double)test_chan_gain(cd, channel, i / channels) /
 				(double)VOL_ZERO_DB + 0.5;
 			if (processed > INT16_MAX)
 				processed = INT16_MAX;
@@ -182,11 +232,10 @@ static void fill_source_s24(struct vol_test_state *vol_state)
 	}
 }
 
-static void verify_s24_to_s24_s32(struct comp_dev *dev,
+static void verify_s24_to_s24_s32(struct comp_data *cd,
 				  struct comp_buffer *sink,
 				  struct comp_buffer *source)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
 	const int32_t *src = (int32_t *)source->stream.r_ptr;
 	const int32_t *dst = (int32_t *)sink->stream.w_ptr;
 	double processed;
@@ -201,7 +250,7 @@ static void verify_s24_to_s24_s32(struct comp_dev *dev,
 	for (i = 0; i < sink->stream.size / sizeof(uint32_t); i += channels) {
 		for (channel = 0; channel < channels; channel++) {
 			processed = (src[i + channel] << 8) *
-				(double)cd->volume[channel] /
+				(double)test_chan_gain(cd, channel, i / channels) /
 				(double)VOL_ZERO_DB + 0.5 * (1 << shift);
 			if (processed > INT32_MAX)
 				processed = INT32_MAX;
@@ -239,11 +288,10 @@ static void fill_source_s32(struct vol_test_state *vol_state)
 	}
 }
 
-static void verify_s32_to_s24_s32(struct comp_dev *dev,
+static void verify_s32_to_s24_s32(struct comp_data *cd,
 				  struct comp_buffer *sink,
 				  struct comp_buffer *source)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
 	double processed;
 	const int32_t *src = (int32_t *)source->stream.r_ptr;
 	const int32_t *dst = (int32_t *)sink->stream.w_ptr;
@@ -258,7 +306,7 @@ static void verify_s32_to_s24_s32(struct comp_dev *dev,
 	for (i = 0; i < sink->stream.size / sizeof(uint32_t); i += channels) {
 		for (channel = 0; channel < channels; channel++) {
 			processed = src[i + channel] *
-				    (double)cd->volume[channel] /
+				    (double)test_chan_gain(cd, channel, i / channels) /
 				    (double)VOL_ZERO_DB + 0.5 * (1 << shift);
 			if (processed > INT32_MAX)
 				processed = INT32_MAX;
@@ -373,6 +421,7 @@ static void test_audio_vol(void **state)
 {
 	struct vol_test_state *vol_state = *state;
 	struct comp_data *cd = comp_get_drvdata(vol_state->dev);
+	struct comp_data ref;
 
 	switch (vol_state->sink->stream.frame_fmt) {
 	case SOF_IPC_FRAME_S16_LE:
@@ -387,10 +436,19 @@ static void test_audio_vol(void **state)
 		break;
 	}
 
-	cd->scale_vol(vol_state->dev, &vol_state->sink->stream,
-		      &vol_state->source->stream, vol_state->dev->frames);
+	/* ramp of the reference data is advanced by verify */
+	ref = *cd;
 
-	vol_state->verify(vol_state->dev, vol_state->sink, vol_state->source);
+	if (cd->ramp_finished)
+		cd->scale_vol(vol_state->dev, &vol_state->sink->stream,
+			      &vol_state->source->stream,
+			      vol_state->dev->frames);
+	else
+		cd->ramp_vol(vol_state->dev, &vol_state->sink->stream,
+			     &vol_state->source->stream,
+			     vol_state->dev->frames);
+
+	vol_state->verify(&ref, vol_state->sink, vol_state->source);
 }
 
 static struct vol_test_parameters parameters[] = {
@@ -401,24 +459,48 @@ static struct vol_test_parameters parameters[] = {
 		SOF_IPC_FRAME_S16_LE,   verify_s16_to_s16 }, /* 2 */
 	{ VOL_MINUS_80DB, 2, 48, 1, SOF_IPC_FRAME_S16_LE,
 		SOF_IPC_FRAME_S16_LE,   verify_s16_to_s16 }, /* 3 */
+	{ VOL_MINUS_80DB, 2, 48, 1, SOF_IPC_FRAME_S16_LE,
+		SOF_IPC_FRAME_S16_LE,   verify_s16_to_s16, 16 }, /* 4 */
+	{ VOL_MINUS_80DB, 2, 48, 1, SOF_IPC_FRAME_S16_LE,
+		SOF_IPC_FRAME_S16_LE,   verify_s16_to_s16, 0,
+		VOL_ZERO_DB }, /* 5 */
+	{ VOL_ZERO_DB,    2, 48, 1, SOF_IPC_FRAME_S16_LE,
+		SOF_IPC_FRAME_S16_LE,   verify_s16_to_s16, 0,
+		VOL_MINUS_80DB, true }, /* 6 */
 #endif /* CONFIG_FORMAT_S16LE */
 
 #if CONFIG_FORMAT_S24LE
 	{ VOL_MAX,        2, 48, 1, SOF_IPC_FRAME_S24_4LE,
-		SOF_IPC_FRAME_S24_4LE, verify_s24_to_s24_s32 }, /* 4 */
+		SOF_IPC_FRAME_S24_4LE, verify_s24_to_s24_s32 }, /* 7 */
 	{ VOL_ZERO_DB,    2, 48, 1, SOF_IPC_FRAME_S24_4LE,
-		SOF_IPC_FRAME_S24_4LE, verify_s24_to_s24_s32 }, /* 5 */
+		SOF_IPC_FRAME_S24_4LE, verify_s24_to_s24_s32 }, /* 8 */
+	{ VOL_MINUS_80DB, 2, 48, 1, SOF_IPC_FRAME_S24_4LE,
+		SOF_IPC_FRAME_S24_4LE, verify_s24_to_s24_s32 }, /* 9 */
 	{ VOL_MINUS_80DB, 2, 48, 1, SOF_IPC_FRAME_S24_4LE,
-		SOF_IPC_FRAME_S24_4LE, verify_s24_to_s24_s32 }, /* 6 */
+		SOF_IPC_FRAME_S24_4LE, verify_s24_to_s24_s32, 16 }, /* 10 */
+	{ VOL_MINUS_80DB, 2, 48, 1, SOF_IPC_FRAME_S24_4LE,
+		SOF_IPC_FRAME_S24_4LE, verify_s24_to_s24_s32, 0,
+		VOL_ZERO_DB }, /* 11 */
+	{ VOL_ZERO_DB,    2, 48, 1, SOF_IPC_FRAME_S24_4LE,
+		SOF_IPC_FRAME_S24_4LE, verify_s24_to_s24_s32, 0,
+		VOL_MINUS_80DB, true }, /* 12 */
 #endif /* CONFIG_FORMAT_S24LE */
 
 #if CONFIG_FORMAT_S32LE
 	{ VOL_MAX,        2, 48, 1, SOF_IPC_FRAME_S32_LE,
-		SOF_IPC_FRAME_S32_LE,   verify_s32_to_s24_s32 }, /* 7 */
+		SOF_IPC_FRAME_S32_LE,   verify_s32_to_s24_s32 }, /* 13 */
 	{ VOL_ZERO_DB,    2, 48, 1, SOF_IPC_FRAME_S32_LE,
-		SOF_IPC_FRAME_S32_LE,   verify_s32_to_s24_s32 }, /* 8 */
+		SOF_IPC_FRAME_S32_LE,   verify_s32_to_s24_s32 }, /* 14 */
 	{ VOL_MINUS_80DB, 2, 48, 1, SOF_IPC_FRAME_S32_LE,
-		SOF_IPC_FRAME_S32_LE,   verify_s32_to_s24_s32 }, /* 9 */
+		SOF_IPC_FRAME_S32_LE,   verify_s32_to_s24_s32 }, /* 15 */
+	{ VOL_MINUS_80DB, 2, 48, 1, SOF_IPC_FRAME_S32_LE,
+		SOF_IPC_FRAME_S32_LE,   verify_s32_to_s24_s32, 16 }, /* 16 */
+	{ VOL_MINUS_80DB, 2, 48, 1, SOF_IPC_FRAME_S32_LE,
+		SOF_IPC_FRAME_S32_LE,   verify_s32_to_s24_s32, 0,
+		VOL_ZERO_DB }, /* 17 */
+	{ VOL_ZERO_DB,    2, 48, 1, SOF_IPC_FRAME_S32_LE,
+		SOF_IPC_FRAME_S32_LE,   verify_s32_to_s24_s32, 0,
+		VOL_MINUS_80DB, true }, /* 18 */
 #endif /* CONFIG_FORMAT_S32LE */
 };
 
@@ -0,0 +1,324 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <math.h>
+#include <cmocka.h>
+#include <sof/audio/component.h>
+#include <sof/audio/volume.h>
+#include <ipc/topology.h>
+
+/* 100 ms ramp for the full volume range at 48 kHz */
+#define TEST_RAMP_MS		100
+#define TEST_RATE		48000
+#define TEST_RAMP_FRAMES	(TEST_RAMP_MS * TEST_RATE / 1000)
+
+/* -40 dB and -6 dB test levels */
+#define VOL_MINUS_40DB		(VOL_ZERO_DB / 100)
+#define VOL_MINUS_6DB		(VOL_ZERO_DB / 2)
+
+/* max errors against the double precision reference */
+#define LOG2_MAX_ERROR		1e-6	/* log2 units */
+#define EXPM1_MAX_ERROR		16	/* Q1.31 LSB */
+#define LINEAR_MAX_ERROR	2	/* Q8.16 LSB, gain and step truncation */
+#define LOG_MAX_ERROR_DB	0.05
+
+struct vol_ramp_test_state {
+	struct comp_dev *dev;
+	struct comp_data *cd;
+};
+
+static int setup(void **state)
+{
+	struct vol_ramp_test_state *ts;
+	struct sof_ipc_comp_volume *pga;
+
+	ts = test_malloc(sizeof(*ts));
+	ts->dev = test_calloc(1, COMP_SIZE(struct sof_ipc_comp_volume));
+	ts->cd = test_calloc(1, sizeof(*ts->cd));
+	comp_set_drvdata(ts->dev, ts->cd);
+
+	pga = COMP_GET_IPC(ts->dev, sof_ipc_comp_volume);
+	pga->initial_ramp = TEST_RAMP_MS;
+	pga->ramp = SOF_VOLUME_LINEAR;
+
+	/* mute to 0 dB is the full volume range */
+	ts->cd->sample_rate = TEST_RATE;
+	ts->cd->vol_min = VOL_MIN;
+	ts->cd->vol_max = VOL_ZERO_DB;
+	ts->cd->vol_ramp_range = VOL_ZERO_DB;
+
+	*state = ts;
+
+	return 0;
+}
+
+static int teardown(void **state)
+{
+	struct vol_ramp_test_state *ts = *state;
+
+	test_free(ts->cd);
+	test_free(ts->dev);
+	test_free(ts);
+
+	return 0;
+}
+
+static void set_ramp_type(struct vol_ramp_test_state *ts, uint32_t ramp)
+{
+	struct sof_ipc_comp_volume *pga =
+		COMP_GET_IPC(ts->dev, sof_ipc_comp_volume);
+
+	pga->ramp = ramp;
+	ts->cd->ramp_log = ramp == SOF_VOLUME_LOG || ramp == SOF_VOLUME_LOG_ZC;
+}
+
+static double gain_db(int32_t gain)
+{
+	return 20 * log10((double)gain / VOL_ZERO_DB);
+}
+
+/* the gain is truncated to Q8.16, so one LSB is allowed on top of the dB
+ * error for the low gains near the floor
+ */
+static bool log_gain_near(int32_t gain, double ref_db)
+{
+	double ref = VOL_ZERO_DB * pow(10, ref_db / 20);
+
+	return fabs(gain - ref) <=
+		1 + ref * (pow(10, LOG_MAX_ERROR_DB / 20) - 1);
+}
+
+/* runs the ramp of channel 0 to the end as the processing functions do,
+ * gains of frames 0 .. frames are stored, the last one must be the target
+ */
+static void run_ramp(struct comp_data *cd, int32_t *gain, uint32_t frames)
+{
+	uint32_t i;
+
+	for (i = 0; i <= frames; i++)
+		gain[i] = vol_ramp_next(cd, 0);
+
+	assert_int_equal(cd->ramp_left[0], 0);
+	assert_int_equal(vol_ramp_next(cd, 0), cd->tvolume[0]);
+}
+
+static void test_vol_log2(void **state)
+{
+	int32_t x;
+	double ref;
+
+	(void)state;
+
+	for (x = 1; x > 0 && x <= VOL_MAX; x += x / 7 + 1) {
+		ref = log2(x);
+		assert_true(fabs(vol_log2(x) / 67108864.0 - ref) <=
+			    LOG2_MAX_ERROR);
+	}
+
+	/* powers of two are exact */
+	assert_int_equal(vol_log2(1), 0);
+	assert_int_equal(vol_log2(VOL_ZERO_DB), VOL_QXY_Y << 26);
+}
+
+static void test_vol_expm1(void **state)
+{
+	double ln2 = log(2);
+	double x;
+	double ref;
+	int32_t q;
+	int i;
+
+	(void)state;
+
+	for (i = -1000; i <= 1000; i++) {
+		x = ln2 * i / 1000;
+		q = (int32_t)lrint(x * 2147483648.0);
+		ref = expm1((double)q / 2147483648.0) * 2147483648.0;
+		if (ref > INT32_MAX)
+			ref = INT32_MAX;
+
+		assert_true(fabs(vol_expm1(q) - ref) <= EXPM1_MAX_ERROR);
+	}
+
+	/* the tiny ratios of long ramps keep their precision */
+	assert_int_equal(vol_expm1(0), 0);
+	assert_int_equal(vol_expm1(1), 1);
+	assert_int_equal(vol_expm1(-1), -1);
+	assert_int_equal(vol_expm1(1000), 1000);
+}
+
+static void test_ramp_linear_length(void **state)
+{
+	struct vol_ramp_test_state *ts = *state;
+	struct comp_data *cd = ts->cd;
+
+	/* constant rate scales the length with the transition */
+	cd->volume[0] = VOL_MIN;
+	assert_int_equal(volume_set_chan(ts->dev, 0, VOL_MINUS_6DB, true), 0);
+	assert_int_equal(cd->ramp_left[0], TEST_RAMP_FRAMES / 2);
+
+	cd->volume[0] = VOL_ZERO_DB;
+	assert_int_equal(volume_set_chan(ts->dev, 0, VOL_MIN, true), 0);
+	assert_int_equal(cd->ramp_left[0], TEST_RAMP_FRAMES);
+
+	/* fixed length for any transition */
+	cd->volume[0] = VOL_MIN;
+	assert_int_equal(volume_set_chan(ts->dev, 0, VOL_MINUS_40DB, false), 0);
+	assert_int_equal(cd->ramp_left[0], TEST_RAMP_FRAMES);
+
+	/* no ramp without a change */
+	cd->volume[0] = VOL_MINUS_6DB;
+	assert_int_equal(volume_set_chan(ts->dev, 0, VOL_MINUS_6DB, true), 0);
+	assert_int_equal(cd->ramp_left[0], 0);
+	assert_int_equal(vol_ramp_next(cd, 0), VOL_MINUS_6DB);
+
+	/* requests are limited to the supported range */
+	assert_int_equal(volume_set_chan(ts->dev, 0, -1, false), 0);
+	assert_int_equal(cd->tvolume[0], VOL_MIN);
+}
+
+static void test_ramp_linear_shape(void **state)
+{
+	struct vol_ramp_test_state *ts = *state;
+	struct comp_data *cd = ts->cd;
+	int32_t gain[TEST_RAMP_FRAMES + 1];
+	int32_t start[] = { VOL_MIN, VOL_ZERO_DB, VOL_MINUS_40DB };
+	int32_t end[] = { VOL_ZERO_DB, VOL_MINUS_40DB, VOL_MINUS_6DB };
+	uint32_t frames;
+	double ref;
+	int i;
+	int n;
+
+	for (i = 0; i < ARRAY_SIZE(start); i++) {
+		cd->volume[0] = start[i];
+		volume_set_chan(ts->dev, 0, end[i], true);
+
+		/* length of the double precision constant rate ramp */
+		frames = (uint32_t)((double)TEST_RAMP_FRAMES *
+				    abs(end[i] - start[i]) / VOL_ZERO_DB);
+		assert_int_equal(cd->ramp_left[0], frames);
+
+		run_ramp(cd, gain, frames);
+		assert_int_equal(gain[0], start[i]);
+		assert_int_equal(gain[frames], end[i]);
+
+		/* constant slope */
+		for (n = 0; n <= frames; n++) {
+			ref = start[i] + (double)(end[i] - start[i]) * n /
+				frames;
+			assert_true(fabs(gain[n] - ref) <= LINEAR_MAX_ERROR);
+		}
+	}
+}
+
+static void test_ramp_log_shape(void **state)
+{
+	struct vol_ramp_test_state *ts = *state;
+	struct comp_data *cd = ts->cd;
+	int32_t gain[TEST_RAMP_FRAMES + 1];
+	int32_t start[] = { VOL_ZERO_DB, VOL_MINUS_40DB, VOL_MINUS_6DB };
+	int32_t end[] = { VOL_MINUS_40DB, VOL_MINUS_6DB, VOL_ZERO_DB };
+	double range = log2((double)VOL_ZERO_DB / VOL_RAMP_LOG_FLOOR);
+	double ref_frames;
+	double ref;
+	uint32_t frames;
+	int i;
+	int n;
+
+	set_ramp_type(ts, SOF_VOLUME_LOG);
+
+	for (i = 0; i < ARRAY_SIZE(start); i++) {
+		cd->volume[0] = start[i];
+		volume_set_chan(ts->dev, 0, end[i], true);
+
+		/* constant dB rate over the volume range down to the floor */
+		ref_frames = TEST_RAMP_FRAMES *
+			fabs(log2((double)end[i] / start[i])) / range;
+		frames = cd->ramp_left[0];
+		assert_true(fabs(frames - ref_frames) <= 1);
+
+		run_ramp(cd, gain, frames);
+		assert_int_equal(gain[0], start[i]);
+		assert_int_equal(gain[frames], end[i]);
+
+		/* equal dB steps */
+		for (n = 0; n <= frames; n++) {
+			ref = gain_db(start[i]) +
+				(gain_db(end[i]) - gain_db(start[i])) * n /
+				frames;
+			assert_true(log_gain_near(gain[n], ref));
+		}
+	}
+}
+
+static void test_ramp_log_floor(void **state)
+{
+	struct vol_ramp_test_state *ts = *state;
+	struct comp_data *cd = ts->cd;
+	int32_t gain[TEST_RAMP_FRAMES + 1];
+	double floor_db = gain_db(VOL_RAMP_LOG_FLOOR);
+	double ref;
+	int n;
+
+	set_ramp_type(ts, SOF_VOLUME_LOG);
+
+	/* the floor is about -60 dB */
+	assert_true(floor_db > -61 && floor_db < -60);
+
+	/* unmute starts from the floor and takes the full range length */
+	cd->volume[0] = VOL_MIN;
+	volume_set_chan(ts->dev, 0, VOL_ZERO_DB, true);
+	assert_int_equal(cd->ramp_left[0], TEST_RAMP_FRAMES);
+
+	run_ramp(cd, gain, TEST_RAMP_FRAMES);
+	assert_int_equal(gain[0], VOL_RAMP_LOG_FLOOR);
+	assert_int_equal(gain[TEST_RAMP_FRAMES], VOL_ZERO_DB);
+	for (n = 0; n <= TEST_RAMP_FRAMES; n++) {
+		ref = floor_db * (TEST_RAMP_FRAMES - n) / TEST_RAMP_FRAMES;
+		assert_true(log_gain_near(gain[n], ref));
+	}
+
+	/* mute ramps down to the floor and ends in mute */
+	cd->volume[0] = VOL_ZERO_DB;
+	volume_set_chan(ts->dev, 0, VOL_MIN, true);
+	assert_int_equal(cd->ramp_left[0], TEST_RAMP_FRAMES);
+
+	run_ramp(cd, gain, TEST_RAMP_FRAMES);
+	assert_int_equal(gain[0], VOL_ZERO_DB);
+	assert_int_equal(gain[TEST_RAMP_FRAMES], VOL_MIN);
+	for (n = 0; n < TEST_RAMP_FRAMES; n++) {
+		ref = floor_db * n / TEST_RAMP_FRAMES;
+		assert_true(log_gain_near(gain[n], ref));
+	}
+
+	/* changes below the floor are done at once */
+	cd->volume[0] = VOL_MIN;
+	volume_set_chan(ts->dev, 0, VOL_RAMP_LOG_FLOOR / 2, true);
+	assert_int_equal(cd->ramp_left[0], 0);
+	assert_int_equal(vol_ramp_next(cd, 0), VOL_RAMP_LOG_FLOOR / 2);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_vol_log2),
+		cmocka_unit_test(test_vol_expm1),
+		cmocka_unit_test_setup_teardown(test_ramp_linear_length,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_ramp_linear_shape,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_ramp_log_shape,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_ramp_log_floor,
+						setup, teardown),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
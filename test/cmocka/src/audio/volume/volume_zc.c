@@ -0,0 +1,227 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include "../../util.h"
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <cmocka.h>
+#include <sof/audio/component.h>
+#include <sof/audio/volume.h>
+
+#define TEST_CHANNELS		2
+#define TEST_CHUNK_FRAMES	8
+
+/* the ring holds 1.5 chunks, so the chunks wrap at different offsets */
+#define TEST_BUFFER_FRAMES	12
+#define TEST_START_FRAME	9
+
+/* rate giving a max wait of two chunks */
+#define TEST_RATE		(2 * TEST_CHUNK_FRAMES * 1000 / \
+				 VOL_ZC_MAX_WAIT_MS)
+
+/* the channel 0 sample is zero at frame 5, channel 1 changes sign at the
+ * first frame of the second chunk, neither crosses zero after that
+ */
+#define TEST_ZERO_FRAME_CH0	5
+#define TEST_SIGN_FRAME_CH1	TEST_CHUNK_FRAMES
+
+#define VOL_MINUS_6DB		(VOL_ZERO_DB / 2)
+#define VOL_MINUS_12DB		(VOL_ZERO_DB / 4)
+
+struct vol_zc_test_parameters {
+	uint32_t frame_fmt;
+	vol_zc_func zc_get;
+	int32_t amplitude;
+};
+
+struct vol_zc_test_state {
+	struct vol_zc_test_parameters *parameters;
+	struct comp_data *cd;
+	struct comp_buffer *source;
+	uint32_t frame;		/* signal frame at the read pointer */
+};
+
+static int32_t test_sample(uint32_t channel, uint32_t frame, int32_t a)
+{
+	if (!channel) {
+		if (frame < TEST_ZERO_FRAME_CH0)
+			return a;
+
+		return frame == TEST_ZERO_FRAME_CH0 ? 0 : -a;
+	}
+
+	return frame < TEST_SIGN_FRAME_CH1 ? a : -a;
+}
+
+static int setup(void **state)
+{
+	struct vol_zc_test_parameters *parameters = *state;
+	struct vol_zc_test_state *ts;
+	uint32_t frame_bytes = get_frame_bytes(parameters->frame_fmt,
+					       TEST_CHANNELS);
+
+	ts = test_malloc(sizeof(*ts));
+	ts->parameters = parameters;
+	ts->frame = 0;
+
+	ts->cd = test_calloc(1, sizeof(*ts->cd));
+	ts->cd->channels = TEST_CHANNELS;
+	ts->cd->sample_rate = TEST_RATE;
+	ts->cd->zc_max_wait = TEST_RATE * VOL_ZC_MAX_WAIT_MS / 1000;
+
+	ts->source = create_test_source(NULL, 0, parameters->frame_fmt,
+					TEST_CHANNELS,
+					TEST_BUFFER_FRAMES * frame_bytes);
+	ts->source->stream.r_ptr = (char *)ts->source->stream.addr +
+		TEST_START_FRAME * frame_bytes;
+
+	*state = ts;
+
+	return 0;
+}
+
+static int teardown(void **state)
+{
+	struct vol_zc_test_state *ts = *state;
+
+	free_test_source(ts->source);
+	test_free(ts->cd);
+	test_free(ts);
+
+	return 0;
+}
+
+/* writes the next chunk of the signal at the read pointer */
+static void fill_chunk(struct vol_zc_test_state *ts)
+{
+	struct audio_stream *stream = &ts->source->stream;
+	int32_t a = ts->parameters->amplitude;
+	int32_t sample;
+	int16_t *x16;
+	int32_t *x32;
+	int frame;
+	int ch;
+	int idx;
+
+	for (frame = 0; frame < TEST_CHUNK_FRAMES; frame++) {
+		for (ch = 0; ch < TEST_CHANNELS; ch++) {
+			idx = frame * TEST_CHANNELS + ch;
+			sample = test_sample(ch, ts->frame + frame, a);
+			switch (stream->frame_fmt) {
+			case SOF_IPC_FRAME_S16_LE:
+				x16 = audio_stream_read_frag_s16(stream, idx);
+				*x16 = sample;
+				break;
+			case SOF_IPC_FRAME_S24_4LE:
+				/* the unused MSB don't carry the sign */
+				x32 = audio_stream_read_frag_s32(stream, idx);
+				*x32 = sample & 0xffffff;
+				break;
+			default:
+				x32 = audio_stream_read_frag_s32(stream, idx);
+				*x32 = sample;
+				break;
+			}
+		}
+	}
+}
+
+/* processes a chunk as volume_process() does with zero crossing ramps,
+ * the zc_frames found are checked before and zc_volume after the update
+ */
+static void process_chunk(struct vol_zc_test_state *ts, int32_t volume,
+			  const uint32_t *zc_frames,
+			  const int32_t *zc_volume)
+{
+	struct comp_data *cd = ts->cd;
+	struct audio_stream *stream = &ts->source->stream;
+	int ch;
+
+	for (ch = 0; ch < TEST_CHANNELS; ch++)
+		cd->volume[ch] = volume;
+
+	fill_chunk(ts);
+	ts->parameters->zc_get(cd, stream, TEST_CHUNK_FRAMES);
+	for (ch = 0; ch < TEST_CHANNELS; ch++)
+		assert_int_equal(cd->zc_frames[ch], zc_frames[ch]);
+
+	vol_zc_update(cd, TEST_CHUNK_FRAMES);
+	for (ch = 0; ch < TEST_CHANNELS; ch++)
+		assert_int_equal(cd->zc_volume[ch], zc_volume[ch]);
+
+	stream->r_ptr = audio_stream_wrap(stream, (char *)stream->r_ptr +
+		TEST_CHUNK_FRAMES * audio_stream_frame_bytes(stream));
+	ts->frame += TEST_CHUNK_FRAMES;
+}
+
+static void test_vol_zc(void **state)
+{
+	struct vol_zc_test_state *ts = *state;
+	struct comp_data *cd = ts->cd;
+	int ch;
+
+	for (ch = 0; ch < TEST_CHANNELS; ch++)
+		cd->zc_volume[ch] = VOL_MINUS_6DB;
+
+	/* channel 0 changes at its zero sample after the wrap, channel 1
+	 * keeps waiting
+	 */
+	process_chunk(ts, VOL_ZERO_DB,
+		      (uint32_t []){ TEST_ZERO_FRAME_CH0, TEST_CHUNK_FRAMES },
+		      (int32_t []){ VOL_ZERO_DB, VOL_MINUS_6DB });
+
+	/* the sign change of channel 1 at the chunk start is found with the
+	 * last sample of the previous chunk, channel 0 has no change pending
+	 */
+	process_chunk(ts, VOL_ZERO_DB, (uint32_t []){ 0, 0 },
+		      (int32_t []){ VOL_ZERO_DB, VOL_ZERO_DB });
+
+	/* without crossings the new volume waits for VOL_ZC_MAX_WAIT_MS */
+	process_chunk(ts, VOL_MINUS_12DB,
+		      (uint32_t []){ TEST_CHUNK_FRAMES, TEST_CHUNK_FRAMES },
+		      (int32_t []){ VOL_ZERO_DB, VOL_ZERO_DB });
+	process_chunk(ts, VOL_MINUS_12DB,
+		      (uint32_t []){ TEST_CHUNK_FRAMES, TEST_CHUNK_FRAMES },
+		      (int32_t []){ VOL_MINUS_12DB, VOL_MINUS_12DB });
+	assert_int_equal(cd->zc_wait[0], 0);
+	assert_int_equal(cd->zc_wait[1], 0);
+
+	/* without pending changes the detector stops following samples */
+	process_chunk(ts, VOL_MINUS_12DB, (uint32_t []){ 0, 0 },
+		      (int32_t []){ VOL_MINUS_12DB, VOL_MINUS_12DB });
+	assert_false(cd->zc_sync);
+}
+
+static struct vol_zc_test_parameters parameters[] = {
+#if CONFIG_FORMAT_S16LE
+	{ SOF_IPC_FRAME_S16_LE, vol_zc_get_s16, 1000 },
+#endif /* CONFIG_FORMAT_S16LE */
+#if CONFIG_FORMAT_S24LE
+	{ SOF_IPC_FRAME_S24_4LE, vol_zc_get_s24, 1000 << 8 },
+#endif /* CONFIG_FORMAT_S24LE */
+#if CONFIG_FORMAT_S32LE
+	{ SOF_IPC_FRAME_S32_LE, vol_zc_get_s32, 1000 << 16 },
+#endif /* CONFIG_FORMAT_S32LE */
+};
+
+int main(void)
+{
+	struct CMUnitTest tests[ARRAY_SIZE(parameters)];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(parameters); i++) {
+		tests[i].name = "test_vol_zc";
+		tests[i].test_func = test_vol_zc;
+		tests[i].setup_func = setup;
+		tests[i].teardown_func = teardown;
+		tests[i].initial_state = &parameters[i];
+	}
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -88,6 +88,26 @@ void WEAK trace_log(bool send_atomic, const void *log_entry,
 	(void) arg_count;
 }
 
+#define _TRACE_LOG_MOCK_PARAM(i, _) (void)META_CONCAT(param, i);
+
+#define _TRACE_LOG_MOCK(arg_count)					\
+	WEAK _TRACE_LOG_FUNC_DECL(arg_count)				\
+	{								\
+		(void)send_atomic;					\
+		(void)log_entry;					\
+		(void)ctx;						\
+		(void)lvl;						\
+		(void)id_1;						\
+		(void)id_2;						\
+		META_SEQ_FROM_0_TO(arg_count, _TRACE_LOG_MOCK_PARAM)	\
+	}
+
+_TRACE_LOG_MOCK(0)
+_TRACE_LOG_MOCK(1)
+_TRACE_LOG_MOCK(2)
+_TRACE_LOG_MOCK(3)
+_TRACE_LOG_MOCK(4)
+
 uint32_t WEAK _spin_lock_irq(spinlock_t *lock)
 {
 	(void)lock;
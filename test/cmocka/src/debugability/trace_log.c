@@ -0,0 +1,250 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/drivers/ipc.h>
+#include <sof/drivers/timer.h>
+#include <sof/lib/clk.h>
+#include <sof/sof.h>
+#include <sof/string.h>
+#include <sof/trace/dma-trace.h>
+#include <sof/trace/trace.h>
+#include <user/trace.h>
+#include <xtensa/hal.h>
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmocka.h>
+
+#define TEST_WINDOW_MS		10
+#define TEST_TICKS_PER_MS	1000
+#define TEST_BURST		4
+#define TEST_BENCH_LOOPS	1000
+
+/* header followed by up to 4 arguments */
+#define TEST_MSG_MAX_SIZE \
+	(sizeof(struct log_entry_header) + 4 * sizeof(uint32_t))
+
+static struct sof sof;
+static struct timer timer;
+static uint64_t timestamp;
+static uint8_t last_msg[TEST_MSG_MAX_SIZE];
+static uint32_t last_msg_size;
+static uint32_t msg_count;
+
+static struct tr_ctx test_tr = {
+	.uuid_p = NULL,
+	.level = LOG_LEVEL_VERBOSE,
+};
+
+static const uint32_t test_log_entry;
+
+struct sof *sof_get(void)
+{
+	return &sof;
+}
+
+uint64_t platform_timer_get(struct timer *timer)
+{
+	return timestamp;
+}
+
+uint64_t clock_ms_to_ticks(int clock, uint64_t ms)
+{
+	return ms * TEST_TICKS_PER_MS;
+}
+
+void dtrace_event(const char *e, uint32_t length)
+{
+	assert_true(length <= sizeof(last_msg));
+	memcpy_s(last_msg, sizeof(last_msg), e, length);
+	last_msg_size = length;
+	msg_count++;
+}
+
+void dtrace_event_atomic(const char *e, uint32_t length)
+{
+	dtrace_event(e, length);
+}
+
+int dma_trace_init_early(struct sof *sof)
+{
+	return 0;
+}
+
+void dma_trace_flush(void *t)
+{
+}
+
+void dma_trace_on(void)
+{
+}
+
+void dma_trace_off(void)
+{
+}
+
+static int setup(void **state)
+{
+	static struct clock_info clk;
+
+	sof.platform_timer = &timer;
+	sof.clocks = &clk;
+	trace_init(&sof);
+	trace_rate_limit_set(LOG_LEVEL_VERBOSE, 0, 0);
+
+	timestamp = 0;
+	msg_count = 0;
+	last_msg_size = 0;
+
+	return 0;
+}
+
+static int teardown(void **state)
+{
+	free(sof.trace);
+
+	return 0;
+}
+
+static void test_trace_log_record_args(void **state)
+{
+	struct log_entry_header *header = (struct log_entry_header *)last_msg;
+	uint32_t *payload = (uint32_t *)(last_msg + sizeof(*header));
+
+	(void)state;
+
+	timestamp = 1234;
+	_trace_log_0(false, &test_log_entry, &test_tr, LOG_LEVEL_INFO, 1, 2);
+	assert_int_equal(last_msg_size, sizeof(*header));
+	assert_int_equal(header->id_0, 1);
+	assert_int_equal(header->id_1, 2);
+	assert_int_equal(header->timestamp, 1234);
+	assert_int_equal(header->log_entry_address, (uint32_t)&test_log_entry);
+
+	_trace_log_4(true, &test_log_entry, &test_tr, LOG_LEVEL_INFO, 3, 4,
+		     10, 20, 30, 40);
+	assert_int_equal(last_msg_size, sizeof(*header) + 4 * sizeof(uint32_t));
+	assert_int_equal(header->id_0, 3);
+	assert_int_equal(payload[0], 10);
+	assert_int_equal(payload[1], 20);
+	assert_int_equal(payload[2], 30);
+	assert_int_equal(payload[3], 40);
+}
+
+static void test_trace_log_matches_variadic(void **state)
+{
+	uint8_t fixed_msg[TEST_MSG_MAX_SIZE];
+
+	(void)state;
+
+	_trace_log_3(false, &test_log_entry, &test_tr, LOG_LEVEL_INFO, 5, 6,
+		     0xdead, 0xbeef, 0xcafe);
+	memcpy_s(fixed_msg, sizeof(fixed_msg), last_msg, last_msg_size);
+
+	trace_log(false, &test_log_entry, &test_tr, LOG_LEVEL_INFO, 5, 6, 3,
+		  0xdead, 0xbeef, 0xcafe);
+	assert_memory_equal(fixed_msg, last_msg, last_msg_size);
+}
+
+static void test_trace_log_level_filter(void **state)
+{
+	(void)state;
+
+	test_tr.level = LOG_LEVEL_INFO;
+	_trace_log_1(false, &test_log_entry, &test_tr, LOG_LEVEL_VERBOSE,
+		     0, 0, 1);
+	test_tr.level = LOG_LEVEL_VERBOSE;
+	assert_int_equal(msg_count, 0);
+}
+
+#if CONFIG_TRACE_RATE_LIMIT
+static void test_trace_log_rate_limit(void **state)
+{
+	int i;
+
+	(void)state;
+
+	assert_int_equal(trace_rate_limit_set(LOG_LEVEL_VERBOSE, TEST_BURST,
+					      TEST_WINDOW_MS), 0);
+
+	/* only burst messages pass within one window */
+	for (i = 0; i < 2 * TEST_BURST; i++)
+		_trace_log_1(false, &test_log_entry, &test_tr,
+			     LOG_LEVEL_VERBOSE, 0, 0, i);
+	assert_int_equal(msg_count, TEST_BURST);
+
+	/* other levels are not affected */
+	_trace_log_1(false, &test_log_entry, &test_tr, LOG_LEVEL_INFO, 0, 0, 0);
+	assert_int_equal(msg_count, TEST_BURST + 1);
+
+	/* next window reports suppressed count and passes the message */
+	timestamp += TEST_WINDOW_MS * TEST_TICKS_PER_MS;
+	msg_count = 0;
+	_trace_log_1(false, &test_log_entry, &test_tr, LOG_LEVEL_VERBOSE,
+		     0, 0, 0x55);
+	assert_int_equal(msg_count, 2);
+	assert_int_equal(*(uint32_t *)(last_msg + sizeof(struct log_entry_header)),
+			 0x55);
+
+	/* critical level can't be limited */
+	assert_int_equal(trace_rate_limit_set(LOG_LEVEL_CRITICAL, 1, 1),
+			 -EINVAL);
+}
+#endif
+
+/* prints cycles per call of the variadic and the specialized entry, the
+ * unit tests run on the simulated DSP so CCOUNT gives DSP cycles
+ */
+static void test_trace_log_cycles(void **state)
+{
+	uint32_t variadic;
+	uint32_t fixed;
+	uint32_t start;
+	int i;
+
+	(void)state;
+
+	start = xthal_get_ccount();
+	for (i = 0; i < TEST_BENCH_LOOPS; i++)
+		trace_log(false, &test_log_entry, &test_tr, LOG_LEVEL_INFO,
+			  0, 0, 4, i, i, i, i);
+	variadic = (xthal_get_ccount() - start) / TEST_BENCH_LOOPS;
+
+	start = xthal_get_ccount();
+	for (i = 0; i < TEST_BENCH_LOOPS; i++)
+		_trace_log_4(false, &test_log_entry, &test_tr, LOG_LEVEL_INFO,
+			     0, 0, i, i, i, i);
+	fixed = (xthal_get_ccount() - start) / TEST_BENCH_LOOPS;
+
+	print_message("trace_log() %u cycles, _trace_log_4() %u cycles\n",
+		      variadic, fixed);
+	assert_int_equal(msg_count, 2 * TEST_BENCH_LOOPS);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown(test_trace_log_record_args,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_trace_log_matches_variadic,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_trace_log_level_filter,
+						setup, teardown),
+#if CONFIG_TRACE_RATE_LIMIT
+		cmocka_unit_test_setup_teardown(test_trace_log_rate_limit,
+						setup, teardown),
+#endif
+		cmocka_unit_test_setup_teardown(test_trace_log_cycles,
+						setup, teardown),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,232 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/drivers/dmic_modes.h>
+#include <xtensa/hal.h>
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <cmocka.h>
+
+#define TEST_IOCLK		38400000
+#define TEST_BENCH_LOOPS	100
+
+static const struct dmic_modes_request test_req = {
+	.ioclk = TEST_IOCLK,
+	.fs_a = 48000,
+	.fs_b = 0,
+	.pdmclk_min = 1000000,
+	.pdmclk_max = 3600000,
+	.duty_min = 40,
+	.duty_max = 60,
+};
+
+static void assert_cfg_equal(struct dmic_configuration *a,
+			     struct dmic_configuration *b)
+{
+	assert_ptr_equal(a->fir_a, b->fir_a);
+	assert_ptr_equal(a->fir_b, b->fir_b);
+	assert_int_equal(a->clkdiv, b->clkdiv);
+	assert_int_equal(a->mcic, b->mcic);
+	assert_int_equal(a->mfir_a, b->mfir_a);
+	assert_int_equal(a->mfir_b, b->mfir_b);
+	assert_int_equal(a->cic_shift, b->cic_shift);
+	assert_int_equal(a->fir_a_shift, b->fir_a_shift);
+	assert_int_equal(a->fir_b_shift, b->fir_b_shift);
+	assert_int_equal(a->fir_a_length, b->fir_a_length);
+	assert_int_equal(a->fir_b_length, b->fir_b_length);
+	assert_int_equal(a->fir_a_scale, b->fir_a_scale);
+	assert_int_equal(a->fir_b_scale, b->fir_b_scale);
+}
+
+/* checks that the decimators produce the rate from the IO clock */
+static void assert_cfg_valid(const struct dmic_modes_request *req,
+			     struct dmic_configuration *cfg)
+{
+	uint32_t pdmclk = req->ioclk / cfg->clkdiv;
+
+	assert_in_range(pdmclk, req->pdmclk_min, req->pdmclk_max);
+	assert_in_range(cfg->mcic, DMIC_HW_CIC_DECIM_MIN,
+			DMIC_HW_CIC_DECIM_MAX);
+
+	if (req->fs_a) {
+		assert_non_null(cfg->fir_a);
+		assert_int_equal(cfg->fir_a->decim_factor, cfg->mfir_a);
+		assert_int_equal(cfg->fir_a_length, cfg->fir_a->length);
+		assert_in_range(cfg->fir_a_shift, DMIC_HW_FIR_SHIFT_MIN,
+				DMIC_HW_FIR_SHIFT_MAX);
+		assert_int_equal(req->fs_a * cfg->mfir_a * cfg->mcic *
+				 cfg->clkdiv, req->ioclk);
+	} else {
+		assert_null(cfg->fir_a);
+		assert_int_equal(cfg->mfir_a, 0);
+	}
+
+	if (req->fs_b) {
+		assert_non_null(cfg->fir_b);
+		assert_int_equal(cfg->fir_b->decim_factor, cfg->mfir_b);
+		assert_int_equal(cfg->fir_b_length, cfg->fir_b->length);
+		assert_in_range(cfg->fir_b_shift, DMIC_HW_FIR_SHIFT_MIN,
+				DMIC_HW_FIR_SHIFT_MAX);
+		assert_int_equal(req->fs_b * cfg->mfir_b * cfg->mcic *
+				 cfg->clkdiv, req->ioclk);
+	} else {
+		assert_null(cfg->fir_b);
+		assert_int_equal(cfg->mfir_b, 0);
+	}
+}
+
+static void test_dmic_modes_search_one_fifo(void **state)
+{
+	struct dmic_configuration cfg;
+
+	(void)state;
+
+	assert_int_equal(dmic_modes_search(&test_req, &cfg), 0);
+	assert_cfg_valid(&test_req, &cfg);
+
+	/* lowest FIR decimation factor, 2.4 MHz microphone clock */
+	assert_int_equal(cfg.clkdiv, 16);
+	assert_int_equal(cfg.mcic, 25);
+	assert_int_equal(cfg.mfir_a, 2);
+}
+
+static void test_dmic_modes_search_two_fifos(void **state)
+{
+	struct dmic_modes_request req = test_req;
+	struct dmic_configuration cfg;
+
+	(void)state;
+
+	req.fs_b = 16000;
+	assert_int_equal(dmic_modes_search(&req, &cfg), 0);
+	assert_cfg_valid(&req, &cfg);
+	assert_int_equal(cfg.mfir_a, 2);
+	assert_int_equal(cfg.mfir_b, 6);
+
+	/* FIFO B only */
+	req.fs_a = 0;
+	assert_int_equal(dmic_modes_search(&req, &cfg), 0);
+	assert_cfg_valid(&req, &cfg);
+}
+
+static void test_dmic_modes_search_ioclk(void **state)
+{
+	struct dmic_modes_request req = test_req;
+	struct dmic_configuration cfg;
+
+	(void)state;
+
+	/* the same microphone clock from a half rate IO clock */
+	req.ioclk = TEST_IOCLK / 2;
+	assert_int_equal(dmic_modes_search(&req, &cfg), 0);
+	assert_cfg_valid(&req, &cfg);
+	assert_int_equal(cfg.clkdiv, 8);
+	assert_int_equal(cfg.mcic, 25);
+	assert_int_equal(cfg.mfir_a, 2);
+}
+
+static void test_dmic_modes_search_invalid(void **state)
+{
+	struct dmic_modes_request req;
+	struct dmic_configuration cfg;
+
+	(void)state;
+
+	req = test_req;
+	req.duty_min = 60;
+	req.duty_max = 40;
+	assert_int_equal(dmic_modes_search(&req, &cfg), -EINVAL);
+
+	req = test_req;
+	req.pdmclk_max = TEST_IOCLK;
+	assert_int_equal(dmic_modes_search(&req, &cfg), -EINVAL);
+
+	/* no integer decimation for the rate */
+	req = test_req;
+	req.fs_a = 47000;
+	assert_int_equal(dmic_modes_search(&req, &cfg), -EINVAL);
+
+	/* failed requests are not remembered */
+	assert_int_equal(dmic_modes_get(&req, &cfg), -EINVAL);
+	assert_int_equal(dmic_modes_get(&req, &cfg), -EINVAL);
+}
+
+static void test_dmic_modes_get(void **state)
+{
+	struct dmic_modes_request req = test_req;
+	struct dmic_configuration cfg_search;
+	struct dmic_configuration cfg;
+	int i;
+
+	(void)state;
+
+	assert_int_equal(dmic_modes_search(&req, &cfg_search), 0);
+	assert_int_equal(dmic_modes_get(&req, &cfg), 0);
+	assert_cfg_equal(&cfg, &cfg_search);
+	assert_int_equal(dmic_modes_get(&req, &cfg), 0);
+	assert_cfg_equal(&cfg, &cfg_search);
+
+	/* other requests replace the entries and the results stay right */
+	for (i = 0; i < 2 * DMIC_MODES_CACHE_SIZE; i++) {
+		req.fs_b = i & 1 ? 16000 : 0;
+		req.ioclk = i & 2 ? TEST_IOCLK / 2 : TEST_IOCLK;
+		req.duty_min = 40 - i;
+		assert_int_equal(dmic_modes_search(&req, &cfg_search), 0);
+		assert_int_equal(dmic_modes_get(&req, &cfg), 0);
+		assert_cfg_equal(&cfg, &cfg_search);
+	}
+
+	req = test_req;
+	assert_int_equal(dmic_modes_search(&req, &cfg_search), 0);
+	assert_int_equal(dmic_modes_get(&req, &cfg), 0);
+	assert_cfg_equal(&cfg, &cfg_search);
+}
+
+/* prints cycles per call of the full search and the remembered result */
+static void test_dmic_modes_cycles(void **state)
+{
+	struct dmic_modes_request req = test_req;
+	struct dmic_configuration cfg;
+	uint32_t search;
+	uint32_t get;
+	uint32_t start;
+	int i;
+
+	(void)state;
+
+	req.fs_b = 16000;
+
+	start = xthal_get_ccount();
+	for (i = 0; i < TEST_BENCH_LOOPS; i++)
+		assert_int_equal(dmic_modes_search(&req, &cfg), 0);
+	search = (xthal_get_ccount() - start) / TEST_BENCH_LOOPS;
+
+	start = xthal_get_ccount();
+	for (i = 0; i < TEST_BENCH_LOOPS; i++)
+		assert_int_equal(dmic_modes_get(&req, &cfg), 0);
+	get = (xthal_get_ccount() - start) / TEST_BENCH_LOOPS;
+
+	print_message("dmic_modes_search() %u cycles, dmic_modes_get() %u cycles\n",
+		      search, get);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_dmic_modes_search_one_fifo),
+		cmocka_unit_test(test_dmic_modes_search_two_fifos),
+		cmocka_unit_test(test_dmic_modes_search_ioclk),
+		cmocka_unit_test(test_dmic_modes_search_invalid),
+		cmocka_unit_test(test_dmic_modes_get),
+		cmocka_unit_test(test_dmic_modes_cycles),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,417 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/component_ext.h>
+#include <sof/drivers/ipc.h>
+#include <sof/lib/mailbox.h>
+#include <sof/list.h>
+#include <sof/schedule/schedule.h>
+#include <sof/schedule/task.h>
+#include <sof/sof.h>
+#include <ipc/control.h>
+#include <ipc/header.h>
+#include <ipc/stream.h>
+#include <kernel/abi.h>
+#include <kernel/header.h>
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+
+#define TEST_COMP_ID		3
+#define TEST_OTHER_COMP_ID	4
+#define TEST_MAX_CMDS		(2 * CONFIG_IPC_DEFERRED_QUEUE)
+
+/* data value the test component fails to apply */
+#define TEST_FAIL_VALUE		0xdead
+
+/* binary control data set with a single word of data */
+struct test_msg {
+	struct sof_ipc_ctrl_data cdata;
+	struct sof_abi_hdr abi;
+	uint32_t value;
+};
+
+struct tr_ctx ipc_tr;
+
+static struct sof sof;
+static struct ipc test_ipc;
+static struct schedulers test_schedulers;
+static struct schedulers *test_schedulers_p = &test_schedulers;
+static struct schedule_data test_edf;
+static struct comp_driver test_drv;
+static struct comp_dev test_dev;
+static struct ipc_comp_dev test_icd;
+static struct task *worker;
+
+/* values applied by the test component and completions sent in order */
+static uint32_t applied[TEST_MAX_CMDS];
+static int num_applied;
+static struct sof_ipc_ctrl_deferred done[TEST_MAX_CMDS];
+static int num_done;
+static int num_scheduled;
+static int num_processed;
+
+struct sof *sof_get(void)
+{
+	return &sof;
+}
+
+struct schedulers **arch_schedulers_get(void)
+{
+	return &test_schedulers_p;
+}
+
+uint64_t clock_ms_to_ticks(int clock, uint64_t ms)
+{
+	return ms;
+}
+
+int schedule_task_init_edf(struct task *task, const struct sof_uuid_entry *uid,
+			   const struct task_ops *ops,
+			   void *data, uint16_t core, uint32_t flags)
+{
+	task->type = SOF_SCHEDULE_EDF;
+	task->state = SOF_TASK_STATE_INIT;
+	task->data = data;
+	task->ops = *ops;
+	worker = task;
+
+	return 0;
+}
+
+struct ipc_comp_dev *ipc_get_comp_by_id(struct ipc *ipc, uint32_t id)
+{
+	return id == TEST_COMP_ID ? &test_icd : NULL;
+}
+
+void ipc_msg_send(struct ipc_msg *msg, void *data, bool high_priority)
+{
+	assert_true(num_done < TEST_MAX_CMDS);
+	memcpy_s(&done[num_done++], sizeof(done[0]), data, sizeof(done[0]));
+}
+
+void ipc_schedule_process(struct ipc *ipc)
+{
+	num_processed++;
+}
+
+static int test_schedule_task(void *data, struct task *task, uint64_t start,
+			      uint64_t period)
+{
+	task->state = SOF_TASK_STATE_QUEUED;
+	num_scheduled++;
+
+	return 0;
+}
+
+static const struct scheduler_ops test_edf_ops = {
+	.schedule_task = test_schedule_task,
+};
+
+static int test_comp_cmd(struct comp_dev *dev, int cmd, void *data,
+			 int max_data_size)
+{
+	struct test_msg *msg = data;
+
+	assert_int_equal(cmd, COMP_CMD_SET_DATA);
+	assert_true(num_applied < TEST_MAX_CMDS);
+	applied[num_applied++] = msg->value;
+
+	return msg->value == TEST_FAIL_VALUE ? -EINVAL : 0;
+}
+
+static int setup(void **state)
+{
+	list_init(&test_schedulers.list);
+	test_edf.type = SOF_SCHEDULE_EDF;
+	test_edf.ops = &test_edf_ops;
+	list_item_append(&test_edf.list, &test_schedulers.list);
+
+	test_drv.ops.cmd = test_comp_cmd;
+	test_dev.drv = &test_drv;
+	test_icd.type = COMP_TYPE_COMPONENT;
+	test_icd.id = TEST_COMP_ID;
+	test_icd.core = cpu_get_id();
+	test_icd.cd = &test_dev;
+
+	num_applied = 0;
+	num_done = 0;
+	num_scheduled = 0;
+	num_processed = 0;
+
+	return ipc_deferred_init(&test_ipc);
+}
+
+static struct sof_ipc_cmd_hdr *data_msg(struct test_msg *msg, uint32_t comp_id,
+					uint32_t value, bool deferred)
+{
+	memset(msg, 0, sizeof(*msg));
+	msg->cdata.rhdr.hdr.cmd = SOF_IPC_GLB_COMP_MSG | SOF_IPC_COMP_SET_DATA;
+	msg->cdata.rhdr.hdr.size = sizeof(*msg);
+	msg->cdata.comp_id = comp_id;
+	msg->cdata.cmd = SOF_CTRL_CMD_BINARY;
+	msg->cdata.num_elems = sizeof(value);
+	msg->cdata.flags = deferred ? SOF_IPC_CTRL_FLAG_DEFERRED : 0;
+	msg->abi.magic = SOF_ABI_MAGIC;
+	msg->abi.abi = SOF_ABI_VERSION;
+	msg->abi.size = sizeof(value);
+	msg->value = value;
+
+	return &msg->cdata.rhdr.hdr;
+}
+
+static struct sof_ipc_cmd_hdr *cmd_msg(struct test_msg *msg, uint32_t cmd,
+				       uint32_t comp_id)
+{
+	memset(msg, 0, sizeof(*msg));
+	msg->cdata.rhdr.hdr.cmd = cmd;
+	msg->cdata.rhdr.hdr.size = sizeof(msg->cdata);
+	msg->cdata.comp_id = comp_id;
+
+	return &msg->cdata.rhdr.hdr;
+}
+
+/* checks the acknowledge written to the mailbox for the last queued data */
+static void check_ack(uint32_t seq)
+{
+	struct sof_ipc_ctrl_deferred ack;
+
+	mailbox_hostbox_read(&ack, sizeof(ack), 0, sizeof(ack));
+	assert_int_equal(ack.rhdr.hdr.cmd,
+			 SOF_IPC_GLB_COMP_MSG | SOF_IPC_COMP_DEFERRED);
+	assert_int_equal(ack.rhdr.error, 0);
+	assert_int_equal(ack.comp_id, TEST_COMP_ID);
+	assert_int_equal(ack.seq, seq);
+}
+
+static void check_done(int i, uint32_t seq, int32_t error)
+{
+	assert_true(i < num_done);
+	assert_int_equal(done[i].rhdr.hdr.cmd,
+			 SOF_IPC_GLB_COMP_MSG | SOF_IPC_COMP_DEFERRED_DONE);
+	assert_int_equal(done[i].rhdr.error, error);
+	assert_int_equal(done[i].comp_id, TEST_COMP_ID);
+	assert_int_equal(done[i].seq, seq);
+}
+
+/* runs the worker once as the EDF scheduler does, the task stays running
+ * after the last command until worker_complete()
+ */
+static enum task_state worker_run(void)
+{
+	enum task_state state;
+
+	assert_int_equal(worker->state, SOF_TASK_STATE_QUEUED);
+
+	worker->state = SOF_TASK_STATE_RUNNING;
+	state = worker->ops.run(worker->data);
+	if (state == SOF_TASK_STATE_RESCHEDULE)
+		worker->state = SOF_TASK_STATE_QUEUED;
+
+	return state;
+}
+
+static void worker_complete(void)
+{
+	worker->state = SOF_TASK_STATE_COMPLETED;
+	worker->ops.complete(worker->data);
+}
+
+static void test_ipc_deferred_queue(void **state)
+{
+	struct test_msg msg;
+
+	(void)state;
+
+	/* queued data is acknowledged at once, the worker is kicked once */
+	assert_true(ipc_deferred_cmd(&test_ipc,
+				     data_msg(&msg, TEST_COMP_ID, 1, true)));
+	check_ack(1);
+	assert_true(ipc_deferred_cmd(&test_ipc,
+				     data_msg(&msg, TEST_COMP_ID, 2, true)));
+	check_ack(2);
+	assert_int_equal(num_scheduled, 1);
+	assert_int_equal(num_applied, 0);
+
+	/* position and value commands of other components overtake */
+	assert_false(ipc_deferred_cmd(&test_ipc,
+				      cmd_msg(&msg, SOF_IPC_GLB_STREAM_MSG |
+					      SOF_IPC_STREAM_POSITION, 0)));
+	assert_false(ipc_deferred_cmd(&test_ipc,
+				      cmd_msg(&msg, SOF_IPC_GLB_COMP_MSG |
+					      SOF_IPC_COMP_GET_VALUE,
+					      TEST_OTHER_COMP_ID)));
+	assert_false(ipc_deferred_held(&test_ipc));
+
+	/* value commands of the component wait for the queued data */
+	assert_true(ipc_deferred_cmd(&test_ipc,
+				     cmd_msg(&msg, SOF_IPC_GLB_COMP_MSG |
+					     SOF_IPC_COMP_SET_VALUE,
+					     TEST_COMP_ID)));
+	assert_true(ipc_deferred_held(&test_ipc));
+
+	/* data is applied in order and the held command processed again
+	 * only once the worker has exited
+	 */
+	assert_int_equal(worker_run(), SOF_TASK_STATE_RESCHEDULE);
+	assert_int_equal(worker_run(), SOF_TASK_STATE_COMPLETED);
+	assert_int_equal(num_applied, 2);
+	assert_int_equal(applied[0], 1);
+	assert_int_equal(applied[1], 2);
+	assert_int_equal(num_done, 2);
+	check_done(0, 1, 0);
+	check_done(1, 2, 0);
+	assert_int_equal(num_processed, 0);
+
+	worker_complete();
+	assert_int_equal(num_processed, 1);
+	assert_false(ipc_deferred_held(&test_ipc));
+
+	assert_false(ipc_deferred_cmd(&test_ipc,
+				      cmd_msg(&msg, SOF_IPC_GLB_COMP_MSG |
+					      SOF_IPC_COMP_SET_VALUE,
+					      TEST_COMP_ID)));
+}
+
+static void test_ipc_deferred_not_allowed(void **state)
+{
+	struct test_msg msg;
+
+	(void)state;
+
+	/* data without the flag or of unknown components is processed as
+	 * before while the queue is empty
+	 */
+	assert_false(ipc_deferred_cmd(&test_ipc,
+				      data_msg(&msg, TEST_COMP_ID, 1, false)));
+	assert_false(ipc_deferred_cmd(&test_ipc,
+				      data_msg(&msg, TEST_OTHER_COMP_ID, 1,
+					       true)));
+	assert_false(ipc_deferred_held(&test_ipc));
+	assert_int_equal(num_scheduled, 0);
+
+	/* and held while it isn't */
+	assert_true(ipc_deferred_cmd(&test_ipc,
+				     data_msg(&msg, TEST_COMP_ID, 1, true)));
+	assert_true(ipc_deferred_cmd(&test_ipc,
+				     data_msg(&msg, TEST_COMP_ID, 2, false)));
+	assert_true(ipc_deferred_held(&test_ipc));
+	check_ack(1);
+}
+
+static void test_ipc_deferred_error(void **state)
+{
+	struct test_msg msg;
+
+	(void)state;
+
+	assert_true(ipc_deferred_cmd(&test_ipc,
+				     data_msg(&msg, TEST_COMP_ID,
+					      TEST_FAIL_VALUE, true)));
+	assert_true(ipc_deferred_cmd(&test_ipc,
+				     data_msg(&msg, TEST_COMP_ID, 5, true)));
+	check_ack(2);
+
+	/* a failed command reports its error and doesn't stop the queue */
+	assert_int_equal(worker_run(), SOF_TASK_STATE_RESCHEDULE);
+	assert_int_equal(worker_run(), SOF_TASK_STATE_COMPLETED);
+	worker_complete();
+
+	assert_int_equal(num_applied, 2);
+	assert_int_equal(applied[1], 5);
+	check_done(0, 1, -EINVAL);
+	check_done(1, 2, 0);
+	assert_int_equal(num_processed, 0);
+}
+
+/* data sent after the worker has drained the queue but before it has
+ * exited can't be queued, the worker wouldn't be kicked again
+ */
+static void test_ipc_deferred_complete_late(void **state)
+{
+	struct test_msg msg;
+
+	(void)state;
+
+	assert_true(ipc_deferred_cmd(&test_ipc,
+				     data_msg(&msg, TEST_COMP_ID, 1, true)));
+	check_ack(1);
+	assert_int_equal(worker_run(), SOF_TASK_STATE_COMPLETED);
+	check_done(0, 1, 0);
+
+	assert_true(ipc_deferred_cmd(&test_ipc,
+				     data_msg(&msg, TEST_COMP_ID, 2, true)));
+	assert_true(ipc_deferred_held(&test_ipc));
+	check_ack(1);
+	assert_int_equal(num_scheduled, 1);
+
+	worker_complete();
+	assert_int_equal(num_processed, 1);
+
+	/* processed again it is queued and the worker kicked */
+	assert_true(ipc_deferred_cmd(&test_ipc,
+				     data_msg(&msg, TEST_COMP_ID, 2, true)));
+	assert_false(ipc_deferred_held(&test_ipc));
+	check_ack(2);
+	assert_int_equal(num_scheduled, 2);
+
+	assert_int_equal(worker_run(), SOF_TASK_STATE_COMPLETED);
+	worker_complete();
+	assert_int_equal(num_applied, 2);
+	assert_int_equal(applied[1], 2);
+	check_done(1, 2, 0);
+	assert_int_equal(num_processed, 1);
+}
+
+static void test_ipc_deferred_full(void **state)
+{
+	struct test_msg msg;
+	int i;
+
+	(void)state;
+
+	for (i = 1; i <= CONFIG_IPC_DEFERRED_QUEUE; i++) {
+		assert_true(ipc_deferred_cmd(&test_ipc,
+					     data_msg(&msg, TEST_COMP_ID, i,
+						      true)));
+		check_ack(i);
+	}
+
+	/* no free slot, the data waits for the worker */
+	assert_true(ipc_deferred_cmd(&test_ipc,
+				     data_msg(&msg, TEST_COMP_ID, i, true)));
+	assert_true(ipc_deferred_held(&test_ipc));
+	check_ack(CONFIG_IPC_DEFERRED_QUEUE);
+
+	for (i = 1; i < CONFIG_IPC_DEFERRED_QUEUE; i++)
+		assert_int_equal(worker_run(), SOF_TASK_STATE_RESCHEDULE);
+	assert_int_equal(worker_run(), SOF_TASK_STATE_COMPLETED);
+	worker_complete();
+
+	assert_int_equal(num_applied, CONFIG_IPC_DEFERRED_QUEUE);
+	for (i = 0; i < CONFIG_IPC_DEFERRED_QUEUE; i++)
+		check_done(i, i + 1, 0);
+	assert_int_equal(num_processed, 1);
+	assert_int_equal(num_scheduled, 1);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup(test_ipc_deferred_queue, setup),
+		cmocka_unit_test_setup(test_ipc_deferred_not_allowed, setup),
+		cmocka_unit_test_setup(test_ipc_deferred_error, setup),
+		cmocka_unit_test_setup(test_ipc_deferred_complete_late, setup),
+		cmocka_unit_test_setup(test_ipc_deferred_full, setup),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
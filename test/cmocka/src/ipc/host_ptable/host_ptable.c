@@ -0,0 +1,263 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/drivers/ipc.h>
+#include <sof/lib/alloc.h>
+#include <sof/lib/dma.h>
+#include <sof/platform.h>
+#include <ipc/stream.h>
+#include <ipc/topology.h>
+
+#include <errno.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+
+#define TEST_MAX_PAGES	16
+
+struct tr_ctx ipc_tr;
+
+static uint8_t test_page_table[TEST_MAX_PAGES * 5 / 2 + 1];
+static struct dma_chan_data test_chan;
+static struct dma test_dma;
+static struct ipc_data_host_buffer test_host_buffer = {
+	.dmac = &test_dma,
+	.page_table = test_page_table,
+};
+
+struct ipc_data_host_buffer *ipc_platform_get_host_buffer(struct ipc *ipc)
+{
+	(void)ipc;
+
+	return &test_host_buffer;
+}
+
+void dma_sg_free(struct dma_sg_elem_array *elem_array)
+{
+	rfree(elem_array->elems);
+	dma_sg_init(elem_array);
+}
+
+static struct dma_chan_data *test_channel_get(struct dma *dma,
+					      unsigned int req_channel)
+{
+	(void)req_channel;
+
+	test_chan.dma = dma;
+
+	return &test_chan;
+}
+
+static void test_channel_put(struct dma_chan_data *channel)
+{
+	(void)channel;
+}
+
+static int test_set_config(struct dma_chan_data *channel,
+			   struct dma_sg_config *config)
+{
+	(void)channel;
+	(void)config;
+
+	return 0;
+}
+
+/* page table is already in place */
+static int test_copy(struct dma_chan_data *channel, int bytes, uint32_t flags)
+{
+	(void)channel;
+	(void)bytes;
+	(void)flags;
+
+	return 0;
+}
+
+static const struct dma_ops test_dma_ops = {
+	.channel_get = test_channel_get,
+	.channel_put = test_channel_put,
+	.set_config = test_set_config,
+	.copy = test_copy,
+};
+
+/* packs the page addresses into 20 bit page frame numbers as the host */
+static void test_page_table_set(const uint32_t *addrs, uint32_t pages)
+{
+	uint32_t pfn;
+	uint32_t bit;
+	uint32_t i;
+	uint32_t b;
+
+	memset(test_page_table, 0, sizeof(test_page_table));
+
+	for (i = 0; i < pages; i++) {
+		pfn = addrs[i] >> 12;
+
+		for (b = 0; b < 20; b++) {
+			bit = i * 20 + b;
+			if (pfn & (1 << b))
+				test_page_table[bit / 8] |= 1 << (bit % 8);
+		}
+	}
+}
+
+static int test_parse(const uint32_t *addrs, uint32_t pages, uint32_t size,
+		      uint32_t direction, struct dma_sg_elem_array *elem_array)
+{
+	struct sof_ipc_host_buffer ring = {
+		.pages = pages,
+		.size = size,
+	};
+	uint32_t ring_size = 0;
+	int ret;
+
+	test_page_table_set(addrs, pages);
+
+	ret = ipc_process_host_buffer(NULL, &ring, direction, elem_array,
+				      &ring_size);
+	if (!ret)
+		assert_int_equal(ring_size, size);
+
+	return ret;
+}
+
+static void test_elem_check(struct dma_sg_elem_array *elem_array, int i,
+			    uint32_t src, uint32_t dest, uint32_t size)
+{
+	struct dma_sg_elem *e = elem_array->elems + i;
+
+	assert_int_equal(e->src, src);
+	assert_int_equal(e->dest, dest);
+	assert_int_equal(e->size, size);
+}
+
+static int setup(void **state)
+{
+	(void)state;
+
+	test_dma.ops = &test_dma_ops;
+
+	return 0;
+}
+
+static void test_host_ptable_contiguous(void **state)
+{
+	const uint32_t addrs[] = {
+		0x10000000, 0x10001000, 0x10002000, 0x10003000,
+	};
+	struct dma_sg_elem_array elem_array;
+	uint32_t size = 3 * HOST_PAGE_SIZE + 256;
+
+	(void)state;
+
+	assert_int_equal(test_parse(addrs, ARRAY_SIZE(addrs), size,
+				    SOF_IPC_STREAM_PLAYBACK, &elem_array), 0);
+
+	/* one element covers the whole ring */
+	assert_int_equal(elem_array.count, 1);
+	test_elem_check(&elem_array, 0, 0x10000000, 0, size);
+
+	dma_sg_free(&elem_array);
+}
+
+static void test_host_ptable_scattered(void **state)
+{
+	const uint32_t addrs[] = {
+		0x20003000, 0x20001000, 0x20000000, 0x20005000,
+	};
+	struct dma_sg_elem_array elem_array;
+	uint32_t size = 4 * HOST_PAGE_SIZE;
+	int i;
+
+	(void)state;
+
+	assert_int_equal(test_parse(addrs, ARRAY_SIZE(addrs), size,
+				    SOF_IPC_STREAM_PLAYBACK, &elem_array), 0);
+
+	/* descending or sparse pages are never merged */
+	assert_int_equal(elem_array.count, ARRAY_SIZE(addrs));
+	for (i = 0; i < ARRAY_SIZE(addrs); i++)
+		test_elem_check(&elem_array, i, addrs[i], 0, HOST_PAGE_SIZE);
+
+	dma_sg_free(&elem_array);
+}
+
+static void test_host_ptable_runs(void **state)
+{
+	const uint32_t addrs[] = {
+		0x30000000, 0x30001000, 0x30002000,
+		0x30010000, 0x30011000,
+		0x30004000,
+		0x30005000, 0x30006000,
+	};
+	struct dma_sg_elem_array elem_array;
+	uint32_t size = 7 * HOST_PAGE_SIZE + 64;
+
+	(void)state;
+
+	assert_int_equal(test_parse(addrs, ARRAY_SIZE(addrs), size,
+				    SOF_IPC_STREAM_CAPTURE, &elem_array), 0);
+
+	/* runs of contiguous pages, partial last page in the last run */
+	assert_int_equal(elem_array.count, 3);
+	test_elem_check(&elem_array, 0, 0, 0x30000000, 3 * HOST_PAGE_SIZE);
+	test_elem_check(&elem_array, 1, 0, 0x30010000, 2 * HOST_PAGE_SIZE);
+	test_elem_check(&elem_array, 2, 0, 0x30004000,
+			2 * HOST_PAGE_SIZE + 64);
+
+	dma_sg_free(&elem_array);
+}
+
+static void test_host_ptable_single(void **state)
+{
+	const uint32_t addrs[] = {
+		0xfffff000,
+	};
+	struct dma_sg_elem_array elem_array;
+
+	(void)state;
+
+	assert_int_equal(test_parse(addrs, ARRAY_SIZE(addrs), 100,
+				    SOF_IPC_STREAM_CAPTURE, &elem_array), 0);
+
+	assert_int_equal(elem_array.count, 1);
+	test_elem_check(&elem_array, 0, 0, 0xfffff000, 100);
+
+	dma_sg_free(&elem_array);
+}
+
+static void test_host_ptable_invalid_size(void **state)
+{
+	const uint32_t addrs[] = {
+		0x10000000, 0x10001000,
+	};
+	struct dma_sg_elem_array elem_array;
+
+	(void)state;
+
+	/* size must end in the last page */
+	assert_int_equal(test_parse(addrs, ARRAY_SIZE(addrs), HOST_PAGE_SIZE,
+				    SOF_IPC_STREAM_PLAYBACK, &elem_array),
+			 -EINVAL);
+	assert_null(elem_array.elems);
+	assert_int_equal(elem_array.count, 0);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup(test_host_ptable_contiguous, setup),
+		cmocka_unit_test_setup(test_host_ptable_scattered, setup),
+		cmocka_unit_test_setup(test_host_ptable_runs, setup),
+		cmocka_unit_test_setup(test_host_ptable_single, setup),
+		cmocka_unit_test_setup(test_host_ptable_invalid_size, setup),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
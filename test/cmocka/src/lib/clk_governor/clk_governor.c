@@ -0,0 +1,251 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/drivers/timer.h>
+#include <sof/lib/clk.h>
+#include <sof/lib/clk_governor.h>
+#include <sof/lib/notifier.h>
+#include <sof/math/numbers.h>
+#include <sof/sof.h>
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <cmocka.h>
+
+/* timer ticks are microseconds and the ll tick is 1 ms */
+#define TEST_TICK	1000
+#define TEST_WINDOW	100
+
+/* load trace entry, ll ticks and million cycles per second needed */
+struct test_load {
+	uint32_t ticks;
+	uint32_t mcps;
+};
+
+static const struct freq_table test_freqs[] = {
+	{ 100000000, 1000 },
+	{ 200000000, 1000 },
+	{ 400000000, 1000 },
+};
+
+static struct clock_info test_clocks[NUM_CLOCKS] = {
+	{
+		.freqs_num = ARRAY_SIZE(test_freqs),
+		.freqs = test_freqs,
+		.notification_id = NOTIFIER_ID_CPU_FREQ,
+	},
+};
+
+static struct sof sof = {
+	.clocks = test_clocks,
+};
+
+static uint64_t test_time;
+static int test_freq_changes;
+
+struct sof *sof_get(void)
+{
+	return &sof;
+}
+
+uint64_t platform_timer_get(struct timer *timer)
+{
+	(void)timer;
+
+	return test_time;
+}
+
+uint64_t clock_ms_to_ticks(int clock, uint64_t ms)
+{
+	(void)clock;
+
+	return ms * TEST_TICK;
+}
+
+void clock_set_freq(int clock, uint32_t hz)
+{
+	struct clock_info *clk_info = &test_clocks[clock];
+	struct clock_notify_data clk_data = {
+		.message = CLOCK_NOTIFY_POST,
+	};
+	uint32_t idx = 0;
+
+	while (idx < clk_info->freqs_num - 1 && hz > clk_info->freqs[idx].freq)
+		idx++;
+
+	clk_info->current_freq_idx = idx;
+	test_freq_changes++;
+
+	notifier_event(clk_info, NOTIFIER_ID_CPU_FREQ, 0, &clk_data,
+		       sizeof(clk_data));
+}
+
+/* runs the ll ticks of the trace with the load at the current clock */
+static void test_replay(struct clk_governor *gov,
+			const struct test_load *trace, int num)
+{
+	uint64_t busy;
+	uint32_t mhz;
+	uint32_t n;
+	int i;
+
+	for (i = 0; i < num; i++) {
+		for (n = 0; n < trace[i].ticks; n++) {
+			mhz = test_freqs[test_clocks[0].current_freq_idx].freq /
+				1000000;
+			busy = MIN(TEST_TICK * trace[i].mcps / mhz, TEST_TICK);
+
+			clk_governor_run_start(gov);
+			test_time += busy;
+			clk_governor_run_end(gov);
+			clk_governor_update(gov);
+			test_time += TEST_TICK - busy;
+		}
+	}
+}
+
+static int setup(void **state)
+{
+	test_time = 0;
+	*state = clk_governor_get();
+
+	return 0;
+}
+
+/* starts the replay from the frequency */
+static void test_start(uint32_t idx)
+{
+	clock_set_freq(0, test_freqs[idx].freq);
+	test_freq_changes = 0;
+}
+
+static void test_clk_governor_select(void **state)
+{
+	(void)state;
+
+	/* 50% at 400 MHz needs 200 MHz, 30% headroom gives 400 MHz */
+	assert_int_equal(clk_governor_select_idx(test_freqs, 3, 2, 50, 100,
+						 30, 10), 2);
+
+	/* 30% at 400 MHz fits 200 MHz with headroom and hysteresis */
+	assert_int_equal(clk_governor_select_idx(test_freqs, 3, 2, 30, 100,
+						 30, 10), 1);
+
+	/* 65% at 100 MHz fits the headroom, no change */
+	assert_int_equal(clk_governor_select_idx(test_freqs, 3, 0, 65, 100,
+						 30, 10), 0);
+
+	/* 75% at 100 MHz goes up */
+	assert_int_equal(clk_governor_select_idx(test_freqs, 3, 0, 75, 100,
+						 30, 10), 1);
+
+	/* 33% at 200 MHz is within hysteresis of 100 MHz, no change */
+	assert_int_equal(clk_governor_select_idx(test_freqs, 3, 1, 33, 100,
+						 30, 10), 1);
+
+	/* overload stays at max */
+	assert_int_equal(clk_governor_select_idx(test_freqs, 3, 2, 200, 100,
+						 30, 10), 2);
+
+	/* empty window keeps the frequency */
+	assert_int_equal(clk_governor_select_idx(test_freqs, 3, 1, 0, 0,
+						 30, 10), 1);
+}
+
+static void test_clk_governor_steady(void **state)
+{
+	const struct test_load trace[] = {
+		{ 10 * TEST_WINDOW, 50 },
+	};
+
+	test_start(2);
+	test_replay(*state, trace, ARRAY_SIZE(trace));
+
+	/* goes down once and stays there */
+	assert_int_equal(test_clocks[0].current_freq_idx, 0);
+	assert_int_equal(test_freq_changes, 1);
+}
+
+static void test_clk_governor_burst(void **state)
+{
+	const struct test_load trace[] = {
+		{ 2 * TEST_WINDOW, 50 },
+		{ 3 * TEST_WINDOW, 250 },
+	};
+
+	test_start(0);
+	test_replay(*state, trace, ARRAY_SIZE(trace));
+
+	/* saturated load goes up a step per window */
+	assert_int_equal(test_clocks[0].current_freq_idx, 2);
+	assert_int_equal(test_freq_changes, 2);
+}
+
+static void test_clk_governor_hysteresis(void **state)
+{
+	const struct test_load trace[] = {
+		{ 10 * TEST_WINDOW, 65 },
+	};
+	const struct test_load lower[] = {
+		{ 2 * TEST_WINDOW, 55 },
+	};
+
+	/* load between the thresholds doesn't toggle */
+	test_start(1);
+	test_replay(*state, trace, ARRAY_SIZE(trace));
+	assert_int_equal(test_clocks[0].current_freq_idx, 1);
+	assert_int_equal(test_freq_changes, 0);
+
+	test_start(0);
+	test_replay(*state, trace, ARRAY_SIZE(trace));
+	assert_int_equal(test_clocks[0].current_freq_idx, 0);
+	assert_int_equal(test_freq_changes, 0);
+
+	test_start(1);
+	test_replay(*state, lower, ARRAY_SIZE(lower));
+	assert_int_equal(test_clocks[0].current_freq_idx, 0);
+	assert_int_equal(test_freq_changes, 1);
+}
+
+static void test_clk_governor_notify(void **state)
+{
+	struct clk_governor *gov = *state;
+	const struct test_load trace[] = {
+		{ TEST_WINDOW / 2, 150 },
+	};
+
+	test_start(2);
+	test_replay(gov, trace, ARRAY_SIZE(trace));
+
+	/* change from elsewhere restarts the window at the new clock */
+	clock_set_freq(0, test_freqs[0].freq);
+	assert_int_equal(gov->cur_idx, 0);
+	assert_int_equal(gov->busy, 0);
+	assert_int_equal(gov->window_start, test_time);
+
+	/* the first half window at 400 MHz is not counted */
+	test_replay(gov, trace, ARRAY_SIZE(trace));
+	assert_int_equal(test_clocks[0].current_freq_idx, 0);
+
+	test_replay(gov, trace, ARRAY_SIZE(trace));
+	assert_int_equal(test_clocks[0].current_freq_idx, 1);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_clk_governor_select),
+		cmocka_unit_test_setup(test_clk_governor_steady, setup),
+		cmocka_unit_test_setup(test_clk_governor_burst, setup),
+		cmocka_unit_test_setup(test_clk_governor_hysteresis, setup),
+		cmocka_unit_test_setup(test_clk_governor_notify, setup),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
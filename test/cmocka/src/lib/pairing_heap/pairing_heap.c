@@ -0,0 +1,215 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/common.h>
+#include <sof/list.h>
+#include <sof/pairing_heap.h>
+#include <xtensa/hal.h>
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <cmocka.h>
+
+#define TEST_NODES		512
+#define TEST_KEYS		64	/* less than nodes to have equal keys */
+
+struct test_task {
+	struct pairing_heap_node node;
+	struct list_item list;
+	uint64_t deadline;
+	int index;
+	int queued;
+};
+
+static struct test_task tasks[TEST_NODES];
+static uint32_t seed = 1;
+
+static uint32_t test_rand(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return seed >> 8;
+}
+
+static struct test_task *test_peek(struct pairing_heap *heap)
+{
+	struct pairing_heap_node *node = pairing_heap_peek(heap);
+
+	return node ? container_of(node, struct test_task, node) : NULL;
+}
+
+/* removes all tasks and checks deadline order, queueing order on ties */
+static void test_drain(struct pairing_heap *heap, int count)
+{
+	struct test_task *prev = NULL;
+	struct test_task *task;
+	int n = 0;
+
+	while (!pairing_heap_is_empty(heap)) {
+		task = test_peek(heap);
+		if (prev) {
+			assert_true(prev->deadline <= task->deadline);
+			if (prev->deadline == task->deadline)
+				assert_true(prev->index < task->index);
+		}
+
+		pairing_heap_remove(heap, &task->node);
+		task->queued = 0;
+		prev = task;
+		n++;
+	}
+
+	assert_int_equal(n, count);
+	assert_int_equal(heap->count, 0);
+}
+
+static void test_pairing_heap_order(void **state)
+{
+	struct pairing_heap heap;
+	int i;
+
+	(void)state;
+
+	pairing_heap_init(&heap);
+	assert_null(pairing_heap_peek(&heap));
+
+	for (i = 0; i < TEST_NODES; i++) {
+		tasks[i].deadline = test_rand() % TEST_KEYS;
+		tasks[i].index = i;
+		pairing_heap_insert(&heap, &tasks[i].node, tasks[i].deadline);
+	}
+
+	assert_int_equal(heap.count, TEST_NODES);
+	test_drain(&heap, TEST_NODES);
+}
+
+static void test_pairing_heap_remove(void **state)
+{
+	struct pairing_heap heap;
+	struct test_task *task;
+	int count = TEST_NODES;
+	int i;
+
+	(void)state;
+
+	pairing_heap_init(&heap);
+
+	for (i = 0; i < TEST_NODES; i++) {
+		tasks[i].deadline = test_rand() % TEST_KEYS;
+		tasks[i].index = i;
+		tasks[i].queued = 1;
+		pairing_heap_insert(&heap, &tasks[i].node, tasks[i].deadline);
+	}
+
+	/* run the minimum once to have a tree with children */
+	task = test_peek(&heap);
+	pairing_heap_remove(&heap, &task->node);
+	task->queued = 0;
+	count--;
+
+	/* cancel random tasks from inside the heap */
+	for (i = 0; i < TEST_NODES / 2; i++) {
+		task = &tasks[test_rand() % TEST_NODES];
+		if (!task->queued)
+			continue;
+
+		pairing_heap_remove(&heap, &task->node);
+		task->queued = 0;
+		count--;
+	}
+
+	assert_int_equal(heap.count, count);
+	test_drain(&heap, count);
+}
+
+static void test_pairing_heap_order_wrap(void **state)
+{
+	struct pairing_heap heap;
+	int i;
+
+	(void)state;
+
+	pairing_heap_init(&heap);
+	heap.order = UINT32_MAX - TEST_NODES / 2;
+
+	for (i = 0; i < TEST_NODES; i++) {
+		tasks[i].deadline = 1;
+		tasks[i].index = i;
+		pairing_heap_insert(&heap, &tasks[i].node, tasks[i].deadline);
+	}
+
+	test_drain(&heap, TEST_NODES);
+}
+
+/* earliest deadline search as done before the heap */
+static struct test_task *test_list_earliest(struct list_item *head)
+{
+	struct test_task *task_next = NULL;
+	struct list_item *tlist;
+	struct test_task *task;
+
+	list_for_item(tlist, head) {
+		task = container_of(tlist, struct test_task, list);
+		if (!task_next || task->deadline <= task_next->deadline)
+			task_next = task;
+	}
+
+	return task_next;
+}
+
+/* prints cycles per queue, pick next and dequeue of a task */
+static void test_pairing_heap_cycles(void **state)
+{
+	struct pairing_heap heap;
+	struct list_item head;
+	struct test_task *task;
+	uint32_t start;
+	uint32_t list_cycles;
+	uint32_t heap_cycles;
+	int i;
+
+	(void)state;
+
+	for (i = 0; i < TEST_NODES; i++)
+		tasks[i].deadline = test_rand();
+
+	list_init(&head);
+	start = xthal_get_ccount();
+	for (i = 0; i < TEST_NODES; i++)
+		list_item_append(&tasks[i].list, &head);
+	for (i = 0; i < TEST_NODES; i++) {
+		task = test_list_earliest(&head);
+		list_item_del(&task->list);
+	}
+	list_cycles = (xthal_get_ccount() - start) / TEST_NODES;
+
+	pairing_heap_init(&heap);
+	start = xthal_get_ccount();
+	for (i = 0; i < TEST_NODES; i++)
+		pairing_heap_insert(&heap, &tasks[i].node, tasks[i].deadline);
+	for (i = 0; i < TEST_NODES; i++) {
+		task = test_peek(&heap);
+		pairing_heap_remove(&heap, &task->node);
+	}
+	heap_cycles = (xthal_get_ccount() - start) / TEST_NODES;
+
+	print_message("%d tasks: list scan %u cycles, pairing heap %u cycles per task\n",
+		      TEST_NODES, list_cycles, heap_cycles);
+	assert_true(pairing_heap_is_empty(&heap));
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_pairing_heap_order),
+		cmocka_unit_test(test_pairing_heap_remove),
+		cmocka_unit_test(test_pairing_heap_order_wrap),
+		cmocka_unit_test(test_pairing_heap_cycles),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
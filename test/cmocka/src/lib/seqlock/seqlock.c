@@ -0,0 +1,184 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/lib/seqlock.h>
+#include <ipc/stream.h>
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+
+#define TEST_UPDATES	16
+
+/* host side view of the position record */
+struct test_data {
+	struct sof_ipc_stream_posn_seq rec;
+	int reads;
+	int retries;
+	uint64_t last;
+};
+
+/* sequence number starts the record */
+static uint32_t *test_seq(struct test_data *td)
+{
+	return (uint32_t *)&td->rec;
+}
+
+/* all the positions of update n have the value n */
+static void test_posn_fill(struct sof_ipc_stream_posn *posn, uint64_t n)
+{
+	memset(posn, 0, sizeof(*posn));
+	posn->host_posn = n;
+	posn->dai_posn = n;
+	posn->comp_posn = n;
+	posn->wallclock = n;
+	posn->timestamp = n;
+}
+
+/* reads the record as the host does, returns false on torn read */
+static bool test_posn_read(struct test_data *td,
+			   struct sof_ipc_stream_posn *posn)
+{
+	uint32_t start = seqlock_read_begin(test_seq(td));
+
+	memcpy(posn, (void *)&td->rec.posn, sizeof(*posn));
+
+	return !seqlock_read_retry(test_seq(td), start);
+}
+
+/* reader polling at any point of the update must never see torn data */
+static void test_posn_poll(struct test_data *td)
+{
+	struct sof_ipc_stream_posn posn;
+
+	td->reads++;
+	if (!test_posn_read(td, &posn)) {
+		td->retries++;
+		return;
+	}
+
+	assert_true(posn.host_posn == posn.dai_posn);
+	assert_true(posn.host_posn == posn.comp_posn);
+	assert_true(posn.host_posn == posn.wallclock);
+	assert_true(posn.host_posn == posn.timestamp);
+	assert_true(posn.host_posn >= td->last);
+	td->last = posn.host_posn;
+}
+
+/* FW update with the host polling after every written byte */
+static void test_posn_write(struct test_data *td, uint64_t n)
+{
+	struct sof_ipc_stream_posn posn;
+	uint8_t *dst = (uint8_t *)&td->rec.posn;
+	uint8_t *src = (uint8_t *)&posn;
+	size_t i;
+
+	test_posn_fill(&posn, n);
+
+	seqlock_write_begin(test_seq(td));
+	test_posn_poll(td);
+
+	for (i = 0; i < sizeof(posn); i++) {
+		dst[i] = src[i];
+		test_posn_poll(td);
+	}
+
+	seqlock_write_end(test_seq(td));
+	test_posn_poll(td);
+}
+
+static int setup(void **state)
+{
+	struct test_data *td = calloc(1, sizeof(*td));
+
+	*state = td;
+
+	return 0;
+}
+
+static int teardown(void **state)
+{
+	free(*state);
+
+	return 0;
+}
+
+static void test_seqlock_idle(void **state)
+{
+	struct test_data *td = *state;
+	struct sof_ipc_stream_posn posn;
+
+	test_posn_fill(&td->rec.posn, 5);
+
+	assert_true(test_posn_read(td, &posn));
+	assert_int_equal(posn.host_posn, 5);
+	assert_int_equal(*test_seq(td), 0);
+}
+
+static void test_seqlock_concurrent(void **state)
+{
+	struct test_data *td = *state;
+	uint64_t n;
+
+	for (n = 1; n <= TEST_UPDATES; n++)
+		test_posn_write(td, n);
+
+	/* only the polls between the updates succeed */
+	assert_int_equal(*test_seq(td), 2 * TEST_UPDATES);
+	assert_int_equal(td->reads - td->retries, TEST_UPDATES);
+	assert_int_equal(td->last, TEST_UPDATES);
+}
+
+static void test_seqlock_torn(void **state)
+{
+	struct test_data *td = *state;
+	struct sof_ipc_stream_posn posn;
+	struct sof_ipc_stream_posn next;
+	size_t half = sizeof(posn) / 2;
+	uint32_t start;
+
+	test_posn_fill(&td->rec.posn, 1);
+	test_posn_fill(&next, 2);
+
+	/* update completes while the host has copied half of the record */
+	start = seqlock_read_begin(test_seq(td));
+	memcpy(&posn, (void *)&td->rec.posn, half);
+
+	seqlock_write_begin(test_seq(td));
+	memcpy((void *)&td->rec.posn, &next, sizeof(next));
+	seqlock_write_end(test_seq(td));
+
+	memcpy((uint8_t *)&posn + half, (uint8_t *)&td->rec.posn + half,
+	       sizeof(posn) - half);
+
+	/* mixed copy is detected from the sequence number */
+	assert_int_not_equal(posn.host_posn, posn.timestamp);
+	assert_true(seqlock_read_retry(test_seq(td), start));
+
+	/* retry gets the new update */
+	assert_true(test_posn_read(td, &posn));
+	assert_int_equal(posn.host_posn, 2);
+	assert_int_equal(posn.timestamp, 2);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown(test_seqlock_idle,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_seqlock_concurrent,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown(test_seqlock_torn,
+						setup, teardown),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
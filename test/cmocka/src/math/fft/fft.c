@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <sof/math/fft.h>
+#include <sof/math/trig.h>
+
+#define TEST_LEN_LOG2	6
+#define TEST_LEN	(1 << TEST_LEN_LOG2)
+
+/* Allowed error in Q1.31 LSBs */
+#define TEST_TOLERANCE	(1 << 12)
+
+static struct icomplex32 twiddle[TEST_LEN / 2];
+
+static void test_signal(struct icomplex32 *x)
+{
+	uint32_t seed = 1;
+	int i;
+
+	/* Pseudo random samples with half of full scale */
+	for (i = 0; i < TEST_LEN; i++) {
+		seed = seed * 1103515245 + 12345;
+		x[i].real = (int32_t)seed >> 1;
+		seed = seed * 1103515245 + 12345;
+		x[i].imag = (int32_t)seed >> 1;
+	}
+}
+
+static void test_math_fft_plan(void **state)
+{
+	struct fft_plan plan;
+
+	(void)state;
+
+	assert_int_equal(fft_plan_init(&plan, twiddle, 1), -EINVAL);
+	assert_int_equal(fft_plan_init(&plan, twiddle, FFT_MAX_LEN_LOG2 + 1),
+			 -EINVAL);
+	assert_int_equal(fft_plan_init(&plan, twiddle, TEST_LEN_LOG2), 0);
+	assert_int_equal(plan.size, TEST_LEN);
+}
+
+static void test_math_fft_impulse(void **state)
+{
+	struct icomplex32 x[TEST_LEN] = { { 0 } };
+	struct fft_plan plan;
+	int i;
+
+	(void)state;
+
+	fft_plan_init(&plan, twiddle, TEST_LEN_LOG2);
+
+	/* Flat spectrum scaled by 1 / size */
+	x[0].real = INT32_MAX;
+	fft_execute_32(&plan, x, false);
+	for (i = 0; i < TEST_LEN; i++) {
+		assert_in_range(x[i].real, (INT32_MAX >> TEST_LEN_LOG2) - 1,
+				(INT32_MAX >> TEST_LEN_LOG2) + 1);
+		assert_in_range(x[i].imag, -1, 1);
+	}
+}
+
+static void test_math_fft_dft(void **state)
+{
+	struct icomplex32 x[TEST_LEN];
+	struct icomplex32 ref[TEST_LEN];
+	struct fft_plan plan;
+	int64_t sr;
+	int64_t si;
+	int32_t wr;
+	int32_t wi;
+	int32_t w;
+	int k;
+	int n;
+
+	(void)state;
+
+	fft_plan_init(&plan, twiddle, TEST_LEN_LOG2);
+	test_signal(x);
+
+	/* Reference direct DFT scaled by 1 / size */
+	for (k = 0; k < TEST_LEN; k++) {
+		sr = 0;
+		si = 0;
+		for (n = 0; n < TEST_LEN; n++) {
+			/* sin_fixed() needs angle in 0 .. 2 * pi */
+			w = ((int64_t)PI_MUL2_Q4_28 *
+			     ((k * n + TEST_LEN / 4) % TEST_LEN)) >>
+				TEST_LEN_LOG2;
+			wr = sin_fixed(w);
+			w = ((int64_t)PI_MUL2_Q4_28 * ((k * n) % TEST_LEN)) >>
+				TEST_LEN_LOG2;
+			wi = -sin_fixed(w);
+			sr += ((int64_t)wr * x[n].real -
+			       (int64_t)wi * x[n].imag) >> 31;
+			si += ((int64_t)wr * x[n].imag +
+			       (int64_t)wi * x[n].real) >> 31;
+		}
+		ref[k].real = sr >> TEST_LEN_LOG2;
+		ref[k].imag = si >> TEST_LEN_LOG2;
+	}
+
+	fft_execute_32(&plan, x, false);
+
+	for (k = 0; k < TEST_LEN; k++) {
+		assert_true(abs(x[k].real - ref[k].real) < TEST_TOLERANCE);
+		assert_true(abs(x[k].imag - ref[k].imag) < TEST_TOLERANCE);
+	}
+}
+
+static void test_math_fft_inverse(void **state)
+{
+	struct icomplex32 x[TEST_LEN];
+	struct icomplex32 ref[TEST_LEN];
+	struct fft_plan plan;
+	int i;
+
+	(void)state;
+
+	fft_plan_init(&plan, twiddle, TEST_LEN_LOG2);
+	test_signal(x);
+	test_signal(ref);
+
+	fft_execute_32(&plan, x, false);
+	fft_execute_32(&plan, x, true);
+
+	for (i = 0; i < TEST_LEN; i++) {
+		assert_true(abs(x[i].real - ref[i].real) < TEST_TOLERANCE);
+		assert_true(abs(x[i].imag - ref[i].imag) < TEST_TOLERANCE);
+	}
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_math_fft_plan),
+		cmocka_unit_test(test_math_fft_impulse),
+		cmocka_unit_test(test_math_fft_dft),
+		cmocka_unit_test(test_math_fft_inverse),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -22,6 +22,9 @@
 
 int enable_fuzzer;
 
+/* seed corpus of the in-process IPC fuzzer, written instead of sending */
+static FILE *seed_file;
+
 int ipc_reply_recd;
 pthread_cond_t ipc_cond = PTHREAD_COND_INITIALIZER;
 pthread_mutex_t ipc_mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -87,11 +90,13 @@ static void usage(char *name)
 	fprintf(stdout, "Usage %s -p platform <option(s)>\n", name);
 	fprintf(stdout, "		-t topology file\n");
 	fprintf(stdout, "		-p platform name\n");
+	fprintf(stdout, "		-s seed file, IPCs of the topology are written to it\n");
 	fprintf(stdout, "		supported platforms: ");
 	for (i = 0; i < ARRAY_SIZE(platform); i++)
 		fprintf(stdout, "%s ", platform[i]->name);
 	fprintf(stdout, "\n");
 	fprintf(stdout, "Qemu must be started before the fuzzer is run.\n");
+	fprintf(stdout, "No platform is needed for the seed file.\n");
 
 	exit(0);
 }
@@ -228,12 +233,22 @@ void fuzzer_ipc_crash(struct fuzz *fuzzer, struct mailbox *mailbox,
 
 int fuzzer_send_msg(struct fuzz *fuzzer)
 {
+	struct sof_ipc_cmd_hdr *hdr = fuzzer->msg.msg_data;
 	struct timespec timeout;
 	struct timeval tp;
 	int ret;
 
 	ipc_dump(&fuzzer->msg);
 
+	/* messages are stored as they appear in the mailbox */
+	if (seed_file) {
+		if (fwrite(hdr, hdr->size, 1, seed_file) != 1) {
+			fprintf(stderr, "error: seed file write failed\n");
+			return -EIO;
+		}
+		return 0;
+	}
+
 	/* send msg */
 	ret = fuzzer->platform->send_msg(fuzzer, &fuzzer->msg);
 	if (ret < 0) {
@@ -286,11 +301,12 @@ int main(int argc, char *argv[])
 	char opt;
 	char *topology_file;
 	char *platform_name = NULL;
+	char *seed_name = NULL;
 	int i, j;
 	int regions = 0;
 
 	/* parse arguments */
-	while ((opt = getopt(argc, argv, "ht:p:")) != -1) {
+	while ((opt = getopt(argc, argv, "ht:p:s:")) != -1) {
 		switch (opt) {
 		case 't':
 			topology_file = optarg;
@@ -298,6 +314,9 @@ int main(int argc, char *argv[])
 		case 'p':
 			platform_name = optarg;
 			break;
+		case 's':
+			seed_name = optarg;
+			break;
 		case 'h':
 			usage(argv[0]);
 			exit(0);
@@ -308,6 +327,24 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	/* allocate max ipc size bytes for the msg and reply */
+	fuzzer.msg.msg_data = malloc(SOF_IPC_MSG_MAX_SIZE);
+	fuzzer.msg.reply_data = malloc(SOF_IPC_MSG_MAX_SIZE);
+
+	/* only convert the topology to IPCs */
+	if (seed_name) {
+		seed_file = fopen(seed_name, "wb");
+		if (!seed_file) {
+			fprintf(stderr, "error: can't open seed file %s\n",
+				seed_name);
+			exit(EXIT_FAILURE);
+		}
+
+		ret = parse_tplg(&fuzzer, topology_file);
+		fclose(seed_file);
+		exit(ret < 0 ? EXIT_FAILURE : 0);
+	}
+
 	/* initialise emulated target device */
 	if (!platform_name) {
 		fprintf(stderr, "error: no target platform specified\n");
@@ -340,10 +377,6 @@ int main(int argc, char *argv[])
 
 	fprintf(stdout, "FW boot complete\n");
 
-	/* allocate max ipc size bytes for the msg and reply */
-	fuzzer.msg.msg_data = malloc(SOF_IPC_MSG_MAX_SIZE);
-	fuzzer.msg.reply_data = malloc(SOF_IPC_MSG_MAX_SIZE);
-
 	/* load topology */
 	ret = parse_tplg(&fuzzer, topology_file);
 	if (ret < 0)
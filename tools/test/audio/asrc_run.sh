@@ -8,9 +8,26 @@ usage ()
     echo "Example: $1 16 16 32000 48000 input.raw output.raw"
 }
 
+# Print testbench process cycles in total and per output sample, the
+# count is from perf stat and includes the topology load.
+report_cycles ()
+{
+    local CYCLES SAMPLES
+
+    CYCLES=$(grep -m1 ',cycles' "$1" | cut -d, -f1)
+    SAMPLES=$(grep -m1 'Output sample count:' "$2" | awk '{print $4}')
+    if ! [[ "$CYCLES" =~ ^[0-9]+$ ]] || ! [[ "$SAMPLES" =~ ^[1-9][0-9]*$ ]]
+    then
+	echo "Cycles:          not available"
+	return
+    fi
+
+    echo "Cycles:          $CYCLES total, $((CYCLES / SAMPLES)) per output sample"
+}
+
 main()
 {
-    local COMP DIRECTION
+    local COMP DIRECTION LOG PERF_LOG RET
 
     if [ $# -ne 6 ]; then
 	usage "$0"
@@ -20,7 +37,21 @@ main()
     COMP=asrc
     DIRECTION=playback
 
-    ./comp_run.sh $COMP $DIRECTION "$@"
+    if ! command -v perf > /dev/null; then
+	echo "Note: perf not found, cycles are not reported"
+	./comp_run.sh $COMP $DIRECTION "$@"
+	exit
+    fi
+
+    LOG=$(mktemp)
+    PERF_LOG=$(mktemp)
+    perf stat -x, -e cycles -o "$PERF_LOG" \
+	 ./comp_run.sh $COMP $DIRECTION "$@" | tee "$LOG"
+    RET=${PIPESTATUS[0]}
+
+    report_cycles "$PERF_LOG" "$LOG"
+    rm -f "$LOG" "$PERF_LOG"
+    exit "$RET"
 }
 
 main "$@"
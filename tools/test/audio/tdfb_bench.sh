@@ -0,0 +1,46 @@
+#!/bin/bash
+# SPDX-License-Identifier: BSD-3-Clause
+# Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+# Runs the testbench with TDFB topologies, e.g. with time and frequency
+# domain configuration blobs of a beamformer, and prints the processing
+# cycles per frame of each.
+
+set -e
+
+usage ()
+{
+    echo "Usage:   $0 <bits> <rate> <input> <topology> [<topology> ...]"
+    echo "Example: $0 16 48000 input.raw tdfb_time.tplg tdfb_freq.tplg"
+}
+
+main ()
+{
+    local BITS FS FN_IN FN_OUT TPLG
+
+    if [ $# -lt 4 ]; then
+	usage "$0"
+	exit
+    fi
+
+    BITS=$1
+    FS=$2
+    FN_IN=$3
+    shift 3
+
+    HOST_ROOT=../../testbench/build_testbench
+    HOST_EXE=$HOST_ROOT/install/bin/testbench
+    HOST_LIB=$HOST_ROOT/sof_ep/install/lib
+    TPLG_LIB=$HOST_ROOT/sof_parser/install/lib
+    export LD_LIBRARY_PATH=$HOST_LIB:$TPLG_LIB
+
+    FN_OUT=$(mktemp --suffix=.raw)
+    for TPLG in "$@"; do
+	echo -n "$TPLG: "
+	$HOST_EXE -r "$FS" -R "$FS" -i "$FN_IN" -o "$FN_OUT" -t "$TPLG" \
+		  -b "S${BITS}_LE" | grep "per output frame"
+    done
+    rm -f "$FN_OUT"
+}
+
+main "$@"
@@ -0,0 +1,231 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/*
+ * In-process libFuzzer target of the host library build. The input is a
+ * sequence of IPC messages as they appear in the mailbox, each starting with
+ * struct sof_ipc_cmd_hdr whose size tells where the next one starts. Seed
+ * inputs are written by sof-fuzzer -s from topology files.
+ *
+ * Topology and component control messages are dispatched to the library as
+ * the firmware IPC handler does. Stream messages are ignored, the library has
+ * no host and DAI components to run the pipelines with. Everything created
+ * by an input is freed before the next one, so the fuzzer can run in
+ * persistent mode.
+ */
+
+#include <sof/audio/buffer.h>
+#include <sof/audio/component_ext.h>
+#include <sof/audio/pipeline.h>
+#include <sof/drivers/ipc.h>
+#include <sof/list.h>
+#include <ipc/control.h>
+#include <ipc/header.h>
+#include <ipc/topology.h>
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "testbench/common_test.h"
+#include "testbench/trace.h"
+
+/* limits the work done by one input */
+#define FUZZ_IPC_MAX_MSGS	256
+
+/* components are registered by loading their libraries */
+static const char * const fuzz_ipc_libs[] = {
+	"libsof_volume.so",
+	"libsof_src.so",
+	"libsof_asrc.so",
+	"libsof_eq-fir.so",
+	"libsof_eq-iir.so",
+	"libsof_dcblock.so",
+	"libsof_crossover.so",
+	"libsof_tdfb.so",
+	"libsof_drc.so",
+	"libsof_matrix.so",
+};
+
+/* main firmware context */
+static struct sof sof;
+
+/* compatible variables, not used */
+intptr_t _comp_init_start, _comp_init_end;
+
+int LLVMFuzzerInitialize(int *argc, char ***argv);
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+struct sof *sof_get(void)
+{
+	return &sof;
+}
+
+static struct comp_dev *fuzz_ipc_comp(uint32_t comp_id)
+{
+	struct ipc_comp_dev *icd = ipc_get_comp_by_id(sof.ipc, comp_id);
+
+	if (!icd || icd->type != COMP_TYPE_COMPONENT)
+		return NULL;
+
+	return icd->cd;
+}
+
+static int fuzz_ipc_tplg(struct sof_ipc_cmd_hdr *hdr)
+{
+	struct ipc *ipc = sof.ipc;
+
+	switch (hdr->cmd & SOF_CMD_TYPE_MASK) {
+	case SOF_IPC_TPLG_COMP_NEW:
+		return ipc_comp_new(ipc, (struct sof_ipc_comp *)hdr);
+	case SOF_IPC_TPLG_COMP_FREE:
+		return ipc_comp_free(ipc, ((struct sof_ipc_free *)hdr)->id);
+	case SOF_IPC_TPLG_COMP_CONNECT:
+		return ipc_comp_connect(ipc,
+					(struct sof_ipc_pipe_comp_connect *)hdr);
+	case SOF_IPC_TPLG_PIPE_NEW:
+		return ipc_pipeline_new(ipc, (struct sof_ipc_pipe_new *)hdr);
+	case SOF_IPC_TPLG_PIPE_FREE:
+		return ipc_pipeline_free(ipc, ((struct sof_ipc_free *)hdr)->id);
+	case SOF_IPC_TPLG_PIPE_COMPLETE:
+		return ipc_pipeline_complete(ipc,
+				((struct sof_ipc_pipe_ready *)hdr)->comp_id);
+	case SOF_IPC_TPLG_BUFFER_NEW:
+		return ipc_buffer_new(ipc, (struct sof_ipc_buffer *)hdr);
+	case SOF_IPC_TPLG_BUFFER_FREE:
+		return ipc_buffer_free(ipc, ((struct sof_ipc_free *)hdr)->id);
+	default:
+		return -EINVAL;
+	}
+}
+
+static int fuzz_ipc_comp_cmd(struct sof_ipc_cmd_hdr *hdr)
+{
+	struct sof_ipc_ctrl_data *cdata = (struct sof_ipc_ctrl_data *)hdr;
+	struct comp_dev *cd = fuzz_ipc_comp(cdata->comp_id);
+
+	if (!cd)
+		return -ENODEV;
+
+	switch (hdr->cmd & SOF_CMD_TYPE_MASK) {
+	case SOF_IPC_COMP_SET_VALUE:
+		return comp_cmd(cd, COMP_CMD_SET_VALUE, cdata,
+				SOF_IPC_MSG_MAX_SIZE);
+	case SOF_IPC_COMP_GET_VALUE:
+		return comp_cmd(cd, COMP_CMD_GET_VALUE, cdata,
+				SOF_IPC_MSG_MAX_SIZE);
+	case SOF_IPC_COMP_SET_DATA:
+		return comp_cmd(cd, COMP_CMD_SET_DATA, cdata,
+				SOF_IPC_MSG_MAX_SIZE);
+	case SOF_IPC_COMP_GET_DATA:
+		return comp_cmd(cd, COMP_CMD_GET_DATA, cdata,
+				SOF_IPC_MSG_MAX_SIZE);
+	default:
+		return -EINVAL;
+	}
+}
+
+static int fuzz_ipc_cmd(struct sof_ipc_cmd_hdr *hdr)
+{
+	switch (hdr->cmd & SOF_GLB_TYPE_MASK) {
+	case SOF_IPC_GLB_TPLG_MSG:
+		return fuzz_ipc_tplg(hdr);
+	case SOF_IPC_GLB_COMP_MSG:
+		return fuzz_ipc_comp_cmd(hdr);
+	default:
+		return -EINVAL;
+	}
+}
+
+/*
+ * Frees everything regardless of the state the input left it in. Buffers go
+ * first to unlink them from the components, the pipelines go last as their
+ * components are already gone.
+ */
+static void fuzz_ipc_reset(void)
+{
+	struct ipc_comp_dev *icd;
+	struct list_item *clist;
+	struct list_item *temp;
+
+	list_for_item_safe(clist, temp, &sof.ipc->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (icd->type != COMP_TYPE_BUFFER)
+			continue;
+
+		buffer_free(icd->cb);
+		list_item_del(&icd->list);
+		rfree(icd);
+	}
+
+	list_for_item_safe(clist, temp, &sof.ipc->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (icd->type != COMP_TYPE_COMPONENT)
+			continue;
+
+		comp_free(icd->cd);
+		list_item_del(&icd->list);
+		rfree(icd);
+	}
+
+	list_for_item_safe(clist, temp, &sof.ipc->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+
+		icd->pipeline->source_comp = NULL;
+		pipeline_free(icd->pipeline);
+		list_item_del(&icd->list);
+		rfree(icd);
+	}
+}
+
+int LLVMFuzzerInitialize(int *argc, char ***argv)
+{
+	int i;
+
+	(void)argc;
+	(void)argv;
+
+	if (tb_pipeline_setup(&sof) < 0) {
+		fprintf(stderr, "error: pipeline init\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(fuzz_ipc_libs); i++) {
+		if (!dlopen(fuzz_ipc_libs[i], RTLD_LAZY)) {
+			fprintf(stderr, "error: %s\n", dlerror());
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	tb_enable_trace(false);
+
+	return 0;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	struct sof_ipc_cmd_hdr *hdr = sof.ipc->comp_data;
+	size_t bytes;
+	int i;
+
+	for (i = 0; i < FUZZ_IPC_MAX_MSGS && size >= sizeof(*hdr); i++) {
+		/* the size is validated by the mailbox read of the firmware */
+		memcpy(hdr, data, sizeof(*hdr));
+		if (hdr->size < sizeof(*hdr) || hdr->size > SOF_IPC_MSG_MAX_SIZE)
+			break;
+
+		/* the rest of the mailbox holds zeros instead of stale data */
+		bytes = MIN(hdr->size, size);
+		memset(sof.ipc->comp_data, 0, SOF_IPC_MSG_MAX_SIZE);
+		memcpy(sof.ipc->comp_data, data, bytes);
+
+		fuzz_ipc_cmd(hdr);
+
+		data += bytes;
+		size -= bytes;
+	}
+
+	fuzz_ipc_reset();
+
+	return 0;
+}
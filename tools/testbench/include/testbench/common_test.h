@@ -23,7 +23,7 @@
 #define MAX_OUTPUT_FILE_NUM	4
 
 /* number of widgets types supported in testbench */
-#define NUM_WIDGETS_SUPPORTED	10
+#define NUM_WIDGETS_SUPPORTED	11
 
 struct testbench_prm {
 	char *tplg_file; /* topology file to use */
@@ -44,6 +44,11 @@ struct testbench_prm {
 	int fw_id;
 	int sched_id;
 	int max_pipeline_id;
+	int period_mult; /* deep buffer, pipeline period and buffer multiplier */
+	char *vdsp_model; /* virtual DSP processing time model */
+	char *tplg_cache; /* binary cache of the topology IPC messages */
+	int tplg_cached; /* pipelines were set up from the cache */
+	int tplg_repeat; /* topology setups, all but the last are freed */
 	enum sof_ipc_frame frame_fmt;
 };
 
@@ -0,0 +1,25 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef _TPLG_CACHE_H
+#define _TPLG_CACHE_H
+
+#include <ipc/topology.h>
+#include <stdint.h>
+#include "testbench/common_test.h"
+
+struct sof;
+
+int tplg_cache_load(struct sof *sof, struct testbench_prm *tp,
+		    char *pipeline_msg);
+
+void tplg_cache_start(struct testbench_prm *tp);
+
+void tplg_cache_add(uint32_t cmd, const void *msg, uint32_t size,
+		    const struct sof_ipc_comp_ext *comp_ext);
+
+int tplg_cache_save(struct testbench_prm *tp, const char *pipeline_msg);
+
+#endif
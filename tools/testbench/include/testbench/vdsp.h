@@ -0,0 +1,55 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef _VDSP_H
+#define _VDSP_H
+
+#include <stdint.h>
+
+/* per pipeline statistics of the DSP time model */
+struct vdsp_pipe_stats {
+	uint64_t period_ns;	/* pipeline period */
+	uint64_t busy_ns;	/* modelled processing time */
+	uint64_t max_busy_ns;	/* longest modelled copy */
+	uint32_t copies;
+	uint32_t misses;	/* wakeups done after the pipeline period */
+};
+
+/*
+ * Cost model of the DSP time taken by the testbench pipeline copies. The
+ * DSP time of a copy is the host execution time scaled to the DSP, and
+ * the copies of a wakeup are summed back to back. Nothing is scheduled
+ * against the model, it only estimates the DSP load and the wakeups that
+ * wouldn't finish within the pipeline period.
+ */
+struct vdsp {
+	double scale;		/* DSP to host execution time ratio */
+	uint64_t overhead_ns;	/* fixed DSP time of each copy */
+	uint64_t period_ns;	/* period of the scheduling pipeline */
+	uint64_t wakeup_busy_ns;	/* modelled processing in the wakeup */
+	uint64_t max_wakeup_busy_ns;
+	uint64_t busy_ns;
+	uint32_t wakeups;
+	int num_pipes;
+	struct vdsp_pipe_stats *pipes;	/* indexed by pipeline id */
+};
+
+int vdsp_parse(struct vdsp *vdsp, char *model);
+
+int vdsp_init(struct vdsp *vdsp, uint32_t period_us, int max_pipeline_id);
+
+void vdsp_free(struct vdsp *vdsp);
+
+int vdsp_set_period(struct vdsp *vdsp, int pipeline_id, uint32_t period_us);
+
+void vdsp_wakeup(struct vdsp *vdsp);
+
+uint64_t vdsp_copy_begin(void);
+
+void vdsp_copy_end(struct vdsp *vdsp, int pipeline_id, uint64_t begin);
+
+void vdsp_print(struct vdsp *vdsp);
+
+#endif
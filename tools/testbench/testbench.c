@@ -13,6 +13,7 @@
 #include <tplg_parser/topology.h>
 #include "testbench/trace.h"
 #include "testbench/file.h"
+#include "testbench/vdsp.h"
 
 #define DECLARE_SOF_TB_UUID(entity_name, uuid_name,			\
 			 va, vb, vc,					\
@@ -33,8 +34,19 @@ DECLARE_SOF_TB_UUID("tdfb", tdfb_uuid,  0xdd511749, 0xd9fa, 0x455c,
 DECLARE_SOF_TB_UUID("drc", drc_uuid, 0xb36ee4da, 0x006f, 0x47f9,
 		    0xa0, 0x6d, 0xfe, 0xcb, 0xe2, 0xd8, 0xb6, 0xce);
 
+DECLARE_SOF_TB_UUID("matrix", matrix_uuid, 0x7c4d3a1b, 0x5e29, 0x4f83,
+		    0x9a, 0x6c, 0x2d, 0x18, 0xb0, 0xe4, 0xf5, 0x37);
+
 #define TESTBENCH_NCH 2 /* Stereo */
 
+/* host cycle counter for the load report, zero if not available */
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define tb_get_cycles() __rdtsc()
+#else
+#define tb_get_cycles() 0
+#endif
+
 /* shared library look up table */
 struct shared_lib_table lib_table[NUM_WIDGETS_SUPPORTED] = {
 	{"file", "", SOF_COMP_HOST, NULL, 0, NULL}, /* File must be first */
@@ -47,6 +59,7 @@ struct shared_lib_table lib_table[NUM_WIDGETS_SUPPORTED] = {
 	{"crossover", "libsof_crossover.so", SOF_COMP_NONE, SOF_TB_UUID(crossover_uuid), 0, NULL},
 	{"tdfb", "libsof_tdfb.so", SOF_COMP_NONE, SOF_TB_UUID(tdfb_uuid), 0, NULL},
 	{"drc", "libsof_drc.so", SOF_COMP_NONE, SOF_TB_UUID(drc_uuid), 0, NULL},
+	{"matrix", "libsof_matrix.so", SOF_COMP_NONE, SOF_TB_UUID(matrix_uuid), 0, NULL},
 };
 
 /* main firmware context */
@@ -143,12 +156,22 @@ static void print_usage(char *executable)
 	printf("Usage: %s -i <input_file> ", executable);
 	printf("-o <output_file1,output_file2,...> ");
 	printf("-t <tplg_file> -b <input_format> -c <channels>");
-	printf("-a <comp1=comp1_library,comp2=comp2_library>\n");
+	printf("-a <comp1=comp1_library,comp2=comp2_library> ");
+	printf("-p <period_multiplier> -V <scale[,overhead_us]> ");
+	printf("-T <tplg_cache_file> -n <tplg_repeat>\n");
 	printf("input_format should be S16_LE, S32_LE, S24_LE or FLOAT_LE\n");
 	printf("Example Usage:\n");
 	printf("%s -i in.txt -o out.txt -t test.tplg ", executable);
 	printf("-r 48000 -R 96000 -c 2");
 	printf("-b S16_LE -a vol=libsof_volume.so\n");
+	printf("period_multiplier > 1 runs pipelines in deep buffer mode with\n");
+	printf("the period and buffers of the topology multiplied\n");
+	printf("-V estimates the DSP load, the DSP time of a copy is the\n");
+	printf("host time multiplied by scale plus overhead\n");
+	printf("-T sets up the pipelines from a cache of the topology, the\n");
+	printf("cache is written when missing or made with other arguments\n");
+	printf("-n sets up the pipelines tplg_repeat times and prints the\n");
+	printf("mean time of the setups after the first\n");
 }
 
 /* free components */
@@ -186,7 +209,7 @@ static void parse_input_args(int argc, char **argv, struct testbench_prm *tp)
 	int option = 0;
 	int ret = 0;
 
-	while ((option = getopt(argc, argv, "hdi:o:t:b:a:r:R:c:")) != -1) {
+	while ((option = getopt(argc, argv, "hdi:o:t:b:a:r:R:c:p:V:T:n:")) != -1) {
 		switch (option) {
 		/* input sample file */
 		case 'i':
@@ -229,6 +252,34 @@ static void parse_input_args(int argc, char **argv, struct testbench_prm *tp)
 			tp->channels = atoi(optarg);
 			break;
 
+		/* deep buffer period multiplier */
+		case 'p':
+			tp->period_mult = atoi(optarg);
+			if (tp->period_mult < 1) {
+				fprintf(stderr, "error: invalid period multiplier\n");
+				ret = -EINVAL;
+			}
+			break;
+
+		/* DSP processing time model */
+		case 'V':
+			tp->vdsp_model = strdup(optarg);
+			break;
+
+		/* binary topology cache */
+		case 'T':
+			tp->tplg_cache = strdup(optarg);
+			break;
+
+		/* topology setups for benchmarking */
+		case 'n':
+			tp->tplg_repeat = atoi(optarg);
+			if (tp->tplg_repeat < 1) {
+				fprintf(stderr, "error: invalid topology repeat count\n");
+				ret = -EINVAL;
+			}
+			break;
+
 		/* enable debug prints */
 		case 'd':
 			debug = 1;
@@ -255,10 +306,17 @@ int main(int argc, char **argv)
 	struct sof_ipc_pipe_new *ipc_pipe;
 	struct comp_dev *cd;
 	struct file_comp_data *frcd, *fwcd;
+	struct vdsp vdsp;
 	char pipeline[DEBUG_MSG_LEN];
 	clock_t tic, toc;
-	double c_realtime, t_exec;
+	clock_t tplg_tic, tplg_first, tplg_repeated = 0;
+	int tplg_first_cached;
+	uint64_t cycles_start, cycles;
+	uint64_t copy_begin = 0;
+	double c_realtime, t_exec, t_audio;
 	int n_in, n_out, ret;
+	int wakeups = 0;
+	int period;
 	int i;
 
 	/* initialize input and output sample rates, files, etc. */
@@ -272,6 +330,11 @@ int main(int argc, char **argv)
 	tp.output_file_num = 0;
 	tp.channels = TESTBENCH_NCH;
 	tp.max_pipeline_id = 0;
+	tp.period_mult = 1;
+	tp.vdsp_model = NULL;
+	tp.tplg_cache = NULL;
+	tp.tplg_cached = 0;
+	tp.tplg_repeat = 1;
 
 	/* command line arguments*/
 	parse_input_args(argc, argv, &tp);
@@ -289,11 +352,27 @@ int main(int argc, char **argv)
 		exit(EXIT_FAILURE);
 	}
 
-	/* parse topology file and create pipeline */
+	/* parse topology file and create pipeline, the pipelines of setups
+	 * repeated for benchmarking are freed before the next one
+	 */
+	tplg_tic = clock();
 	if (parse_topology(&sof, lib_table, &tp, pipeline) < 0) {
 		fprintf(stderr, "error: parsing topology\n");
 		exit(EXIT_FAILURE);
 	}
+	tplg_first = clock() - tplg_tic;
+	tplg_first_cached = tp.tplg_cached;
+
+	for (i = 1; i < tp.tplg_repeat; i++) {
+		free_comps();
+		tp.tplg_cached = 0;
+		tplg_tic = clock();
+		if (parse_topology(&sof, lib_table, &tp, pipeline) < 0) {
+			fprintf(stderr, "error: parsing topology\n");
+			exit(EXIT_FAILURE);
+		}
+		tplg_repeated += clock() - tplg_tic;
+	}
 
 	/* Get pointer to filewrite */
 	pcm_dev = ipc_get_comp_by_id(sof.ipc, tp.fw_id);
@@ -318,10 +397,12 @@ int main(int argc, char **argv)
 
 	/* input and output sample rate */
 	if (!tp.fs_in)
-		tp.fs_in = ipc_pipe->period * ipc_pipe->frames_per_sched;
+		tp.fs_in = ipc_pipe->period / tp.period_mult *
+			ipc_pipe->frames_per_sched;
 
 	if (!tp.fs_out)
-		tp.fs_out = ipc_pipe->period * ipc_pipe->frames_per_sched;
+		tp.fs_out = ipc_pipe->period / tp.period_mult *
+			ipc_pipe->frames_per_sched;
 
 	/* set pipeline params and trigger start */
 	if (tb_pipeline_start(sof.ipc, ipc_pipe, &tp) < 0) {
@@ -329,11 +410,36 @@ int main(int argc, char **argv)
 		exit(EXIT_FAILURE);
 	}
 
+	/* DSP load of the wakeups, each pipeline is due in its own period */
+	if (tp.vdsp_model) {
+		struct ipc_comp_dev *ppl_dev;
+
+		if (vdsp_parse(&vdsp, tp.vdsp_model) < 0 ||
+		    vdsp_init(&vdsp, ipc_pipe->period, tp.max_pipeline_id) < 0) {
+			fprintf(stderr, "error: invalid DSP time model\n");
+			exit(EXIT_FAILURE);
+		}
+
+		for (i = 1; i <= tp.max_pipeline_id; i++) {
+			ppl_dev = ipc_get_comp_by_ppl_id(sof.ipc,
+							 COMP_TYPE_PIPELINE, i);
+			if (ppl_dev)
+				vdsp_set_period(&vdsp, i,
+						ppl_dev->pipeline->ipc_pipe.period);
+		}
+	}
+
 	cd = pcm_dev->cd;
 	tb_enable_trace(false); /* reduce trace output */
 	tic = clock();
+	cycles_start = tb_get_cycles();
 
 	while (frcd->fs.reached_eof == 0) {
+		/* each scheduling round is one DSP wakeup */
+		wakeups++;
+		if (tp.vdsp_model)
+			vdsp_wakeup(&vdsp);
+
 		/*
 		 * Schedule copy for all pipelines which have the same schedule
 		 * component as the working one.
@@ -347,8 +453,16 @@ int main(int argc, char **argv)
 							 COMP_TYPE_PIPELINE, i);
 			if (pcm_dev) {
 				curr_p = pcm_dev->pipeline;
-				if (pipeline_is_same_sched_comp(p, curr_p))
-					pipeline_schedule_copy(curr_p, 0);
+				if (!pipeline_is_same_sched_comp(p, curr_p))
+					continue;
+
+				if (tp.vdsp_model)
+					copy_begin = vdsp_copy_begin();
+
+				pipeline_schedule_copy(curr_p, 0);
+
+				if (tp.vdsp_model)
+					vdsp_copy_end(&vdsp, i, copy_begin);
 			}
 		}
 	}
@@ -358,6 +472,7 @@ int main(int argc, char **argv)
 
 	/* reset and free pipeline */
 	toc = clock();
+	cycles = tb_get_cycles() - cycles_start;
 	tb_enable_trace(true);
 	pipeline_trigger(p, cd, COMP_TRIGGER_STOP);
 	ret = pipeline_reset(p, cd);
@@ -369,7 +484,9 @@ int main(int argc, char **argv)
 	n_in = frcd->fs.n;
 	n_out = fwcd->fs.n;
 	t_exec = (double)(toc - tic) / CLOCKS_PER_SEC;
-	c_realtime = (double)n_out / tp.channels / tp.fs_out / t_exec;
+	t_audio = (double)n_out / tp.channels / tp.fs_out;
+	period = ipc_pipe->period;
+	c_realtime = t_audio / t_exec;
 
 	/* free all components/buffers in pipeline */
 	free_comps();
@@ -391,11 +508,35 @@ int main(int argc, char **argv)
 	printf("Output sample count: %d\n", n_out);
 	printf("Total execution time: %.2f us, %.2f x realtime\n",
 	       1e3 * t_exec, c_realtime);
+	printf("Topology %s in %.2f ms\n",
+	       tplg_first_cached ? "loaded from cache" : "parsed",
+	       1e3 * tplg_first / CLOCKS_PER_SEC);
+	if (tp.tplg_repeat > 1)
+		printf("Topology %s in %.3f ms, mean of %d repeated setups\n",
+		       tp.tplg_cached ? "loaded from cache" : "parsed",
+		       1e3 * tplg_repeated / CLOCKS_PER_SEC /
+		       (tp.tplg_repeat - 1), tp.tplg_repeat - 1);
+	printf("Pipeline period: %d us%s\n", period,
+	       tp.period_mult > 1 ? " (deep buffer)" : "");
+	printf("Wakeups: %d, %.1f per second of audio\n", wakeups,
+	       wakeups / t_audio);
+	if (cycles) {
+		printf("Cycles: %.2f M per second of audio\n",
+		       cycles / t_audio / 1e6);
+		printf("Cycles: %.1f per output frame\n",
+		       (double)cycles * tp.channels / n_out);
+	}
+	if (tp.vdsp_model) {
+		vdsp_print(&vdsp);
+		vdsp_free(&vdsp);
+	}
 
 	/* free all other data */
 	free(tp.bits_in);
 	free(tp.input_file);
 	free(tp.tplg_file);
+	free(tp.vdsp_model);
+	free(tp.tplg_cache);
 	for (i = 0; i < tp.output_file_num; i++)
 		free(tp.output_file[i]);
 
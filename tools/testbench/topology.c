@@ -18,11 +18,13 @@
 #include <tplg_parser/topology.h>
 #include "testbench/common_test.h"
 #include "testbench/file.h"
+#include "testbench/tplg_cache.h"
 
 FILE *file;
 char pipeline_string[DEBUG_MSG_LEN];
 struct shared_lib_table *lib_table;
 int output_file_index;
+int period_mult;
 
 const struct sof_dai_types sof_dais[] = {
 	{"SSP", SOF_DAI_INTEL_SSP},
@@ -104,6 +106,7 @@ static int load_graph(void *dev, struct comp_info *temp_comp_list,
 		      int count, int num_comps, int pipeline_id)
 {
 	struct sof_ipc_pipe_comp_connect connection;
+	struct sof_ipc_pipe_ready ready = {0};
 	struct sof *sof = (struct sof *)dev;
 	int ret = 0;
 	int i;
@@ -120,13 +123,22 @@ static int load_graph(void *dev, struct comp_info *temp_comp_list,
 			fprintf(stderr, "error: comp connect\n");
 			return -EINVAL;
 		}
+
+		tplg_cache_add(SOF_IPC_GLB_TPLG_MSG | SOF_IPC_TPLG_COMP_CONNECT,
+			       &connection, sizeof(connection), NULL);
 	}
 
 	/* pipeline complete after pipeline connections are established */
 	for (i = 0; i < num_comps; i++) {
 		if (temp_comp_list[i].pipeline_id == pipeline_id &&
-		    temp_comp_list[i].type == SND_SOC_TPLG_DAPM_SCHEDULER)
+		    temp_comp_list[i].type == SND_SOC_TPLG_DAPM_SCHEDULER) {
 			ipc_pipeline_complete(sof->ipc, temp_comp_list[i].id);
+
+			ready.comp_id = temp_comp_list[i].id;
+			tplg_cache_add(SOF_IPC_GLB_TPLG_MSG |
+				       SOF_IPC_TPLG_PIPE_COMPLETE,
+				       &ready, sizeof(ready), NULL);
+		}
 	}
 
 	return ret;
@@ -145,6 +157,9 @@ int load_buffer(void *dev, int comp_id, int pipeline_id,
 	if (ret < 0)
 		return ret;
 
+	/* deep buffer mode needs room for the longer period */
+	buffer.size *= period_mult;
+
 	if (tplg_load_controls(widget->num_kcontrols, file) < 0) {
 		fprintf(stderr, "error: loading controls\n");
 		return -EINVAL;
@@ -156,6 +171,9 @@ int load_buffer(void *dev, int comp_id, int pipeline_id,
 		return -EINVAL;
 	}
 
+	tplg_cache_add(SOF_IPC_GLB_TPLG_MSG | SOF_IPC_TPLG_BUFFER_NEW,
+		       &buffer, sizeof(buffer), NULL);
+
 	return 0;
 }
 
@@ -326,6 +344,9 @@ static int load_fileread(void *dev, int comp_id, int pipeline_id,
 		return -EINVAL;
 	}
 
+	tplg_cache_add(SOF_IPC_GLB_TPLG_MSG | SOF_IPC_TPLG_COMP_NEW,
+		       &fileread, sizeof(fileread), NULL);
+
 	free(fileread.fn);
 	return 0;
 }
@@ -375,6 +396,9 @@ static int load_filewrite(struct sof *sof, int comp_id, int pipeline_id,
 		return -EINVAL;
 	}
 
+	tplg_cache_add(SOF_IPC_GLB_TPLG_MSG | SOF_IPC_TPLG_COMP_NEW,
+		       &filewrite, sizeof(filewrite), NULL);
+
 	free(filewrite.fn);
 	return 0;
 }
@@ -461,6 +485,9 @@ int load_pga(void *dev, int comp_id, int pipeline_id,
 		return -EINVAL;
 	}
 
+	tplg_cache_add(SOF_IPC_GLB_TPLG_MSG | SOF_IPC_TPLG_COMP_NEW,
+		       &volume, sizeof(volume), NULL);
+
 	return 0;
 }
 
@@ -483,6 +510,7 @@ int load_pipeline(void *dev, int comp_id, int pipeline_id,
 	}
 
 	pipeline.sched_id = sched_id;
+	pipeline.period *= period_mult;
 
 	/* Create pipeline */
 	if (ipc_pipeline_new(sof->ipc, &pipeline) < 0) {
@@ -490,6 +518,9 @@ int load_pipeline(void *dev, int comp_id, int pipeline_id,
 		return -EINVAL;
 	}
 
+	tplg_cache_add(SOF_IPC_GLB_TPLG_MSG | SOF_IPC_TPLG_PIPE_NEW,
+		       &pipeline, sizeof(pipeline), NULL);
+
 	return 0;
 }
 
@@ -532,6 +563,9 @@ int load_src(void *dev, int comp_id, int pipeline_id,
 		return -EINVAL;
 	}
 
+	tplg_cache_add(SOF_IPC_GLB_TPLG_MSG | SOF_IPC_TPLG_COMP_NEW,
+		       &src, sizeof(src), NULL);
+
 	return ret;
 }
 
@@ -574,6 +608,9 @@ int load_asrc(void *dev, int comp_id, int pipeline_id,
 		return -EINVAL;
 	}
 
+	tplg_cache_add(SOF_IPC_GLB_TPLG_MSG | SOF_IPC_TPLG_COMP_NEW,
+		       &asrc, sizeof(asrc), NULL);
+
 	return ret;
 }
 
@@ -662,10 +699,15 @@ int load_process(void *dev, int comp_id, int pipeline_id,
 
 	/* Instantiate */
 	ret = ipc_comp_new(sof->ipc, (struct sof_ipc_comp *)process_ipc);
-	free(process_ipc);
-
 	if (ret < 0)
 		fprintf(stderr, "error: new process comp\n");
+	else
+		tplg_cache_add(SOF_IPC_GLB_TPLG_MSG | SOF_IPC_TPLG_COMP_NEW,
+			       process_ipc,
+			       sizeof(*process_ipc) + process_ipc->size,
+			       &comp_ext);
+
+	free(process_ipc);
 
 	return ret;
 }
@@ -696,8 +738,10 @@ int parse_topology(struct sof *sof, struct shared_lib_table *library_table,
 {
 	struct snd_soc_tplg_hdr *hdr;
 
-	/* initialize output file index */
+	/* initialize output file index and pipeline description */
 	output_file_index = 0;
+	pipeline_string[0] = '\0';
+	period_mult = tp->period_mult;
 
 	struct comp_info *temp_comp_list = NULL, *comp_list_realloc = NULL;
 	char message[DEBUG_MSG_LEN];
@@ -717,6 +761,18 @@ int parse_topology(struct sof *sof, struct shared_lib_table *library_table,
 
 	lib_table = library_table;
 
+	/* pipelines of an unchanged topology are set up from the cache */
+	if (tp->tplg_cache) {
+		ret = tplg_cache_load(sof, tp, pipeline_msg);
+		if (ret) {
+			fclose(file);
+			tp->tplg_cached = ret > 0;
+			return ret < 0 ? ret : 0;
+		}
+
+		tplg_cache_start(tp);
+	}
+
 	/* file size */
 	if (fseek(file, 0, SEEK_END)) {
 		fprintf(stderr, "error: seek to end of topology\n");
@@ -826,5 +882,9 @@ finish:
 
 	free(temp_comp_list);
 	fclose(file);
+
+	if (ret >= 0 && tp->tplg_cache)
+		tplg_cache_save(tp, pipeline_msg);
+
 	return ret;
 }
@@ -0,0 +1,339 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/*
+ * Binary topology cache of the testbench. The IPC messages built by the
+ * topology loader are stored in the order they are sent, together with the
+ * testbench parameters they depend on. Later runs with the same topology file
+ * and parameters map the cache and replay the messages without parsing the
+ * topology again.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <sof/common.h>
+#include <sof/drivers/ipc.h>
+#include <ipc/header.h>
+#include <kernel/abi.h>
+#include <tplg_parser/topology.h>
+#include "testbench/file.h"
+#include "testbench/tplg_cache.h"
+
+#define TPLG_CACHE_MAGIC	0x48434354	/* "TCCH" */
+#define TPLG_CACHE_VERSION	2
+
+/* testbench parameters the cached messages depend on */
+struct tplg_cache_key {
+	uint64_t tplg_size;
+	int64_t tplg_mtime;
+	uint32_t abi_version;
+	uint32_t fs_in;
+	uint32_t fs_out;
+	uint32_t channels;
+	uint32_t frame_fmt;
+	uint32_t period_mult;
+	uint32_t output_file_num;
+	uint32_t tplg_mtime_nsec;
+};
+
+struct tplg_cache_hdr {
+	uint32_t magic;
+	uint32_t version;
+	struct tplg_cache_key key;
+
+	/* testbench parameters set by the topology */
+	uint32_t fs_in;
+	uint32_t fs_out;
+	int32_t fr_id;
+	int32_t fw_id;
+	int32_t sched_id;
+	int32_t max_pipeline_id;
+
+	uint32_t num_recs;
+	uint32_t size;		/* bytes of the records after the header */
+	char pipeline[DEBUG_MSG_LEN];
+};
+
+/* message of the topology loader, followed by the message data */
+struct tplg_cache_rec {
+	uint32_t cmd;		/* global and command type */
+	uint32_t size;		/* bytes of the message */
+	uint32_t has_ext;	/* comp_ext is used to register the driver */
+	uint32_t reserved;
+	struct sof_ipc_comp_ext comp_ext;
+};
+
+/* records are 8 byte aligned for the mapped replay */
+#define TPLG_CACHE_REC_SIZE(size) \
+	(sizeof(struct tplg_cache_rec) + ALIGN_UP(size, 8))
+
+static struct tplg_cache_key cache_key;
+static uint8_t *cache_data;
+static size_t cache_size;
+static uint32_t cache_recs;
+static bool cache_recording;
+
+static int tplg_cache_key_get(struct testbench_prm *tp,
+			      struct tplg_cache_key *key)
+{
+	struct stat st;
+
+	if (stat(tp->tplg_file, &st) < 0)
+		return -errno;
+
+	memset(key, 0, sizeof(*key));
+	key->tplg_size = st.st_size;
+	key->tplg_mtime = st.st_mtim.tv_sec;
+	key->tplg_mtime_nsec = st.st_mtim.tv_nsec;
+	key->abi_version = SOF_ABI_VERSION;
+	key->fs_in = tp->fs_in;
+	key->fs_out = tp->fs_out;
+	key->channels = tp->channels;
+	key->frame_fmt = tp->frame_fmt;
+	key->period_mult = tp->period_mult;
+	key->output_file_num = tp->output_file_num;
+
+	return 0;
+}
+
+/* file components take their file names from the command line */
+static int tplg_cache_file_name(struct testbench_prm *tp,
+				struct sof_ipc_comp_file *file, int *outputs)
+{
+	if (file->comp.hdr.size != sizeof(*file))
+		return -EINVAL;
+
+	if (file->mode == FILE_READ) {
+		file->fn = tp->input_file;
+		return 0;
+	}
+
+	if (*outputs >= tp->output_file_num)
+		return -EINVAL;
+
+	file->fn = tp->output_file[(*outputs)++];
+
+	return 0;
+}
+
+static int tplg_cache_send(struct sof *sof, struct testbench_prm *tp,
+			   struct tplg_cache_rec *rec, void *msg, int *outputs)
+{
+	struct sof_ipc_comp *comp = msg;
+	int ret;
+
+	switch (rec->cmd) {
+	case SOF_IPC_GLB_TPLG_MSG | SOF_IPC_TPLG_COMP_NEW:
+		register_comp(comp->type, rec->has_ext ? &rec->comp_ext : NULL);
+
+		if (comp->type == SOF_COMP_HOST || comp->type == SOF_COMP_DAI) {
+			ret = tplg_cache_file_name(tp, msg, outputs);
+			if (ret < 0)
+				return ret;
+		}
+
+		return ipc_comp_new(sof->ipc, comp);
+	case SOF_IPC_GLB_TPLG_MSG | SOF_IPC_TPLG_BUFFER_NEW:
+		return ipc_buffer_new(sof->ipc, msg);
+	case SOF_IPC_GLB_TPLG_MSG | SOF_IPC_TPLG_PIPE_NEW:
+		return ipc_pipeline_new(sof->ipc, msg);
+	case SOF_IPC_GLB_TPLG_MSG | SOF_IPC_TPLG_COMP_CONNECT:
+		return ipc_comp_connect(sof->ipc, msg);
+	case SOF_IPC_GLB_TPLG_MSG | SOF_IPC_TPLG_PIPE_COMPLETE:
+		/* result is not checked by the topology loader either */
+		ipc_pipeline_complete(sof->ipc,
+				      ((struct sof_ipc_pipe_ready *)msg)->comp_id);
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
+
+static int tplg_cache_replay(struct sof *sof, struct testbench_prm *tp,
+			     struct tplg_cache_hdr *hdr)
+{
+	uint8_t *pos = (uint8_t *)(hdr + 1);
+	uint8_t *end = pos + hdr->size;
+	struct tplg_cache_rec *rec;
+	int outputs = 0;
+	uint32_t i;
+	int ret;
+
+	for (i = 0; i < hdr->num_recs; i++) {
+		rec = (struct tplg_cache_rec *)pos;
+		if (end - pos < sizeof(*rec) ||
+		    end - pos < TPLG_CACHE_REC_SIZE(rec->size)) {
+			fprintf(stderr, "error: topology cache truncated\n");
+			return -EINVAL;
+		}
+
+		ret = tplg_cache_send(sof, tp, rec, rec + 1, &outputs);
+		if (ret < 0) {
+			fprintf(stderr, "error: topology cache cmd 0x%x\n",
+				rec->cmd);
+			return ret;
+		}
+
+		pos += TPLG_CACHE_REC_SIZE(rec->size);
+	}
+
+	return 0;
+}
+
+/*
+ * Sets up the pipelines from the cache of the topology. Returns 1 when the
+ * cache was used, 0 when it's missing or made with other parameters.
+ */
+int tplg_cache_load(struct sof *sof, struct testbench_prm *tp,
+		    char *pipeline_msg)
+{
+	struct tplg_cache_key key;
+	struct tplg_cache_hdr *hdr;
+	struct stat st;
+	void *addr;
+	int fd;
+	int ret;
+
+	fd = open(tp->tplg_cache, O_RDONLY);
+	if (fd < 0)
+		return 0;
+
+	if (fstat(fd, &st) < 0 || st.st_size < sizeof(*hdr)) {
+		close(fd);
+		return 0;
+	}
+
+	/* private mapping, file names are written to the messages */
+	addr = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+		    fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED)
+		return 0;
+
+	hdr = addr;
+	if (tplg_cache_key_get(tp, &key) < 0 ||
+	    hdr->magic != TPLG_CACHE_MAGIC ||
+	    hdr->version != TPLG_CACHE_VERSION ||
+	    memcmp(&hdr->key, &key, sizeof(key)) ||
+	    st.st_size != sizeof(*hdr) + hdr->size) {
+		debug_print("topology cache is stale\n");
+		munmap(addr, st.st_size);
+		return 0;
+	}
+
+	ret = tplg_cache_replay(sof, tp, hdr);
+	if (!ret) {
+		tp->fs_in = hdr->fs_in;
+		tp->fs_out = hdr->fs_out;
+		tp->fr_id = hdr->fr_id;
+		tp->fw_id = hdr->fw_id;
+		tp->sched_id = hdr->sched_id;
+		tp->max_pipeline_id = hdr->max_pipeline_id;
+		memcpy(pipeline_msg, hdr->pipeline, sizeof(hdr->pipeline));
+		pipeline_msg[DEBUG_MSG_LEN - 1] = '\0';
+	}
+
+	munmap(addr, st.st_size);
+
+	return ret < 0 ? ret : 1;
+}
+
+/* records the messages of the following topology parsing */
+void tplg_cache_start(struct testbench_prm *tp)
+{
+	cache_recording = tp->tplg_cache &&
+		!tplg_cache_key_get(tp, &cache_key);
+	cache_size = 0;
+	cache_recs = 0;
+}
+
+void tplg_cache_add(uint32_t cmd, const void *msg, uint32_t size,
+		    const struct sof_ipc_comp_ext *comp_ext)
+{
+	struct tplg_cache_rec *rec;
+	uint8_t *data;
+
+	if (!cache_recording)
+		return;
+
+	data = realloc(cache_data, cache_size + TPLG_CACHE_REC_SIZE(size));
+	if (!data) {
+		fprintf(stderr, "warning: topology cache disabled\n");
+		cache_recording = false;
+		return;
+	}
+
+	cache_data = data;
+	rec = (struct tplg_cache_rec *)(cache_data + cache_size);
+	memset(rec, 0, TPLG_CACHE_REC_SIZE(size));
+	rec->cmd = cmd;
+	rec->size = size;
+	if (comp_ext) {
+		rec->has_ext = 1;
+		rec->comp_ext = *comp_ext;
+	}
+
+	memcpy(rec + 1, msg, size);
+
+	cache_size += TPLG_CACHE_REC_SIZE(size);
+	cache_recs++;
+}
+
+int tplg_cache_save(struct testbench_prm *tp, const char *pipeline_msg)
+{
+	struct tplg_cache_hdr hdr;
+	FILE *fh;
+	int ret = 0;
+
+	if (!cache_recording)
+		return 0;
+
+	cache_recording = false;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = TPLG_CACHE_MAGIC;
+	hdr.version = TPLG_CACHE_VERSION;
+	hdr.key = cache_key;
+	hdr.fs_in = tp->fs_in;
+	hdr.fs_out = tp->fs_out;
+	hdr.fr_id = tp->fr_id;
+	hdr.fw_id = tp->fw_id;
+	hdr.sched_id = tp->sched_id;
+	hdr.max_pipeline_id = tp->max_pipeline_id;
+	hdr.num_recs = cache_recs;
+	hdr.size = cache_size;
+	strncpy(hdr.pipeline, pipeline_msg, DEBUG_MSG_LEN - 1);
+
+	fh = fopen(tp->tplg_cache, "wb");
+	if (!fh) {
+		fprintf(stderr, "error: opening file %s\n", tp->tplg_cache);
+		ret = -errno;
+		goto out;
+	}
+
+	if (fwrite(&hdr, sizeof(hdr), 1, fh) != 1 ||
+	    (cache_size && fwrite(cache_data, cache_size, 1, fh) != 1)) {
+		fprintf(stderr, "error: writing file %s\n", tp->tplg_cache);
+		ret = -EIO;
+	}
+
+	fclose(fh);
+
+	/* partial cache would be replayed as a broken topology */
+	if (ret < 0)
+		unlink(tp->tplg_cache);
+
+out:
+	free(cache_data);
+	cache_data = NULL;
+
+	return ret;
+}
@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "testbench/vdsp.h"
+
+/* DSP processing time model of the testbench pipeline copies */
+
+#define NS_PER_US	1000
+#define NS_PER_S	1000000000ULL
+
+/*
+ * Parse the processing time model from user input in the format
+ * "scale[,overhead_us]". The DSP time of a pipeline copy is the host
+ * execution time multiplied by scale plus the fixed overhead, so scale 0
+ * gives a deterministic model.
+ */
+int vdsp_parse(struct vdsp *vdsp, char *model)
+{
+	char *end;
+
+	vdsp->scale = strtod(model, &end);
+	if (end == model || vdsp->scale < 0)
+		return -EINVAL;
+
+	vdsp->overhead_ns = 0;
+	if (*end == ',') {
+		model = end + 1;
+		vdsp->overhead_ns = strtoul(model, &end, 10) * NS_PER_US;
+		if (end == model)
+			return -EINVAL;
+	}
+
+	return *end ? -EINVAL : 0;
+}
+
+int vdsp_init(struct vdsp *vdsp, uint32_t period_us, int max_pipeline_id)
+{
+	if (!period_us)
+		return -EINVAL;
+
+	vdsp->period_ns = (uint64_t)period_us * NS_PER_US;
+	vdsp->wakeup_busy_ns = 0;
+	vdsp->max_wakeup_busy_ns = 0;
+	vdsp->busy_ns = 0;
+	vdsp->wakeups = 0;
+	vdsp->num_pipes = max_pipeline_id + 1;
+	vdsp->pipes = calloc(vdsp->num_pipes, sizeof(*vdsp->pipes));
+	if (!vdsp->pipes)
+		return -ENOMEM;
+
+	return 0;
+}
+
+void vdsp_free(struct vdsp *vdsp)
+{
+	free(vdsp->pipes);
+	vdsp->pipes = NULL;
+}
+
+/* sets the period the copies of the pipeline are due in */
+int vdsp_set_period(struct vdsp *vdsp, int pipeline_id, uint32_t period_us)
+{
+	if (pipeline_id < 0 || pipeline_id >= vdsp->num_pipes || !period_us)
+		return -EINVAL;
+
+	vdsp->pipes[pipeline_id].period_ns = (uint64_t)period_us * NS_PER_US;
+
+	return 0;
+}
+
+/* starts summing the copies of the next wakeup */
+void vdsp_wakeup(struct vdsp *vdsp)
+{
+	vdsp->wakeups++;
+	vdsp->wakeup_busy_ns = 0;
+}
+
+/* host time stamp of the copy start */
+uint64_t vdsp_copy_begin(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * NS_PER_S + ts.tv_nsec;
+}
+
+/* adds the modelled DSP time of the copy to the wakeup */
+void vdsp_copy_end(struct vdsp *vdsp, int pipeline_id, uint64_t begin)
+{
+	struct vdsp_pipe_stats *ps;
+	uint64_t busy;
+
+	if (pipeline_id < 0 || pipeline_id >= vdsp->num_pipes)
+		return;
+
+	ps = vdsp->pipes + pipeline_id;
+	busy = (vdsp_copy_begin() - begin) * vdsp->scale + vdsp->overhead_ns;
+
+	vdsp->busy_ns += busy;
+	vdsp->wakeup_busy_ns += busy;
+	if (vdsp->wakeup_busy_ns > vdsp->max_wakeup_busy_ns)
+		vdsp->max_wakeup_busy_ns = vdsp->wakeup_busy_ns;
+
+	ps->copies++;
+	ps->busy_ns += busy;
+	if (busy > ps->max_busy_ns)
+		ps->max_busy_ns = busy;
+
+	/* the copies of the wakeup so far don't fit in the pipeline period */
+	if (ps->period_ns && vdsp->wakeup_busy_ns > ps->period_ns)
+		ps->misses++;
+}
+
+void vdsp_print(struct vdsp *vdsp)
+{
+	struct vdsp_pipe_stats *ps;
+	uint64_t elapsed_ns = (uint64_t)vdsp->wakeups * vdsp->period_ns;
+	int i;
+
+	if (!elapsed_ns)
+		return;
+
+	printf("DSP time model: %.2f x host time + %.1f us per copy\n",
+	       vdsp->scale, (double)vdsp->overhead_ns / NS_PER_US);
+	printf("DSP load estimate: %.1f %% average, %.1f %% peak wakeup\n",
+	       100.0 * vdsp->busy_ns / elapsed_ns,
+	       100.0 * vdsp->max_wakeup_busy_ns / vdsp->period_ns);
+
+	for (i = 0; i < vdsp->num_pipes; i++) {
+		ps = vdsp->pipes + i;
+		if (!ps->copies || !ps->period_ns)
+			continue;
+
+		printf("Pipeline %d: period %.1f us, copy %.1f us avg %.1f us max, ",
+		       i, (double)ps->period_ns / NS_PER_US,
+		       (double)ps->busy_ns / ps->copies / NS_PER_US,
+		       (double)ps->max_busy_ns / NS_PER_US);
+		printf("%u wakeups over the period\n", ps->misses);
+	}
+}
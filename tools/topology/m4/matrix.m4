@@ -0,0 +1,65 @@
+divert(-1)
+
+dnl Define macro for channel matrix widget
+DECLARE_SOF_RT_UUID("matrix", matrix_uuid, 0x7c4d3a1b, 0x5e29, 0x4f83,
+		 0x9a, 0x6c, 0x2d, 0x18, 0xb0, 0xe4, 0xf5, 0x37)
+
+dnl N_MATRIX(name)
+define(`N_MATRIX', `MATRIX'PIPELINE_ID`.'$1)
+
+dnl W_MATRIX(name, format, periods_sink, periods_source, core, kcontrols_list)
+define(`W_MATRIX',
+`SectionVendorTuples."'N_MATRIX($1)`_tuples_uuid" {'
+`	tokens "sof_comp_tokens"'
+`	tuples."uuid" {'
+`		SOF_TKN_COMP_UUID'		STR(matrix_uuid)
+`	}'
+`}'
+`SectionData."'N_MATRIX($1)`_data_uuid" {'
+`	tuples "'N_MATRIX($1)`_tuples_uuid"'
+`}'
+`SectionVendorTuples."'N_MATRIX($1)`_tuples_w" {'
+`	tokens "sof_comp_tokens"'
+`	tuples."word" {'
+`		SOF_TKN_COMP_PERIOD_SINK_COUNT'		STR($3)
+`		SOF_TKN_COMP_PERIOD_SOURCE_COUNT'	STR($4)
+`		SOF_TKN_COMP_CORE_ID'			STR($5)
+`	}'
+`}'
+`SectionData."'N_MATRIX($1)`_data_w" {'
+`	tuples "'N_MATRIX($1)`_tuples_w"'
+`}'
+`SectionVendorTuples."'N_MATRIX($1)`_tuples_str" {'
+`	tokens "sof_comp_tokens"'
+`	tuples."string" {'
+`		SOF_TKN_COMP_FORMAT'	STR($2)
+`	}'
+`}'
+`SectionData."'N_MATRIX($1)`_data_str" {'
+`	tuples "'N_MATRIX($1)`_tuples_str"'
+`}'
+`SectionVendorTuples."'N_MATRIX($1)`_tuples_str_type" {'
+`	tokens "sof_process_tokens"'
+`	tuples."string" {'
+`		SOF_TKN_PROCESS_TYPE'	"MATRIX"
+`	}'
+`}'
+`SectionData."'N_MATRIX($1)`_data_str_type" {'
+`	tuples "'N_MATRIX($1)`_tuples_str_type"'
+`}'
+`SectionWidget."'N_MATRIX($1)`" {'
+`	index "'PIPELINE_ID`"'
+`	type "effect"'
+`	no_pm "true"'
+`	data ['
+`		"'N_MATRIX($1)`_data_uuid"'
+`		"'N_MATRIX($1)`_data_w"'
+`		"'N_MATRIX($1)`_data_str"'
+`		"'N_MATRIX($1)`_data_str_type"'
+`	]'
+`	bytes ['
+		$6
+`	]'
+`}')
+
+divert(0)dnl
@@ -56,7 +56,7 @@ end
 %	uint16_t num_filters;
 %	uint16_t num_output_channels;
 %	uint16_t num_output_streams;
-%	uint16_t reserved16;
+%	uint16_t mode;
 %	uint32_t reserved32[4];
 %	int16_t data[];
 %
@@ -65,6 +65,9 @@ end
 % int16_t fir_filter2[length_filter2];  Multiple of 4 taps and 32 bit align
 %		...
 % int16_t fir_filterN[length_filterN];  Multiple of 4 taps and 32 bit align
+% or in frequency domain mode with non-zero bf.fft_size
+% int16_t freq_filter1[fft_size + 2];  Complex weights of bins 0 .. fft_size/2
+%		...
 % int16_t input_channel_select[num_filters];  0 = ch0, 1 = 1ch1, ..
 % int16_t output_channel_mix[num_filters];
 % int16_t output_stream_mix[num_filters];
@@ -80,6 +83,9 @@ h16(2) = 0;
 h16(3) = bf.num_filters;
 h16(4) = bf.num_output_channels;
 h16(5) = bf.num_output_streams;
+if bf.fft_size > 0
+	h16(6) = 1; % SOF_TDFB_MODE_FREQ
+end
 
 %% Merge header and coefficients, make even number of int16 to make it
 %  multiple of int32
@@ -7,6 +7,7 @@ bf.steer_az = 0;     % Azimuth 0 deg
 bf.steer_el = 0;     % Elevation 0 deg
 bf.steer_r = 2.0;    % Distance 2.0m
 bf.fir_length = 64;  % 64 tap FIR filters
+bf.fft_size = 0;     % Set to e.g. 256 for frequency domain mode weights
 bf.fir_beta = 10;    % Beta for kaiser window method FIR design
 bf.mu_db = -50;      % dB of diagonal loading to noise covariance matrix
 bf.do_plots = 1;
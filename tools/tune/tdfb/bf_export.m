@@ -19,7 +19,11 @@ addpath('../eq');
 %% Build blob
 filters = [];
 for i=1:bf.num_filters
-	bq = eq_fir_blob_quant(bf.w(:,i)', 16, 0);
+	if bf.fft_size > 0
+		bq = bf_freq_blob_quant(bf.w(:,i)', bf.fft_size);
+	else
+		bq = eq_fir_blob_quant(bf.w(:,i)', 16, 0);
+	end
 	filters = [filters bq ];
 end
 bf.all_filters = filters;
@@ -30,3 +34,35 @@ eq_alsactl_write(bf.sofctl_fn, bp);
 eq_tplg_write(bf.tplg_fn, bp, 'DEF_TDFB_PRIV');
 
 end
+
+function fbr = bf_freq_blob_quant(b, fft_size)
+
+% Complex weights of FFT bins 0 .. fft_size / 2 for frequency domain mode.
+% The overlap-save processes fft_size / 2 new samples per FFT so the
+% filter can't be longer than fft_size / 2 + 1.
+if length(b) > fft_size / 2 + 1
+	error('Filter length %d is too long for FFT size %d', ...
+	      length(b), fft_size);
+end
+
+w = fft(b, fft_size);
+w = w(1:fft_size / 2 + 1);
+
+%% Output shift for weights as with FIR coefficients
+scale = 2^15;
+m = max(abs([real(w) imag(w)]));
+shift = -ceil(log(m + 1 / scale) / log(2));
+wr = max(min(round(real(w) * 2^shift * scale), scale - 1), -scale);
+wi = max(min(round(imag(w) * 2^shift * scale), scale - 1), -scale);
+
+%% Pack data into frequency domain coefficient format
+%	int16_t fft_size
+%	int16_t out_shift
+%	uint32_t reserved[4]
+%	int16_t coef[]  real and imaginary part pairs
+coef = zeros(1, 2 * length(wr));
+coef(1:2:end) = wr;
+coef(2:2:end) = wi;
+fbr = [fft_size shift 0 0 0 0 0 0 0 0 coef];
+
+end
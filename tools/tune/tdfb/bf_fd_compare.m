@@ -0,0 +1,98 @@
+% bf_fd_compare(bf)
+%
+% Compares the frequency domain mode of TDFB to the time domain FIR filter
+% bank for a design. The frequency domain mode is modeled as in firmware
+% with overlap-save of bf.fft_size and Q1.15 quantized weights. The output
+% difference to the FIR filters and the multiplications per frame of both
+% modes are printed.
+%
+% Inputs
+% bf ............... the design procedure output with bf.fft_size set
+
+% SPDX-License-Identifier: BSD-3-Clause
+%
+% Copyright (c) 2020, Intel Corporation. All rights reserved.
+
+function bf_fd_compare(bf)
+
+if bf.fft_size < 4
+	error('Set bf.fft_size for the frequency domain mode');
+end
+
+n_fft = bf.fft_size;
+hop = n_fft / 2;
+n_fir = size(bf.w, 1);
+n_in = max(bf.input_channel_select) + 1;
+n_out = bf.num_output_channels;
+nx = 20 * n_fft;
+
+if n_fir > hop + 1
+	error('FIR length %d is too long for FFT size %d', n_fir, n_fft);
+end
+
+x = 0.1 * randn(nx, n_in);
+
+%% Time domain reference
+yt = zeros(nx, n_out);
+for i = 1:bf.num_filters
+	y = filter(bf.w(:,i), 1, x(:, bf.input_channel_select(i) + 1));
+	for ch = 1:n_out
+		if bitand(bf.output_channel_mix(i), 2^(ch - 1))
+			yt(:, ch) = yt(:, ch) + y;
+		end
+	end
+end
+
+%% Quantized weights as in bf_export()
+w = zeros(n_fft, bf.num_filters);
+for i = 1:bf.num_filters
+	wf = fft(bf.w(:,i), n_fft);
+	wf = wf(1:hop + 1);
+	m = max(abs([real(wf); imag(wf)]));
+	shift = -ceil(log(m + 2^-15) / log(2));
+	wq = round(wf * 2^(shift + 15)) / 2^(shift + 15);
+	w(:,i) = [wq; conj(wq(hop:-1:2))];
+end
+
+%% Overlap-save, without the one hop latency of firmware
+yf = zeros(nx, n_out);
+win = zeros(n_fft, n_in);
+for b = 1:floor(nx / hop)
+	idx = (b - 1) * hop + (1:hop);
+	win = [win(hop + 1:end, :); x(idx, :)];
+	xf = fft(win);
+	yspec = zeros(n_fft, n_out);
+	for i = 1:bf.num_filters
+		for ch = 1:n_out
+			if bitand(bf.output_channel_mix(i), 2^(ch - 1))
+				yspec(:, ch) = yspec(:, ch) + ...
+					w(:,i) .* xf(:, bf.input_channel_select(i) + 1);
+			end
+		end
+	end
+	y = real(ifft(yspec));
+	yf(idx, :) = y(hop + 1:end, :);
+end
+
+%% Results
+i1 = n_fft + 1;
+err_db = 20 * log10(norm(yf(i1:end, :) - yt(i1:end, :)) / ...
+		    norm(yt(i1:end, :)));
+mixes = 0;
+for i = 1:bf.num_filters
+	mixes = mixes + sum(bitget(bf.output_channel_mix(i), 1:n_out));
+end
+
+% Real multiplications per frame, radix-2 FFT has 4 per butterfly
+mul_time = bf.num_filters * n_fir;
+mul_fft = 4 * n_fft / 2 * log2(n_fft);
+mul_freq = ((n_in + n_out) * mul_fft + ...
+	    4 * (hop + 1) * (bf.num_filters + mixes)) / hop;
+
+fprintf(1, 'FIR length %d, FFT size %d, latency %d frames\n', ...
+	n_fir, n_fft, hop);
+fprintf(1, 'Frequency domain output difference %.1f dB\n', err_db);
+fprintf(1, 'Multiplications per frame, time %d, frequency %.0f\n', ...
+	mul_time, mul_freq);
+
+end